@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <time.h>
+
+#include <cerver/types/types.h>
+
+#include <cerver/collections/htab.h>
+#include <cerver/collections/ohtab.h>
+
+#define STRING_KEY_SIZE					16
+
+typedef enum BenchHtabType {
+
+	BENCH_HTAB_TYPE_SUM				= 0,	// htab with the old sum of bytes hash
+	BENCH_HTAB_TYPE_HTAB			= 1,
+	BENCH_HTAB_TYPE_OHTAB			= 2
+
+} BenchHtabType;
+
+static const char *bench_htab_type_names[] = { "sum", "htab", "ohtab" };
+
+// the previous generic htab hash, used as a reference
+static size_t bench_htab_sum_hash (
+	const void *key, size_t key_size, size_t table_size
+) {
+
+	size_t sum = 0;
+	const u8 *bytes = (const u8 *) key;
+	for (size_t i = 0; i < key_size; i++) sum += bytes[i];
+
+	return sum % table_size;
+
+}
+
+static double bench_htab_elapsed (
+	const struct timespec *start, const struct timespec *end
+) {
+
+	return (double) (end->tv_sec - start->tv_sec)
+		+ (double) (end->tv_nsec - start->tv_nsec) / 1e9;
+
+}
+
+// inserts, gets & removes every key
+// returns the number of operations per second
+static double bench_htab_run (
+	BenchHtabType type, const u8 *keys, size_t key_size, size_t n_keys
+) {
+
+	Htab *htab = NULL;
+	OHtab *ohtab = NULL;
+	switch (type) {
+		case BENCH_HTAB_TYPE_SUM:
+			htab = htab_create (HTAB_DEFAULT_INIT_SIZE, bench_htab_sum_hash, NULL);
+			break;
+		case BENCH_HTAB_TYPE_HTAB:
+			htab = htab_create (HTAB_DEFAULT_INIT_SIZE, NULL, NULL);
+			break;
+		case BENCH_HTAB_TYPE_OHTAB:
+			ohtab = ohtab_create (key_size, OHTAB_DEFAULT_INIT_SIZE, NULL);
+			break;
+	}
+
+	// every key maps to a value that is not NULL
+	void *value = (void *) keys;
+	size_t found = 0;
+
+	struct timespec start = { 0 }, end = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &start);
+
+	for (size_t i = 0; i < n_keys; i++) {
+		if (htab) (void) htab_insert (htab, &keys[i * key_size], key_size, value, 1);
+		else (void) ohtab_insert (ohtab, &keys[i * key_size], value);
+	}
+
+	for (size_t i = 0; i < n_keys; i++) {
+		if (htab) found += (htab_get (htab, &keys[i * key_size], key_size) != NULL);
+		else found += (ohtab_get (ohtab, &keys[i * key_size]) != NULL);
+	}
+
+	for (size_t i = 0; i < n_keys; i++) {
+		if (htab) (void) htab_remove (htab, &keys[i * key_size], key_size);
+		else (void) ohtab_remove (ohtab, &keys[i * key_size]);
+	}
+
+	(void) clock_gettime (CLOCK_MONOTONIC, &end);
+
+	if (found != n_keys) (void) printf ("only %lu / %lu keys found! ", found, n_keys);
+
+	if (htab) htab_destroy (htab);
+	else ohtab_destroy (ohtab);
+
+	return (double) (n_keys * 3) / bench_htab_elapsed (&start, &end);
+
+}
+
+// sock fd like keys
+static u8 *bench_htab_int_keys (size_t n_keys) {
+
+	i32 *keys = (i32 *) malloc (n_keys * sizeof (i32));
+	for (size_t i = 0; i < n_keys; i++) keys[i] = (i32) i + 3;
+
+	return (u8 *) keys;
+
+}
+
+// fixed size random strings
+static u8 *bench_htab_string_keys (size_t n_keys) {
+
+	char *keys = (char *) malloc (n_keys * STRING_KEY_SIZE);
+	for (size_t i = 0; i < n_keys; i++) {
+		char *key = &keys[i * STRING_KEY_SIZE];
+		for (size_t c = 0; c < (STRING_KEY_SIZE - 1); c++)
+			key[c] = (char) ('a' + (rand () % 26));
+
+		key[STRING_KEY_SIZE - 1] = '\0';
+	}
+
+	return (u8 *) keys;
+
+}
+
+int main (int argc, const char **argv) {
+
+	srand ((unsigned) time (NULL));
+
+	const size_t sizes[] = { 1000, 10000, 100000 };
+
+	(void) printf ("Htabs - insert, get & remove every key\n\n");
+
+	for (unsigned int s = 0; s < 3; s++) {
+		u8 *int_keys = bench_htab_int_keys (sizes[s]);
+		u8 *string_keys = bench_htab_string_keys (sizes[s]);
+
+		for (unsigned int t = 0; t < 3; t++) {
+			// the sum hash is too slow with many keys
+			if ((t == BENCH_HTAB_TYPE_SUM) && (sizes[s] > 10000)) continue;
+
+			(void) printf (
+				"%-6s %6lu int keys\t: %12.0f ops / sec\n",
+				bench_htab_type_names[t], sizes[s],
+				bench_htab_run ((BenchHtabType) t, int_keys, sizeof (i32), sizes[s])
+			);
+
+			(void) printf (
+				"%-6s %6lu string keys\t: %12.0f ops / sec\n",
+				bench_htab_type_names[t], sizes[s],
+				bench_htab_run ((BenchHtabType) t, string_keys, STRING_KEY_SIZE, sizes[s])
+			);
+		}
+
+		(void) printf ("\n");
+
+		free (int_keys);
+		free (string_keys);
+	}
+
+	return 0;
+
+}
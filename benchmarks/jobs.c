@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include <cerver/threads/jobs.h>
+
+#define JOBS_PER_PRODUCER				100000
+#define N_CONSUMERS						4
+
+typedef struct BenchJobs {
+
+	JobQueue *job_queue;
+
+	unsigned int n_producers;
+	size_t total;
+
+	size_t consumed;
+	bool done;
+
+} BenchJobs;
+
+static void *bench_jobs_producer (void *bench_ptr) {
+
+	BenchJobs *bench = (BenchJobs *) bench_ptr;
+
+	for (size_t i = 0; i < JOBS_PER_PRODUCER; i++) {
+		Job *job = job_create (NULL, NULL);
+
+		// a ring queue fails when it is full
+		while (job_queue_push (bench->job_queue, job)) (void) sched_yield ();
+	}
+
+	return NULL;
+
+}
+
+static void *bench_jobs_consumer (void *bench_ptr) {
+
+	BenchJobs *bench = (BenchJobs *) bench_ptr;
+
+	Job *job = NULL;
+	while (!__atomic_load_n (&bench->done, __ATOMIC_ACQUIRE)) {
+		job_queue_wait (bench->job_queue);
+
+		while ((job = job_queue_pull (bench->job_queue))) {
+			job_delete (job);
+
+			if (__atomic_add_fetch (&bench->consumed, 1, __ATOMIC_RELAXED) == bench->total) {
+				__atomic_store_n (&bench->done, true, __ATOMIC_RELEASE);
+			}
+		}
+	}
+
+	// a list queue only wakes one thread at a time
+	job_queue_wake_all (bench->job_queue);
+
+	return NULL;
+
+}
+
+static double bench_jobs_run (JobQueueType type, unsigned int n_producers) {
+
+	BenchJobs bench = {
+		.job_queue = job_queue_create_with_type (type, JOB_QUEUE_DEFAULT_CAPACITY),
+		.n_producers = n_producers,
+		.total = (size_t) n_producers * JOBS_PER_PRODUCER,
+		.consumed = 0,
+		.done = false
+	};
+
+	pthread_t consumers[N_CONSUMERS] = { 0 };
+	pthread_t *producers = (pthread_t *) calloc (n_producers, sizeof (pthread_t));
+
+	struct timespec start = { 0 }, end = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &start);
+
+	for (unsigned int i = 0; i < N_CONSUMERS; i++)
+		(void) pthread_create (&consumers[i], NULL, bench_jobs_consumer, &bench);
+
+	for (unsigned int i = 0; i < n_producers; i++)
+		(void) pthread_create (&producers[i], NULL, bench_jobs_producer, &bench);
+
+	for (unsigned int i = 0; i < n_producers; i++)
+		(void) pthread_join (producers[i], NULL);
+
+	for (unsigned int i = 0; i < N_CONSUMERS; i++)
+		(void) pthread_join (consumers[i], NULL);
+
+	(void) clock_gettime (CLOCK_MONOTONIC, &end);
+
+	free (producers);
+	job_queue_delete (bench.job_queue);
+
+	double elapsed = (double) (end.tv_sec - start.tv_sec)
+		+ (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	return (double) bench.total / elapsed;
+
+}
+
+int main (int argc, const char **argv) {
+
+	const unsigned int producers[] = { 1, 4, 16 };
+	const JobQueueType types[] = { JOB_QUEUE_TYPE_LIST, JOB_QUEUE_TYPE_RING };
+
+	(void) printf (
+		"Job queues - %d jobs per producer - %d consumers\n\n",
+		JOBS_PER_PRODUCER, N_CONSUMERS
+	);
+
+	for (unsigned int p = 0; p < 3; p++) {
+		for (unsigned int t = 0; t < 2; t++) {
+			double jobs_per_sec = bench_jobs_run (types[t], producers[p]);
+			(void) printf (
+				"%-6s %2u producers\t: %10.0f jobs / sec\n",
+				job_queue_type_to_string (types[t]), producers[p], jobs_per_sec
+			);
+		}
+	}
+
+	return 0;
+
+}
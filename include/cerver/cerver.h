@@ -9,19 +9,23 @@
 #include "cerver/types/string.h"
 
 #include "cerver/collections/avl.h"
-#include "cerver/collections/htab.h"
+#include "cerver/collections/ohtab.h"
 #include "cerver/collections/pool.h"
 
 #include "cerver/admin.h"
 #include "cerver/config.h"
 #include "cerver/events.h"
 #include "cerver/errors.h"
+#include "cerver/fdtable.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/wheel.h"
 
 #include "cerver/threads/thpool.h"
 
+#include "cerver/utils/histogram.h"
+
 #include "cerver/game/game.h"
 
 #define MAX_PORT_NUM								65535
@@ -32,20 +36,33 @@
 #define CERVER_DEFAULT_USE_IPV6						false
 #define CERVER_DEFAULT_CONNECTION_QUEUE				10
 
+#define CERVER_DEFAULT_ACCEPT_BUDGET				64
+
 #define CERVER_DEFAULT_RECEIVE_BUFFER_SIZE			4096
 
 #define CERVER_DEFAULT_REUSABLE_FLAGS				false
 
 #define CERVER_DEFAULT_POOL_THREADS					4
+#define CERVER_DEFAULT_THPOOL_TYPE					THPOOL_TYPE_SHARED
 
 #define CERVER_DEFAULT_SOCKETS_INIT					10
 
 #define CERVER_DEFAULT_POLL_FDS						128
 #define CERVER_DEFAULT_POLL_TIMEOUT					2000
 
+#define CERVER_DEFAULT_EPOLL_MAX_EVENTS				128
+
+#define CERVER_DEFAULT_N_REACTORS					4
+
+#define CERVER_DEFAULT_URING_ENTRIES				1024
+#define CERVER_DEFAULT_URING_N_BUFFERS				256
+
 #define CERVER_DEFAULT_MAX_INACTIVE_TIME			60
 #define CERVER_DEFAULT_CHECK_INACTIVE_INTERVAL		30
 
+// every cerver timeout is in secs
+#define CERVER_TIMER_WHEEL_TICK						1000
+
 #define CERVER_DEFAULT_AUTH_REQUIRED				false
 #define CERVER_DEFAULT_MAX_AUTH_TRIES				2
 
@@ -54,13 +71,27 @@
 #define CERVER_DEFAULT_ON_HOLD_MAX_BAD_PACKETS		4
 #define CERVER_DEFAULT_ON_HOLD_CHECK_PACKETS		false
 #define CERVER_DEFAULT_ON_HOLD_RECEIVE_BUFFER_SIZE	4096
+#define CERVER_DEFAULT_ON_HOLD_MAX_TIME				0
 
 #define CERVER_DEFAULT_USE_SESSIONS					false
 
 #define CERVER_DEFAULT_MULTIPLE_HANDLERS			false
+#define CERVER_DEFAULT_HANDLERS_ROUTING				CERVER_HANDLERS_ROUTING_HANDLER_ID
 
 #define CERVER_DEFAULT_CHECK_PACKETS				false
 
+#define CERVER_DEFAULT_RECEIVE_PACKET_VIEWS			false
+
+#define CERVER_DEFAULT_SEND_QUEUE					false
+#define CERVER_DEFAULT_SEND_COALESCING				false
+
+#define CERVER_COALESCE_FLUSH_BATCH					64
+
+// payloads smaller than this are cheaper to copy than to pin
+#define CERVER_DEFAULT_ZEROCOPY_THRESHOLD			65536
+
+#define CERVER_DEFAULT_SLABS_MAX_FREE				1024
+
 #define CERVER_DEFAULT_UPDATE_TICKS					30
 #define CERVER_DEFAULT_UPDATE_INTERVAL_SECS			1
 
@@ -75,6 +106,9 @@ struct _Connection;
 struct _Packet;
 struct _PacketsPerType;
 struct _Handler;
+struct _CerverReactor;
+struct _CerverUring;
+struct _CerverUdpWorker;
 
 #pragma region global
 
@@ -110,7 +144,10 @@ CERVER_EXPORT const char *cerver_type_to_string (CerverType type);
 #define CERVER_HANDLER_TYPE_MAP(XX)																\
 	XX(0,	NONE, 		None, 		None)														\
 	XX(1,	POLL, 		Poll, 		Handle connections using a single thread & poll ())			\
-	XX(2,	THREADS, 	Threads, 	Handle each new connection in a dedicated thread)
+	XX(2,	THREADS, 	Threads, 	Handle each new connection in a dedicated thread)			\
+	XX(3,	EPOLL, 		Epoll, 		Handle connections using a single thread & edge triggered epoll ())	\
+	XX(4,	REACTORS, 	Reactors, 	Handle connections using N epoll () loops each with its own SO_REUSEPORT socket)	\
+	XX(5,	IO_URING, 	IoUring, 	Handle connections using io_uring multishot accept & receive with provided buffers)
 
 typedef enum CerverHandlerType {
 
@@ -128,6 +165,27 @@ CERVER_EXPORT const char *cerver_handler_type_description (
 	CerverHandlerType type
 );
 
+#define CERVER_HANDLERS_ROUTING_MAP(XX)																		\
+	XX(0,	HANDLER_ID, 	Handler Id, 	Select the handler using the packet header handler id)		\
+	XX(1,	CLIENT, 		Client, 		Every packet from the same client goes to the same handler)	\
+	XX(2,	CONNECTION, 	Connection, 	Every packet from the same connection goes to the same handler)
+
+typedef enum CerverHandlersRouting {
+
+	#define XX(num, name, string, description) CERVER_HANDLERS_ROUTING_##name = num,
+	CERVER_HANDLERS_ROUTING_MAP (XX)
+	#undef XX
+
+} CerverHandlersRouting;
+
+CERVER_EXPORT const char *cerver_handlers_routing_to_string (
+	CerverHandlersRouting routing
+);
+
+CERVER_EXPORT const char *cerver_handlers_routing_description (
+	CerverHandlersRouting routing
+);
+
 #pragma endregion
 
 #pragma region info
@@ -160,10 +218,84 @@ CERVER_PUBLIC u8 cerver_info_send_info_packet (
 
 #pragma region stats
 
+// stats of each independent event loop when using CERVER_HANDLER_TYPE_REACTORS
+typedef struct CerverReactorStats {
+
+	u64 current_active_connections;                 // current connections handled by the reactor
+	u64 total_connections;                          // the total amount of connections accepted by the reactor
+	u64 n_events;                                   // the total amount of ready events handled by the reactor
+	u64 n_receives_done;                            // total amount of actual calls to recv () in the reactor
+	u64 bytes_received;                             // total amount of bytes received in the reactor
+
+} CerverReactorStats;
+
+// each thread adds to its own counters shard, so threads never share
+// the cache lines of the counters that are updated for every packet
+#define CERVER_STATS_N_SHARDS						16
+
+#define CERVER_STATS_COUNTER_MAP(XX)																	\
+	XX(0,	CLIENT_N_PACKETS_RECEIVED, 		client_n_packets_received,		Packets received from clients)		\
+	XX(1,	CLIENT_RECEIVES_DONE, 			client_receives_done,			Receives done to clients)			\
+	XX(2,	CLIENT_BYTES_RECEIVED, 			client_bytes_received,			Bytes received from clients)		\
+	XX(3,	ON_HOLD_N_PACKETS_RECEIVED, 	on_hold_n_packets_received,		Packets received from on hold connections)	\
+	XX(4,	ON_HOLD_RECEIVES_DONE, 			on_hold_receives_done,			Receives done to on hold connections)		\
+	XX(5,	ON_HOLD_BYTES_RECEIVED, 		on_hold_bytes_received,			Bytes received from on hold connections)	\
+	XX(6,	TOTAL_N_PACKETS_RECEIVED, 		total_n_packets_received,		Total number of packets received)	\
+	XX(7,	TOTAL_N_RECEIVES_DONE, 			total_n_receives_done,			Total calls to recv ())				\
+	XX(8,	TOTAL_BYTES_RECEIVED, 			total_bytes_received,			Total bytes received)				\
+	XX(9,	N_PACKETS_SENT, 				n_packets_sent,					Total number of packets sent)		\
+	XX(10,	TOTAL_BYTES_SENT, 				total_bytes_sent,				Total bytes sent)					\
+	XX(11,	N_COALESCED_SENDS, 				n_coalesced_sends,				Sends appended to a coalescing buffer)		\
+	XX(12,	COALESCED_BYTES, 				coalesced_bytes,				Bytes appended to the coalescing buffers)	\
+	XX(13,	N_COALESCED_FLUSHES, 			n_coalesced_flushes,			Flushes that sent coalesced bytes)
+
+typedef enum CerverStatsCounter {
+
+	#define XX(num, name, field, description) CERVER_STATS_##name = num,
+	CERVER_STATS_COUNTER_MAP (XX)
+	#undef XX
+
+	CERVER_STATS_N_COUNTERS
+
+} CerverStatsCounter;
+
+#define CERVER_STATS_LATENCY_MAP(XX)																			\
+	XX(0,	RECEIVE_DISPATCH, 	Receive dispatch,	From recv () returning until the packet handler is selected)		\
+	XX(1,	JOB_QUEUE_WAIT, 	Job queue wait,		Time a job waits in a handler job queue before being pulled)		\
+	XX(2,	HANDLER, 			Handler,			Execution time of the packets handlers of every packet type)		\
+	XX(3,	SEND, 				Send,				Duration of a packet send including the socket write lock)
+
+typedef enum CerverStatsLatency {
+
+	#define XX(num, name, string, description) CERVER_STATS_LATENCY_##name = num,
+	CERVER_STATS_LATENCY_MAP (XX)
+	#undef XX
+
+	CERVER_STATS_N_LATENCIES
+
+} CerverStatsLatency;
+
+CERVER_EXPORT const char *cerver_stats_latency_to_string (
+	const CerverStatsLatency latency
+);
+
+CERVER_EXPORT const char *cerver_stats_latency_description (
+	const CerverStatsLatency latency
+);
+
+struct _CerverStatsShard;
+struct _CerverStatsLatencies;
+
 typedef struct CerverStats {
 
 	time_t threshold_time;                          // every time we want to reset cerver stats (like packets), defaults 24hrs
 
+	// DEPRECATED: the fields of every CerverStatsCounter & the packets per type
+	// are NOT updated for every packet in the cerver's stats, as they are kept in shards
+	// they are set to the current values each time a snapshot is taken,
+	// so use cerver_stats_get_snapshot () or cerver_stats_get_counter () to read them
+	// the fields after them can be read directly & are updated atomically
+
 	u64 client_n_packets_received;                  // packets received from clients
 	u64 client_receives_done;                       // receives done to clients
 	u64 client_bytes_received;                      // bytes received from clients
@@ -179,6 +311,10 @@ typedef struct CerverStats {
 	u64 n_packets_sent;                             // total number of packets that were sent
 	u64 total_bytes_sent;                           // total amount of bytes sent by the cerver
 
+	u64 n_coalesced_sends;                          // sends that were appended to a connection's coalescing buffer
+	u64 coalesced_bytes;                            // bytes that were appended to the coalescing buffers
+	u64 n_coalesced_flushes;                        // flushes that sent coalesced bytes to a connection
+
 	u64 current_active_client_connections;          // all of the current active connections for all current clients (active in main poll array)
 	u64 current_n_connected_clients;                // the current number of clients connected
 	u64 current_n_hold_connections;                 // current numbers of on hold connections (only if the cerver requires authentication)
@@ -190,8 +326,71 @@ typedef struct CerverStats {
 	struct _PacketsPerType *received_packets;
 	struct _PacketsPerType *sent_packets;
 
+	u32 n_reactors;
+	CerverReactorStats *reactors_stats;             // the stats of each reactor (if any)
+
+	struct _CerverStatsShard *shards;
+
+	// latency histograms in nanoseconds, NULL if they are disabled
+	// sharded like the counters, a snapshot has a single merged copy
+	struct _CerverStatsLatencies *latencies;
+
 } CerverStats;
 
+// adds the value to the calling thread's shard of the counter
+CERVER_PRIVATE void cerver_stats_add (
+	CerverStats *stats, const CerverStatsCounter counter, const u64 value
+);
+
+// returns the calling thread's shard of the received or sent packets per type
+CERVER_PRIVATE struct _PacketsPerType *cerver_stats_packets (
+	CerverStats *stats, const bool sent
+);
+
+// returns the current value of the counter adding all of its shards
+CERVER_EXPORT u64 cerver_stats_get_counter (
+	const struct _Cerver *cerver, const CerverStatsCounter counter
+);
+
+// returns a new copy of the cerver stats with the sum of every counter's shards
+// & the current value of every other field, each value is read without tearing
+// the deprecated counters of the cerver's stats are also set to the snapshot's values
+// the snapshot must be deleted using cerver_stats_snapshot_delete ()
+CERVER_EXPORT CerverStats *cerver_stats_get_snapshot (
+	const struct _Cerver *cerver
+);
+
+CERVER_EXPORT void cerver_stats_snapshot_delete (CerverStats *snapshot);
+
+// returns the current time to start measuring a latency,
+// or 0 if the latency histograms are disabled
+CERVER_PRIVATE u64 cerver_stats_latency_start (const CerverStats *stats);
+
+// records the time since start in the calling thread's shard of the latency
+// nothing is recorded if start is 0
+CERVER_PRIVATE void cerver_stats_latency_end (
+	CerverStats *stats, const CerverStatsLatency latency, const u64 start
+);
+
+// records the time since start divided between n packets
+// in the calling thread's shard of the packet type's handler latency
+// nothing is recorded if start is 0
+CERVER_PRIVATE void cerver_stats_handler_latency_end (
+	CerverStats *stats, const u32 packet_type, const u64 start, const u64 n_packets
+);
+
+// returns the snapshot's histogram of the latency,
+// or NULL if the latency histograms are disabled
+CERVER_EXPORT const Histogram *cerver_stats_get_latency (
+	const CerverStats *snapshot, const CerverStatsLatency latency
+);
+
+// returns the snapshot's histogram of the packet type's handlers execution time,
+// or NULL if the latency histograms are disabled
+CERVER_EXPORT const Histogram *cerver_stats_get_handler_latency (
+	const CerverStats *snapshot, const u32 packet_type
+);
+
 // sets the cerver stats threshold time (how often the stats get reset)
 CERVER_EXPORT void cerver_stats_set_threshold_time (
 	struct _Cerver *cerver, time_t threshold_time
@@ -218,6 +417,7 @@ struct _Cerver {
 	Protocol protocol;                  // we only support either tcp or udp
 	bool use_ipv6;
 	u16 connection_queue;               // each server can handle connection differently
+	u32 accept_budget;                  // max connections accepted on each listening socket event
 	u32 receive_buffer_size;
 
 	bool isRunning;                     // the server is recieving and/or sending packetss
@@ -228,6 +428,7 @@ struct _Cerver {
 	Action delete_cerver_data;
 
 	u16 n_thpool_threads;
+	ThpoolType thpool_type;
 	Thpool *thpool;
 
 	// 29/05/2020
@@ -237,15 +438,15 @@ struct _Cerver {
 	Pool *sockets_pool;
 
 	AVLTree *clients;                   // connected clients
-	Htab *client_sock_fd_map;           // direct indexing by sokcet fd as key
+	CerverFdTable *fd_table;            // direct indexing by sock fd, used by every handler type
 
 	// 17/06/2020 - ability to check for inactive clients
 	// clients that have not been sent or received from a packet in x time
 	// will be automatically dropped from the cerver
 	bool inactive_clients;              // enable / disable checking
 	u32 max_inactive_time;              // max secs allowed for a client to be inactive
-	u32 check_inactive_interval;        // how often to check for inactive clients
-	pthread_t inactive_thread_id;
+	u32 check_inactive_interval;        // unused, each client has its own timer
+	TimerWheel *timer_wheel;            // inactive clients & lobby players timeouts
 
 	CerverHandlerType handler_type;
 
@@ -255,11 +456,40 @@ struct _Cerver {
 	// a detachable thread will be created anyway
 	bool handle_detachable_threads;
 
+	// new fds are always added after the last one in the pollfd array
+	// and fds_idx maps each registered sock fd to its idx in it
+	// removed fds leave a hole until the poll thread compacts the array
 	struct pollfd *fds;
 	u32 max_n_fds;                      // current max n fds in pollfd
-	u16 current_n_fds;                  // n of active fds in the pollfd array
+	u32 current_n_fds;                  // n of used fds in the pollfd array, including holes
+	u32 n_removed_fds;                  // holes waiting to be compacted by the poll thread
+	i32 *fds_idx;                       // sock fd -> idx in fds, -1 if not registered
+	u32 fds_idx_size;                   // n of sock fds that fit in fds_idx
 	u32 poll_timeout;
 	pthread_mutex_t *poll_lock;
+	i32 poll_wake_fd;                   // eventfd in the poll's idx 1, wakes it up to wait for POLLOUT
+
+	// used with CERVER_HANDLER_TYPE_EPOLL, the active fds are tracked by
+	// the kernel & only the ready ones are returned on each wakeup
+	i32 epoll_fd;
+	u32 epoll_max_events;               // max events returned by each epoll_wait ()
+
+	// used with CERVER_HANDLER_TYPE_REACTORS, each reactor handles the connections
+	// that it accepted in its own thread using its own structures
+	u32 n_reactors;
+	struct _CerverReactor **reactors;
+
+	// used with CERVER_HANDLER_TYPE_IO_URING, accepts & receives are completed
+	// by the kernel & the cerver falls back to poll () if they are not supported
+	u32 uring_entries;                  // max n of requests in the submission queue
+	u32 uring_n_buffers;                // n of provided receive buffers
+	struct _CerverUring *uring;
+
+	// used with PROTOCOL_UDP, each worker receives & sends datagrams
+	// in batches using its own socket bound to the cerver's port
+	u32 udp_n_workers;
+	u32 udp_batch_size;                 // max datagrams of each recvmmsg () & sendmmsg ()
+	struct _CerverUdpWorker **udp_workers;
 
 	/*** auth ***/
 	bool auth_required;                 // does the server requires authentication?
@@ -268,7 +498,7 @@ struct _Cerver {
 	delegate authenticate;              // authentication function
 
 	AVLTree *on_hold_connections;       // hold on the connections until they authenticate
-	Htab *on_hold_connection_sock_fd_map;
+	OHtab *on_hold_connection_sock_fd_map;
 	struct pollfd *hold_fds;
 	u32 on_hold_poll_timeout;
 	u32 max_on_hold_connections;
@@ -278,6 +508,8 @@ struct _Cerver {
 	u8 on_hold_max_bad_packets;
 	bool on_hold_check_packets;
 	size_t on_hold_receive_buffer_size;
+	u32 on_hold_max_time;               // max secs for a connection to authenticate
+	TimerWheel *on_hold_timer_wheel;    // advanced by the on hold poll thread
 
 	// allow the clients to use sessions (have multiple connections)
 	bool use_sessions;
@@ -303,6 +535,7 @@ struct _Cerver {
 	// DoubleList *handlers;
 	struct _Handler **handlers;
 	unsigned int n_handlers;
+	CerverHandlersRouting handlers_routing;
 	unsigned int num_handlers_alive;       // handlers currently alive
 	unsigned int num_handlers_working;     // handlers currently working
 	pthread_mutex_t *handlers_lock;
@@ -311,6 +544,28 @@ struct _Cerver {
 
 	bool check_packets;                     // enable / disbale packet checking
 
+	// complete packets are dispatched as views into the receive buffer
+	bool receive_packet_views;
+
+	// connections queue what can't be sent without blocking
+	bool send_queue;
+	size_t send_queue_low_watermark;
+	size_t send_queue_high_watermark;
+
+	// connections' sends are flushed once per poll iteration or update tick
+	bool send_coalescing;
+	struct _Connection **coalesce_connections;     // connections waiting to be flushed
+	u32 n_coalesce_connections;
+	u32 max_coalesce_connections;
+	pthread_mutex_t *coalesce_lock;
+
+	// large payloads of at least this size are sent using MSG_ZEROCOPY
+	size_t zerocopy_threshold;
+
+	// max n of free packets, headers, jobs & receive structures
+	// that each thread keeps to be reused
+	u32 slabs_max_free;
+
 	pthread_t update_thread_id;
 	Action update;                          // method to be executed every tick
 	void *update_args;                      // args to pass to custom update method
@@ -353,6 +608,13 @@ CERVER_EXPORT void cerver_set_connection_queue (
 	Cerver *cerver, const u16 connection_queue
 );
 
+// sets the max number of connections that are accepted in a loop
+// each time that the listening socket is ready
+// the default value is CERVER_DEFAULT_ACCEPT_BUDGET
+CERVER_EXPORT void cerver_set_accept_budget (
+	Cerver *cerver, const u32 accept_budget
+);
+
 // sets the cerver's receive buffer size used in recv method
 CERVER_EXPORT void cerver_set_receive_buffer_size (
 	Cerver *cerver, const u32 size
@@ -380,6 +642,14 @@ CERVER_EXPORT void cerver_set_thpool_n_threads (
 	Cerver *cerver, u16 n_threads
 );
 
+// sets the type of the cerver's thpool
+// THPOOL_TYPE_WORK_STEALING gives each thread its own queue,
+// so bursts of new connections don't contend on a single queue
+// the default value is THPOOL_TYPE_SHARED
+CERVER_EXPORT void cerver_set_thpool_type (
+	Cerver *cerver, const ThpoolType type
+);
+
 // sets the initial number of sockets to be created in the cerver's sockets pool
 // the defauult value is 10
 CERVER_EXPORT void cerver_set_sockets_pool_init (
@@ -390,7 +660,7 @@ CERVER_EXPORT void cerver_set_sockets_pool_init (
 // enables the ability to check for inactive clients - clients that have not been sent or received from a packet in x time
 // will be automatically dropped from the cerver
 // max_inactive_time - max secs allowed for a client to be inactive, 0 for default
-// check_inactive_interval - how often to check for inactive clients in secs, 0 for default
+// check_inactive_interval - unused, each client is dropped by its own timer
 CERVER_EXPORT void cerver_set_inactive_clients (
 	Cerver *cerver,
 	u32 max_inactive_time, u32 check_inactive_interval
@@ -416,6 +686,32 @@ CERVER_EXPORT void cerver_set_poll_time_out (
 	Cerver *cerver, const u32 poll_timeout
 );
 
+// sets the max number of events to be handled on each epoll_wait () call
+// only used if cerver handler type is CERVER_HANDLER_TYPE_EPOLL
+CERVER_EXPORT void cerver_set_epoll_max_events (
+	Cerver *cerver, const u32 epoll_max_events
+);
+
+// sets the number of independent event loops to be used
+// only used if cerver handler type is CERVER_HANDLER_TYPE_REACTORS
+CERVER_EXPORT void cerver_set_n_reactors (
+	Cerver *cerver, const u32 n_reactors
+);
+
+// sets the size of the io_uring submission queue & the number of buffers
+// that are provided to the kernel to complete the connections receives
+// only used if cerver handler type is CERVER_HANDLER_TYPE_IO_URING
+CERVER_EXPORT void cerver_set_uring_values (
+	Cerver *cerver, const u32 entries, const u32 n_buffers
+);
+
+// sets the number of udp workers & the max number of datagrams
+// that each one receives & sends with a single call
+// only used if cerver protocol is PROTOCOL_UDP
+CERVER_EXPORT void cerver_set_udp_values (
+	Cerver *cerver, const u32 n_workers, const u32 batch_size
+);
+
 // enables cerver's built in authentication methods
 // cerver requires client authentication upon new client connections
 // max_auth_tries is the number of failed auth allowed for each new client connection
@@ -463,6 +759,12 @@ CERVER_EXPORT void cerver_set_on_hold_receive_buffer_size (
 	Cerver *cerver, const size_t on_hold_receive_buffer_size
 );
 
+// sets the max secs an on hold connection has to authenticate
+// before being dropped, the default is 0 to wait forever
+CERVER_EXPORT void cerver_set_on_hold_max_time (
+	Cerver *cerver, const u32 on_hold_max_time
+);
+
 // configures the cerver to use client sessions
 // This will allow for multiple connections from the same client,
 // or you can use it to allow different connections from different devices using a token
@@ -520,6 +822,15 @@ CERVER_EXPORT int cerver_set_multiple_handlers (
 	Cerver *cerver, unsigned int n_handlers
 );
 
+// sets how app packets are routed to the cerver's multiple app handlers
+// CERVER_HANDLERS_ROUTING_CLIENT & CERVER_HANDLERS_ROUTING_CONNECTION
+// keep the packets from the same client or connection in order
+// on the same handler, ignoring the packet header handler id
+// the default value is CERVER_HANDLERS_ROUTING_HANDLER_ID
+CERVER_EXPORT void cerver_set_handlers_routing (
+	Cerver *cerver, CerverHandlersRouting routing
+);
+
 // set whether to check or not incoming packets
 // check packet's header protocol id & version compatibility
 // if packets do not pass the checks, won't be handled and will be inmediately destroyed
@@ -529,6 +840,76 @@ CERVER_EXPORT void cerver_set_check_packets (
 	Cerver *cerver, bool check_packets
 );
 
+// set whether complete packets that fit in the receive buffer
+// are dispatched as views into it instead of being copied
+// the packet's header & data reference the buffer (packet_ref & data_ref are set),
+// and are only valid while the packet is being handled
+// packets that are pushed to a handler's job queue or that are NOT
+// deleted after being handled are copied using packet_retain ()
+// only used with connections from cerver's clients
+// by default, this option is turned off
+CERVER_EXPORT void cerver_set_receive_packet_views (
+	Cerver *cerver, bool receive_packet_views
+);
+
+// set whether the cerver's connections send packets without blocking
+// bytes that can't be sent are kept in a per connection send queue
+// that is flushed when the cerver's poll reports the socket as writable
+// only used with POLL, EPOLL, REACTORS & IO_URING handler types
+// by default, this option is turned off
+CERVER_EXPORT void cerver_set_send_queue (
+	Cerver *cerver, bool send_queue
+);
+
+// sets the connections' send queue watermarks
+// a connection with more pending bytes than the low watermark is congested,
+// and it is dropped if its pending bytes exceed the high watermark
+// the default values are CONNECTION_DEFAULT_SEND_QUEUE_LOW_WATERMARK
+// & CONNECTION_DEFAULT_SEND_QUEUE_HIGH_WATERMARK
+CERVER_EXPORT void cerver_set_send_queue_watermarks (
+	Cerver *cerver,
+	const size_t low_watermark, const size_t high_watermark
+);
+
+// set whether the packets sent to the cerver's connections are
+// appended to a per connection buffer instead of being sent right away
+// every connection with pending bytes is flushed once at the end of each
+// poll iteration, update tick & after a handler has handled its jobs
+// only used with POLL, EPOLL, REACTORS & IO_URING handler types
+// the send queue watermarks are also applied to the coalescing buffer
+// by default, this option is turned off
+CERVER_EXPORT void cerver_set_send_coalescing (
+	Cerver *cerver, bool send_coalescing
+);
+
+// sets the min size of the payloads sent with packet_send_large ()
+// that are sent using MSG_ZEROCOPY instead of being copied by the kernel
+// a value of 0 disables zerocopy sends
+// the default value is CERVER_DEFAULT_ZEROCOPY_THRESHOLD
+CERVER_EXPORT void cerver_set_zerocopy_threshold (
+	Cerver *cerver, const size_t zerocopy_threshold
+);
+
+// set whether the cerver records latency histograms of its packets
+// (receive dispatch, job queue wait, handlers execution & sends)
+// that can be read from a stats snapshot or requested by an admin
+// each thread records into its own shard, so they can be left on in production
+// must be called before the cerver starts
+// by default, this option is turned off
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 cerver_set_latency_histograms (
+	Cerver *cerver, bool latency_histograms
+);
+
+// sets the max n of free packets, headers, jobs & receive structures
+// that each thread keeps to be reused instead of calling malloc ()
+// the slabs are shared by all the cervers, so the value is applied
+// when the cerver starts, a value of 0 disables them
+// the default value is CERVER_DEFAULT_SLABS_MAX_FREE
+CERVER_EXPORT void cerver_set_slabs_max_free (
+	Cerver *cerver, const u32 slabs_max_free
+);
+
 // sets a custom cerver update function to be executed every n ticks
 // a new thread will be created that will call your method each tick
 // the update args will be passed to your method as a CerverUpdate &
@@ -559,6 +940,9 @@ CERVER_EXPORT u8 cerver_set_admin_enable (Cerver *cerver);
 
 #pragma region sockets
 
+// moves the socket to the cerver's sockets pool, it is never destroyed
+// as another thread might still be waiting for its mutex
+// returns 0 on success, 1 if the pool could not keep it
 CERVER_PRIVATE int cerver_sockets_pool_push (
 	Cerver *cerver, struct _Socket *socket
 );
@@ -569,6 +953,22 @@ CERVER_PRIVATE struct _Socket *cerver_sockets_pool_pop (
 
 #pragma endregion
 
+#pragma region coalesce
+
+// marks the connection to be flushed
+// at the end of the current poll iteration or update tick
+// the connection is retained until it is flushed
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_coalesce_push (
+	Cerver *cerver, struct _Connection *connection
+);
+
+// sends the coalesced bytes of every connection that is waiting to be flushed
+// each connection is released after it was flushed
+CERVER_PRIVATE void cerver_coalesce_flush (Cerver *cerver);
+
+#pragma endregion
+
 #pragma region handlers
 
 // prints info about current handlers
@@ -702,6 +1102,27 @@ CERVER_PRIVATE CerverReport *cerver_deserialize (SCerver *scerver);
 // creates a cerver info packet ready to be sent
 CERVER_PRIVATE struct _Packet *cerver_packet_generate (Cerver *cerver);
 
+// serialized percentiles of one of the cerver's latency histograms, in nanoseconds
+// the handler latency of a single packet type has it set in packet_type,
+// the rest use PACKET_TYPE_NONE
+typedef struct SCerverLatency {
+
+	u32 latency;
+	u32 packet_type;
+
+	u64 count;
+	u64 p50;
+	u64 p99;
+	u64 p999;
+	u64 max;
+
+} SCerverLatency;
+
+// creates a packet with a SCerverLatency for each cerver's latency
+// followed by the handler latency of every packet type that has been handled
+// returns NULL if the latency histograms are disabled
+CERVER_PRIVATE struct _Packet *cerver_latencies_packet_generate (Cerver *cerver);
+
 #pragma endregion
 
 #ifdef __cplusplus
@@ -17,6 +17,7 @@
 #include "cerver/network.h"
 #include "cerver/packets.h"
 #include "cerver/handler.h"
+#include "cerver/wheel.h"
 
 #include "cerver/utils/log.h"
 
@@ -130,6 +131,7 @@ struct _Client {
 	String *session_id;
 
 	time_t last_activity;	// the last time the client sent / receive data
+	WheelTimer inactive_timer;	// armed in the cerver's wheel when checking for inactive clients
 
 	bool drop_client;		// client failed to authenticate
 
@@ -180,6 +182,10 @@ struct _Client {
 
 	ClientStats *stats;
 
+	// the client is deleted when its last reference is released,
+	// each packet that is queued in a handler keeps one
+	unsigned int references;
+
 };
 
 typedef struct _Client Client;
@@ -187,8 +193,18 @@ typedef struct _Client Client;
 CERVER_PUBLIC Client *client_new (void);
 
 // completely deletes a client and all of its data
+// if packets that point to the client are still queued in handlers,
+// it is deleted when the last one of them is released
 CERVER_PUBLIC void client_delete (void *ptr);
 
+// takes a reference to the client, so it is not deleted
+// until the reference is released with client_release ()
+CERVER_PUBLIC void client_retain (Client *client);
+
+// releases a reference to the client
+// it is deleted when there are no more references to it
+CERVER_PUBLIC void client_release (Client *client);
+
 // used in data structures that require a delete function
 // but the client needs to stay alive
 CERVER_PUBLIC void client_delete_dummy (void *ptr);
@@ -267,6 +283,7 @@ CERVER_EXPORT void client_got_disconnected (Client *client);
 
 // drops a client form the cerver
 // unregisters the client from the cerver and the deletes him
+// the client is only deleted by the thread that removes it from the cerver
 CERVER_EXPORT void client_drop (
 	struct _Cerver *cerver, Client *client
 );
@@ -295,6 +312,7 @@ CERVER_EXPORT u8 client_connection_drop (
 // removes the connection from the client referred to by the sock fd by calling client_connection_drop ()
 // and also remove the client & connection from the cerver's structures when needed
 // also checks if there is another active connection in the client, if not it will be dropped
+// the client is only deleted by the thread that removes it from the cerver
 // returns the resulting status after the operation
 CERVER_PUBLIC ClientConnectionsStatus client_remove_connection_by_sock_fd (
 	struct _Cerver *cerver,
@@ -341,7 +359,8 @@ CERVER_PRIVATE Client *client_unregister_from_cerver (
 	struct _Cerver *cerver, Client *client
 );
 
-// gets the client associated with a sock fd using the client-sock fd map
+// gets the client associated with a sock fd using the cerver's fd table
+// the connections accepted by every reactor are also in the same table
 CERVER_PUBLIC Client *client_get_by_sock_fd (
 	struct _Cerver *cerver, i32 sock_fd
 );
@@ -353,6 +372,7 @@ CERVER_PUBLIC Client *client_get_by_session_id (
 );
 
 // broadcast a packet to all clients inside an avl structure
+// the packet is serialized only once & then sent to all the connections
 CERVER_PUBLIC void client_broadcast_to_all_avl (
 	AVLNode *node,
 	struct _Cerver *cerver,
@@ -7,12 +7,29 @@
 
 #include <pthread.h>
 
+#include "cerver/types/types.h"
+
 #define HTAB_DEFAULT_INIT_SIZE				32
 
+// the table doubles its size when it has more elements than buckets
+#define HTAB_MAX_LOAD_FACTOR				1
+
+// n of buckets that are moved to the new table by each operation while resizing
+#define HTAB_REHASH_STEP					4
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// returns a random seed that is different for each call
+// used by the hash tables to make their hashes unpredictable
+extern u64 htab_hash_seed (void);
+
+// fast seeded hash for keys of any size
+extern u64 htab_hash_bytes (
+	const void *key, size_t key_size, u64 seed
+);
+
 typedef struct HtabNode {
 
 	struct HtabNode *next;
@@ -21,6 +38,8 @@ typedef struct HtabNode {
 	void *val;
 	size_t val_size;
 
+	u64 hash;					// the key's seeded hash
+
 } HtabNode;
 
 typedef struct HtabBucket {
@@ -32,11 +51,19 @@ typedef struct HtabBucket {
 
 typedef struct Htab {
 
-	HtabBucket **table;
+	HtabBucket *table;
 
 	size_t size;
 	size_t count;
 
+	// while the table is being resized, every operation
+	// moves HTAB_REHASH_STEP buckets from the old table
+	HtabBucket *old_table;
+	size_t old_size;
+	size_t rehash_idx;
+
+	u64 seed;
+
 	size_t (*hash)(
 		const void *key, size_t key_size, size_t table_size
 	);
@@ -65,6 +92,8 @@ extern void htab_set_key_create (
 // sets a method to correctly delete (free) your previous allocated key
 // a ptr to the allocated key if passed for you to correctly handle it
 // if not set, free will be used as default
+// if neither key_create nor key_delete are set, keys are copied
+// into the same allocation as their node
 extern void htab_set_key_delete (
 	Htab *htab, void (*key_delete)(void *)
 );
@@ -78,8 +107,9 @@ extern void htab_set_key_comparator (
 );
 
 // creates a new htab
-// size - how many buckets do you want - more buckets = less collisions
-// hash - custom method to hash the key for insertion, NULL for default
+// size - how many buckets to start with, rounded up to a power of 2
+// the table grows automatically when it has more elements than buckets
+// hash - custom method to hash the key for insertion, NULL for the default seeded hash
 // delete_data - custom method to delete your data, NULL for no delete when htab gets destroyed
 extern Htab *htab_create (
 	size_t size,
@@ -0,0 +1,93 @@
+#ifndef _COLLECTIONS_OHTAB_H_
+#define _COLLECTIONS_OHTAB_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#define OHTAB_DEFAULT_INIT_SIZE				32
+
+// the table doubles its size when it is 3/4 full
+#define OHTAB_MAX_LOAD_NUM					3
+#define OHTAB_MAX_LOAD_DEN					4
+
+// n of slots that are moved to the new table by each insert or remove while resizing
+#define OHTAB_REHASH_STEP					16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// open addressing table with linear probing
+// keys have a fixed size & are copied inside the table,
+// so inserts & lookups never allocate memory
+typedef struct OHtabTable {
+
+	u64 *hashes;					// 0 for empty slots, 1 for removed ones
+	void **vals;
+	u8 *keys;
+
+	size_t size;					// always a power of 2
+
+} OHtabTable;
+
+typedef struct OHtab {
+
+	size_t key_size;
+
+	OHtabTable table;
+	size_t count;
+
+	// while the table is being resized, inserts & removes
+	// move OHTAB_REHASH_STEP slots from the old table
+	OHtabTable old_table;
+	size_t old_count;
+	size_t rehash_idx;
+
+	u64 seed;
+
+	void (*delete_data)(void *);
+
+	// lookups only take the read lock
+	pthread_rwlock_t *rwlock;
+
+} OHtab;
+
+// creates a new open addressing htab for keys of key_size bytes
+// init_size - how many slots to start with, rounded up to a power of 2
+// delete_data - custom method to delete your data, NULL for no delete when ohtab gets destroyed
+extern OHtab *ohtab_create (
+	size_t key_size, size_t init_size,
+	void (*delete_data)(void *data)
+);
+
+// returns the current number of elements inside the ohtab
+extern size_t ohtab_size (OHtab *ht);
+
+// returns true if there is a value associated with the key
+extern bool ohtab_contains_key (OHtab *ht, const void *key);
+
+// inserts a new value associated with its key
+// returns 0 on success, 1 on error or if the key is already in the ohtab
+extern int ohtab_insert (OHtab *ht, const void *key, void *val);
+
+// returns a ptr to the data associated with the key
+// returns NULL if no data was found
+extern void *ohtab_get (OHtab *ht, const void *key);
+
+// removes and returns the data associated with the key
+// the data should be deleted by the user
+// returns NULL if no data was found with the provided key
+extern void *ohtab_remove (OHtab *ht, const void *key);
+
+extern void ohtab_destroy (OHtab *ht);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,16 +3,84 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-#include "cerver/collections/dlist.h"
+#include <pthread.h>
+
+// pools with a greater id don't have thread caches
+// & always use the pool's shared cache
+#define POOL_MAX_POOLS						64
+
+// n of elements that fit in each magazine
+#define POOL_MAGAZINE_SIZE					32
+
+// max n of empty magazines kept in each pool's depot
+#define POOL_MAX_EMPTY_MAGAZINES			16
+
+// no limit on the elements kept in the pool's depot
+#define POOL_DEFAULT_MAX_RETAINED			0
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// a fixed array of elements that is moved as a whole
+// between the threads' caches & the pool's depot
+typedef struct PoolMagazine {
+
+	struct PoolMagazine *next;          // in the depot's lists
+
+	unsigned int n_elements;
+	void *elements[POOL_MAGAZINE_SIZE];
+
+} PoolMagazine;
+
+typedef struct PoolStats {
+
+	size_t n_elements;                  // elements that are currently in the pool
+
+	uint64_t hits;                      // pops that were served with a pool's element
+	uint64_t misses;                    // pops that found the pool empty
+	uint64_t pushes;                    // elements that were returned to the pool
+	uint64_t released;                  // pushed elements given back to the caller as the pool was full
+
+} PoolStats;
+
+// each thread pops & pushes without locking using its own cache
+// full & empty magazines are exchanged with the depot only when
+// the thread's magazines are empty or full
+typedef struct PoolCache {
+
+	struct PoolCache *next;             // in the pool's list of caches
+
+	PoolMagazine *loaded;
+	PoolMagazine *previous;
+
+	size_t n_elements;
+	PoolStats stats;
+
+} PoolCache;
+
 typedef struct Pool {
 
-	DoubleList *dlist;
+	unsigned int id;                    // used to find the thread caches
+	uint64_t generation;                // detects caches of deleted pools
+
+	size_t max_retained;                // max elements in the depot, 0 for no limit
+
+	pthread_mutex_t depot_lock;
+	PoolMagazine *full;                 // magazines with at least one element
+	PoolMagazine *empty;
+	size_t depot_n_elements;
+	unsigned int depot_n_empty;
+
+	PoolCache *caches;                  // the caches of every thread that has used the pool
+
+	// used by every thread when the pool doesn't have an id
+	pthread_mutex_t shared_lock;
+	PoolCache shared;
+
+	PoolStats stats;                    // from the caches of threads that have exited
 
 	void (*destroy)(void *data);
 	void *(*create)(void);
@@ -31,6 +99,11 @@ extern void pool_set_create (Pool *pool, void *(*create)(void));
 // the pool will use its create method to allocate a new element and fullfil the request
 extern void pool_set_produce_if_empty (Pool *pool, bool produce);
 
+// sets the max n of elements kept in the pool's depot, 0 for no limit
+// each thread can also keep up to 2 * POOL_MAGAZINE_SIZE elements
+// elements pushed when the pool is full are not kept & still belong to the caller
+extern void pool_set_max_retained (Pool *pool, size_t max_retained);
+
 // returns how many elements are inside the pool
 extern size_t pool_size (Pool *pool);
 
@@ -44,18 +117,26 @@ extern int pool_init (
 	void *(*create)(void), unsigned int n_elements
 );
 
-// inserts the new data at the end of the pool
+// inserts the data in the current thread's cache
+// if the pool is full, the data is NOT kept & the caller still owns it
 // returns 0 on success, 1 on error
 extern int pool_push (Pool *pool, void *data);
 
-// returns the data that is first in the pool
+// returns an element from the current thread's cache or from the pool's depot
+// elements are reused in LIFO order by each thread, so the last element
+// that a thread pushed is the first one it gets, instead of the oldest one
 extern void *pool_pop (Pool *pool);
 
+// gets the pool's stats adding the ones of every thread
+extern void pool_get_stats (Pool *pool, PoolStats *stats);
+
 // only gets rid of the pool's elements, but the data is kept
 // this is usefull if another structure points to the same data
+// must not be called while other threads use the pool
 extern void pool_clear (Pool *pool);
 
 // destroys all of the pool's elements and their data but keeps the pool
+// must not be called while other threads use the pool
 extern void pool_reset (Pool *pool);
 
 // deletes the pool and all of its members using the destroy method
@@ -0,0 +1,74 @@
+#ifndef _COLLECTIONS_SLAB_H_
+#define _COLLECTIONS_SLAB_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SLAB_MAX_SLABS						32
+
+// max n of free objects that each thread keeps for each slab
+#define SLAB_DEFAULT_MAX_FREE				1024
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// allocates objects of a fixed size keeping a free list in each thread,
+// so objects that are freed can be reused without calling malloc () again
+// objects are plain malloc () blocks, so they can also be released with free ()
+typedef struct Slab {
+
+	const char *name;
+	size_t obj_size;
+
+	unsigned int id;                    // set the first time the slab is used
+
+	uint64_t hits;                      // allocations served from a free list
+	uint64_t misses;                    // allocations that required malloc ()
+
+} Slab;
+
+// used to declare a static slab for objects of the same type
+#define SLAB_INITIALIZER(slab_name, type) {					\
+	.name = slab_name,										\
+	.obj_size = sizeof (type) > sizeof (void *) ?			\
+		sizeof (type) : sizeof (void *),					\
+	.id = 0,												\
+	.hits = 0, .misses = 0									\
+}
+
+// sets the max n of free objects that each thread keeps for every slab
+// objects that are freed when the list is full are released with free ()
+// a value of 0 disables the free lists
+extern void slabs_set_max_free (size_t max_free);
+
+// returns the max n of free objects that each thread keeps for every slab
+extern size_t slabs_get_max_free (void);
+
+// returns a new object from the current thread's free list or from malloc ()
+extern void *slab_alloc (Slab *slab);
+
+// keeps the object in the current thread's free list to be reused,
+// or releases it if the list is full
+extern void slab_free (Slab *slab, void *obj);
+
+// each thread adds its counters to the slab's ones every 256 allocations
+// returns the n of allocations that were served from a free list
+extern uint64_t slab_get_hits (Slab *slab);
+
+// returns the n of allocations that required malloc ()
+extern uint64_t slab_get_misses (Slab *slab);
+
+// releases the free objects kept by the current thread
+// this is done automatically for threads that are not the main one
+extern void slab_thread_cleanup (void);
+
+// prints the hits & misses of every slab that has been used
+extern void slabs_stats_print (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,15 +3,20 @@
 
 #include <stdbool.h>
 
+#include <sys/uio.h>
+
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
+#include "cerver/collections/dlist.h"
+
 #include "cerver/cerver.h"
 #include "cerver/config.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
 #include "cerver/socket.h"
+#include "cerver/wheel.h"
 
 #include "cerver/threads/thread.h"
 
@@ -30,6 +35,10 @@
 
 #define CONNECTION_DEFAULT_RECEIVE_PACKETS			true
 
+#define CONNECTION_DEFAULT_SEND_QUEUE_SIZE			4096
+#define CONNECTION_DEFAULT_SEND_QUEUE_LOW_WATERMARK		65536
+#define CONNECTION_DEFAULT_SEND_QUEUE_HIGH_WATERMARK	4194304
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -42,6 +51,7 @@ struct _Connection;
 struct _PacketsPerType;
 struct _SockReceive;
 struct _AdminCerver;
+struct _CerverReactor;
 
 struct _ConnectionStats {
 
@@ -55,6 +65,9 @@ struct _ConnectionStats {
 	u64 n_packets_received;                 // total number of packets received from this connection (packet header + data)
 	u64 n_packets_sent;                     // total number of packets sent to this connection
 
+	u64 total_bytes_zerocopy;               // bytes sent using MSG_ZEROCOPY (included in total_bytes_sent)
+	u64 n_zerocopy_copied;                  // zerocopy sends that the kernel had to copy anyway
+
 	struct _PacketsPerType *received_packets;
 	struct _PacketsPerType *sent_packets;
 
@@ -68,12 +81,82 @@ CERVER_PUBLIC void connection_stats_print (
 	struct _Connection *connection
 );
 
+// bytes that could not be sent to a cerver's connection without blocking
+// they are sent when the cerver's poll reports the socket as writable
+struct _ConnectionSendQueue {
+
+	char *buffer;
+	size_t buffer_size;
+
+	size_t start;                           // idx of the first pending byte
+	size_t end;                             // idx after the last pending byte
+
+	// the connection is congested while it has more pending bytes
+	// than the low watermark & it gets dropped if they exceed the high watermark
+	size_t low_watermark;
+	size_t high_watermark;
+
+	bool congested;
+	bool dropped;
+
+	bool writable;                          // waiting for the sock fd to be writable
+
+	// sends are only appended & the bytes are sent when the cerver flushes the connection
+	bool coalesce;
+	bool dirty;                             // waiting to be flushed by the cerver
+
+	struct _Cerver *cerver;                 // the cerver that flushes the queue
+
+};
+
+typedef struct _ConnectionSendQueue ConnectionSendQueue;
+
+CERVER_PRIVATE ConnectionSendQueue *connection_send_queue_create (
+	struct _Cerver *cerver,
+	const size_t low_watermark, const size_t high_watermark
+);
+
+CERVER_PRIVATE void connection_send_queue_delete (void *send_queue_ptr);
+
+// a payload that was sent using MSG_ZEROCOPY, it is released
+// when the kernel reports that its pages are no longer used
+struct _ConnectionZeroCopyBuffer {
+
+	u32 first_id;                           // the id of the first zerocopy send of the payload
+	u32 n_sends;                            // n zerocopy sends that used the payload
+	u32 n_pending;                          // n sends that have not been completed
+
+	void *data;
+	Action data_delete;
+
+};
+
+typedef struct _ConnectionZeroCopyBuffer ConnectionZeroCopyBuffer;
+
+// created by the first large payload that is sent to the connection
+struct _ConnectionZeroCopy {
+
+	bool enabled;                           // SO_ZEROCOPY was set in the sock fd
+	u32 next_id;                            // the id that the kernel gives to the next zerocopy send
+
+	DoubleList *buffers;                    // payloads waiting for their completions
+
+};
+
+typedef struct _ConnectionZeroCopy ConnectionZeroCopy;
+
+CERVER_PRIVATE ConnectionZeroCopy *connection_zerocopy_create (void);
+
+// releases every pending payload
+CERVER_PRIVATE void connection_zerocopy_delete (void *zerocopy_ptr);
+
 // a connection from a client
 struct _Connection {
 
 	String *name;
 
 	struct _Socket *socket;
+	struct _CerverReactor *reactor;         // the cerver's reactor that accepted the connection (if any)
 	u16 port;
 	Protocol protocol;
 	bool use_ipv6;
@@ -122,20 +205,46 @@ struct _Connection {
 	Action delete_auth_data;                // destroys the auth data when the connection ends
 	bool admin_auth;                        // attempt to connect as an admin
 	struct _Packet *auth_packet;
+	WheelTimer on_hold_timer;               // drops the connection if it takes too long to authenticate
 
 	ConnectionStats *stats;
 
+	// only set for cerver's connections when the cerver's send queue is enabled
+	ConnectionSendQueue *send_queue;
+
+	// payloads sent using MSG_ZEROCOPY, guarded by the socket's write mutex
+	ConnectionZeroCopy *zerocopy;
+
 	pthread_cond_t *cond;
 	pthread_mutex_t *mutex;
 
+	// the connection is deleted when its last reference is released,
+	// each packet that is queued in a handler keeps one
+	unsigned int references;
+
+	// set when a cerver drops the connection,
+	// its socket is moved to the cerver's sockets pool when it gets deleted
+	struct _Cerver *cerver;
+
 };
 
 typedef struct _Connection Connection;
 
 CERVER_PUBLIC Connection *connection_new (void);
 
+// deletes the connection & all of its data
+// if packets that point to the connection are still queued in handlers,
+// it is deleted when the last one of them is released
 CERVER_PUBLIC void connection_delete (void *ptr);
 
+// takes a reference to the connection, so it is not deleted
+// until the reference is released with connection_release ()
+CERVER_PUBLIC void connection_retain (Connection *connection);
+
+// releases a reference to the connection
+// it is deleted when there are no more references to it
+CERVER_PUBLIC void connection_release (Connection *connection);
+
 CERVER_PUBLIC Connection *connection_create_empty (void);
 
 // creates a new client connection with the specified values
@@ -326,6 +435,68 @@ CERVER_PRIVATE u8 connection_remove_from_cerver (
 // starts listening and receiving data in the connection sock
 CERVER_PRIVATE void *connection_update (void *ptr);
 
+// returns the n of bytes waiting in the connection's send queue
+CERVER_EXPORT size_t connection_send_queue_get_pending (
+	const Connection *connection
+);
+
+// returns true if the connection has more bytes waiting to be sent
+// than its send queue low watermark
+// the application should stop sending data to the connection until
+// it is no longer congested to avoid it being dropped
+CERVER_EXPORT bool connection_is_congested (
+	const Connection *connection
+);
+
+// sends the buffers to the connection without blocking
+// anything that can't be sent is added to the connection's send queue
+// and the connection's sock fd is registered to wait until it is writable
+// if the queue coalesces sends, the buffers are only appended to it
+// the connection is dropped if its pending bytes exceed the high watermark
+// the socket's write mutex must be locked
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 connection_send_queue_send (
+	Connection *connection,
+	struct iovec *iov, unsigned int iov_count,
+	int flags, size_t *total_sent
+);
+
+// sends as many pending bytes as possible without blocking,
+// used when the connection's sock fd is reported as writable
+// & when the cerver flushes coalesced sends
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 connection_send_queue_flush (
+	Connection *connection
+);
+
+// returns the n of payloads sent using MSG_ZEROCOPY
+// that the kernel has not released yet
+CERVER_EXPORT size_t connection_zerocopy_get_pending (
+	const Connection *connection
+);
+
+// sends the header (copied) & then the data using MSG_ZEROCOPY
+// data_delete () is called with the data when the kernel no longer uses it,
+// or right away if the data had to be copied, even if the send fails
+// connections with a send queue never block & queue what can't be sent
+// the socket's write mutex must be locked
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 connection_zerocopy_send (
+	Connection *connection,
+	const void *header, const size_t header_size,
+	void *data, const size_t data_size, Action data_delete,
+	size_t *total_sent
+);
+
+// reads the connection's socket error queue & releases
+// every payload whose zerocopy sends have been completed
+// this is done by the cerver when its poll reports an error in the sock fd
+// & before each zerocopy send to the connection
+// returns 0 if the error queue only had zerocopy completions, 1 on a socket error
+CERVER_PUBLIC u8 connection_zerocopy_handle_completions (
+	Connection *connection
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,89 @@
+#ifndef _CERVER_FDTABLE_H_
+#define _CERVER_FDTABLE_H_
+
+#include <stdbool.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+#include "cerver/receive.h"
+
+// entries are allocated in chunks the first time one of their sock fds is used
+#define CERVER_FD_TABLE_CHUNK_BITS				10
+#define CERVER_FD_TABLE_CHUNK_SIZE				(1 << CERVER_FD_TABLE_CHUNK_BITS)
+
+// the default max n of open files that the kernel allows
+#define CERVER_FD_TABLE_MAX_FDS					(1 << 20)
+#define CERVER_FD_TABLE_MAX_CHUNKS				\
+	(CERVER_FD_TABLE_MAX_FDS >> CERVER_FD_TABLE_CHUNK_BITS)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+struct _Connection;
+
+// each entry is a seqlock, its sequence is odd while it is being written
+struct _CerverFdTableEntry {
+
+	u32 seq;
+	u32 receive_type;
+
+	struct _Client *client;
+	struct _Connection *connection;
+
+};
+
+typedef struct _CerverFdTableEntry CerverFdTableEntry;
+
+// maps sock fds directly to their client & connection
+// lookups never take a lock, and chunks are never moved or released
+// until the table is deleted, so readers can always access them
+struct _CerverFdTable {
+
+	CerverFdTableEntry *chunks[CERVER_FD_TABLE_MAX_CHUNKS];
+
+	u32 n_entries;
+
+};
+
+typedef struct _CerverFdTable CerverFdTable;
+
+CERVER_PRIVATE void cerver_fd_table_delete (void *fd_table_ptr);
+
+// creates a new fd table with entries for the first size sock fds
+CERVER_PRIVATE CerverFdTable *cerver_fd_table_create (const u32 size);
+
+// returns the current number of sock fds in the table
+CERVER_PRIVATE u32 cerver_fd_table_size (const CerverFdTable *fd_table);
+
+// maps the sock fd with its client & connection
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_fd_table_set (
+	CerverFdTable *fd_table, const i32 sock_fd,
+	const ReceiveType receive_type,
+	struct _Client *client, struct _Connection *connection
+);
+
+// removes the sock fd from the table
+// only if it is still mapped to the connection, or any if connection is NULL
+// returns 0 on success, 1 if the sock fd was not found
+CERVER_PRIVATE u8 cerver_fd_table_remove (
+	CerverFdTable *fd_table, const i32 sock_fd,
+	const struct _Connection *connection
+);
+
+// gets the values mapped to the sock fd without locking
+// returns true if the sock fd was found
+CERVER_PRIVATE bool cerver_fd_table_get (
+	const CerverFdTable *fd_table, const i32 sock_fd,
+	ReceiveType *receive_type,
+	struct _Client **client, struct _Connection **connection
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,7 +8,7 @@
 #include "cerver/types/string.h"
 
 #include "cerver/collections/dlist.h"
-#include "cerver/collections/htab.h"
+#include "cerver/collections/ohtab.h"
 
 #include "cerver/cerver.h"
 #include "cerver/client.h"
@@ -78,7 +78,7 @@ struct _Lobby {
 	String *id;							// lobby unique id - generated using the creation timestamp
 	time_t creation_time_stamp;
 
-	Htab *sock_fd_player_map;           // maps a socket fd to a player
+	OHtab *sock_fd_player_map;          // maps a socket fd to a player
 	struct pollfd *players_fds;     			
 	u16 max_players_fds;
 	u16 current_players_fds;            // n of active fds in the pollfd array
@@ -91,6 +91,8 @@ struct _Lobby {
 	struct _Player *owner;				// the client that created the lobby -> he has higher privileges
 	unsigned int max_players;
 	unsigned int n_current_players;
+	u32 player_timeout;					// secs until we drop an inactive player, 0 to never drop
+	u32 n_timed_out_players;			// players waiting to be dropped by the lobby's thread
 
 	pthread_t handler_thread_id;
 	bool default_handler;
@@ -137,6 +139,11 @@ extern void lobby_set_packet_handler (Lobby *lobby, Action packet_handler);
 extern void lobby_set_game_settings (Lobby *lobby, 
 	void *game_settings, Action game_settings_delete);
 
+// sets the secs a player can be inactive before being dropped from the lobby
+// players are checked using the cerver's timer wheel, 0 to never drop them
+// the default lobby poll drops them, custom handlers need to call lobby_players_timeout_handle ()
+extern void lobby_set_player_timeout (Lobby *lobby, u32 player_timeout);
+
 // sets the lobby game data and a function to delete it
 extern void lobby_set_game_data (Lobby *lobby, void *game_data, Action game_data_delete);
 
@@ -187,6 +194,11 @@ extern u8 lobby_join (struct _Cerver *cerver, struct _Client *client, Lobby *lob
 // returns 0 on success, 1 on error
 extern u8 lobby_leave (struct _Cerver *cerver, Lobby *lobby, struct _Player *player);
 
+// drops the players whose timeout has expired from the lobby
+// must be called by the thread that handles the lobby's players
+// returns true if the lobby was deleted because it was left empty
+extern bool lobby_players_timeout_handle (Lobby *lobby);
+
 // starts the lobby's handler and/or update method in the cervers thpool
 extern u8 lobby_start (struct _Cerver *cerver, Lobby *lobby);
 
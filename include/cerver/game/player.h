@@ -6,6 +6,7 @@
 
 #include "cerver/cerver.h"
 #include "cerver/packets.h"
+#include "cerver/wheel.h"
 
 #include "cerver/game/game.h"
 #include "cerver/game/lobby.h"
@@ -27,6 +28,10 @@ struct _Player {
 
 	struct _Client *client;		// client network data associated to this player
 
+	struct _Lobby *lobby;		// the lobby the player is registered to
+	WheelTimer timeout_timer;	// flags the player when the lobby's player timeout expires
+	bool timed_out;				// the lobby's thread drops the player when set
+
 	void *data;     
 	Action data_delete;
 
@@ -62,6 +67,11 @@ extern u8 player_unregister_from_lobby_poll (struct _Lobby *lobby, Player *playe
 // unregisters a player from a lobby --> removes him from lobby's structures
 extern u8 player_unregister_from_lobby (struct _Lobby *lobby, Player *player);
 
+// arms the player's timeout in the cerver's timer wheel
+// if the lobby has a player timeout
+// returns 0 on success, 1 if the player will not timeout
+extern u8 player_timeout_arm (struct _Lobby *lobby, Player *player);
+
 // gets a player from the lobby using the query
 extern Player *player_get_from_lobby (struct _Lobby *lobby, Player *query);
 
@@ -72,6 +82,7 @@ extern ListElement *player_get_le_from_lobby (struct _Lobby *lobby, Player *play
 extern Player *player_get_by_sock_fd_list (struct _Lobby *lobby, i32 sock_fd);
 
 // broadcasts a packet to all the players in the lobby
+// the packet is serialized only once & then sent to all the connections
 extern void player_broadcast_to_all (struct _Cerver *cerver, const struct _Lobby *lobby, struct _Packet *packet, 
 	Protocol protocol, int flags);
 
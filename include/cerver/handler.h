@@ -2,6 +2,8 @@
 #define _CERVER_HANDLER_H_
 
 #include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
 
 #include "cerver/types/types.h"
 
@@ -23,11 +25,13 @@ struct _Socket;
 
 struct _Admin;
 struct _Cerver;
+struct _CerverReactor;
 struct _Client;
 struct _Connection;
 struct _Lobby;
 
 struct _Packet;
+struct _PacketHeader;
 
 #pragma region handler
 
@@ -41,6 +45,9 @@ typedef enum HandlerType {
 
 } HandlerType;
 
+// max n of packets that a handler can get in a single call
+#define HANDLER_MAX_BATCH_SIZE				64
+
 // the strcuture that will be passed to the handler
 typedef struct HandlerData {
 
@@ -49,6 +56,11 @@ typedef struct HandlerData {
 	void *data;                     // handler's own data
 	struct _Packet *packet;         // the packet to handle
 
+	// handlers with a batch size get up to batch size packets in each call
+	// packet is always the first one
+	struct _Packet **packets;
+	size_t n_packets;
+
 } HandlerData;
 
 struct _Handler {
@@ -86,6 +98,11 @@ struct _Handler {
 	// cons - calling thread will be busy until handler method is done
 	bool direct_handle;
 
+	// the max n of packets that are passed to the handler method in one call
+	// packets parsed from the same received buffer are also queued as one job
+	// this option is set to 0 as default to handle packets one by one
+	size_t batch_size;
+
 	// the jobs (packets) that are waiting to be handled
 	// passed as args to the handler method
 	JobQueue *job_queue;
@@ -143,10 +160,38 @@ CERVER_EXPORT void handler_set_direct_handle (
 	Handler *handler, bool direct_handle
 );
 
+// sets the max n of packets that the handler method can get in one call
+// using HandlerData's packets & n_packets
+// app packets parsed from the same received buffer are queued as one job,
+// so the handler pays a single push & wake up for all of them
+// only used by cerver handlers that are not set to direct handle
+// the max value is HANDLER_MAX_BATCH_SIZE, 0 disables batches (default)
+CERVER_EXPORT void handler_set_batch_size (
+	Handler *handler, size_t batch_size
+);
+
+// replaces the handler's job queue with a new one of the selected type
+// a JOB_QUEUE_TYPE_RING queue avoids locks but can only hold capacity packets,
+// any packet that does not fit will be dropped
+// must be called before the handler starts
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 handler_set_job_queue_type (
+	Handler *handler, JobQueueType type, size_t capacity
+);
+
 // starts the new handler by creating a dedicated thread for it
 // called by internal cerver methods
 CERVER_PRIVATE int handler_start (Handler *handler);
 
+// pushes the packet to the handler's job queue to be handled
+// as soon as the handler is available
+// packet views are copied first as their buffer will be reused
+// the packet is deleted if it can't be queued
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 handler_push_packet (
+	Handler *handler, struct _Packet *packet
+);
+
 #pragma endregion
 
 #pragma region handlers
@@ -191,16 +236,27 @@ CERVER_PRIVATE void cerver_test_packet_handler (
 
 #pragma region sock receive
 
+// the initial size of a connection's receive buffer, it is only
+// allocated when a packet gets cut between receives
+#define SOCK_RECEIVE_DEFAULT_SIZE                  4096
+
+// packets bigger than this are considered invalid
+#define SOCK_RECEIVE_DEFAULT_MAX_SIZE              16777216
+
+// secs that the buffer must be empty before shrinking back to its default size
+#define SOCK_RECEIVE_DEFAULT_IDLE_SECS             30
+
+// keeps the bytes of a packet that was cut between receives,
+// the pending packet always starts at the beginning of the buffer
+// and it grows only once to fit the complete packet
 struct _SockReceive {
 
-	struct _Packet *spare_packet;
-	size_t missing_packet;
+	char *buffer;
+	size_t size;                    // allocated size of the buffer
+	size_t len;                     // n of bytes of the pending packet
 
-	void *header;
-	char *header_end;
-	// unsigned int curr_header_pos;
-	unsigned int remaining_header;
-	bool complete_header;
+	size_t max_size;                // max packet size that can be reassembled
+	time_t last_used;               // last time bytes were stored in the buffer
 
 };
 
@@ -210,6 +266,28 @@ CERVER_PRIVATE SockReceive *sock_receive_new (void);
 
 CERVER_PRIVATE void sock_receive_delete (void *sock_receive_ptr);
 
+// discards the bytes of the pending packet
+CERVER_PRIVATE void sock_receive_reset (SockReceive *sock_receive);
+
+// method that handles each complete packet found by sock_receive_handle_buffer ()
+// header & data are only valid inside the method
+// returns 0 to keep handling packets, 1 to stop
+typedef u8 (*SockReceiveFrameHandler) (
+	void *args,
+	struct _PacketHeader *header,
+	char *data, const size_t data_size
+);
+
+// splits the received buffer into complete packets, packets that are
+// cut between receives are reassembled in the sock receive's buffer
+// every complete packet is handled by the frame handler
+// returns 0 when all the buffer was handled, 1 if the handler stopped or on error
+CERVER_PRIVATE u8 sock_receive_handle_buffer (
+	SockReceive *sock_receive,
+	char *buffer, const size_t buffer_size,
+	SockReceiveFrameHandler frame_handler, void *args
+);
+
 #pragma endregion
 
 #pragma region receive
@@ -234,6 +312,8 @@ typedef struct ReceiveHandle {
 	size_t buffer_size;
 	size_t received_size;
 
+	u64 received_time;			// when recv () returned, only if measuring latencies
+
 } ReceiveHandle;
 
 CERVER_PRIVATE void receive_handle_delete (void *receive_ptr);
@@ -243,6 +323,16 @@ CERVER_PRIVATE void cerver_receive_handle_buffer (
 	void *receive_handle_ptr
 );
 
+// handles every complete packet in a datagram received from a udp peer
+// packets are never reassembled between datagrams, so the rest of
+// the datagram is discarded when an invalid or incomplete packet is found
+// returns 0 on success, 1 if the datagram had an invalid packet
+CERVER_PRIVATE u8 cerver_receive_handle_datagram (
+	struct _Cerver *cerver,
+	struct _Client *client, struct _Connection *connection,
+	char *buffer, const size_t received
+);
+
 typedef struct CerverReceive {
 
 	ReceiveType type;
@@ -321,6 +411,13 @@ CERVER_PRIVATE i32 cerver_poll_get_idx_by_sock_fd (
 	struct _Cerver *cerver, i32 sock_fd
 );
 
+// adds a sock fd at the end of the active fds in the cerver poll fds
+// this does NOT update the cerver's connections stats
+// returns the idx where the sock fd was placed, -1 on error
+CERVER_PRIVATE i32 cerver_poll_add_sock_fd (
+	struct _Cerver *cerver, const i32 sock_fd
+);
+
 // regsiters a client connection to the cerver's mains poll structure
 // and maps the sock fd to the client
 // returns 0 on success, 1 on error
@@ -340,9 +437,30 @@ CERVER_PRIVATE u8 cerver_poll_unregister_connection (
 	struct _Cerver *cerver, struct _Connection *connection
 );
 
+// sets whether the cerver's poll (or the connection's reactor) waits
+// for the connection's sock fd to be writable to flush its send queue
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_poll_set_writable (
+	struct _Cerver *cerver, struct _Connection *connection, bool writable
+);
+
 // server poll loop to handle events in the registered socket's fds
 CERVER_PRIVATE u8 cerver_poll (struct _Cerver *cerver);
 
+// cerver epoll loop to handle events only in the registered sockets that are ready
+CERVER_PRIVATE u8 cerver_epoll (struct _Cerver *cerver);
+
+// reactor epoll loop to accept & handle connections in its own socket
+// using the reactor's own structures
+CERVER_PRIVATE u8 cerver_reactor_epoll (struct _CerverReactor *reactor);
+
+#pragma endregion
+
+#pragma region io_uring
+
+// cerver io_uring loop to handle the accepts & receives completed by the kernel
+CERVER_PRIVATE u8 cerver_uring (struct _Cerver *cerver);
+
 #pragma endregion
 
 #pragma region threads
@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#include <pthread.h>
+
+#include <sys/uio.h>
+
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
@@ -130,6 +134,19 @@ CERVER_PUBLIC void packets_per_type_print (
 	PacketsPerType *packets_per_type
 );
 
+// atomically adds packets of the selected type
+// unknown types are counted as unknown packets
+CERVER_PRIVATE void packets_per_type_add (
+	PacketsPerType *packets_per_type,
+	const PacketType packet_type, const u64 n_packets
+);
+
+// adds every counter of the source to the destination
+// the source counters are read atomically, as they can still be updated
+CERVER_PRIVATE void packets_per_type_accumulate (
+	PacketsPerType *packets_per_type, const PacketsPerType *source
+);
+
 #pragma endregion
 
 #pragma region header
@@ -204,7 +221,8 @@ typedef enum ClientPacketType {
 #define REQUEST_PACKET_TYPE_MAP(XX)			\
 	XX(0, 	NONE)							\
 	XX(1, 	GET_FILE)						\
-	XX(2, 	SEND_FILE)
+	XX(2, 	SEND_FILE)						\
+	XX(3, 	GET_LATENCIES)
 
 typedef enum RequestPacketType {
 
@@ -255,6 +273,11 @@ struct _Packet {
 	struct _Connection *connection;
 	struct _Lobby *lobby;
 
+	// set while the packet keeps a reference to its client & connection,
+	// like when it is queued in a cerver's handler
+	bool client_ref;
+	bool connection_ref;
+
 	PacketType packet_type;
 	u32 req_type;
 
@@ -355,6 +378,23 @@ CERVER_EXPORT u8 packet_set_packet_ref (
 	Packet *packet, void *data, size_t packet_size
 );
 
+// creates a packet that references a complete packet inside a buffer
+// the packet's header & data point to the buffer (packet_ref & data_ref are set),
+// so the view is only valid while the buffer is NOT modified
+// returns a newly allocated packet that should be deleted after use
+CERVER_PRIVATE Packet *packet_create_view (
+	PacketHeader *header, char *data, const size_t data_size
+);
+
+// returns true if the packet's header & data reference an external buffer
+CERVER_PUBLIC bool packet_is_view (const Packet *packet);
+
+// copies the header & data of a packet view into the packet,
+// so that it can be safely used after its buffer has been reused
+// does nothing if the packet already owns its values
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 packet_retain (Packet *packet);
+
 // prepares the packet to be ready to be sent
 // WARNING: dont call this method if you have set the packet directly
 // returns 0 on success, 1 on error
@@ -376,8 +416,22 @@ CERVER_EXPORT Packet *packet_generate_request (
 	const void *data, const size_t data_size
 );
 
+// sends the buffers using as few sendmsg () calls as possible
+// continues after partial writes by advancing the iov array, so it is modified
+// and only the bytes that were not sent remain in it
+// the socket's write mutex is NOT locked
+// on error, errno is only set if sendmsg () failed, else it is 0
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 packet_send_iov (
+	struct _Socket *socket,
+	struct iovec *iov, unsigned int iov_count,
+	int flags, size_t *total_sent
+);
+
 // sends a packet using its network values
 // raw flag to send a raw packet (only the data that was set to the packet, without any header)
+// if the packet has not been generated, its header & data are sent together
+// without copying them into a new buffer
 // returns 0 on success, 1 on error
 CERVER_EXPORT u8 packet_send (
 	const Packet *packet, int flags, size_t *total_sent, bool raw
@@ -403,7 +457,7 @@ CERVER_EXPORT u8 packet_send_to (
 	struct _Lobby *lobby
 );
 
-// sends a packet to the socket in two parts, first the header & then the data
+// sends the packet's header & then the data using a single sendmsg ()
 // this method can be useful when trying to forward a big received packet without the overhead of
 // performing and additional copy to create a continuos data (packet) buffer
 // the socket's write mutex will be locked to ensure that the packet
@@ -426,6 +480,7 @@ CERVER_EXPORT u8 packet_send_to_split (
 
 // sends a packet in pieces, taking the header from the packet's field
 // sends each buffer as they are with they respective sizes
+// the header & all the pieces are sent using a single sendmsg ()
 // socket mutex will be locked for the entire operation
 // returns 0 on success, 1 on error
 CERVER_EXPORT u8 packet_send_pieces (
@@ -435,6 +490,23 @@ CERVER_EXPORT u8 packet_send_pieces (
 	size_t *total_sent
 );
 
+// sends a large payload (like a snapshot) with a header of the selected types
+// without copying it into a new packet
+// payloads of at least the cerver's zerocopy threshold are sent using MSG_ZEROCOPY,
+// smaller ones, or if the socket does not support it, are copied by the kernel
+// the data must not be modified until data_delete () is called with it,
+// which happens when the kernel no longer uses its pages, even if the send fails
+// if data_delete is NULL, the data must be valid while the connection is active
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 packet_send_large (
+	const PacketType packet_type, const u32 request_type,
+	void *data, const size_t data_size, Action data_delete,
+	size_t *total_sent,
+	struct _Cerver *cerver,
+	struct _Client *client, struct _Connection *connection,
+	struct _Lobby *lobby
+);
+
 // sends a packet directly to the socket
 // raw flag to send a raw packet (only the data that was set to the packet, without any header)
 // returns 0 on success, 1 on error
@@ -467,6 +539,102 @@ CERVER_EXPORT bool packet_check (Packet *packet);
 
 #pragma endregion
 
+#pragma region broadcast
+
+// max number of recipients that each broadcast job sends the packet to
+#define PACKET_BROADCAST_CHUNK_SIZE				32
+
+#define PACKET_BROADCAST_DEFAULT_RECIPIENTS		16
+
+// a connection that will receive a broadcast packet
+// & the result of sending the packet to it
+struct _PacketBroadcastRecipient {
+
+	struct _Client *client;
+	struct _Connection *connection;
+
+	size_t sent;
+	u8 result;				// 0 on success, 1 on error
+
+};
+
+typedef struct _PacketBroadcastRecipient PacketBroadcastRecipient;
+
+// a packet that has been serialized once into a shared buffer
+// that is sent as it is to all of the recipients
+struct _PacketBroadcast {
+
+	PacketType packet_type;
+
+	// the packet's header & data
+	void *buffer;
+	size_t buffer_size;
+
+	// the broadcast is deleted when its last reference is released
+	unsigned int references;
+
+	PacketBroadcastRecipient *recipients;
+	size_t n_recipients;
+	size_t max_recipients;
+
+	// the results of the last packet_broadcast_send ()
+	size_t n_sent;
+	size_t n_failed;
+	size_t bytes_sent;
+
+	// the recipients are sent in chunks by the thpool's threads
+	int flags;
+	size_t n_chunks;
+	size_t next_chunk;
+	size_t done_chunks;
+
+	pthread_mutex_t *mutex;
+	pthread_cond_t *done;
+
+};
+
+typedef struct _PacketBroadcast PacketBroadcast;
+
+// creates a new broadcast by serializing the packet's header & data
+// into a single buffer that will be shared by all the recipients
+// the packet can be safely deleted after this call
+// returns a new broadcast that should be deleted after use
+CERVER_EXPORT PacketBroadcast *packet_broadcast_create (
+	const Packet *packet
+);
+
+// releases a reference to the broadcast
+// it is deleted when there are no more references to it
+CERVER_EXPORT void packet_broadcast_delete (void *broadcast_ptr);
+
+// adds a connection to the broadcast's recipients
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 packet_broadcast_add (
+	PacketBroadcast *broadcast,
+	struct _Client *client, struct _Connection *connection
+);
+
+// adds all of the client's connections to the broadcast's recipients
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 packet_broadcast_add_client (
+	PacketBroadcast *broadcast, struct _Client *client
+);
+
+// sends the broadcast's buffer to all of its recipients
+// connections with a send queue never block, so a slow recipient
+// only delays the chunk it belongs to
+// chunks are sent in parallel by the cerver's thpool (if any)
+// & by the calling thread, that waits until all of them are done
+// each recipient's result is set & the totals are stored in the broadcast
+// returns 0 if the packet was sent to all the recipients, 1 on any error
+CERVER_EXPORT u8 packet_broadcast_send (
+	PacketBroadcast *broadcast,
+	struct _Cerver *cerver, struct _Lobby *lobby,
+	int flags
+);
+
+#pragma endregion
+
 #ifdef __cplusplus
 }
 #endif
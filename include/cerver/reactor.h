@@ -0,0 +1,97 @@
+#ifndef _CERVER_REACTOR_H_
+#define _CERVER_REACTOR_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Cerver;
+struct _Connection;
+struct CerverReactorStats;
+
+// an independent event loop used with CERVER_HANDLER_TYPE_REACTORS
+// each reactor has its own SO_REUSEPORT listening socket, epoll instance,
+// & receive buffer, and the connections it accepts
+// stay pinned to it until they are closed
+struct _CerverReactor {
+
+	u32 id;
+	struct _Cerver *cerver;
+
+	bool running;
+	pthread_t thread_id;
+
+	i32 sock;                                   // the reactor's listening socket
+	i32 epoll_fd;
+	u32 current_n_fds;                          // n of fds registered in the reactor's epoll
+
+	char *packet_buffer;
+
+	pthread_mutex_t *lock;
+
+	struct CerverReactorStats *stats;           // reference to the reactor's stats inside cerver stats
+
+};
+
+typedef struct _CerverReactor CerverReactor;
+
+CERVER_PRIVATE CerverReactor *cerver_reactor_new (void);
+
+CERVER_PRIVATE void cerver_reactor_delete (void *reactor_ptr);
+
+// creates a new reactor with its own epoll instance & receive buffer
+// the listening socket is created when calling cerver_reactors_listen ()
+CERVER_PRIVATE CerverReactor *cerver_reactor_create (
+	struct _Cerver *cerver, const u32 id
+);
+
+// creates the cerver's reactors based on its n_reactors value
+// and sets up their stats inside cerver stats
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactors_init (struct _Cerver *cerver);
+
+// deletes all the cerver's reactors
+CERVER_PRIVATE void cerver_reactors_delete (struct _Cerver *cerver);
+
+// opens each reactor's SO_REUSEPORT listening socket & starts listening in it
+// the first reactor uses the cerver's main socket
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactors_listen (struct _Cerver *cerver);
+
+// starts every reactor loop in a dedicated thread,
+// except for the first one that is handled in the calling thread
+// if a thread fails to start, the ones already started are stopped
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactors_start (struct _Cerver *cerver);
+
+// stops all the reactors & waits for their threads to finish
+CERVER_PRIVATE void cerver_reactors_end (struct _Cerver *cerver);
+
+// registers a connection that was accepted by the reactor to its epoll
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactor_register_connection (
+	CerverReactor *reactor, struct _Connection *connection
+);
+
+// removes a sock fd from the reactor's epoll
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactor_unregister_sock_fd (
+	CerverReactor *reactor, const i32 sock_fd
+);
+
+// prints the stats of each of the cerver's reactors
+CERVER_PUBLIC void cerver_reactors_stats_print (struct _Cerver *cerver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,14 +1,21 @@
 #ifndef _CERVER_THREADS_JOBS_H_
 #define _CERVER_THREADS_JOBS_H_
 
+#include <stdlib.h>
+
 #include <pthread.h>
 
 #include "cerver/collections/dlist.h"
 
+#include "cerver/types/types.h"
+
 #include "cerver/config.h"
 
 #include "cerver/threads/bsem.h"
 
+// default max n of jobs that a ring job queue can hold
+#define JOB_QUEUE_DEFAULT_CAPACITY				4096
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -19,6 +26,8 @@ typedef struct Job {
 	void (*method) (void *args);
 	void *args;
 
+	u64 queued_time;			// set by the cerver handlers when measuring latencies
+
 } Job;
 
 CERVER_PUBLIC Job *job_new (void);
@@ -29,33 +38,95 @@ CERVER_PUBLIC Job *job_create (
 	void (*method) (void *args), void *args
 );
 
-typedef struct JobQueue {
+#define JOB_QUEUE_TYPE_MAP(XX)												\
+	XX(0,	NONE,		None,		No queue)							\
+	XX(1,	LIST,		List,		Unbounded list protected by a mutex)	\
+	XX(2,	RING,		Ring,		Bounded lock-free ring buffer)
+
+typedef enum JobQueueType {
+
+	#define XX(num, name, string, description) JOB_QUEUE_TYPE_##name = num,
+	JOB_QUEUE_TYPE_MAP(XX)
+	#undef XX
+
+} JobQueueType;
+
+CERVER_PUBLIC const char *job_queue_type_to_string (
+	const JobQueueType type
+);
+
+CERVER_PUBLIC const char *job_queue_type_description (
+	const JobQueueType type
+);
 
-	// Job *front;
-	// Job *rear;
+// a slot in a ring job queue
+// its sequence tells if it is ready to be written or read
+typedef struct JobQueueCell {
 
-	// size_t size;
+	size_t sequence;
+	Job *job;
 
+} JobQueueCell;
+
+typedef struct JobQueue {
+
+	JobQueueType type;
+
+	// JOB_QUEUE_TYPE_LIST
 	DoubleList *queue;
 
 	pthread_mutex_t *rwmutex;             // used for queue r/w access
 	bsem *has_jobs;
 
+	// JOB_QUEUE_TYPE_RING
+	JobQueueCell *cells;
+	size_t mask;
+
+	// producers & consumers positions are kept in different cache lines
+	char pad_enqueue[64];
+	size_t enqueue_pos;
+	char pad_dequeue[64];
+	size_t dequeue_pos;
+	char pad_signal[64];
+
+	// idle consumers sleep on this value using a futex
+	unsigned int signal;
+	unsigned int waiters;
+
 } JobQueue;
 
 CERVER_PUBLIC JobQueue *job_queue_new (void);
 
 CERVER_PUBLIC void job_queue_delete (void *job_queue_ptr);
 
+// creates a JOB_QUEUE_TYPE_LIST job queue
 CERVER_PUBLIC JobQueue *job_queue_create (void);
 
+// creates a job queue of the selected type
+// capacity is only used by JOB_QUEUE_TYPE_RING queues
+// and is rounded up to the next power of two
+CERVER_PUBLIC JobQueue *job_queue_create_with_type (
+	JobQueueType type, size_t capacity
+);
+
 // add a new job to the queue
-// returns 0 on success, 1 on error
+// returns 0 on success, 1 on error or if a ring queue is full
 CERVER_PUBLIC int job_queue_push (JobQueue *job_queue, Job *job);
 
 // get the job at the start of the queue
 CERVER_PUBLIC Job *job_queue_pull (JobQueue *job_queue);
 
+// returns the current n of jobs in the queue
+CERVER_PUBLIC size_t job_queue_size (JobQueue *job_queue);
+
+// blocks the calling thread until the queue may have jobs
+// or until job_queue_wake_all () gets called
+// job_queue_pull () can still return NULL after this returns
+CERVER_PUBLIC void job_queue_wait (JobQueue *job_queue);
+
+// wakes up every thread waiting on the queue
+CERVER_PUBLIC void job_queue_wake_all (JobQueue *job_queue);
+
 // clears the job queue -> destroys all jobs
 CERVER_PUBLIC void job_queue_clear (JobQueue *job_queue);
 
@@ -7,16 +7,39 @@
 #include "cerver/config.h"
 #include "cerver/threads/jobs.h"
 
+// max n of jobs that each worker queue can hold in a work stealing thpool
+// jobs that don't fit are added to the thpool's shared queue
+#define THPOOL_WORKER_QUEUE_CAPACITY			1024
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define THPOOL_TYPE_MAP(XX)														\
+	XX(0,	NONE,			None,			No type)									\
+	XX(1,	SHARED,			Shared,			All threads pull jobs from one queue)		\
+	XX(2,	WORK_STEALING,	Work Stealing,	Each thread has its own queue & steals from others)
+
+typedef enum ThpoolType {
+
+	#define XX(num, name, string, description) THPOOL_TYPE_##name = num,
+	THPOOL_TYPE_MAP(XX)
+	#undef XX
+
+} ThpoolType;
+
+CERVER_PUBLIC const char *thpool_type_to_string (const ThpoolType type);
+
+CERVER_PUBLIC const char *thpool_type_description (const ThpoolType type);
+
 struct _PoolThread;
 
 typedef struct Thpool {
 
 	const char *name;
 
+	ThpoolType type;
+
 	unsigned int n_threads;
 	struct _PoolThread **threads;
 
@@ -29,6 +52,12 @@ typedef struct Thpool {
 
 	JobQueue *job_queue;
 
+	// THPOOL_TYPE_WORK_STEALING
+	// idle threads sleep on signal using a futex
+	unsigned int signal;
+	unsigned int idle;
+	unsigned int next_thread;
+
 } Thpool;
 
 // creates a new thpool with n threads
@@ -42,6 +71,22 @@ CERVER_EXPORT unsigned int thpool_init (Thpool *thpool);
 // sets the name for the thpool
 CERVER_EXPORT void thpool_set_name (Thpool *thpool, const char *name);
 
+// sets the thpool's type, the default is THPOOL_TYPE_SHARED
+// in THPOOL_TYPE_WORK_STEALING each thread gets its own lock-free queue,
+// works added from outside the thpool are spread between the threads
+// and idle threads steal jobs from random threads
+// must be called before thpool_init ()
+CERVER_EXPORT void thpool_set_type (Thpool *thpool, const ThpoolType type);
+
+// replaces the thpool's job queue with a new one of the selected type
+// a JOB_QUEUE_TYPE_RING queue avoids locks but thpool_add_work ()
+// fails when it already has capacity jobs waiting
+// must be called before thpool_init ()
+// returns 0 on success, 1 on error
+CERVER_EXPORT unsigned int thpool_set_job_queue_type (
+	Thpool *thpool, JobQueueType type, size_t capacity
+);
+
 // gets the current number of threads that are alive (running) in the thpool
 CERVER_EXPORT unsigned int thpool_get_num_threads_alive (Thpool *thpool);
 
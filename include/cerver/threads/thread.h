@@ -11,6 +11,13 @@
 
 #define THREAD_NAME_BUFFER_LEN			64
 
+// used inside spin loops to let the cpu know we are waiting
+#if defined(__x86_64__) || defined(__i386__)
+#define thread_cpu_relax()				__builtin_ia32_pause ()
+#else
+#define thread_cpu_relax()				__asm__ __volatile__ ("" ::: "memory")
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -49,6 +56,17 @@ CERVER_PUBLIC void pthread_cond_delete (pthread_cond_t *cond);
 
 #pragma endregion
 
+#pragma region futex
+
+// sleeps while the value at addr is equal to value
+// can return early, so callers should check their condition again
+CERVER_PUBLIC void thread_futex_wait (unsigned int *addr, unsigned int value);
+
+// wakes up to count threads sleeping on addr
+CERVER_PUBLIC void thread_futex_wake (unsigned int *addr, int count);
+
+#pragma endregion
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,149 @@
+#ifndef _CERVER_UDP_H_
+#define _CERVER_UDP_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/collections/ohtab.h"
+
+#include "cerver/config.h"
+#include "cerver/wheel.h"
+
+#define CERVER_UDP_DEFAULT_N_WORKERS				1
+
+// max n of datagrams received by each recvmmsg ()
+// & sent by each sendmmsg ()
+#define CERVER_UDP_DEFAULT_BATCH_SIZE				32
+
+#define CERVER_UDP_PEERS_INIT						64
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Cerver;
+struct _Client;
+struct _Connection;
+
+// the key of a peer in a worker's map, built from the source address
+// of its datagrams, so the same ip & port always map to the same client
+struct _CerverUdpAddress {
+
+	u16 family;
+	u16 port;
+	u32 scope_id;
+	u8 addr[16];
+
+};
+
+typedef struct _CerverUdpAddress CerverUdpAddress;
+
+typedef struct CerverUdpWorkerStats {
+
+	u64 current_peers;                  // peers that are currently mapped in the worker
+	u64 total_peers;                    // the total amount of peers that the worker has seen
+	u64 n_receives_done;                // total amount of calls to recvmmsg ()
+	u64 n_datagrams_received;
+	u64 bytes_received;
+	u64 n_bad_datagrams;                // truncated datagrams or with invalid packets
+	u64 n_sends_done;                   // total amount of calls to sendmmsg ()
+	u64 n_datagrams_sent;
+	u64 n_datagrams_dropped;            // datagrams that sendmmsg () failed to send
+
+} CerverUdpWorkerStats;
+
+// an independent datagram loop used when the cerver's protocol is PROTOCOL_UDP
+// each worker has its own SO_REUSEPORT socket, so the kernel always
+// delivers the datagrams of the same peer to the same worker, which keeps
+// its peers in its own map & expires them in its own timer wheel
+struct _CerverUdpWorker {
+
+	u32 id;
+	struct _Cerver *cerver;
+
+	bool running;
+	pthread_t thread_id;
+
+	i32 sock;                           // the first worker uses the cerver's socket
+
+	u32 batch_size;
+	size_t datagram_size;               // max bytes of each datagram
+
+	// the messages, addresses & buffers used by each recvmmsg ()
+	struct mmsghdr *receive_msgs;
+	struct iovec *receive_iovs;
+	struct sockaddr_storage *receive_addresses;
+	char *receive_buffers;
+
+	// replies sent from the worker's thread, sent with a single sendmmsg ()
+	struct mmsghdr *send_msgs;
+	struct iovec *send_iovs;
+	struct sockaddr_storage *send_addresses;
+	char *send_buffers;
+	u32 n_sends;
+
+	OHtab *peers;                       // CerverUdpAddress -> Client
+	TimerWheel *timer_wheel;            // expires inactive peers
+
+	CerverUdpWorkerStats stats;
+
+};
+
+typedef struct _CerverUdpWorker CerverUdpWorker;
+
+CERVER_PRIVATE void cerver_udp_worker_delete (void *worker_ptr);
+
+// creates a new worker with its own receive & send batches
+// the socket is created when calling cerver_udp_bind ()
+CERVER_PRIVATE CerverUdpWorker *cerver_udp_worker_create (
+	struct _Cerver *cerver, const u32 id
+);
+
+// creates the cerver's udp workers based on its udp_n_workers value
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_udp_init (struct _Cerver *cerver);
+
+// deletes all the cerver's udp workers & their peers
+CERVER_PRIVATE void cerver_udp_delete (struct _Cerver *cerver);
+
+// binds each worker's SO_REUSEPORT socket to the cerver's address
+// the first worker uses the cerver's main socket
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_udp_bind (struct _Cerver *cerver);
+
+// starts every worker loop in a dedicated thread,
+// except for the first one that is handled in the calling thread
+// if a thread can't be created, the workers that were started are stopped
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_udp_start (struct _Cerver *cerver);
+
+// stops all the udp workers & waits for their threads to finish
+CERVER_PRIVATE void cerver_udp_end (struct _Cerver *cerver);
+
+// sends the iovecs as a single datagram to the connection's address
+// sends from a worker's thread are batched & sent after handling its datagrams
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_udp_send (
+	struct _Connection *connection,
+	const struct iovec *iov, unsigned int iov_count,
+	size_t *total_sent
+);
+
+// returns the n of peers that are currently mapped in every worker
+CERVER_EXPORT u64 cerver_udp_get_n_peers (struct _Cerver *cerver);
+
+// prints the stats of each of the cerver's udp workers
+CERVER_PUBLIC void cerver_udp_stats_print (struct _Cerver *cerver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef _CERVER_URING_H_
+#define _CERVER_URING_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <linux/io_uring.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the provided buffers group used by the connections receives
+#define CERVER_URING_BUFFERS_GROUP				0
+
+// ms to wait before submitting again an accept that has failed,
+// like when the process has run out of fds
+#define CERVER_URING_ACCEPT_RETRY_TIMEOUT		100
+
+struct _Cerver;
+struct _Connection;
+
+#define CERVER_URING_OP_MAP(XX)										\
+	XX(0,	NONE, 		None)										\
+	XX(1,	ACCEPT, 	Multishot accept in the listening socket)	\
+	XX(2,	RECEIVE, 	Multishot receive using provided buffers)	\
+	XX(3,	WRITABLE, 	Wait for the sock fd to be writable)		\
+	XX(4,	CANCEL, 	Cancel all the requests of a sock fd)		\
+	XX(5,	ACCEPT_RETRY, 	Wait before submitting again a failed accept)
+
+typedef enum CerverUringOp {
+
+	#define XX(num, name, description) CERVER_URING_OP_##name = num,
+	CERVER_URING_OP_MAP (XX)
+	#undef XX
+
+} CerverUringOp;
+
+// the requests of each sock fd are tagged with its registration generation,
+// so completions for a sock fd that has been closed (& maybe reused) are ignored
+struct _CerverUringFd {
+
+	u32 generation;
+	bool writable;						// waiting for the sock fd to be writable
+
+};
+
+typedef struct _CerverUringFd CerverUringFd;
+
+// an io_uring instance used with CERVER_HANDLER_TYPE_IO_URING
+// the rings are mapped using the raw syscalls, so no external library is needed
+struct _CerverUring {
+
+	i32 ring_fd;
+
+	// submission queue
+	void *sq_ring;
+	size_t sq_ring_size;
+	u32 *sq_head;
+	u32 *sq_tail;
+	u32 sq_mask;
+	u32 *sq_array;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+
+	// completion queue
+	void *cq_ring;
+	size_t cq_ring_size;
+	u32 *cq_head;
+	u32 *cq_tail;
+	u32 cq_mask;
+	struct io_uring_cqe *cqes;
+
+	// provided buffers used by the multishot receives
+	struct io_uring_buf_ring *buf_ring;
+	size_t buf_ring_size;
+	char *buffers;
+	u32 buffer_size;
+	u32 n_buffers;
+
+	// sock fd -> its requests state
+	CerverUringFd *fds;
+	u32 fds_size;
+
+	// used by the accept retry timeout
+	struct __kernel_timespec accept_retry_ts;
+
+	// requests can be submitted from any thread
+	pthread_mutex_t *lock;
+
+};
+
+typedef struct _CerverUring CerverUring;
+
+// returns true if the running kernel supports every io_uring feature
+// that is required by CERVER_HANDLER_TYPE_IO_URING
+CERVER_PRIVATE bool cerver_uring_is_supported (void);
+
+// creates a new io_uring instance with its provided buffers ring
+// returns a new uring on success, NULL on error
+CERVER_PRIVATE CerverUring *cerver_uring_create (
+	const u32 entries, const u32 n_buffers, const u32 buffer_size
+);
+
+CERVER_PRIVATE void cerver_uring_delete (void *uring_ptr);
+
+// gets the operation & the sock fd from a completion's user data
+// returns false if the sock fd was unregistered after the request was submitted
+CERVER_PRIVATE bool cerver_uring_user_data_get (
+	CerverUring *uring, const u64 user_data,
+	CerverUringOp *op, i32 *sock_fd
+);
+
+// submits a multishot accept in the listening socket
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_accept (CerverUring *uring, const i32 sock);
+
+// submits a timeout that completes with a CERVER_URING_OP_ACCEPT_RETRY
+// after which the accept in the listening socket should be submitted again
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_accept_retry (
+	CerverUring *uring, const i32 sock, const u32 timeout
+);
+
+// submits again a multishot request that has stopped
+// only if its sock fd has not been unregistered
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_rearm (CerverUring *uring, const u64 user_data);
+
+// gives back a provided buffer after its data has been handled
+CERVER_PRIVATE void cerver_uring_buffer_release (
+	CerverUring *uring, const u16 buffer_id
+);
+
+// gets the provided buffer that was used in a receive
+CERVER_PRIVATE char *cerver_uring_buffer_get (
+	CerverUring *uring, const u16 buffer_id
+);
+
+// waits until there is at least one completion or the timeout expires
+// returns the number of completions that are ready
+CERVER_PRIVATE u32 cerver_uring_wait (CerverUring *uring, const u32 timeout);
+
+// gets the next ready completion, NULL if there are none
+CERVER_PRIVATE struct io_uring_cqe *cerver_uring_peek (CerverUring *uring);
+
+// marks the completion returned by cerver_uring_peek () as handled
+CERVER_PRIVATE void cerver_uring_advance (CerverUring *uring);
+
+// starts receiving in the connection's sock fd
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_register_connection (
+	struct _Cerver *cerver, struct _Connection *connection
+);
+
+// cancels every request of the sock fd & ignores their pending completions
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_unregister_sock_fd (
+	struct _Cerver *cerver, const i32 sock_fd
+);
+
+// waits for the sock fd to be writable, the request is only submitted once
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_set_writable (
+	CerverUring *uring, const i32 sock_fd, bool writable
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
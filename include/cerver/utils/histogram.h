@@ -0,0 +1,79 @@
+#ifndef _CERVER_UTILS_HISTOGRAM_H_
+#define _CERVER_UTILS_HISTOGRAM_H_
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+// each power of two range is split in 2^bits buckets,
+// so any recorded value is off by at most 1 / 2^bits (12.5%)
+#define HISTOGRAM_SUB_BUCKETS_BITS			3
+#define HISTOGRAM_SUB_BUCKETS				(1 << HISTOGRAM_SUB_BUCKETS_BITS)
+
+// values of 2^bits or bigger are counted in the last bucket
+// in nanoseconds, this is more than a minute
+#define HISTOGRAM_MAX_BITS					36
+
+#define HISTOGRAM_N_BUCKETS					\
+	((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKETS_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a log bucketed histogram with a fixed size,
+// values can be recorded from any thread without locks
+typedef struct Histogram {
+
+	u64 count;
+	u64 sum;
+	u64 max;
+
+	u64 buckets[HISTOGRAM_N_BUCKETS];
+
+} Histogram;
+
+CERVER_EXPORT Histogram *histogram_new (void);
+
+CERVER_EXPORT void histogram_delete (void *histogram_ptr);
+
+// sets every value back to 0
+CERVER_EXPORT void histogram_reset (Histogram *histogram);
+
+// atomically records the value n times
+CERVER_EXPORT void histogram_record_n (
+	Histogram *histogram, const u64 value, const u64 n
+);
+
+// atomically records the value
+CERVER_EXPORT void histogram_record (
+	Histogram *histogram, const u64 value
+);
+
+// adds every value of the source to the histogram
+// the source values are read atomically, as they can still be recorded
+CERVER_EXPORT void histogram_accumulate (
+	Histogram *histogram, const Histogram *source
+);
+
+// returns the number of values that have been recorded
+CERVER_EXPORT u64 histogram_get_count (const Histogram *histogram);
+
+// returns the mean of the recorded values
+CERVER_EXPORT u64 histogram_get_mean (const Histogram *histogram);
+
+// returns the biggest recorded value
+CERVER_EXPORT u64 histogram_get_max (const Histogram *histogram);
+
+// returns the highest value of the bucket where the percentile (0 - 100) is
+// like 50 for the median, 99 or 99.9 for the tail
+// returns 0 if no value has been recorded
+CERVER_EXPORT u64 histogram_get_percentile (
+	const Histogram *histogram, const double percentile
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
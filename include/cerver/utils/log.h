@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include "cerver/types/types.h"
+
 #include "cerver/config.h"
 
 #define LOG_DEFAULT_PATH		"/var/log/cerver"
@@ -26,6 +28,17 @@
 
 #define LOG_DEFAULT_UPDATE_INTERVAL			1
 
+// bytes of each thread's ring when logging asynchronously
+#define LOG_ASYNC_DEFAULT_RING_SIZE			65536
+#define LOG_ASYNC_MIN_RING_SIZE				(4 * LOG_MESSAGE_SIZE)
+#define LOG_ASYNC_MAX_RINGS					64
+
+// records written with a single writev () for each output
+#define LOG_ASYNC_BATCH_SIZE				256
+
+// ms that the writer thread waits when there are no records
+#define LOG_ASYNC_WRITER_INTERVAL			10
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -60,6 +73,25 @@ typedef enum LogType {
 	
 } LogType;
 
+// the level of a log is set by its first type
+#define LOG_LEVEL_NONE			0
+#define LOG_LEVEL_ERROR			1
+#define LOG_LEVEL_WARNING		2
+#define LOG_LEVEL_INFO			3
+#define LOG_LEVEL_DEBUG			4
+
+#define LOG_TYPE_LEVEL(type)										\
+	(((type) == LOG_TYPE_ERROR) ? LOG_LEVEL_ERROR :				\
+	((type) == LOG_TYPE_WARNING) ? LOG_LEVEL_WARNING :			\
+	(((type) == LOG_TYPE_DEBUG) || ((type) == LOG_TYPE_TEST)) ?	\
+		LOG_LEVEL_DEBUG : LOG_LEVEL_INFO)
+
+// logs above this level are removed when compiling,
+// like -D CERVER_LOG_MAX_LEVEL=2 to only keep errors & warnings
+#ifndef CERVER_LOG_MAX_LEVEL
+#define CERVER_LOG_MAX_LEVEL	LOG_LEVEL_DEBUG
+#endif
+
 #pragma endregion
 
 #pragma region configuration
@@ -133,6 +165,19 @@ CERVER_EXPORT void cerver_log_set_local_time (bool value);
 // any other type will be ignored
 CERVER_EXPORT void cerver_log_set_quiet (bool value);
 
+// enables asynchronous logging, must be set before cerver_init ()
+// each thread pushes its messages to its own lock free ring of ring_size bytes
+// and a writer thread formats & writes them in batches, 0 for default size
+// messages that don't fit in their thread's ring are dropped
+CERVER_EXPORT void cerver_log_set_async (bool value, unsigned int ring_size);
+
+// returns the number of messages that have been dropped
+// because the ring of their thread was full
+CERVER_EXPORT u64 cerver_log_get_dropped (void);
+
+// waits until the writer thread has written every pushed message
+CERVER_EXPORT void cerver_log_flush (void);
+
 #pragma endregion
 
 #pragma region public
@@ -182,6 +227,54 @@ CERVER_PUBLIC void cerver_log_raw (const char *msg, ...);
 // prints a line break, equivalent to printf ("\n")
 CERVER_PUBLIC void cerver_log_line_break (void);
 
+// removes the logs above CERVER_LOG_MAX_LEVEL,
+// so their arguments are never evaluated
+#ifndef CERVER_LOG_NO_FILTER
+
+// only used inside sizeof () to keep referencing the arguments
+// of the removed logs, so they are not reported as unused
+static inline int cerver_log_discard (const char *msg, ...) {
+
+	(void) msg;
+
+	return 0;
+
+}
+
+#define CERVER_LOG_DISCARD(...)			((void) sizeof (cerver_log_discard (__VA_ARGS__)))
+
+#if CERVER_LOG_MAX_LEVEL < LOG_LEVEL_DEBUG
+#define cerver_log(first_type, ...)												\
+	((LOG_TYPE_LEVEL (first_type) <= CERVER_LOG_MAX_LEVEL) ?						\
+		(cerver_log) (first_type, __VA_ARGS__) : (void) 0)
+
+#define cerver_log_with_date(first_type, ...)									\
+	((LOG_TYPE_LEVEL (first_type) <= CERVER_LOG_MAX_LEVEL) ?						\
+		(cerver_log_with_date) (first_type, __VA_ARGS__) : (void) 0)
+
+#define cerver_log_both(first_type, ...)										\
+	((LOG_TYPE_LEVEL (first_type) <= CERVER_LOG_MAX_LEVEL) ?						\
+		(cerver_log_both) (first_type, __VA_ARGS__) : (void) 0)
+
+#define cerver_log_debug(...)			CERVER_LOG_DISCARD (__VA_ARGS__)
+#endif
+
+#if CERVER_LOG_MAX_LEVEL < LOG_LEVEL_INFO
+#define cerver_log_msg(...)				CERVER_LOG_DISCARD (__VA_ARGS__)
+#define cerver_log_success(...)			CERVER_LOG_DISCARD (__VA_ARGS__)
+#define cerver_log_raw(...)				CERVER_LOG_DISCARD (__VA_ARGS__)
+#endif
+
+#if CERVER_LOG_MAX_LEVEL < LOG_LEVEL_WARNING
+#define cerver_log_warning(...)			CERVER_LOG_DISCARD (__VA_ARGS__)
+#endif
+
+#if CERVER_LOG_MAX_LEVEL < LOG_LEVEL_ERROR
+#define cerver_log_error(...)			CERVER_LOG_DISCARD (__VA_ARGS__)
+#endif
+
+#endif
+
 #pragma endregion
 
 #pragma region main
@@ -0,0 +1,126 @@
+#ifndef _CERVER_WHEEL_H_
+#define _CERVER_WHEEL_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+// each level has 64 slots, and each slot of a level
+// covers the whole range of the level below it
+#define TIMER_WHEEL_LEVELS					4
+#define TIMER_WHEEL_SLOT_BITS				6
+#define TIMER_WHEEL_SLOTS					(1 << TIMER_WHEEL_SLOT_BITS)
+
+// timers longer than the range of every level expire at its end
+#define TIMER_WHEEL_MAX_TICKS				\
+	((1ULL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1)
+
+#define TIMER_WHEEL_DEFAULT_TICK			100
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _TimerWheel;
+
+// a timer that is embedded in the structure that it belongs to,
+// so arming & cancelling it never allocates memory
+struct _WheelTimer {
+
+	struct _WheelTimer *next;
+	struct _WheelTimer *prev;
+
+	struct _TimerWheel *wheel;			// the wheel where the timer was armed
+	u64 expires;						// the tick when the timer expires
+	bool armed;
+
+	// called by the wheel without holding its lock
+	// the timer can be armed again or its structure deleted
+	void (*callback)(struct _TimerWheel *wheel, void *data);
+	void *data;
+
+};
+
+typedef struct _WheelTimer WheelTimer;
+
+// sets the method that will be called when the timer expires
+CERVER_EXPORT void wheel_timer_init (
+	WheelTimer *timer,
+	void (*callback)(struct _TimerWheel *wheel, void *data), void *data
+);
+
+// returns true if the timer is waiting to expire
+CERVER_EXPORT bool wheel_timer_is_armed (WheelTimer *timer);
+
+// hierarchical timing wheel where timers are armed & cancelled in O(1)
+// the timers of a slot of an upper level are moved to the lower levels
+// only when the wheel reaches that slot
+struct _TimerWheel {
+
+	u32 tick;							// in milliseconds
+	u64 start;							// monotonic time when the wheel was created
+	u64 current;						// the current tick
+
+	WheelTimer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	u64 n_timers;
+
+	// the data that is passed to every timer callback
+	void *data;
+
+	pthread_mutex_t *lock;
+
+	// cancelling a timer waits until its callback has finished
+	pthread_cond_t *callback_done;
+	WheelTimer *running_timer;
+	pthread_t running_thread;
+
+	// optional thread that advances the wheel every tick
+	bool thread_running;
+	pthread_t thread_id;
+	pthread_cond_t *thread_cond;
+
+};
+
+typedef struct _TimerWheel TimerWheel;
+
+CERVER_EXPORT void timer_wheel_delete (void *wheel_ptr);
+
+// creates a new timer wheel that advances every tick milliseconds
+// data - passed to every timer callback, like the structure that owns the wheel
+CERVER_EXPORT TimerWheel *timer_wheel_create (const u32 tick, void *data);
+
+// returns the n of timers that are waiting to expire
+CERVER_EXPORT u64 timer_wheel_get_n_timers (TimerWheel *wheel);
+
+// arms the timer to expire after timeout milliseconds
+// if the timer was already armed, it is moved to its new expiration
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 timer_wheel_arm (
+	TimerWheel *wheel, WheelTimer *timer, const u64 timeout
+);
+
+// removes the timer from its wheel if it is armed
+// if its callback is running in another thread, waits until it has finished
+// returns 0 if the timer was armed, 1 if not
+CERVER_EXPORT u8 wheel_timer_cancel (WheelTimer *timer);
+
+// expires every timer up to the current time
+// returns the n of timers that have expired
+CERVER_EXPORT u32 timer_wheel_advance (TimerWheel *wheel);
+
+// starts a thread that advances the wheel every tick
+// returns 0 on success or if it is already running, 1 on error
+CERVER_EXPORT u8 timer_wheel_start (TimerWheel *wheel);
+
+// stops the wheel thread & waits for it to finish
+CERVER_EXPORT void timer_wheel_stop (TimerWheel *wheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -20,12 +20,13 @@
 #include "cerver/cerver.h"
 #include "cerver/client.h"
 #include "cerver/connection.h"
+#include "cerver/errors.h"
 #include "cerver/handler.h"
 #include "cerver/packets.h"
 #include "cerver/events.h"
 
 #include "cerver/threads/thread.h"
-#include "cerver/threads/bsem.h"
+#include "cerver/threads/jobs.h"
 
 #include "cerver/utils/utils.h"
 #include "cerver/utils/log.h"
@@ -97,34 +98,12 @@ static void admin_cerver_packet_send_update_stats (
 	PacketType packet_type, size_t sent
 ) {
 
-	stats->total_n_packets_sent += 1;
-	stats->total_bytes_sent += sent;
+	// admins' packets can be sent from any thread
+	(void) __atomic_add_fetch (&stats->total_n_packets_sent, 1, __ATOMIC_RELAXED);
+	(void) __atomic_add_fetch (&stats->total_bytes_sent, sent, __ATOMIC_RELAXED);
 
-	switch (packet_type) {
-		case PACKET_TYPE_NONE: break;
-
-		case PACKET_TYPE_CERVER: stats->sent_packets->n_cerver_packets += 1; break;
-
-		case PACKET_TYPE_CLIENT: break;
-
-		case PACKET_TYPE_ERROR: stats->sent_packets->n_error_packets += 1; break;
-
-		case PACKET_TYPE_REQUEST: stats->sent_packets->n_request_packets += 1; break;
-
-		case PACKET_TYPE_AUTH: stats->sent_packets->n_auth_packets += 1; break;
-
-		case PACKET_TYPE_GAME: stats->sent_packets->n_game_packets += 1; break;
-
-		case PACKET_TYPE_APP: stats->sent_packets->n_app_packets += 1; break;
-
-		case PACKET_TYPE_APP_ERROR: stats->sent_packets->n_app_error_packets += 1; break;
-
-		case PACKET_TYPE_CUSTOM: stats->sent_packets->n_custom_packets += 1; break;
-
-		case PACKET_TYPE_TEST: stats->sent_packets->n_test_packets += 1; break;
-
-		default: stats->sent_packets->n_unknown_packets += 1; break;
-	}
+	if (packet_type != PACKET_TYPE_CLIENT)
+		packets_per_type_add (stats->sent_packets, packet_type, 1);
 
 }
 
@@ -610,6 +589,11 @@ AdminCerver *admin_cerver_new (void) {
 void admin_cerver_delete (AdminCerver *admin_cerver) {
 
 	if (admin_cerver) {
+		// the packets that were never handled release their admins' clients
+		handler_delete (admin_cerver->app_packet_handler);
+		handler_delete (admin_cerver->app_error_packet_handler);
+		handler_delete (admin_cerver->custom_packet_handler);
+
 		dlist_delete (admin_cerver->admins);
 
 		if (admin_cerver->fds) free (admin_cerver->fds);
@@ -619,10 +603,6 @@ void admin_cerver_delete (AdminCerver *admin_cerver) {
 			free (admin_cerver->poll_lock);
 		}
 
-		handler_delete (admin_cerver->app_packet_handler);
-		handler_delete (admin_cerver->app_error_packet_handler);
-		handler_delete (admin_cerver->custom_packet_handler);
-
 		if (admin_cerver->handlers_lock) {
 			pthread_mutex_destroy (admin_cerver->handlers_lock);
 			free (admin_cerver->handlers_lock);
@@ -1460,9 +1440,7 @@ static u8 admin_cerver_app_handler_destroy (AdminCerver *admin_cerver) {
 		if (admin_cerver->app_packet_handler) {
 			if (!admin_cerver->app_packet_handler->direct_handle) {
 				// stop app handler
-				bsem_post_all (
-					admin_cerver->app_packet_handler->job_queue->has_jobs
-				);
+				job_queue_wake_all (admin_cerver->app_packet_handler->job_queue);
 			}
 		}
 	}
@@ -1479,9 +1457,7 @@ static u8 admin_cerver_app_error_handler_destroy (AdminCerver *admin_cerver) {
 		if (admin_cerver->app_error_packet_handler) {
 			if (!admin_cerver->app_error_packet_handler->direct_handle) {
 				// stop app error handler
-				bsem_post_all (
-					admin_cerver->app_error_packet_handler->job_queue->has_jobs
-				);
+				job_queue_wake_all (admin_cerver->app_error_packet_handler->job_queue);
 			}
 		}
 	}
@@ -1498,9 +1474,7 @@ static u8 admin_cerver_custom_handler_destroy (AdminCerver *admin_cerver) {
 		if (admin_cerver->custom_packet_handler) {
 			if (!admin_cerver->custom_packet_handler->direct_handle) {
 				// stop custom handler
-				bsem_post_all (
-					admin_cerver->custom_packet_handler->job_queue->has_jobs
-				);
+				job_queue_wake_all (admin_cerver->custom_packet_handler->job_queue);
 			}
 		}
 	}
@@ -1531,13 +1505,13 @@ static u8 admin_cerver_handlers_end (AdminCerver *admin_cerver) {
 		// poll remaining handlers
 		while (admin_cerver->num_handlers_alive) {
 			if (admin_cerver->app_packet_handler)
-				bsem_post_all (admin_cerver->app_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (admin_cerver->app_packet_handler->job_queue);
 
 			if (admin_cerver->app_error_packet_handler)
-				bsem_post_all (admin_cerver->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (admin_cerver->app_error_packet_handler->job_queue);
 
 			if (admin_cerver->custom_packet_handler)
-				bsem_post_all (admin_cerver->custom_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (admin_cerver->custom_packet_handler->job_queue);
 
 			sleep (1);
 		}
@@ -1697,6 +1671,36 @@ static AdminCerverHandlerError admin_cerver_client_packet_handler (
 
 }
 
+// sends the cerver's latency percentiles to the admin
+static void admin_cerver_request_latencies (Packet *packet) {
+
+	Packet *latencies = cerver_latencies_packet_generate (packet->cerver);
+	if (latencies) {
+		packet_set_network_values (
+			latencies,
+			packet->cerver, packet->client, packet->connection, NULL
+		);
+
+		if (packet_send (latencies, 0, NULL, false)) {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_ADMIN,
+				"Failed to send latencies to admin in cerver %s!",
+				packet->cerver->info->name->str
+			);
+		}
+
+		packet_delete (latencies);
+	}
+
+	else {
+		(void) error_packet_generate_and_send (
+			CERVER_ERROR_PACKET_ERROR, "Latency histograms are disabled",
+			packet->cerver, packet->client, packet->connection
+		);
+	}
+
+}
+
 // handles a request made from the admin
 static void admin_cerver_request_packet_handler (Packet *packet) {
 
@@ -1712,6 +1716,11 @@ static void admin_cerver_request_packet_handler (Packet *packet) {
 				cerver_request_send_file (packet);
 				break;
 
+			// request from an admin to get the cerver's latencies
+			case REQUEST_PACKET_TYPE_GET_LATENCIES:
+				admin_cerver_request_latencies (packet);
+				break;
+
 			default: {
 				#ifdef ADMIN_DEBUG
 				cerver_log (
@@ -1740,9 +1749,8 @@ static void admin_app_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->admin->app_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->cerver->admin->app_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s ADMIN app_packet_handler!",
@@ -1777,9 +1785,8 @@ static void admin_app_error_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->admin->app_error_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->cerver->admin->app_error_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s ADMIN app_error_packet_handler!",
@@ -1814,9 +1821,8 @@ static void admin_custom_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->admin->custom_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->cerver->admin->custom_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s ADMIN custom_packet_handler!",
@@ -16,11 +16,12 @@
 #include "cerver/connection.h"
 #include "cerver/auth.h"
 #include "cerver/events.h"
+#include "cerver/wheel.h"
 
 #include "cerver/threads/thread.h"
 #include "cerver/threads/thpool.h"
 
-#include "cerver/collections/htab.h"
+#include "cerver/collections/ohtab.h"
 
 #include "cerver/utils/utils.h"
 #include "cerver/utils/log.h"
@@ -29,6 +30,7 @@ static u8 on_hold_connection_remove (const Cerver *cerver, Connection *connectio
 static u8 on_hold_poll_register_connection (Cerver *cerver, Connection *connection);
 u8 on_hold_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd);
 static u8 on_hold_poll_unregister_connection (Cerver *cerver, Connection *connection);
+static void on_hold_connection_expired (TimerWheel *wheel, void *connection_ptr);
 
 #pragma region errors
 
@@ -1020,10 +1022,9 @@ u8 on_hold_connection (Cerver *cerver, Connection *connection) {
 				avl_insert_node (cerver->on_hold_connections, connection);
 
 				const void *key = &connection->socket->sock_fd;
-				if (!htab_insert (
+				if (!ohtab_insert (
 					cerver->on_hold_connection_sock_fd_map,
-					key, sizeof (i32),
-					connection, sizeof (Connection)
+					key, connection
 				)) {
 					#ifdef AUTH_DEBUG
 					cerver_log_debug (
@@ -1032,6 +1033,18 @@ u8 on_hold_connection (Cerver *cerver, Connection *connection) {
 					);
 					#endif
 
+					if (cerver->on_hold_timer_wheel) {
+						wheel_timer_init (
+							&connection->on_hold_timer,
+							on_hold_connection_expired, connection
+						);
+
+						(void) timer_wheel_arm (
+							cerver->on_hold_timer_wheel, &connection->on_hold_timer,
+							(u64) cerver->on_hold_max_time * 1000
+						);
+					}
+
 					retval = 0;     // success
 				}
 
@@ -1058,6 +1071,8 @@ static u8 on_hold_connection_remove (
 	u8 retval = 1;
 
 	if (cerver && connection) {
+		(void) wheel_timer_cancel (&connection->on_hold_timer);
+
 		if (!on_hold_poll_unregister_connection ((Cerver *) cerver, connection)) {
 			// remove the connection associated to the sock fd
 			Connection *query = connection_new ();
@@ -1082,8 +1097,8 @@ static u8 on_hold_connection_remove (
 
 			// remove connection from on hold map
 			const void *key = &connection->socket->sock_fd;
-			if (htab_remove (
-				cerver->on_hold_connection_sock_fd_map, key, sizeof (i32))
+			if (ohtab_remove (
+				cerver->on_hold_connection_sock_fd_map, key)
 			) {
 				#ifdef AUTH_DEBUG
 				cerver_log_debug (
@@ -1122,7 +1137,7 @@ void on_hold_connection_drop (
 		// close the connection socket
 		connection_end (connection);
 
-		cerver_sockets_pool_push ((Cerver *) cerver, connection->socket);
+		(void) cerver_sockets_pool_push ((Cerver *) cerver, connection->socket);
 		connection->socket = NULL;
 
 		// we can now safely delete the connection
@@ -1137,6 +1152,22 @@ void on_hold_connection_drop (
 
 }
 
+// called by the on hold timer wheel when the connection
+// has not authenticated in the cerver's on hold max time
+static void on_hold_connection_expired (TimerWheel *wheel, void *connection_ptr) {
+
+	Cerver *cerver = (Cerver *) wheel->data;
+	Connection *connection = (Connection *) connection_ptr;
+
+	cerver_log_warning (
+		"On hold connection %d has not authenticated in %u secs, dropping it...",
+		connection->socket->sock_fd, cerver->on_hold_max_time
+	);
+
+	on_hold_connection_drop (cerver, connection);
+
+}
+
 #pragma endregion
 
 #pragma region poll
@@ -1182,7 +1213,7 @@ static u8 on_hold_poll_register_connection (
 			cerver->hold_fds[idx].events = POLLIN;
 			cerver->current_on_hold_nfds++;
 
-			cerver->stats->current_n_hold_connections++;
+			(void) __atomic_add_fetch (&cerver->stats->current_n_hold_connections, 1, __ATOMIC_RELAXED);
 
 			#ifdef AUTH_DEBUG
 			cerver_log (
@@ -1238,7 +1269,7 @@ u8 on_hold_poll_unregister_sock_fd (
 			cerver->hold_fds[idx].revents = -1;
 			cerver->current_on_hold_nfds--;
 
-			cerver->stats->current_n_hold_connections--;
+			(void) __atomic_sub_fetch (&cerver->stats->current_n_hold_connections, 1, __ATOMIC_RELAXED);
 
 			#ifdef AUTH_DEBUG
 			cerver_log (
@@ -1394,6 +1425,10 @@ void *on_hold_poll (void *cerver_ptr) {
 						}
 					} break;
 				}
+
+				// drops the connections that have taken too long to authenticate
+				if (cerver->on_hold_timer_wheel)
+					(void) timer_wheel_advance (cerver->on_hold_timer_wheel);
 			}
 
 			#ifdef AUTH_DEBUG
@@ -10,6 +10,8 @@
 #include <unistd.h>
 
 #include <sys/poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
@@ -17,6 +19,7 @@
 #include "cerver/collections/avl.h"
 #include "cerver/collections/dlist.h"
 #include "cerver/collections/pool.h"
+#include "cerver/collections/slab.h"
 
 #include "cerver/admin.h"
 #include "cerver/auth.h"
@@ -25,16 +28,21 @@
 #include "cerver/connection.h"
 #include "cerver/events.h"
 #include "cerver/errors.h"
+#include "cerver/fdtable.h"
 #include "cerver/files.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/reactor.h"
+#include "cerver/udp.h"
+#include "cerver/uring.h"
 
 #include "cerver/threads/thread.h"
 #include "cerver/threads/thpool.h"
 
 #include "cerver/game/game.h"
 
+#include "cerver/utils/histogram.h"
 #include "cerver/utils/log.h"
 #include "cerver/utils/utils.h"
 
@@ -52,6 +60,9 @@ void cerver_init (void) {
 // should be called only once at the very end of the program
 void cerver_end (void) {
 
+	// release the objects kept by the main thread
+	slab_thread_cleanup ();
+
 	cerver_log_end ();
 
 }
@@ -96,6 +107,30 @@ const char *cerver_handler_type_description (CerverHandlerType type) {
 
 }
 
+const char *cerver_handlers_routing_to_string (CerverHandlersRouting routing) {
+
+	switch (routing) {
+		#define XX(num, name, string, description) case CERVER_HANDLERS_ROUTING_##name: return #string;
+		CERVER_HANDLERS_ROUTING_MAP(XX)
+		#undef XX
+	}
+
+	return cerver_handlers_routing_to_string (CERVER_HANDLERS_ROUTING_HANDLER_ID);
+
+}
+
+const char *cerver_handlers_routing_description (CerverHandlersRouting routing) {
+
+	switch (routing) {
+		#define XX(num, name, string, description) case CERVER_HANDLERS_ROUTING_##name: return #description;
+		CERVER_HANDLERS_ROUTING_MAP(XX)
+		#undef XX
+	}
+
+	return cerver_handlers_routing_description (CERVER_HANDLERS_ROUTING_HANDLER_ID);
+
+}
+
 #pragma endregion
 
 #pragma region info
@@ -184,13 +219,122 @@ u8 cerver_info_send_info_packet (
 
 #pragma region stats
 
-static CerverStats *cerver_stats_new (void) {
+// padded to a multiple of a cache line, so two shards never share one
+#define CERVER_STATS_SHARD_PADDING			\
+	(64 - (((CERVER_STATS_N_COUNTERS * sizeof (u64)) + (2 * sizeof (PacketsPerType))) % 64))
+
+struct _CerverStatsShard {
+
+	u64 counters[CERVER_STATS_N_COUNTERS];
+
+	PacketsPerType received_packets;
+	PacketsPerType sent_packets;
+
+	char padding[CERVER_STATS_SHARD_PADDING];
+
+};
+
+typedef struct _CerverStatsShard CerverStatsShard;
+
+// the packet types values go from 0 to the number of types
+enum {
+
+	#define XX(num, name) CERVER_STATS_PACKET_TYPE_##name,
+	PACKET_TYPE_MAP (XX)
+	#undef XX
+
+	CERVER_STATS_N_PACKET_TYPES
+
+};
+
+static const char *cerver_stats_packet_types[CERVER_STATS_N_PACKET_TYPES] = {
+
+	#define XX(num, name) [num] = #name,
+	PACKET_TYPE_MAP (XX)
+	#undef XX
+
+};
+
+#define CERVER_STATS_LATENCIES_PADDING		\
+	(64 - (((CERVER_STATS_N_LATENCIES + CERVER_STATS_N_PACKET_TYPES) * sizeof (Histogram)) % 64))
+
+// the CERVER_STATS_LATENCY_HANDLER histogram is only set in a snapshot,
+// with the sum of the handler latencies of every packet type
+struct _CerverStatsLatencies {
+
+	Histogram latencies[CERVER_STATS_N_LATENCIES];
+	Histogram handler_latencies[CERVER_STATS_N_PACKET_TYPES];
+
+	char padding[CERVER_STATS_LATENCIES_PADDING];
+
+};
+
+typedef struct _CerverStatsLatencies CerverStatsLatencies;
+
+const char *cerver_stats_latency_to_string (
+	const CerverStatsLatency latency
+) {
+
+	switch (latency) {
+		#define XX(num, name, string, description) case CERVER_STATS_LATENCY_##name: return #string;
+		CERVER_STATS_LATENCY_MAP(XX)
+		#undef XX
+
+		default: break;
+	}
+
+	return "Unknown";
+
+}
+
+const char *cerver_stats_latency_description (
+	const CerverStatsLatency latency
+) {
+
+	switch (latency) {
+		#define XX(num, name, string, description) case CERVER_STATS_LATENCY_##name: return #description;
+		CERVER_STATS_LATENCY_MAP(XX)
+		#undef XX
+
+		default: break;
+	}
+
+	return "Unknown latency";
+
+}
+
+static u32 cerver_stats_next_shard = 0;
+
+// the shard used by the current thread in every cerver
+static _Thread_local u32 cerver_stats_shard_idx = CERVER_STATS_N_SHARDS;
+
+static void cerver_stats_delete (CerverStats *cerver_stats);
+
+static CerverStats *cerver_stats_new (const bool sharded) {
 
 	CerverStats *cerver_stats = (CerverStats *) malloc (sizeof (CerverStats));
 	if (cerver_stats) {
 		(void) memset (cerver_stats, 0, sizeof (CerverStats));
 		cerver_stats->received_packets = packets_per_type_new ();
 		cerver_stats->sent_packets = packets_per_type_new ();
+
+		if (sharded) {
+			cerver_stats->shards = (CerverStatsShard *) aligned_alloc (
+				64, CERVER_STATS_N_SHARDS * sizeof (CerverStatsShard)
+			);
+
+			if (cerver_stats->shards) {
+				(void) memset (
+					cerver_stats->shards, 0, CERVER_STATS_N_SHARDS * sizeof (CerverStatsShard)
+				);
+			}
+
+			// the counters can't be updated without their shards
+			else {
+				cerver_stats_delete (cerver_stats);
+				cerver_stats = NULL;
+			}
+		}
 	}
 
 	return cerver_stats;
@@ -203,11 +347,281 @@ static void cerver_stats_delete (CerverStats *cerver_stats) {
 		packets_per_type_delete (cerver_stats->received_packets);
 		packets_per_type_delete (cerver_stats->sent_packets);
 
+		if (cerver_stats->reactors_stats) free (cerver_stats->reactors_stats);
+
+		if (cerver_stats->shards) free (cerver_stats->shards);
+
+		if (cerver_stats->latencies) free (cerver_stats->latencies);
+
 		free (cerver_stats);
 	}
 
 }
 
+// each thread gets the next shard the first time it updates any stats
+static inline u32 cerver_stats_get_shard_idx (void) {
+
+	if (cerver_stats_shard_idx == CERVER_STATS_N_SHARDS) {
+		cerver_stats_shard_idx = __atomic_fetch_add (
+			&cerver_stats_next_shard, 1, __ATOMIC_RELAXED
+		) % CERVER_STATS_N_SHARDS;
+	}
+
+	return cerver_stats_shard_idx;
+
+}
+
+static inline CerverStatsShard *cerver_stats_shard (CerverStats *stats) {
+
+	return &stats->shards[cerver_stats_get_shard_idx ()];
+
+}
+
+// adds the value to the calling thread's shard of the counter
+void cerver_stats_add (
+	CerverStats *stats, const CerverStatsCounter counter, const u64 value
+) {
+
+	// threads that got the same shard may update it at the same time
+	(void) __atomic_add_fetch (
+		&cerver_stats_shard (stats)->counters[counter], value, __ATOMIC_RELAXED
+	);
+
+}
+
+// returns the calling thread's shard of the received or sent packets per type
+PacketsPerType *cerver_stats_packets (
+	CerverStats *stats, const bool sent
+) {
+
+	CerverStatsShard *shard = cerver_stats_shard (stats);
+
+	return sent ? &shard->sent_packets : &shard->received_packets;
+
+}
+
+static inline u64 cerver_stats_latency_now (void) {
+
+	struct timespec now = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &now);
+
+	return ((u64) now.tv_sec * 1000000000) + (u64) now.tv_nsec;
+
+}
+
+// returns the current time to start measuring a latency,
+// or 0 if the latency histograms are disabled
+u64 cerver_stats_latency_start (const CerverStats *stats) {
+
+	return (stats && stats->latencies) ? cerver_stats_latency_now () : 0;
+
+}
+
+// records the time since start in the calling thread's shard of the latency
+// nothing is recorded if start is 0
+void cerver_stats_latency_end (
+	CerverStats *stats, const CerverStatsLatency latency, const u64 start
+) {
+
+	if (start && (latency < CERVER_STATS_N_LATENCIES)) {
+		histogram_record (
+			&stats->latencies[cerver_stats_get_shard_idx ()].latencies[latency],
+			cerver_stats_latency_now () - start
+		);
+	}
+
+}
+
+// records the time since start divided between n packets
+// in the calling thread's shard of the packet type's handler latency
+// nothing is recorded if start is 0
+void cerver_stats_handler_latency_end (
+	CerverStats *stats, const u32 packet_type, const u64 start, const u64 n_packets
+) {
+
+	if (start && n_packets && (packet_type < CERVER_STATS_N_PACKET_TYPES)) {
+		histogram_record_n (
+			&stats->latencies[cerver_stats_get_shard_idx ()].handler_latencies[packet_type],
+			(cerver_stats_latency_now () - start) / n_packets, n_packets
+		);
+	}
+
+}
+
+// merges the latencies shards into a single copy
+static CerverStatsLatencies *cerver_stats_latencies_snapshot (
+	const CerverStatsLatencies *shards
+) {
+
+	CerverStatsLatencies *latencies = (CerverStatsLatencies *) malloc (
+		sizeof (CerverStatsLatencies)
+	);
+
+	if (latencies) {
+		(void) memset (latencies, 0, sizeof (CerverStatsLatencies));
+
+		for (u32 i = 0; i < CERVER_STATS_N_SHARDS; i++) {
+			for (u32 l = 0; l < CERVER_STATS_N_LATENCIES; l++)
+				histogram_accumulate (&latencies->latencies[l], &shards[i].latencies[l]);
+
+			for (u32 t = 0; t < CERVER_STATS_N_PACKET_TYPES; t++)
+				histogram_accumulate (&latencies->handler_latencies[t], &shards[i].handler_latencies[t]);
+		}
+
+		for (u32 t = 0; t < CERVER_STATS_N_PACKET_TYPES; t++) {
+			histogram_accumulate (
+				&latencies->latencies[CERVER_STATS_LATENCY_HANDLER],
+				&latencies->handler_latencies[t]
+			);
+		}
+	}
+
+	return latencies;
+
+}
+
+// returns the snapshot's histogram of the latency,
+// or NULL if the latency histograms are disabled
+const Histogram *cerver_stats_get_latency (
+	const CerverStats *snapshot, const CerverStatsLatency latency
+) {
+
+	return (snapshot && snapshot->latencies && (latency < CERVER_STATS_N_LATENCIES)) ?
+		&snapshot->latencies->latencies[latency] : NULL;
+
+}
+
+// returns the snapshot's histogram of the packet type's handlers execution time,
+// or NULL if the latency histograms are disabled
+const Histogram *cerver_stats_get_handler_latency (
+	const CerverStats *snapshot, const u32 packet_type
+) {
+
+	return (snapshot && snapshot->latencies && (packet_type < CERVER_STATS_N_PACKET_TYPES)) ?
+		&snapshot->latencies->handler_latencies[packet_type] : NULL;
+
+}
+
+// returns the current value of the counter adding all of its shards
+u64 cerver_stats_get_counter (
+	const Cerver *cerver, const CerverStatsCounter counter
+) {
+
+	u64 value = 0;
+
+	if (cerver && cerver->stats && (counter < CERVER_STATS_N_COUNTERS)) {
+		for (u32 i = 0; i < CERVER_STATS_N_SHARDS; i++) {
+			value += __atomic_load_n (
+				&cerver->stats->shards[i].counters[counter], __ATOMIC_RELAXED
+			);
+		}
+	}
+
+	return value;
+
+}
+
+static inline void cerver_stats_packets_store (
+	PacketsPerType *packets_per_type, const PacketsPerType *source
+) {
+
+	const u64 *counters = (const u64 *) source;
+	u64 *values = (u64 *) packets_per_type;
+	for (size_t i = 0; i < (sizeof (PacketsPerType) / sizeof (u64)); i++)
+		__atomic_store_n (&values[i], counters[i], __ATOMIC_RELAXED);
+
+}
+
+// the deprecated counters of the cerver's stats are set to the snapshot's values,
+// so the ones that still read those fields get the values of the last snapshot
+static void cerver_stats_deprecated_update (
+	CerverStats *stats, const CerverStats *snapshot
+) {
+
+	#define XX(num, name, field, description) __atomic_store_n (&stats->field, snapshot->field, __ATOMIC_RELAXED);
+	CERVER_STATS_COUNTER_MAP (XX)
+	#undef XX
+
+	if (stats->received_packets && snapshot->received_packets)
+		cerver_stats_packets_store (stats->received_packets, snapshot->received_packets);
+
+	if (stats->sent_packets && snapshot->sent_packets)
+		cerver_stats_packets_store (stats->sent_packets, snapshot->sent_packets);
+
+}
+
+// returns a new copy of the cerver stats with the sum of every counter's shards
+// & the current value of every other field, each value is read without tearing
+// the deprecated counters of the cerver's stats are also set to the snapshot's values
+// the snapshot must be deleted using cerver_stats_snapshot_delete ()
+CerverStats *cerver_stats_get_snapshot (const Cerver *cerver) {
+
+	CerverStats *snapshot = NULL;
+
+	if (cerver) {
+		if (cerver->stats && (snapshot = cerver_stats_new (false))) {
+			const CerverStats *stats = cerver->stats;
+
+			snapshot->threshold_time = stats->threshold_time;
+
+			u64 counters[CERVER_STATS_N_COUNTERS] = { 0 };
+			const CerverStatsShard *shard = NULL;
+			for (u32 i = 0; i < CERVER_STATS_N_SHARDS; i++) {
+				shard = &stats->shards[i];
+
+				for (u32 c = 0; c < CERVER_STATS_N_COUNTERS; c++)
+					counters[c] += __atomic_load_n (&shard->counters[c], __ATOMIC_RELAXED);
+
+				packets_per_type_accumulate (snapshot->received_packets, &shard->received_packets);
+				packets_per_type_accumulate (snapshot->sent_packets, &shard->sent_packets);
+			}
+
+			#define XX(num, name, field, description) snapshot->field = counters[num];
+			CERVER_STATS_COUNTER_MAP (XX)
+			#undef XX
+
+			cerver_stats_deprecated_update (cerver->stats, snapshot);
+
+			snapshot->current_active_client_connections = __atomic_load_n (&stats->current_active_client_connections, __ATOMIC_RELAXED);
+			snapshot->current_n_connected_clients = __atomic_load_n (&stats->current_n_connected_clients, __ATOMIC_RELAXED);
+			snapshot->current_n_hold_connections = __atomic_load_n (&stats->current_n_hold_connections, __ATOMIC_RELAXED);
+			snapshot->total_on_hold_connections = __atomic_load_n (&stats->total_on_hold_connections, __ATOMIC_RELAXED);
+			snapshot->total_n_clients = __atomic_load_n (&stats->total_n_clients, __ATOMIC_RELAXED);
+			snapshot->unique_clients = __atomic_load_n (&stats->unique_clients, __ATOMIC_RELAXED);
+			snapshot->total_client_connections = __atomic_load_n (&stats->total_client_connections, __ATOMIC_RELAXED);
+
+			// each reactor only updates its own stats
+			if (stats->n_reactors && stats->reactors_stats) {
+				snapshot->reactors_stats = (CerverReactorStats *) calloc (
+					stats->n_reactors, sizeof (CerverReactorStats)
+				);
+
+				if (snapshot->reactors_stats) {
+					snapshot->n_reactors = stats->n_reactors;
+
+					const u64 *values = (const u64 *) stats->reactors_stats;
+					u64 *copy = (u64 *) snapshot->reactors_stats;
+					for (size_t i = 0; i < (stats->n_reactors * (sizeof (CerverReactorStats) / sizeof (u64))); i++)
+						copy[i] = __atomic_load_n (&values[i], __ATOMIC_RELAXED);
+				}
+			}
+
+			if (stats->latencies) {
+				snapshot->latencies = cerver_stats_latencies_snapshot (stats->latencies);
+			}
+		}
+	}
+
+	return snapshot;
+
+}
+
+void cerver_stats_snapshot_delete (CerverStats *snapshot) {
+
+	cerver_stats_delete (snapshot);
+
+}
+
 // sets the cerver stats threshold time (how often the stats get reset)
 void cerver_stats_set_threshold_time (
 	Cerver *cerver, time_t threshold_time
@@ -219,49 +633,114 @@ void cerver_stats_set_threshold_time (
 
 }
 
+static void cerver_stats_latency_print (
+	const char *name, const Histogram *histogram
+) {
+
+	cerver_log_msg (
+		"%-20s %10ld %10.1f %10.1f %10.1f %10.1f",
+		name, histogram_get_count (histogram),
+		(double) histogram_get_percentile (histogram, 50) / 1000,
+		(double) histogram_get_percentile (histogram, 99) / 1000,
+		(double) histogram_get_percentile (histogram, 99.9) / 1000,
+		(double) histogram_get_max (histogram) / 1000
+	);
+
+}
+
+static void cerver_stats_latencies_print (const CerverStats *snapshot) {
+
+	cerver_log_msg (
+		"\nLatencies (us):      %10s %10s %10s %10s %10s",
+		"Count", "p50", "p99", "p999", "Max"
+	);
+
+	for (u32 l = 0; l < CERVER_STATS_N_LATENCIES; l++) {
+		cerver_stats_latency_print (
+			cerver_stats_latency_to_string ((CerverStatsLatency) l),
+			&snapshot->latencies->latencies[l]
+		);
+	}
+
+	cerver_log_msg ("\nHandlers latencies (us):");
+	for (u32 t = 0; t < CERVER_STATS_N_PACKET_TYPES; t++) {
+		if (snapshot->latencies->handler_latencies[t].count) {
+			cerver_stats_latency_print (
+				cerver_stats_packet_types[t],
+				&snapshot->latencies->handler_latencies[t]
+			);
+		}
+	}
+
+}
+
 void cerver_stats_print (Cerver *cerver, bool received, bool sent) {
 
 	if (cerver) {
-		if (cerver->stats) {
+		CerverStats *stats = cerver_stats_get_snapshot (cerver);
+		if (stats) {
 			cerver_log_msg ("\nCerver's %s stats:\n", cerver->info->name->str);
-			cerver_log_msg ("Threshold time:                %ld\n", cerver->stats->threshold_time);
+			cerver_log_msg ("Threshold time:                %ld\n", stats->threshold_time);
 
 			if (cerver->auth_required) {
-				cerver_log_msg ("Client packets received:       %ld", cerver->stats->client_n_packets_received);
-				cerver_log_msg ("Client receives done:          %ld", cerver->stats->client_receives_done);
-				cerver_log_msg ("Client bytes received:         %ld\n", cerver->stats->client_bytes_received);
+				cerver_log_msg ("Client packets received:       %ld", stats->client_n_packets_received);
+				cerver_log_msg ("Client receives done:          %ld", stats->client_receives_done);
+				cerver_log_msg ("Client bytes received:         %ld\n", stats->client_bytes_received);
 
-				cerver_log_msg ("On hold packets received:      %ld", cerver->stats->on_hold_n_packets_received);
-				cerver_log_msg ("On hold receives done:         %ld", cerver->stats->on_hold_receives_done);
-				cerver_log_msg ("On hold bytes received:        %ld\n", cerver->stats->on_hold_bytes_received);
+				cerver_log_msg ("On hold packets received:      %ld", stats->on_hold_n_packets_received);
+				cerver_log_msg ("On hold receives done:         %ld", stats->on_hold_receives_done);
+				cerver_log_msg ("On hold bytes received:        %ld\n", stats->on_hold_bytes_received);
 			}
 
-			cerver_log_msg ("Total packets received:        %ld", cerver->stats->total_n_packets_received);
-			cerver_log_msg ("Total receives done:           %ld", cerver->stats->total_n_receives_done);
-			cerver_log_msg ("Total bytes received:          %ld\n", cerver->stats->total_bytes_received);
+			cerver_log_msg ("Total packets received:        %ld", stats->total_n_packets_received);
+			cerver_log_msg ("Total receives done:           %ld", stats->total_n_receives_done);
+			cerver_log_msg ("Total bytes received:          %ld\n", stats->total_bytes_received);
+
+			cerver_log_msg ("N packets sent:                %ld", stats->n_packets_sent);
+			cerver_log_msg ("Total bytes sent:              %ld\n", stats->total_bytes_sent);
 
-			cerver_log_msg ("N packets sent:                %ld", cerver->stats->n_packets_sent);
-			cerver_log_msg ("Total bytes sent:              %ld\n", cerver->stats->total_bytes_sent);
+			if (cerver->send_coalescing) {
+				cerver_log_msg ("N coalesced sends:             %ld", stats->n_coalesced_sends);
+				cerver_log_msg ("Coalesced bytes:               %ld", stats->coalesced_bytes);
+				cerver_log_msg ("N coalesced flushes:           %ld\n", stats->n_coalesced_flushes);
+			}
 
-			cerver_log_msg ("Current active client connections:         %ld", cerver->stats->current_active_client_connections);
-			cerver_log_msg ("Current connected clients:                 %ld", cerver->stats->current_n_connected_clients);
-			cerver_log_msg ("Current on hold connections:               %ld", cerver->stats->current_n_hold_connections);
-			cerver_log_msg ("Total on hold connections:                 %ld", cerver->stats->total_on_hold_connections);
-			cerver_log_msg ("Total clients:                             %ld", cerver->stats->total_n_clients);
-			cerver_log_msg ("Unique clients:                            %ld", cerver->stats->unique_clients);
-			cerver_log_msg ("Total client connections:                  %ld", cerver->stats->total_client_connections);
+			cerver_log_msg ("Current active client connections:         %ld", stats->current_active_client_connections);
+			cerver_log_msg ("Current connected clients:                 %ld", stats->current_n_connected_clients);
+			cerver_log_msg ("Current on hold connections:               %ld", stats->current_n_hold_connections);
+			cerver_log_msg ("Total on hold connections:                 %ld", stats->total_on_hold_connections);
+			cerver_log_msg ("Total clients:                             %ld", stats->total_n_clients);
+			cerver_log_msg ("Unique clients:                            %ld", stats->unique_clients);
+			cerver_log_msg ("Total client connections:                  %ld", stats->total_client_connections);
 
 			if (received) {
 				cerver_log_msg ("\nReceived packets:");
-				packets_per_type_print (cerver->stats->received_packets);
+				packets_per_type_print (stats->received_packets);
 			}
 
 			if (sent) {
 				cerver_log_msg ("\nSent packets:");
-				packets_per_type_print (cerver->stats->sent_packets);
+				packets_per_type_print (stats->sent_packets);
+			}
+
+			if (stats->n_reactors) {
+				cerver_reactors_stats_print (cerver);
+			}
+
+			if (cerver->udp_workers) {
+				cerver_udp_stats_print (cerver);
+			}
+
+			if (stats->latencies) {
+				cerver_stats_latencies_print (stats);
 			}
 
 			cerver_log_msg ("\n");
+			slabs_stats_print ();
+
+			cerver_log_msg ("\n");
+
+			cerver_stats_snapshot_delete (stats);
 		}
 
 		else {
@@ -299,6 +778,7 @@ Cerver *cerver_new (void) {
 		cerver->protocol = CERVER_DEFAULT_PROTOCOL;         // default protocol
 		cerver->use_ipv6 = CERVER_DEFAULT_USE_IPV6;
 		cerver->connection_queue = CERVER_DEFAULT_CONNECTION_QUEUE;
+		cerver->accept_budget = CERVER_DEFAULT_ACCEPT_BUDGET;
 		cerver->receive_buffer_size = CERVER_DEFAULT_RECEIVE_BUFFER_SIZE;
 
 		cerver->isRunning = false;
@@ -309,18 +789,19 @@ Cerver *cerver_new (void) {
 		cerver->delete_cerver_data = NULL;
 
 		cerver->n_thpool_threads = CERVER_DEFAULT_POOL_THREADS;
+		cerver->thpool_type = CERVER_DEFAULT_THPOOL_TYPE;
 		cerver->thpool = NULL;
 
 		cerver->sockets_pool_init = CERVER_DEFAULT_SOCKETS_INIT;
 		cerver->sockets_pool = NULL;
 
 		cerver->clients = NULL;
-		cerver->client_sock_fd_map = NULL;
+		cerver->fd_table = NULL;
 
 		cerver->inactive_clients = false;
 		cerver->max_inactive_time = CERVER_DEFAULT_MAX_INACTIVE_TIME;
 		cerver->check_inactive_interval = CERVER_DEFAULT_CHECK_INACTIVE_INTERVAL;
-		cerver->inactive_thread_id = 0;
+		cerver->timer_wheel = NULL;
 
 		cerver->handler_type = CERVER_HANDLER_TYPE_NONE;
 
@@ -329,8 +810,26 @@ Cerver *cerver_new (void) {
 		cerver->fds = NULL;
 		cerver->max_n_fds = CERVER_DEFAULT_POLL_FDS;
 		cerver->current_n_fds = 0;
+		cerver->n_removed_fds = 0;
+		cerver->fds_idx = NULL;
+		cerver->fds_idx_size = 0;
 		cerver->poll_timeout = CERVER_DEFAULT_POLL_TIMEOUT;
 		cerver->poll_lock = NULL;
+		cerver->poll_wake_fd = -1;
+
+		cerver->epoll_fd = -1;
+		cerver->epoll_max_events = CERVER_DEFAULT_EPOLL_MAX_EVENTS;
+
+		cerver->n_reactors = CERVER_DEFAULT_N_REACTORS;
+		cerver->reactors = NULL;
+
+		cerver->uring_entries = CERVER_DEFAULT_URING_ENTRIES;
+		cerver->uring_n_buffers = CERVER_DEFAULT_URING_N_BUFFERS;
+		cerver->uring = NULL;
+
+		cerver->udp_n_workers = CERVER_UDP_DEFAULT_N_WORKERS;
+		cerver->udp_batch_size = CERVER_UDP_DEFAULT_BATCH_SIZE;
+		cerver->udp_workers = NULL;
 
 		cerver->auth_required = CERVER_DEFAULT_AUTH_REQUIRED;
 		cerver->auth_packet = NULL;
@@ -348,6 +847,8 @@ Cerver *cerver_new (void) {
 		cerver->on_hold_max_bad_packets = CERVER_DEFAULT_ON_HOLD_MAX_BAD_PACKETS;
 		cerver->on_hold_check_packets = CERVER_DEFAULT_ON_HOLD_CHECK_PACKETS;
 		cerver->on_hold_receive_buffer_size = CERVER_DEFAULT_ON_HOLD_RECEIVE_BUFFER_SIZE;
+		cerver->on_hold_max_time = CERVER_DEFAULT_ON_HOLD_MAX_TIME;
+		cerver->on_hold_timer_wheel = NULL;
 
 		cerver->use_sessions = CERVER_DEFAULT_USE_SESSIONS;
 		cerver->session_id_generator = NULL;
@@ -365,12 +866,29 @@ Cerver *cerver_new (void) {
 		cerver->multiple_handlers = CERVER_DEFAULT_MULTIPLE_HANDLERS;
 		cerver->handlers = NULL;
 		cerver->n_handlers = 0;
+		cerver->handlers_routing = CERVER_DEFAULT_HANDLERS_ROUTING;
 		cerver->num_handlers_alive = 0;
 		cerver->num_handlers_working = 0;
 		cerver->handlers_lock = NULL;
 
 		cerver->check_packets = CERVER_DEFAULT_CHECK_PACKETS;
 
+		cerver->receive_packet_views = CERVER_DEFAULT_RECEIVE_PACKET_VIEWS;
+
+		cerver->send_queue = CERVER_DEFAULT_SEND_QUEUE;
+		cerver->send_queue_low_watermark = CONNECTION_DEFAULT_SEND_QUEUE_LOW_WATERMARK;
+		cerver->send_queue_high_watermark = CONNECTION_DEFAULT_SEND_QUEUE_HIGH_WATERMARK;
+
+		cerver->send_coalescing = CERVER_DEFAULT_SEND_COALESCING;
+		cerver->coalesce_connections = NULL;
+		cerver->n_coalesce_connections = 0;
+		cerver->max_coalesce_connections = 0;
+		cerver->coalesce_lock = NULL;
+
+		cerver->zerocopy_threshold = CERVER_DEFAULT_ZEROCOPY_THRESHOLD;
+
+		cerver->slabs_max_free = CERVER_DEFAULT_SLABS_MAX_FREE;
+
 		cerver->update_thread_id = 0;
 		cerver->update = NULL;
 		cerver->update_args = NULL;
@@ -410,12 +928,39 @@ void cerver_delete (void *ptr) {
 			else free (cerver->cerver_data);
 		}
 
+		// the packets that were never handled release their clients
+		// before they are deleted with the cerver's timers
+		// 27/05/2020
+		handler_delete (cerver->app_packet_handler);
+		handler_delete (cerver->app_error_packet_handler);
+		handler_delete (cerver->custom_packet_handler);
+
+		// 10/05/2020
+		if (cerver->handlers) {
+			for (unsigned int idx = 0; idx < cerver->n_handlers; idx++) {
+				handler_delete (cerver->handlers[idx]);
+			}
+
+			free (cerver->handlers);
+		}
+
+		if (cerver->handlers_lock) {
+			pthread_mutex_destroy (cerver->handlers_lock);
+			free (cerver->handlers_lock);
+		}
+
+		// the connections that were never flushed are released
+		// before their sockets can be moved to the pool
+		for (u32 idx = 0; idx < cerver->n_coalesce_connections; idx++)
+			connection_release (cerver->coalesce_connections[idx]);
+
 		pool_delete (cerver->sockets_pool);
 
 		if (cerver->clients) avl_delete (cerver->clients);
-		if (cerver->client_sock_fd_map) htab_destroy (cerver->client_sock_fd_map);
+		cerver_fd_table_delete (cerver->fd_table);
 
 		if (cerver->fds) free (cerver->fds);
+		if (cerver->fds_idx) free (cerver->fds_idx);
 
 		// 28/05/2020
 		if (cerver->poll_lock) {
@@ -423,10 +968,26 @@ void cerver_delete (void *ptr) {
 			free (cerver->poll_lock);
 		}
 
+		if (cerver->coalesce_connections) free (cerver->coalesce_connections);
+		if (cerver->coalesce_lock) {
+			pthread_mutex_destroy (cerver->coalesce_lock);
+			free (cerver->coalesce_lock);
+		}
+
+		if (cerver->poll_wake_fd > -1) close (cerver->poll_wake_fd);
+
+		if (cerver->epoll_fd > -1) close (cerver->epoll_fd);
+
+		cerver_reactors_delete (cerver);
+
+		cerver_uring_delete (cerver->uring);
+
+		cerver_udp_delete (cerver);
+
 		packet_delete (cerver->auth_packet);
 
 		if (cerver->on_hold_connections) avl_delete (cerver->on_hold_connections);
-		if (cerver->on_hold_connection_sock_fd_map) htab_destroy (cerver->on_hold_connection_sock_fd_map);
+		if (cerver->on_hold_connection_sock_fd_map) ohtab_destroy (cerver->on_hold_connection_sock_fd_map);
 		if (cerver->hold_fds) free (cerver->hold_fds);
 
 		if (cerver->on_hold_poll_lock) {
@@ -434,24 +995,9 @@ void cerver_delete (void *ptr) {
 			free (cerver->on_hold_poll_lock);
 		}
 
-		// 27/05/2020
-		handler_delete (cerver->app_packet_handler);
-		handler_delete (cerver->app_error_packet_handler);
-		handler_delete (cerver->custom_packet_handler);
-
-		// 10/05/2020
-		if (cerver->handlers) {
-			for (unsigned int idx = 0; idx < cerver->n_handlers; idx++) {
-				handler_delete (cerver->handlers[idx]);
-			}
-
-			free (cerver->handlers);
-		}
-
-		if (cerver->handlers_lock) {
-			pthread_mutex_destroy (cerver->handlers_lock);
-			free (cerver->handlers_lock);
-		}
+		// every timer has been cancelled when deleting its client or connection
+		timer_wheel_delete (cerver->timer_wheel);
+		timer_wheel_delete (cerver->on_hold_timer_wheel);
 
 		admin_cerver_delete (cerver->admin);
 
@@ -494,6 +1040,17 @@ void cerver_set_connection_queue (
 
 }
 
+// sets the max number of connections that are accepted in a loop
+// each time that the listening socket is ready
+// the default value is CERVER_DEFAULT_ACCEPT_BUDGET
+void cerver_set_accept_budget (
+	Cerver *cerver, const u32 accept_budget
+) {
+
+	if (cerver && accept_budget) cerver->accept_budget = accept_budget;
+
+}
+
 // sets the cerver's receive buffer size used in recv method
 void cerver_set_receive_buffer_size (
 	Cerver *cerver, const u32 size
@@ -540,6 +1097,18 @@ void cerver_set_thpool_n_threads (
 
 }
 
+// sets the type of the cerver's thpool
+// THPOOL_TYPE_WORK_STEALING gives each thread its own queue,
+// so bursts of new connections don't contend on a single queue
+// the default value is THPOOL_TYPE_SHARED
+void cerver_set_thpool_type (
+	Cerver *cerver, const ThpoolType type
+) {
+
+	if (cerver) cerver->thpool_type = type;
+
+}
+
 // sets the initial number of sockets to be created in the cerver's sockets pool
 // the defauult value is 10
 void cerver_set_sockets_pool_init (
@@ -554,7 +1123,7 @@ void cerver_set_sockets_pool_init (
 // enables the ability to check for inactive clients - clients that have not been sent or received from a packet in x time
 // will be automatically dropped from the cerver
 // max_inactive_time - max secs allowed for a client to be inactive, 0 for default
-// check_inactive_interval - how often to check for inactive clients in secs, 0 for default
+// check_inactive_interval - unused, each client is dropped by its own timer
 void cerver_set_inactive_clients (
 	Cerver *cerver,
 	u32 max_inactive_time, u32 check_inactive_interval
@@ -600,6 +1169,54 @@ void cerver_set_poll_time_out (
 
 }
 
+// sets the max number of events to be handled on each epoll_wait () call
+// only used if cerver handler type is CERVER_HANDLER_TYPE_EPOLL
+void cerver_set_epoll_max_events (
+	Cerver *cerver, const u32 epoll_max_events
+) {
+
+	if (cerver && epoll_max_events) cerver->epoll_max_events = epoll_max_events;
+
+}
+
+// sets the number of independent event loops to be used
+// only used if cerver handler type is CERVER_HANDLER_TYPE_REACTORS
+void cerver_set_n_reactors (
+	Cerver *cerver, const u32 n_reactors
+) {
+
+	if (cerver && n_reactors) cerver->n_reactors = n_reactors;
+
+}
+
+// sets the size of the io_uring submission queue & the number of buffers
+// that are provided to the kernel to complete the connections receives
+// only used if cerver handler type is CERVER_HANDLER_TYPE_IO_URING
+void cerver_set_uring_values (
+	Cerver *cerver, const u32 entries, const u32 n_buffers
+) {
+
+	if (cerver) {
+		if (entries) cerver->uring_entries = entries;
+		if (n_buffers) cerver->uring_n_buffers = n_buffers;
+	}
+
+}
+
+// sets the number of udp workers & the max number of datagrams
+// that each one receives & sends with a single call
+// only used if cerver protocol is PROTOCOL_UDP
+void cerver_set_udp_values (
+	Cerver *cerver, const u32 n_workers, const u32 batch_size
+) {
+
+	if (cerver) {
+		if (n_workers) cerver->udp_n_workers = n_workers;
+		if (batch_size) cerver->udp_batch_size = batch_size;
+	}
+
+}
+
 // enables cerver's built in authentication methods
 // cerver requires client authentication upon new client connections
 // retuns 0 on success, 1 on error
@@ -684,6 +1301,18 @@ void cerver_set_on_hold_receive_buffer_size (
 
 }
 
+// sets the max secs an on hold connection has to authenticate
+// before being dropped, the default is 0 to wait forever
+void cerver_set_on_hold_max_time (
+	Cerver *cerver, const u32 on_hold_max_time
+) {
+
+	if (cerver) {
+		cerver->on_hold_max_time = on_hold_max_time;
+	}
+
+}
+
 // configures the cerver to use client sessions
 // retuns 0 on success, 1 on error
 u8 cerver_set_sessions (
@@ -812,6 +1441,19 @@ int cerver_set_multiple_handlers (
 
 }
 
+// sets how app packets are routed to the cerver's multiple app handlers
+// CERVER_HANDLERS_ROUTING_CLIENT & CERVER_HANDLERS_ROUTING_CONNECTION
+// keep the packets from the same client or connection in order
+// on the same handler, ignoring the packet header handler id
+// the default value is CERVER_HANDLERS_ROUTING_HANDLER_ID
+void cerver_set_handlers_routing (
+	Cerver *cerver, CerverHandlersRouting routing
+) {
+
+	if (cerver) cerver->handlers_routing = routing;
+
+}
+
 // set whether to check or not incoming packets
 // check packet's header protocol id & version compatibility
 // if packets do not pass the checks, won't be handled and will be inmediately destroyed
@@ -827,6 +1469,145 @@ void cerver_set_check_packets (
 
 }
 
+// set whether complete packets that fit in the receive buffer
+// are dispatched as views into it instead of being copied
+// the packet's header & data reference the buffer (packet_ref & data_ref are set),
+// and are only valid while the packet is being handled
+// packets that are pushed to a handler's job queue or that are NOT
+// deleted after being handled are copied using packet_retain ()
+// only used with connections from cerver's clients
+// by default, this option is turned off
+void cerver_set_receive_packet_views (
+	Cerver *cerver, bool receive_packet_views
+) {
+
+	if (cerver) {
+		cerver->receive_packet_views = receive_packet_views;
+	}
+
+}
+
+// set whether the cerver's connections send packets without blocking
+// bytes that can't be sent are kept in a per connection send queue
+// that is flushed when the cerver's poll reports the socket as writable
+// only used with POLL, EPOLL, REACTORS & IO_URING handler types
+// by default, this option is turned off
+void cerver_set_send_queue (
+	Cerver *cerver, bool send_queue
+) {
+
+	if (cerver) cerver->send_queue = send_queue;
+
+}
+
+// sets the connections' send queue watermarks
+// a connection with more pending bytes than the low watermark is congested,
+// and it is dropped if its pending bytes exceed the high watermark
+// the default values are CONNECTION_DEFAULT_SEND_QUEUE_LOW_WATERMARK
+// & CONNECTION_DEFAULT_SEND_QUEUE_HIGH_WATERMARK
+void cerver_set_send_queue_watermarks (
+	Cerver *cerver,
+	const size_t low_watermark, const size_t high_watermark
+) {
+
+	if (cerver) {
+		cerver->send_queue_low_watermark = low_watermark;
+		cerver->send_queue_high_watermark = high_watermark;
+	}
+
+}
+
+// set whether the packets sent to the cerver's connections are
+// appended to a per connection buffer instead of being sent right away
+// every connection with pending bytes is flushed once at the end of each
+// poll iteration, update tick & after a handler has handled its jobs
+// only used with POLL, EPOLL, REACTORS & IO_URING handler types
+// the send queue watermarks are also applied to the coalescing buffer
+// by default, this option is turned off
+void cerver_set_send_coalescing (
+	Cerver *cerver, bool send_coalescing
+) {
+
+	if (cerver) cerver->send_coalescing = send_coalescing;
+
+}
+
+// sets the min size of the payloads sent with packet_send_large ()
+// that are sent using MSG_ZEROCOPY instead of being copied by the kernel
+// a value of 0 disables zerocopy sends
+// the default value is CERVER_DEFAULT_ZEROCOPY_THRESHOLD
+void cerver_set_zerocopy_threshold (
+	Cerver *cerver, const size_t zerocopy_threshold
+) {
+
+	if (cerver) cerver->zerocopy_threshold = zerocopy_threshold;
+
+}
+
+// set whether the cerver records latency histograms of its packets
+// (receive dispatch, job queue wait, handlers execution & sends)
+// that can be read from a stats snapshot or requested by an admin
+// each thread records into its own shard, so they can be left on in production
+// must be called before the cerver starts
+// by default, this option is turned off
+// returns 0 on success, 1 on error
+u8 cerver_set_latency_histograms (
+	Cerver *cerver, bool latency_histograms
+) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		if (cerver->stats) {
+			if (latency_histograms) {
+				if (!cerver->stats->latencies) {
+					cerver->stats->latencies = (CerverStatsLatencies *) aligned_alloc (
+						64, CERVER_STATS_N_SHARDS * sizeof (CerverStatsLatencies)
+					);
+
+					if (cerver->stats->latencies) {
+						(void) memset (
+							cerver->stats->latencies, 0,
+							CERVER_STATS_N_SHARDS * sizeof (CerverStatsLatencies)
+						);
+
+						retval = 0;
+					}
+				}
+
+				else {
+					retval = 0;
+				}
+			}
+
+			else {
+				if (cerver->stats->latencies) {
+					free (cerver->stats->latencies);
+					cerver->stats->latencies = NULL;
+				}
+
+				retval = 0;
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+// sets the max n of free packets, headers, jobs & receive structures
+// that each thread keeps to be reused instead of calling malloc ()
+// the slabs are shared by all the cervers, so the value is applied
+// when the cerver starts, a value of 0 disables them
+// the default value is CERVER_DEFAULT_SLABS_MAX_FREE
+void cerver_set_slabs_max_free (
+	Cerver *cerver, const u32 slabs_max_free
+) {
+
+	if (cerver) cerver->slabs_max_free = slabs_max_free;
+
+}
+
 // sets a custom cerver update function to be executed every n ticks
 // a new thread will be created that will call your method each tick
 // the update args will be passed to your method as a CerverUpdate &
@@ -908,6 +1689,9 @@ static int cerver_sockets_pool_init (Cerver *cerver) {
 
 }
 
+// moves the socket to the cerver's sockets pool, it is never destroyed
+// as another thread might still be waiting for its mutex
+// returns 0 on success, 1 if the pool could not keep it
 int cerver_sockets_pool_push (Cerver *cerver, Socket *socket) {
 
 	int retval = 1;
@@ -946,6 +1730,90 @@ static void cerver_sockets_pool_end (Cerver *cerver) {
 
 #pragma endregion
 
+#pragma region coalesce
+
+// marks the connection to be flushed
+// at the end of the current poll iteration or update tick
+// the connection is retained until it is flushed
+// returns 0 on success, 1 on error
+u8 cerver_coalesce_push (Cerver *cerver, Connection *connection) {
+
+	u8 retval = 1;
+
+	if (cerver && cerver->coalesce_lock && connection) {
+		(void) pthread_mutex_lock (cerver->coalesce_lock);
+
+		if (cerver->n_coalesce_connections == cerver->max_coalesce_connections) {
+			u32 new_max = cerver->max_coalesce_connections ?
+				cerver->max_coalesce_connections * 2 : CERVER_DEFAULT_POLL_FDS;
+
+			Connection **connections = (Connection **) realloc (
+				cerver->coalesce_connections, new_max * sizeof (Connection *)
+			);
+
+			if (connections) {
+				cerver->coalesce_connections = connections;
+				cerver->max_coalesce_connections = new_max;
+			}
+		}
+
+		if (cerver->n_coalesce_connections < cerver->max_coalesce_connections) {
+			connection_retain (connection);
+
+			cerver->coalesce_connections[cerver->n_coalesce_connections] = connection;
+			cerver->n_coalesce_connections++;
+
+			retval = 0;
+		}
+
+		(void) pthread_mutex_unlock (cerver->coalesce_lock);
+	}
+
+	return retval;
+
+}
+
+// sends the coalesced bytes of every connection that is waiting to be flushed
+// the connections are taken in small batches, so the lock is never held
+// while sending & other threads can flush at the same time
+// each connection is released after it was flushed
+void cerver_coalesce_flush (Cerver *cerver) {
+
+	if (cerver && cerver->coalesce_lock) {
+		Connection *connections[CERVER_COALESCE_FLUSH_BATCH] = { 0 };
+		u32 n_connections = 0;
+
+		do {
+			(void) pthread_mutex_lock (cerver->coalesce_lock);
+
+			n_connections = (cerver->n_coalesce_connections > CERVER_COALESCE_FLUSH_BATCH) ?
+				CERVER_COALESCE_FLUSH_BATCH : cerver->n_coalesce_connections;
+
+			cerver->n_coalesce_connections -= n_connections;
+			if (n_connections) {
+				(void) memcpy (
+					connections,
+					cerver->coalesce_connections + cerver->n_coalesce_connections,
+					n_connections * sizeof (Connection *)
+				);
+			}
+
+			(void) pthread_mutex_unlock (cerver->coalesce_lock);
+
+			for (u32 i = 0; i < n_connections; i++) {
+				// the connection might have ended after it was pushed
+				if (connections[i]->active)
+					(void) connection_send_queue_flush (connections[i]);
+
+				connection_release (connections[i]);
+			}
+		} while (n_connections == CERVER_COALESCE_FLUSH_BATCH);
+	}
+
+}
+
+#pragma endregion
+
 #pragma region handlers
 
 // prints info about current handlers
@@ -1057,7 +1925,7 @@ static u8 cerver_multiple_app_handlers_destroy (Cerver *cerver) {
 			time (&start);
 			while (time_passed < timeout && cerver->num_handlers_alive) {
 				for (unsigned int i = 0; i < cerver->n_handlers; i++) {
-					bsem_post_all (cerver->handlers[i]->job_queue->has_jobs);
+					job_queue_wake_all (cerver->handlers[i]->job_queue);
 					time (&end);
 					time_passed = difftime (end, start);
 				}
@@ -1066,7 +1934,7 @@ static u8 cerver_multiple_app_handlers_destroy (Cerver *cerver) {
 			// poll remaining handlers
 			while (cerver->num_handlers_alive) {
 				for (unsigned int i = 0; i < cerver->n_handlers; i++) {
-					bsem_post_all (cerver->handlers[i]->job_queue->has_jobs);
+					job_queue_wake_all (cerver->handlers[i]->job_queue);
 					sleep (1);
 				}
 			}
@@ -1108,7 +1976,7 @@ static u8 cerver_app_handlers_destroy (Cerver *cerver) {
 			if (cerver->app_packet_handler) {
 				if (!cerver->app_packet_handler->direct_handle) {
 					// stop app handler
-					bsem_post_all (cerver->app_packet_handler->job_queue->has_jobs);
+					job_queue_wake_all (cerver->app_packet_handler->job_queue);
 				}
 			}
 		}
@@ -1126,7 +1994,7 @@ static u8 cerver_app_error_handler_destroy (Cerver *cerver) {
 		if (cerver->app_error_packet_handler) {
 			if (!cerver->app_error_packet_handler->direct_handle) {
 				// stop app error handler
-				bsem_post_all (cerver->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (cerver->app_error_packet_handler->job_queue);
 			}
 		}
 	}
@@ -1143,7 +2011,7 @@ static u8 cerver_custom_handler_destroy (Cerver *cerver) {
 		if (cerver->custom_packet_handler) {
 			if (!cerver->custom_packet_handler->direct_handle) {
 				// stop custom handler
-				bsem_post_all (cerver->custom_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (cerver->custom_packet_handler->job_queue);
 			}
 		}
 	}
@@ -1175,13 +2043,13 @@ static u8 cerver_handlers_destroy (Cerver *cerver) {
 		// poll remaining handlers
 		while (cerver->num_handlers_alive) {
 			if (cerver->app_packet_handler)
-				bsem_post_all (cerver->app_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (cerver->app_packet_handler->job_queue);
 
 			if (cerver->app_error_packet_handler)
-				bsem_post_all (cerver->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (cerver->app_error_packet_handler->job_queue);
 
 			if (cerver->custom_packet_handler)
-				bsem_post_all (cerver->custom_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (cerver->custom_packet_handler->job_queue);
 
 			sleep (1);
 		}
@@ -1238,7 +2106,15 @@ Cerver *cerver_create (
 			cerver->info = cerver_info_new ();
 			cerver->info->name = str_new (name);
 
-			cerver->stats = cerver_stats_new ();
+			cerver->stats = cerver_stats_new (true);
+			if (!cerver->stats) {
+				cerver_log_error (
+					"Failed to allocate cerver %s stats!", name
+				);
+
+				cerver_delete (cerver);
+				cerver = NULL;
+			}
 		}
 	}
 
@@ -1278,7 +2154,12 @@ static u8 cerver_network_init_address (Cerver *cerver) {
 		addr->sin_port = htons (cerver->port);
 	}
 
-	if (cerver->reusable) {
+	// reactors & udp workers bind their own sockets to the same address
+	if (
+		cerver->reusable
+		|| (cerver->handler_type == CERVER_HANDLER_TYPE_REACTORS)
+		|| ((cerver->protocol == PROTOCOL_UDP) && (cerver->udp_n_workers > 1))
+	) {
 		if (sock_set_reusable (cerver->sock)) {
 			cerver_log (
 				LOG_TYPE_WARNING, LOG_TYPE_CERVER,
@@ -1317,7 +2198,10 @@ static u8 cerver_network_init_block_socket (Cerver *cerver) {
 	switch (cerver->handler_type) {
 		case CERVER_HANDLER_TYPE_NONE: break;
 
-		case CERVER_HANDLER_TYPE_POLL: {
+		case CERVER_HANDLER_TYPE_POLL:
+		case CERVER_HANDLER_TYPE_EPOLL:
+		case CERVER_HANDLER_TYPE_REACTORS:
+		case CERVER_HANDLER_TYPE_IO_URING: {
 			// set the socket to non blocking mode
 			if (sock_set_blocking (cerver->sock, cerver->blocking)) {
 				cerver->blocking = false;
@@ -1422,8 +2306,17 @@ static u8 cerver_init_poll_fds (Cerver *cerver) {
 
 		cerver->max_n_fds = CERVER_DEFAULT_POLL_FDS;
 		cerver->current_n_fds = 0;
+		cerver->n_removed_fds = 0;
 
-		retval = 0;     // success!!
+		// sock fds are mapped to their idx in fds to avoid searching them
+		cerver->fds_idx = (i32 *) malloc (CERVER_DEFAULT_POLL_FDS * sizeof (i32));
+		if (cerver->fds_idx) {
+			for (u32 i = 0; i < CERVER_DEFAULT_POLL_FDS; i++) cerver->fds_idx[i] = -1;
+
+			cerver->fds_idx_size = CERVER_DEFAULT_POLL_FDS;
+
+			retval = 0;     // success!!
+		}
 	}
 
 	else {
@@ -1439,6 +2332,63 @@ static u8 cerver_init_poll_fds (Cerver *cerver) {
 
 }
 
+static u8 cerver_init_epoll (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	cerver->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+	if (cerver->epoll_fd > -1) {
+		cerver->current_n_fds = 0;
+
+		retval = 0;     // success!!
+	}
+
+	else {
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Failed to create cerver %s main epoll!", cerver->info->name->str
+		);
+		#endif
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_init_uring (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	if (cerver_uring_is_supported ()) {
+		cerver->uring = cerver_uring_create (
+			cerver->uring_entries, cerver->uring_n_buffers,
+			(u32) cerver->receive_buffer_size
+		);
+	}
+
+	if (cerver->uring) {
+		cerver->current_n_fds = 0;
+
+		retval = 0;     // success!!
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+			"Cerver %s can't use io_uring - falling back to poll ()",
+			cerver->info->name->str
+		);
+
+		cerver->handler_type = CERVER_HANDLER_TYPE_POLL;
+
+		retval = cerver_init_poll_fds (cerver);
+	}
+
+	return retval;
+
+}
+
 static u8 cerver_init_data_structures (Cerver *cerver) {
 
 	u8 retval = 1;
@@ -1450,12 +2400,18 @@ static u8 cerver_init_data_structures (Cerver *cerver) {
 		);
 
 		if (cerver->clients) {
-			cerver->client_sock_fd_map = htab_create (CERVER_DEFAULT_POLL_FDS, NULL, NULL);
-			if (cerver->client_sock_fd_map) {
+			cerver->fd_table = cerver_fd_table_create (CERVER_DEFAULT_POLL_FDS);
+			cerver->timer_wheel = timer_wheel_create (CERVER_TIMER_WHEEL_TICK, cerver);
+			if (cerver->fd_table && cerver->timer_wheel) {
 				u8 errors = 0;
 
+				// udp datagrams are always handled by the udp workers
+				if (cerver->protocol == PROTOCOL_UDP) {
+					errors |= cerver_udp_init (cerver);
+				}
+
 				// init cerver handler type based values
-				switch (cerver->handler_type) {
+				else switch (cerver->handler_type) {
 					case CERVER_HANDLER_TYPE_NONE: break;
 
 					case CERVER_HANDLER_TYPE_POLL: {
@@ -1463,6 +2419,21 @@ static u8 cerver_init_data_structures (Cerver *cerver) {
 						errors |= cerver_init_poll_fds (cerver);
 					} break;
 
+					case CERVER_HANDLER_TYPE_EPOLL: {
+						// create the main epoll instance
+						errors |= cerver_init_epoll (cerver);
+					} break;
+
+					case CERVER_HANDLER_TYPE_REACTORS: {
+						// create each reactor with its own structures
+						errors |= cerver_reactors_init (cerver);
+					} break;
+
+					case CERVER_HANDLER_TYPE_IO_URING: {
+						// use the main poll if io_uring can't be used
+						errors |= cerver_init_uring (cerver);
+					} break;
+
 					case CERVER_HANDLER_TYPE_THREADS: break;
 
 					default: break;
@@ -1475,7 +2446,7 @@ static u8 cerver_init_data_structures (Cerver *cerver) {
 				#ifdef CERVER_DEBUG
 				cerver_log (
 					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-					"Failed to init clients sock fd map in cerver %s",
+					"Failed to init clients sock fd table & timer wheel in cerver %s",
 					cerver->info->name->str
 				);
 				#endif
@@ -1553,13 +2524,16 @@ static u8 cerver_one_time_init_thpool (Cerver *cerver) {
 		if (cerver->n_thpool_threads) {
 			#ifdef CERVER_DEBUG
 			cerver_log_debug (
-				"Cerver %s is configured to use a thpool with %d threads",
-				cerver->info->name->str, cerver->n_thpool_threads
+				"Cerver %s is configured to use a %s thpool with %d threads",
+				cerver->info->name->str,
+				thpool_type_to_string (cerver->thpool_type),
+				cerver->n_thpool_threads
 			);
 			#endif
 
 			cerver->thpool = thpool_create (cerver->n_thpool_threads);
 			thpool_set_name (cerver->thpool, cerver->info->name->str);
+			thpool_set_type (cerver->thpool, cerver->thpool_type);
 			if (thpool_init (cerver->thpool)) {
 				cerver_log (
 					LOG_TYPE_ERROR, LOG_TYPE_NONE,
@@ -1602,6 +2576,11 @@ static u8 cerver_one_time_init (Cerver *cerver) {
 			cerver->poll_lock = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
 			pthread_mutex_init (cerver->poll_lock, NULL);
 
+			if (cerver->send_coalescing) {
+				cerver->coalesce_lock = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+				pthread_mutex_init (cerver->coalesce_lock, NULL);
+			}
+
 			// init the cerver thpool
 			errors |= cerver_one_time_init_thpool (cerver);
 
@@ -1678,8 +2657,16 @@ static u8 cerver_auth_start (Cerver *cerver) {
 
 		cerver->max_on_hold_connections = CERVER_DEFAULT_POLL_FDS / 2;
 		cerver->on_hold_connections = avl_init (connection_comparator, connection_delete);
-		cerver->on_hold_connection_sock_fd_map = htab_create (cerver->max_on_hold_connections / 4, NULL, NULL);
-		if (cerver->on_hold_connections && cerver->on_hold_connection_sock_fd_map) {
+		cerver->on_hold_connection_sock_fd_map = ohtab_create (sizeof (i32), cerver->max_on_hold_connections / 4, NULL);
+
+		// the on hold poll thread advances the wheel after every poll
+		if (cerver->on_hold_max_time)
+			cerver->on_hold_timer_wheel = timer_wheel_create (CERVER_TIMER_WHEEL_TICK, cerver);
+
+		if (
+			cerver->on_hold_connections && cerver->on_hold_connection_sock_fd_map
+			&& (!cerver->on_hold_max_time || cerver->on_hold_timer_wheel)
+		) {
 			cerver->hold_fds = (struct pollfd *) calloc (cerver->max_on_hold_connections, sizeof (struct pollfd));
 			if (cerver->hold_fds) {
 				memset (cerver->hold_fds, 0, sizeof (struct pollfd) * cerver->max_on_hold_connections);
@@ -2002,80 +2989,22 @@ static u8 cerver_update_interval_start (Cerver *cerver) {
 
 }
 
-static void cerver_inactive_check (AVLNode *node, Cerver *cerver, time_t current_time) {
-
-	cerver_inactive_check (node->right, cerver, current_time);
-
-	// check for client inactivity
-	if (node->id) {
-		Client *client = (Client *) node->id;
-
-		if ((current_time - client->last_activity) >= cerver->max_inactive_time) {
-			// TODO: the client should be dropped
-			cerver_log_warning (
-				"Client %ld has been inactive more than %d secs and should be dropped",
-				client->id, cerver->max_inactive_time
-			);
-		}
-	}
-
-	cerver_inactive_check (node->left, cerver, current_time);
-
-}
-
-// 17/06/2020 - thread to check for inactive clients
-static void *cerver_inactive_thread (void *args) {
-
-	if (args) {
-		Cerver *cerver = (Cerver *) args;
-
-		u32 count = 0;
-		while (cerver->isRunning) {
-			if (count == cerver->check_inactive_interval) {
-				count = 0;
-
-				cerver_log_debug (
-					"Checking for inactive clients in cerver %s...",
-					cerver->info->name->str
-				);
-
-				time_t current_time = time (NULL);
-				cerver_inactive_check (cerver->clients->root, cerver, current_time);
-
-				cerver_log_debug (
-					"Done checking for inactive clients in cerver %s",
-					cerver->info->name->str
-				);
-			}
-
-			sleep (1);
-			count++;
-		}
-	}
-
-	return NULL;
-
-}
-
+// 17/06/2020 - inactive clients are dropped by the cerver's timer wheel
+// each client is armed when it gets registered to the cerver
 static u8 cerver_start_inactive (Cerver *cerver) {
 
 	u8 retval = 1;
 
 	if (cerver) {
 		cerver_log_debug (
-			"Cerver %s is set to check for inactive clients with max time of <%d> secs every <%d> secs",
+			"Cerver %s is set to drop inactive clients with max time of <%u> secs",
 			cerver->info->name->str,
-			cerver->max_inactive_time,
-			cerver->check_inactive_interval
+			cerver->max_inactive_time
 		);
 
-		if (!thread_create_detachable (
-			&cerver->inactive_thread_id,
-			(void *(*) (void *)) cerver_inactive_thread,
-			cerver
-		)) {
+		if (!timer_wheel_start (cerver->timer_wheel)) {
 			cerver_log_success (
-				"Created cerver %s INACTIVE thread!",
+				"Created cerver %s INACTIVE timer wheel thread!",
 				cerver->info->name->str
 			);
 
@@ -2084,7 +3013,7 @@ static u8 cerver_start_inactive (Cerver *cerver) {
 
 		else {
 			cerver_log_error (
-				"Failed to create cerver %s INACTIVE thread!",
+				"Failed to create cerver %s INACTIVE timer wheel thread!",
 				cerver->info->name->str
 			);
 		}
@@ -2114,9 +3043,15 @@ static u8 cerver_start_tcp (Cerver *cerver) {
 					time (&cerver->info->time_started);
 
 					// set up the initial listening socket
-					cerver->fds[cerver->current_n_fds].fd = cerver->sock;
-					cerver->fds[cerver->current_n_fds].events = POLLIN;
-					cerver->current_n_fds++;
+					(void) cerver_poll_add_sock_fd (cerver, cerver->sock);
+
+					// other threads use it to wake up the poll
+					// when a sock fd needs to wait to be writable
+					if (cerver->poll_wake_fd < 0) {
+						cerver->poll_wake_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+						if (cerver->poll_wake_fd > -1)
+							(void) cerver_poll_add_sock_fd (cerver, cerver->poll_wake_fd);
+					}
 
 					cerver_event_trigger (
 						CERVER_EVENT_STARTED,
@@ -2147,6 +3082,130 @@ static u8 cerver_start_tcp (Cerver *cerver) {
 			}
 		} break;
 
+		case CERVER_HANDLER_TYPE_EPOLL: {
+			if (!cerver->blocking) {
+				if (!listen (cerver->sock, cerver->connection_queue)) {
+					// register the cerver start time
+					time (&cerver->info->time_started);
+
+					// set up the initial listening socket
+					// it is kept level triggered, so any pending connection
+					// will be reported again if it was not accepted
+					struct epoll_event event = { 0 };
+					event.events = EPOLLIN;
+					event.data.fd = cerver->sock;
+
+					if (!epoll_ctl (cerver->epoll_fd, EPOLL_CTL_ADD, cerver->sock, &event)) {
+						cerver->current_n_fds++;
+
+						cerver_event_trigger (
+							CERVER_EVENT_STARTED,
+							cerver,
+							NULL, NULL
+						);
+
+						retval = cerver_epoll (cerver);
+					}
+
+					else {
+						cerver_log (
+							LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+							"Failed to add cerver %s socket to main epoll!",
+							cerver->info->name->str
+						);
+
+						close (cerver->sock);
+					}
+				}
+
+				else {
+					cerver_log (
+						LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+						"Failed to listen in cerver %s socket!",
+						cerver->info->name->str
+					);
+
+					close (cerver->sock);
+				}
+			}
+
+			else {
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Can't start cerver %s in CERVER_HANDLER_TYPE_EPOLL - socket is NOT set to non blocking!",
+					cerver->info->name->str
+				);
+			}
+		} break;
+
+		case CERVER_HANDLER_TYPE_REACTORS: {
+			if (!cerver->blocking) {
+				if (!cerver_reactors_listen (cerver)) {
+					// register the cerver start time
+					time (&cerver->info->time_started);
+
+					cerver_event_trigger (
+						CERVER_EVENT_STARTED,
+						cerver,
+						NULL, NULL
+					);
+
+					retval = cerver_reactors_start (cerver);
+				}
+
+				else {
+					cerver_log (
+						LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+						"Failed to listen in cerver %s reactors sockets!",
+						cerver->info->name->str
+					);
+				}
+			}
+
+			else {
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Can't start cerver %s in CERVER_HANDLER_TYPE_REACTORS - socket is NOT set to non blocking!",
+					cerver->info->name->str
+				);
+			}
+		} break;
+
+		case CERVER_HANDLER_TYPE_IO_URING: {
+			if (!cerver->blocking) {
+				if (!listen (cerver->sock, cerver->connection_queue)) {
+					// register the cerver start time
+					time (&cerver->info->time_started);
+
+					cerver_event_trigger (
+						CERVER_EVENT_STARTED,
+						cerver,
+						NULL, NULL
+					);
+
+					retval = cerver_uring (cerver);
+				}
+
+				else {
+					cerver_log (
+						LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+						"Failed to listen in cerver %s socket!",
+						cerver->info->name->str
+					);
+
+					close (cerver->sock);
+				}
+			}
+
+			else {
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Can't start cerver %s in CERVER_HANDLER_TYPE_IO_URING - socket is NOT set to non blocking!",
+					cerver->info->name->str
+				);
+			}
+		} break;
+
 		case CERVER_HANDLER_TYPE_THREADS: {
 			if (cerver->blocking) {
 				if (!listen (cerver->sock, cerver->connection_queue)) {
@@ -2195,14 +3254,41 @@ static u8 cerver_start_tcp (Cerver *cerver) {
 
 }
 
+// the cerver's handler type is ignored, the datagrams
+// are received & handled by each udp worker in its own thread
 static u8 cerver_start_udp (Cerver *cerver) {
 
-	cerver_log_warning (
-		"Cerver %s - udp server is not yet implemented!",
-		cerver->info->name->str
-	);
+	u8 retval = 1;
 
-	return 1;
+	if (cerver->auth_required) {
+		cerver_log_warning (
+			"Cerver %s - authentication is not supported with udp!",
+			cerver->info->name->str
+		);
+	}
+
+	if (!cerver_udp_bind (cerver)) {
+		// register the cerver start time
+		time (&cerver->info->time_started);
+
+		cerver_event_trigger (
+			CERVER_EVENT_STARTED,
+			cerver,
+			NULL, NULL
+		);
+
+		retval = cerver_udp_start (cerver);
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Failed to bind cerver %s udp workers sockets!",
+			cerver->info->name->str
+		);
+	}
+
+	return retval;
 
 }
 
@@ -2220,6 +3306,8 @@ u8 cerver_start (Cerver *cerver) {
 		if (!cerver_one_time_init (cerver)) {
 			u8 errors = 0;
 
+			slabs_set_max_free (cerver->slabs_max_free);
+
 			errors |= cerver_handlers_start (cerver);
 
 			if (cerver->auth_required) {
@@ -2359,6 +3447,9 @@ static void *cerver_update (void *args) {
 			// do stuff
 			if (cerver->update) cerver->update (cu);
 
+			// send what was coalesced during this tick
+			if (cerver->send_coalescing) cerver_coalesce_flush (cerver);
+
 			// limit the fps
 			(void) clock_gettime (CLOCK_MONOTONIC_RAW, &middle);
 			temp = (middle.tv_nsec - start.tv_nsec) / 1000;
@@ -2516,9 +3607,9 @@ static void cerver_destroy_clients (Cerver *cerver) {
 			}
 		}
 
-		// destroy the sock fd client map
-		htab_destroy (cerver->client_sock_fd_map);
-		cerver->client_sock_fd_map = NULL;
+		// destroy the sock fd client table
+		cerver_fd_table_delete (cerver->fd_table);
+		cerver->fd_table = NULL;
 
 		// this will end and delete client connections and then delete the client
 		avl_delete (cerver->clients);
@@ -2528,6 +3619,11 @@ static void cerver_destroy_clients (Cerver *cerver) {
 			free (cerver->fds);
 			cerver->fds = NULL;
 		}
+
+		if (cerver->fds_idx) {
+			free (cerver->fds_idx);
+			cerver->fds_idx = NULL;
+		}
 	}
 
 }
@@ -2536,6 +3632,9 @@ static void cerver_destroy_clients (Cerver *cerver) {
 static void cerver_clean (Cerver *cerver) {
 
 	if (cerver) {
+		// no timer can expire while its client or player is being deleted
+		timer_wheel_stop (cerver->timer_wheel);
+
 		switch (cerver->type) {
 			case CERVER_TYPE_CUSTOM: break;
 
@@ -2569,6 +3668,12 @@ static void cerver_clean (Cerver *cerver) {
 			default: break;
 		}
 
+		// stop the reactors before cleaning up their connections
+		cerver_reactors_end (cerver);
+
+		// the udp peers are deleted with their workers
+		cerver_udp_end (cerver);
+
 		// clean up on hold connections
 		cerver_destroy_on_hold_connections (cerver);
 
@@ -2959,4 +4064,57 @@ Packet *cerver_packet_generate (Cerver *cerver) {
 
 }
 
+// creates a packet with a SCerverLatency for each cerver's latency
+// followed by the handler latency of every packet type that has been handled
+// returns NULL if the latency histograms are disabled
+Packet *cerver_latencies_packet_generate (Cerver *cerver) {
+
+	Packet *packet = NULL;
+
+	if (cerver) {
+		CerverStats *snapshot = cerver_stats_get_snapshot (cerver);
+		if (snapshot) {
+			if (snapshot->latencies) {
+				SCerverLatency slatencies[CERVER_STATS_N_LATENCIES + CERVER_STATS_N_PACKET_TYPES] = { 0 };
+				u32 n_latencies = 0;
+
+				const Histogram *histogram = NULL;
+				for (u32 i = 0; i < (CERVER_STATS_N_LATENCIES + CERVER_STATS_N_PACKET_TYPES); i++) {
+					if (i < CERVER_STATS_N_LATENCIES) {
+						histogram = &snapshot->latencies->latencies[i];
+						slatencies[n_latencies].latency = i;
+						slatencies[n_latencies].packet_type = PACKET_TYPE_NONE;
+					}
+
+					else {
+						histogram = &snapshot->latencies->handler_latencies[i - CERVER_STATS_N_LATENCIES];
+						if (!histogram->count) continue;
+
+						slatencies[n_latencies].latency = CERVER_STATS_LATENCY_HANDLER;
+						slatencies[n_latencies].packet_type = i - CERVER_STATS_N_LATENCIES;
+					}
+
+					slatencies[n_latencies].count = histogram->count;
+					slatencies[n_latencies].p50 = histogram_get_percentile (histogram, 50);
+					slatencies[n_latencies].p99 = histogram_get_percentile (histogram, 99);
+					slatencies[n_latencies].p999 = histogram_get_percentile (histogram, 99.9);
+					slatencies[n_latencies].max = histogram->max;
+
+					n_latencies += 1;
+				}
+
+				packet = packet_generate_request (
+					PACKET_TYPE_REQUEST, REQUEST_PACKET_TYPE_GET_LATENCIES,
+					slatencies, n_latencies * sizeof (SCerverLatency)
+				);
+			}
+
+			cerver_stats_snapshot_delete (snapshot);
+		}
+	}
+
+	return packet;
+
+}
+
 #pragma endregion
\ No newline at end of file
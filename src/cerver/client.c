@@ -6,6 +6,8 @@
 #include <time.h>
 #include <errno.h>
 
+#include <sys/socket.h>
+
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
@@ -18,11 +20,14 @@
 #include "cerver/connection.h"
 #include "cerver/events.h"
 #include "cerver/errors.h"
+#include "cerver/fdtable.h"
 #include "cerver/files.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/reactor.h"
 #include "cerver/sessions.h"
+#include "cerver/wheel.h"
 
 #include "cerver/threads/thread.h"
 
@@ -30,6 +35,7 @@
 #include "cerver/utils/utils.h"
 
 static void client_event_delete (void *ptr);
+static void client_inactive_timer_expired (TimerWheel *wheel, void *client_ptr);
 static void client_error_delete (void *client_error_ptr);
 
 static u8 client_file_receive (
@@ -210,6 +216,9 @@ Client *client_new (void) {
 
 		client->connections = NULL;
 
+		client->last_activity = 0;
+		wheel_timer_init (&client->inactive_timer, client_inactive_timer_expired, client);
+
 		client->drop_client = false;
 
 		client->data = NULL;
@@ -249,58 +258,91 @@ Client *client_new (void) {
 		client->file_stats = NULL;
 
 		client->stats = NULL;
+
+		client->references = 1;
 	}
 
 	return client;
 
 }
 
-void client_delete (void *ptr) {
+static void client_delete_actual (Client *client) {
 
-	if (ptr) {
-		Client *client = (Client *) ptr;
+	str_delete (client->session_id);
 
-		str_delete (client->session_id);
+	str_delete (client->name);
 
-		str_delete (client->name);
+	dlist_delete (client->connections);
 
-		dlist_delete (client->connections);
+	if (client->data) {
+		if (client->delete_data) client->delete_data (client->data);
+		else free (client->data);
+	}
 
-		if (client->data) {
-			if (client->delete_data) client->delete_data (client->data);
-			else free (client->data);
-		}
+	if (client->handlers_lock) {
+		pthread_mutex_destroy (client->handlers_lock);
+		free (client->handlers_lock);
+	}
 
-		if (client->handlers_lock) {
-			pthread_mutex_destroy (client->handlers_lock);
-			free (client->handlers_lock);
-		}
+	handler_delete (client->app_packet_handler);
+	handler_delete (client->app_error_packet_handler);
+	handler_delete (client->custom_packet_handler);
 
-		handler_delete (client->app_packet_handler);
-		handler_delete (client->app_error_packet_handler);
-		handler_delete (client->custom_packet_handler);
+	if (client->lock) {
+		pthread_mutex_destroy (client->lock);
+		free (client->lock);
+	}
 
-		if (client->lock) {
-			pthread_mutex_destroy (client->lock);
-			free (client->lock);
-		}
+	for (unsigned int i = 0; i < CLIENT_MAX_EVENTS; i++)
+		if (client->events[i]) client_event_delete (client->events[i]);
 
-		for (unsigned int i = 0; i < CLIENT_MAX_EVENTS; i++)
-			if (client->events[i]) client_event_delete (client->events[i]);
+	for (unsigned int i = 0; i < CLIENT_MAX_ERRORS; i++)
+		if (client->errors[i]) client_error_delete (client->errors[i]);
 
-		for (unsigned int i = 0; i < CLIENT_MAX_ERRORS; i++)
-			if (client->errors[i]) client_error_delete (client->errors[i]);
+	for (unsigned int i = 0; i < CLIENT_FILES_MAX_PATHS; i++)
+		str_delete (client->paths[i]);
 
-		for (unsigned int i = 0; i < CLIENT_FILES_MAX_PATHS; i++)
-			str_delete (client->paths[i]);
+	str_delete (client->uploads_path);
 
-		str_delete (client->uploads_path);
+	client_file_stats_delete (client->file_stats);
 
-		client_file_stats_delete (client->file_stats);
+	client_stats_delete (client->stats);
 
-		client_stats_delete (client->stats);
+	free (client);
 
-		free (client);
+}
+
+// completely deletes a client and all of its data
+// if packets that point to the client are still queued in handlers,
+// it is deleted when the last one of them is released
+void client_delete (void *ptr) {
+
+	if (ptr) {
+		Client *client = (Client *) ptr;
+
+		(void) wheel_timer_cancel (&client->inactive_timer);
+
+		client_release (client);
+	}
+
+}
+
+// takes a reference to the client, so it is not deleted
+// until the reference is released with client_release ()
+void client_retain (Client *client) {
+
+	(void) __atomic_add_fetch (&client->references, 1, __ATOMIC_RELAXED);
+
+}
+
+// releases a reference to the client
+// it is deleted when there are no more references to it
+void client_release (Client *client) {
+
+	if (client) {
+		if (!__atomic_sub_fetch (&client->references, 1, __ATOMIC_ACQ_REL)) {
+			client_delete_actual (client);
+		}
 	}
 
 }
@@ -565,11 +607,65 @@ void client_got_disconnected (Client *client) {
 
 // drops a client form the cerver
 // unregisters the client from the cerver and the deletes him
+// only the thread that removes the client from the cerver deletes it,
+// so a client that is dropped at the same time by its inactive timer
+// & by another thread is never deleted twice
 void client_drop (Cerver *cerver, Client *client) {
 
 	if (cerver && client) {
-		client_unregister_from_cerver (cerver, client);
-		client_delete (client);
+		if (client_unregister_from_cerver (cerver, client))
+			client_delete (client);
+	}
+
+}
+
+// shuts down the connection's socket, so its handler drops it as a closed connection
+static void client_inactive_connection_shutdown (void *connection_ptr, void *args) {
+
+	(void) args;
+
+	Connection *connection = (Connection *) connection_ptr;
+	if (connection->socket) (void) shutdown (connection->socket->sock_fd, SHUT_RDWR);
+
+}
+
+// called by the cerver's timer wheel when the client's inactive timer expires
+// if the client has been active since it was armed, the timer is armed
+// again with the remaining time, so packets only update its last activity
+static void client_inactive_timer_expired (TimerWheel *wheel, void *client_ptr) {
+
+	Cerver *cerver = (Cerver *) wheel->data;
+	Client *client = (Client *) client_ptr;
+
+	const time_t inactive = time (NULL)
+		- __atomic_load_n (&client->last_activity, __ATOMIC_RELAXED);
+
+	if (inactive >= (time_t) cerver->max_inactive_time) {
+		cerver_log_warning (
+			"Client %lu has been inactive more than %u secs, dropping it...",
+			client->id, cerver->max_inactive_time
+		);
+
+		// the handler of each connection drops the client after its last
+		// connection gets closed, so it is never deleted while being used
+		// no lock is held while dropping it, as a thread that is dropping
+		// the same client waits in wheel_timer_cancel () for this callback
+		if (dlist_size (client->connections)) {
+			(void) dlist_traverse (
+				client->connections, client_inactive_connection_shutdown, NULL
+			);
+		}
+
+		else {
+			client_drop (cerver, client);
+		}
+	}
+
+	else {
+		(void) timer_wheel_arm (
+			wheel, &client->inactive_timer,
+			(u64) (cerver->max_inactive_time - inactive) * 1000
+		);
 	}
 
 }
@@ -628,6 +724,7 @@ u8 client_connection_drop (
 // removes the connection from the client referred to by the sock fd by calling client_connection_drop ()
 // and also remove the client & connection from the cerver's structures when needed
 // also checks if there is another active connection in the client, if not it will be dropped
+// the client is only deleted by the thread that removes it from the cerver
 // returns the resulting status after the operation
 ClientConnectionsStatus client_remove_connection_by_sock_fd (
 	Cerver *cerver, Client *client, const i32 sock_fd
@@ -648,8 +745,8 @@ ClientConnectionsStatus client_remove_connection_by_sock_fd (
 				);
 				#endif
 
-				(void) client_remove_from_cerver (cerver, client);
-				client_delete (client);
+				if (client_remove_from_cerver (cerver, client))
+					client_delete (client);
 
 				status = CLIENT_CONNECTIONS_STATUS_DROPPED;
 			} break;
@@ -682,8 +779,9 @@ ClientConnectionsStatus client_remove_connection_by_sock_fd (
 					);
 
 					// no connections left in client, just remove and delete
-					client_remove_from_cerver (cerver, client);
-					client_delete (client);
+					// only if this thread was the one that removed it
+					if (client_remove_from_cerver (cerver, client))
+						client_delete (client);
 
 					cerver_event_trigger (
 						CERVER_EVENT_CLIENT_DROPPED,
@@ -914,6 +1012,8 @@ Client *client_remove_from_cerver (
 		if (client_data) {
 			retval = (Client *) client_data;
 
+			(void) wheel_timer_cancel (&client->inactive_timer);
+
 			#ifdef CLIENT_DEBUG
 			cerver_log (
 				LOG_TYPE_SUCCESS, LOG_TYPE_CLIENT,
@@ -921,7 +1021,7 @@ Client *client_remove_from_cerver (
 			);
 			#endif
 
-			cerver->stats->current_n_connected_clients--;
+			(void) __atomic_sub_fetch (&cerver->stats->current_n_connected_clients, 1, __ATOMIC_RELAXED);
 			#ifdef CERVER_STATS
 			cerver_log (
 				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
@@ -952,6 +1052,15 @@ static void client_register_to_cerver_internal (
 
 	(void) avl_insert_node (cerver->clients, client);
 
+	if (cerver->inactive_clients) {
+		__atomic_store_n (&client->last_activity, time (NULL), __ATOMIC_RELAXED);
+
+		(void) timer_wheel_arm (
+			cerver->timer_wheel, &client->inactive_timer,
+			(u64) cerver->max_inactive_time * 1000
+		);
+	}
+
 	#ifdef CLIENT_DEBUG
 	cerver_log (
 		LOG_TYPE_SUCCESS, LOG_TYPE_CLIENT,
@@ -960,8 +1069,8 @@ static void client_register_to_cerver_internal (
 	);
 	#endif
 
-	cerver->stats->total_n_clients++;
-	cerver->stats->current_n_connected_clients++;
+	(void) __atomic_add_fetch (&cerver->stats->total_n_clients, 1, __ATOMIC_RELAXED);
+	(void) __atomic_add_fetch (&cerver->stats->current_n_connected_clients, 1, __ATOMIC_RELAXED);
 
 	#ifdef CERVER_STATS
 	cerver_log (
@@ -988,7 +1097,10 @@ u8 client_register_to_cerver (
 			switch (cerver->handler_type) {
 				case CERVER_HANDLER_TYPE_NONE: break;
 
-				case CERVER_HANDLER_TYPE_POLL: {
+				case CERVER_HANDLER_TYPE_POLL:
+				case CERVER_HANDLER_TYPE_EPOLL:
+				case CERVER_HANDLER_TYPE_REACTORS:
+				case CERVER_HANDLER_TYPE_IO_URING: {
 					if (!client_register_connections_to_cerver_poll (cerver, client)) {
 						client_register_to_cerver_internal (cerver, client);
 
@@ -1040,19 +1152,16 @@ Client *client_unregister_from_cerver (
 
 }
 
-// gets the client associated with a sock fd using the client-sock fd map
+// gets the client associated with a sock fd using the cerver's fd table
+// the connections accepted by every reactor are also in the same table
 Client *client_get_by_sock_fd (Cerver *cerver, i32 sock_fd) {
 
 	Client *client = NULL;
 
 	if (cerver) {
-		const i32 *key = &sock_fd;
-		void *client_data = htab_get (
-			cerver->client_sock_fd_map,
-			key, sizeof (i32)
+		(void) cerver_fd_table_get (
+			cerver->fd_table, sock_fd, NULL, &client, NULL
 		);
-
-		if (client_data) client = (Client *) client_data;
 	}
 
 	return client;
@@ -1084,7 +1193,25 @@ Client *client_get_by_session_id (
 
 }
 
+static void client_broadcast_add_avl (
+	AVLNode *node, PacketBroadcast *broadcast
+) {
+
+	if (node) {
+		client_broadcast_add_avl (node->right, broadcast);
+
+		// add all of the client's active connections
+		if (node->id) {
+			(void) packet_broadcast_add_client (broadcast, (Client *) node->id);
+		}
+
+		client_broadcast_add_avl (node->left, broadcast);
+	}
+
+}
+
 // broadcast a packet to all clients inside an avl structure
+// the packet is serialized only once & then sent to all the connections
 void client_broadcast_to_all_avl (
 	AVLNode *node,
 	Cerver *cerver,
@@ -1092,22 +1219,14 @@ void client_broadcast_to_all_avl (
 ) {
 
 	if (node && cerver && packet) {
-		client_broadcast_to_all_avl (node->right, cerver, packet);
+		PacketBroadcast *broadcast = packet_broadcast_create (packet);
+		if (broadcast) {
+			client_broadcast_add_avl (node, broadcast);
 
-		// send the packet to current client
-		if (node->id) {
-			Client *client = (Client *) node->id;
+			(void) packet_broadcast_send (broadcast, cerver, NULL, 0);
 
-			// send the packet to all of its active connections
-			Connection *connection = NULL;
-			for (ListElement *le = dlist_start (client->connections); le; le = le->next) {
-				connection = (Connection *) le->data;
-				packet_set_network_values (packet, cerver, client, connection, NULL);
-				packet_send (packet, 0, NULL, false);
-			}
+			packet_broadcast_delete (broadcast);
 		}
-
-		client_broadcast_to_all_avl (node->left, cerver, packet);
 	}
 
 }
@@ -2856,9 +2975,8 @@ static void client_app_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->app_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->client->app_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to client's %s app_packet_handler!",
@@ -2890,9 +3008,8 @@ static void client_app_error_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->app_error_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->client->app_error_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to client's %s app_error_packet_handler!",
@@ -2924,9 +3041,8 @@ static void client_custom_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->custom_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->client->custom_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to client's %s custom_packet_handler!",
@@ -3058,50 +3174,45 @@ static void client_packet_handler (void *packet_ptr) {
 
 }
 
-static void client_receive_handle_spare_packet (
-	Client *client, Connection *connection,
-	size_t buffer_size, char **end, size_t *buffer_pos
-) {
+typedef struct ClientReceiveFrame {
 
-	if (connection->sock_receive->header) {
-		// copy the remaining header size
-		memcpy (connection->sock_receive->header_end, (void *) *end, connection->sock_receive->remaining_header);
+	Client *client;
+	Connection *connection;
 
-		connection->sock_receive->complete_header = true;
-	}
+} ClientReceiveFrame;
 
-	else if (connection->sock_receive->spare_packet) {
-		size_t copy_to_spare = 0;
-		if (connection->sock_receive->missing_packet < buffer_size)
-			copy_to_spare = connection->sock_receive->missing_packet;
-
-		else copy_to_spare = buffer_size;
-
-		// append new data from buffer to the spare packet
-		if (copy_to_spare > 0) {
-			packet_append_data (connection->sock_receive->spare_packet, *end, copy_to_spare);
+// creates a packet for a complete packet found in the received buffer
+// returns 0 to keep handling packets
+static u8 client_receive_handle_frame (
+	void *receive_frame_ptr,
+	PacketHeader *header,
+	char *data, const size_t data_size
+) {
 
-			// check if we can handler the packet
-			size_t curr_packet_size = connection->sock_receive->spare_packet->data_size + sizeof (PacketHeader);
-			if (connection->sock_receive->spare_packet->header->packet_size == curr_packet_size) {
-				connection->sock_receive->spare_packet->client = client;
-				connection->sock_receive->spare_packet->connection = connection;
+	ClientReceiveFrame *receive_frame = (ClientReceiveFrame *) receive_frame_ptr;
 
-				connection->full_packet = true;
-				client_packet_handler (connection->sock_receive->spare_packet);
+	Packet *packet = packet_new ();
+	if (packet) {
+		packet_header_copy (&packet->header, header);
+		packet->packet_size = header->packet_size;
+		packet->client = receive_frame->client;
+		packet->connection = receive_frame->connection;
 
-				connection->sock_receive->spare_packet = NULL;
-				connection->sock_receive->missing_packet = 0;
-			}
+		packet_set_data (packet, (void *) data, data_size);
 
-			else connection->sock_receive->missing_packet -= copy_to_spare;
+		receive_frame->connection->full_packet = true;
+		client_packet_handler (packet);
+	}
 
-			// offset for the buffer
-			if (copy_to_spare < buffer_size) *end += copy_to_spare;
-			*buffer_pos += copy_to_spare;
-		}
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+			"Failed to create a new packet in cerver_handle_receive_buffer ()"
+		);
 	}
 
+	return 0;
+
 }
 
 // splits the entry buffer in packets of the correct size
@@ -3110,163 +3221,14 @@ static void client_receive_handle_buffer (
 	char *buffer, size_t buffer_size
 ) {
 
-	char *end = buffer;
-	size_t buffer_pos = 0;
+	ClientReceiveFrame receive_frame = { client, connection };
 
-	SockReceive *sock_receive = connection->sock_receive;
-
-	client_receive_handle_spare_packet (
-		client, connection,
-		buffer_size, &end,
-		&buffer_pos
+	(void) sock_receive_handle_buffer (
+		connection->sock_receive,
+		buffer, buffer_size,
+		client_receive_handle_frame, &receive_frame
 	);
 
-	PacketHeader *header = NULL;
-	size_t packet_size = 0;
-	// char *packet_data = NULL;
-
-	size_t remaining_buffer_size = 0;
-	size_t packet_real_size = 0;
-	size_t to_copy_size = 0;
-
-	bool spare_header = false;
-
-	while (buffer_pos < buffer_size) {
-		remaining_buffer_size = buffer_size - buffer_pos;
-
-		if (sock_receive->complete_header) {
-			packet_header_copy (&header, (PacketHeader *) sock_receive->header);
-			// header = ((PacketHeader *) sock_receive->header);
-			// packet_header_print (header);
-
-			end += sock_receive->remaining_header;
-			buffer_pos += sock_receive->remaining_header;
-			// printf ("buffer pos after copy to header: %ld\n", buffer_pos);
-
-			// reset sock header values
-			free (sock_receive->header);
-			sock_receive->header = NULL;
-			sock_receive->header_end = NULL;
-			// sock_receive->curr_header_pos = 0;
-			// sock_receive->remaining_header = 0;
-			sock_receive->complete_header = false;
-
-			spare_header = true;
-		}
-
-		else if (remaining_buffer_size >= sizeof (PacketHeader)) {
-			header = (PacketHeader *) end;
-			end += sizeof (PacketHeader);
-			buffer_pos += sizeof (PacketHeader);
-
-			// packet_header_print (header);
-
-			spare_header = false;
-		}
-
-		if (header) {
-			// check the packet size
-			packet_size = header->packet_size;
-			if ((packet_size > 0) /* && (packet_size < 65536) */) {
-				// printf ("packet_size: %ld\n", packet_size);
-				// end += sizeof (PacketHeader);
-				// buffer_pos += sizeof (PacketHeader);
-				// printf ("first buffer pos: %ld\n", buffer_pos);
-
-				Packet *packet = packet_new ();
-				if (packet) {
-					packet_header_copy (&packet->header, header);
-					packet->packet_size = header->packet_size;
-					// packet->cerver = cerver;
-					// packet->lobby = lobby;
-					packet->client = client;
-					packet->connection = connection;
-
-					if (spare_header) {
-						free (header);
-						header = NULL;
-					}
-
-					// check for packet size and only copy what is in the current buffer
-					packet_real_size = packet->header->packet_size - sizeof (PacketHeader);
-					to_copy_size = 0;
-					if ((remaining_buffer_size - sizeof (PacketHeader)) < packet_real_size) {
-						sock_receive->spare_packet = packet;
-
-						if (spare_header) to_copy_size = buffer_size - sock_receive->remaining_header;
-						else to_copy_size = remaining_buffer_size - sizeof (PacketHeader);
-
-						sock_receive->missing_packet = packet_real_size - to_copy_size;
-					}
-
-					else {
-						if ((header->packet_type == PACKET_TYPE_REQUEST) && (header->request_type == REQUEST_PACKET_TYPE_SEND_FILE)) {
-							to_copy_size = remaining_buffer_size - sizeof (PacketHeader);
-						}
-
-						else {
-							to_copy_size = packet_real_size;
-						}
-
-						packet_delete (sock_receive->spare_packet);
-						sock_receive->spare_packet = NULL;
-					}
-
-					// printf ("to copy size: %ld\n", to_copy_size);
-					packet_set_data (packet, (void *) end, to_copy_size);
-
-					end += to_copy_size;
-					buffer_pos += to_copy_size;
-					// printf ("second buffer pos: %ld\n", buffer_pos);
-
-					if (!sock_receive->spare_packet) {
-						connection->full_packet = true;
-						client_packet_handler (packet);
-					}
-				}
-
-				else {
-					cerver_log (
-						LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
-						"Failed to create a new packet in cerver_handle_receive_buffer ()"
-					);
-				}
-			}
-
-			else {
-				cerver_log (
-					LOG_TYPE_WARNING, LOG_TYPE_CLIENT,
-					"Got a packet of invalid size: %ld", packet_size
-				);
-
-				break;
-			}
-		}
-
-		else {
-			if (sock_receive->spare_packet) packet_append_data (sock_receive->spare_packet, (void *) end, remaining_buffer_size);
-
-			else {
-				// copy the piece of possible header that was cut of between recv ()
-				sock_receive->header = malloc (sizeof (PacketHeader));
-				memcpy (sock_receive->header, (void *) end, remaining_buffer_size);
-
-				sock_receive->header_end = (char *) sock_receive->header;
-				sock_receive->header_end += remaining_buffer_size;
-
-				// sock_receive->curr_header_pos = remaining_buffer_size;
-				sock_receive->remaining_header = sizeof (PacketHeader) - remaining_buffer_size;
-
-				// printf ("curr header pos: %d\n", sock_receive->curr_header_pos);
-				// printf ("remaining header: %d\n", sock_receive->remaining_header);
-
-				buffer_pos += remaining_buffer_size;
-			}
-		}
-
-		header = NULL;
-	}
-
 }
 
 // handles a failed recive from a connection associatd with a client
@@ -3511,7 +3473,7 @@ static void client_app_handler_destroy (Client *client) {
 		if (client->app_packet_handler) {
 			if (!client->app_packet_handler->direct_handle) {
 				// stop app handler
-				bsem_post_all (client->app_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (client->app_packet_handler->job_queue);
 			}
 		}
 	}
@@ -3524,7 +3486,7 @@ static void client_app_error_handler_destroy (Client *client) {
 		if (client->app_error_packet_handler) {
 			if (!client->app_error_packet_handler->direct_handle) {
 				// stop app error handler
-				bsem_post_all (client->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (client->app_error_packet_handler->job_queue);
 			}
 		}
 	}
@@ -3537,7 +3499,7 @@ static void client_custom_handler_destroy (Client *client) {
 		if (client->custom_packet_handler) {
 			if (!client->custom_packet_handler->direct_handle) {
 				// stop custom handler
-				bsem_post_all (client->custom_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (client->custom_packet_handler->job_queue);
 			}
 		}
 	}
@@ -3561,13 +3523,13 @@ static void client_handlers_destroy (Client *client) {
 		// poll remaining handlers
 		while (client->num_handlers_alive) {
 			if (client->app_packet_handler)
-				bsem_post_all (client->app_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (client->app_packet_handler->job_queue);
 
 			if (client->app_error_packet_handler)
-				bsem_post_all (client->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (client->app_error_packet_handler->job_queue);
 
 			if (client->custom_packet_handler)
-				bsem_post_all (client->custom_packet_handler->job_queue->has_jobs);
+				job_queue_wake_all (client->custom_packet_handler->job_queue);
 
 			sleep (1);
 		}
@@ -1,58 +1,160 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 
+#include <time.h>
 #include <pthread.h>
 
+#include <sys/random.h>
+
+#include "cerver/types/types.h"
+
 #include "cerver/collections/htab.h"
 
-#pragma region generic
+#pragma region hash
 
-static size_t htab_generic_hash (
-	const void *key, size_t key_size, size_t table_size
-) {
+// wyhash constants & mix
+#define HTAB_HASH_P0			0xa0761d6478bd642full
+#define HTAB_HASH_P1			0xe7037ed1a0b428dbull
+#define HTAB_HASH_P2			0x8ebc6af09c88c6e3ull
+#define HTAB_HASH_P3			0x589965cc75374cc1ull
+
+static inline u64 htab_hash_mix (u64 a, u64 b) {
+
+	__uint128_t r = (__uint128_t) a * b;
+
+	return (u64) r ^ (u64) (r >> 64);
 
-	size_t i;
-	size_t sum = 0;
-	unsigned char *k = (unsigned char *) key;
-	for (i = 0; i < key_size; ++i)
-		sum = (sum + (int)k[i]) % table_size;
-	
-	return sum;
 }
 
-static int htab_generic_compare (
-	const void *k1, size_t s1, const void *k2, size_t s2
-) {
+static inline u64 htab_hash_read64 (const u8 *p) {
 
-	if (!k1 || !s1 || !k2 || !s2) return -1;
+	u64 value = 0;
+	(void) memcpy (&value, p, sizeof (u64));
 
-	if (s1 != s2) return -1;
+	return value;
 
-	return memcmp (k1, k2, s1);
 }
 
-#pragma endregion
+static inline u64 htab_hash_read32 (const u8 *p) {
 
-#pragma region internal
+	u32 value = 0;
+	(void) memcpy (&value, p, sizeof (u32));
 
-static inline void *htab_internal_key_create (
-	void *(*key_create)(const void *), 
-	const void *key, size_t key_size
+	return value;
+
+}
+
+// fast seeded hash for keys of any size
+u64 htab_hash_bytes (
+	const void *key, size_t key_size, u64 seed
 ) {
 
-	void *retval = NULL;
+	const u8 *p = (const u8 *) key;
+	u64 a = 0, b = 0;
+
+	seed ^= htab_hash_mix (seed ^ HTAB_HASH_P0, HTAB_HASH_P1);
+
+	if (key_size <= 16) {
+		if (key_size >= 4) {
+			const size_t middle = (key_size >> 3) << 2;
+			a = (htab_hash_read32 (p) << 32) | htab_hash_read32 (p + middle);
+			b = (htab_hash_read32 (p + key_size - 4) << 32)
+				| htab_hash_read32 (p + key_size - 4 - middle);
+		}
+
+		else if (key_size > 0) {
+			a = ((u64) p[0] << 16) | ((u64) p[key_size >> 1] << 8) | p[key_size - 1];
+		}
+	}
 
-	if (key_create) retval = key_create (key);
 	else {
-		retval = malloc (key_size);
-		(void) memcpy (retval, key, key_size);
+		size_t remaining = key_size;
+		if (remaining > 48) {
+			u64 seed1 = seed, seed2 = seed;
+			do {
+				seed = htab_hash_mix (htab_hash_read64 (p) ^ HTAB_HASH_P1, htab_hash_read64 (p + 8) ^ seed);
+				seed1 = htab_hash_mix (htab_hash_read64 (p + 16) ^ HTAB_HASH_P2, htab_hash_read64 (p + 24) ^ seed1);
+				seed2 = htab_hash_mix (htab_hash_read64 (p + 32) ^ HTAB_HASH_P3, htab_hash_read64 (p + 40) ^ seed2);
+				p += 48;
+				remaining -= 48;
+			} while (remaining > 48);
+
+			seed ^= seed1 ^ seed2;
+		}
+
+		while (remaining > 16) {
+			seed = htab_hash_mix (htab_hash_read64 (p) ^ HTAB_HASH_P1, htab_hash_read64 (p + 8) ^ seed);
+			p += 16;
+			remaining -= 16;
+		}
+
+		a = htab_hash_read64 (p + remaining - 16);
+		b = htab_hash_read64 (p + remaining - 8);
 	}
 
-	return retval;
+	a ^= HTAB_HASH_P1;
+	b ^= seed;
+
+	__uint128_t r = (__uint128_t) a * b;
+	a = (u64) r;
+	b = (u64) (r >> 64);
+
+	return htab_hash_mix (a ^ HTAB_HASH_P0 ^ key_size, b ^ HTAB_HASH_P1);
+
+}
+
+static pthread_once_t htab_seed_once = PTHREAD_ONCE_INIT;
+static u64 htab_seed_base = 0;
+static u64 htab_seed_counter = 0;
+
+static void htab_hash_seed_init (void) {
+
+	if (getrandom (&htab_seed_base, sizeof (u64), GRND_NONBLOCK) != sizeof (u64)) {
+		struct timespec now = { 0 };
+		(void) clock_gettime (CLOCK_MONOTONIC, &now);
+
+		htab_seed_base = htab_hash_mix (
+			(u64) now.tv_nsec ^ HTAB_HASH_P2,
+			(u64) (uintptr_t) &htab_seed_base ^ (u64) now.tv_sec
+		);
+	}
+
+}
+
+// returns a random seed that is different for each call
+// used by the hash tables to make their hashes unpredictable
+u64 htab_hash_seed (void) {
+
+	(void) pthread_once (&htab_seed_once, htab_hash_seed_init);
+
+	return htab_hash_mix (
+		htab_seed_base ^ HTAB_HASH_P3,
+		__atomic_add_fetch (&htab_seed_counter, HTAB_HASH_P0, __ATOMIC_RELAXED)
+	);
 
 }
 
+#pragma endregion
+
+#pragma region generic
+
+static int htab_generic_compare (
+	const void *k1, size_t s1, const void *k2, size_t s2
+) {
+
+	if (!k1 || !s1 || !k2 || !s2) return -1;
+
+	if (s1 != s2) return -1;
+
+	return memcmp (k1, k2, s1);
+}
+
+#pragma endregion
+
+#pragma region internal
+
 static inline int htab_internal_key_compare (
 	Htab *htab,
 	const void *k1, size_t s1, const void *k2, size_t s2
@@ -64,33 +166,69 @@ static inline int htab_internal_key_compare (
 	
 }
 
-static HtabNode *htab_node_new (void) {
+// keys are copied after their node, unless they have custom methods
+static inline bool htab_internal_key_inline (const Htab *htab) {
 
-	HtabNode *node = (HtabNode *) malloc (sizeof (HtabNode));
-	if (node) {
-		node->key = NULL;
-		node->val = NULL;
-		node->next = NULL;
-		node->key_size = 0;
-		node->val_size = 0;
-	}
+	return !htab->key_create && !htab->key_delete;
 
-	return node;
+}
+
+static inline u64 htab_internal_hash (
+	const Htab *htab, const void *key, size_t key_size
+) {
+
+	return htab->hash ? 0 : htab_hash_bytes (key, key_size, htab->seed);
+
+}
+
+// custom hash methods are called with the size of the table
+static inline size_t htab_internal_index (
+	const Htab *htab,
+	const void *key, size_t key_size, u64 hash,
+	size_t table_size
+) {
+
+	return htab->hash ?
+		htab->hash (key, key_size, table_size) % table_size :
+		(size_t) (hash & (table_size - 1));
 
 }
 
 static HtabNode *htab_node_create (
-	const void *key, size_t key_size, void *val, size_t val_size,
-	void *(*key_create)(void const *)
+	Htab *htab,
+	const void *key, size_t key_size, u64 hash,
+	void *val, size_t val_size
 ) {
 
-	HtabNode *node = htab_node_new ();
+	HtabNode *node = NULL;
+
+	if (htab_internal_key_inline (htab)) {
+		node = (HtabNode *) malloc (sizeof (HtabNode) + key_size);
+		if (node) {
+			node->key = node + 1;
+			(void) memcpy (node->key, key, key_size);
+		}
+	}
+
+	else {
+		node = (HtabNode *) malloc (sizeof (HtabNode));
+		if (node) {
+			if (htab->key_create) node->key = htab->key_create (key);
+			else {
+				node->key = malloc (key_size);
+				(void) memcpy (node->key, key, key_size);
+			}
+		}
+	}
+
 	if (node) {
+		node->next = NULL;
 		node->key_size = key_size;
-		node->key = htab_internal_key_create (key_create, key, key_size);
 
 		node->val = val;
 		node->val_size = val_size;
+
+		node->hash = hash;
 	}
 
 	return node;
@@ -98,18 +236,16 @@ static HtabNode *htab_node_create (
 }
 
 static void htab_node_delete (
-	HtabNode *node,
-	void (*key_delete)(void *),
-	void (*delete_data)(void *data)
+	Htab *htab, HtabNode *node
 ) {
 
 	if (node) {
 		if (node->val) {
-			if (delete_data) delete_data (node->val);
+			if (htab->delete_data) htab->delete_data (node->val);
 		}
 
-		if (node->key) {
-			if (key_delete) key_delete (node->key) ;
+		if (!htab_internal_key_inline (htab) && node->key) {
+			if (htab->key_delete) htab->key_delete (node->key) ;
 			else free (node->key);
 		}
 
@@ -118,43 +254,123 @@ static void htab_node_delete (
 
 }
 
-static HtabBucket *htab_bucket_new (void) {
+static void htab_bucket_delete (
+	Htab *htab, HtabBucket *bucket
+) {
+
+	HtabNode *node = NULL;
+	while (bucket->start) {
+		node = bucket->start;
+		bucket->start = bucket->start->next;
+
+		htab_node_delete (htab, node);
+	}
+
+	bucket->count = 0;
+
+}
+
+// moves the next buckets from the old table to the new one
+static void htab_rehash_step (Htab *htab, size_t n_buckets) {
+
+	HtabBucket *bucket = NULL;
+	HtabNode *node = NULL;
+	size_t index = 0;
+	while (htab->old_table && n_buckets--) {
+		bucket = &htab->old_table[htab->rehash_idx];
+		while (bucket->start) {
+			node = bucket->start;
+			bucket->start = node->next;
+
+			index = htab_internal_index (
+				htab, node->key, node->key_size, node->hash, htab->size
+			);
+
+			node->next = htab->table[index].start;
+			htab->table[index].start = node;
+			htab->table[index].count += 1;
+		}
 
-	HtabBucket *bucket = (HtabBucket *) malloc (sizeof (HtabBucket));
-	if (bucket) {
-		bucket->start = NULL;
 		bucket->count = 0;
+
+		htab->rehash_idx += 1;
+		if (htab->rehash_idx == htab->old_size) {
+			free (htab->old_table);
+			htab->old_table = NULL;
+			htab->old_size = 0;
+			htab->rehash_idx = 0;
+		}
 	}
 
-	return bucket;
+}
+
+// starts moving the nodes to a table with twice the buckets
+static void htab_grow (Htab *htab) {
+
+	// the previous resize must be completed first
+	if (htab->old_table) htab_rehash_step (htab, htab->old_size);
+
+	HtabBucket *table = (HtabBucket *) calloc (htab->size * 2, sizeof (HtabBucket));
+	if (table) {
+		htab->old_table = htab->table;
+		htab->old_size = htab->size;
+		htab->rehash_idx = 0;
+
+		htab->table = table;
+		htab->size *= 2;
+	}
 
 }
 
-static void htab_bucket_delete (
-	HtabBucket *bucket, 
-	void (*key_delete)(void *),
-	void (*delete_data)(void *data)
+// returns the bucket of the table or of the old table where the key is
+// the key's node is returned in node & the previous one in prev
+static HtabBucket *htab_internal_find (
+	Htab *htab,
+	const void *key, size_t key_size, u64 hash,
+	HtabNode **node_ptr, HtabNode **prev_ptr
 ) {
 
-	if (bucket) {
-		while (bucket->count) {
-			HtabNode *node = bucket->start;
-			bucket->start = bucket->start->next;
+	HtabBucket *bucket = NULL;
+	HtabNode *node = NULL;
+	HtabNode *prev = NULL;
 
-			htab_node_delete (node, key_delete, delete_data);
+	HtabBucket *tables[2] = { htab->table, htab->old_table };
+	size_t sizes[2] = { htab->size, htab->old_size };
+	for (unsigned int t = 0; t < 2; t++) {
+		if (!tables[t]) break;
 
-			bucket->count--;
+		bucket = &tables[t][htab_internal_index (htab, key, key_size, hash, sizes[t])];
+
+		prev = NULL;
+		node = bucket->start;
+		while (node) {
+			if (
+				(node->hash == hash)
+				&& (node->key_size == key_size)
+				&& !htab_internal_key_compare (htab, key, key_size, node->key, node->key_size)
+			) {
+				break;
+			}
+
+			prev = node;
+			node = node->next;
 		}
 
-		free (bucket);
+		if (node) break;
 	}
 
+	*node_ptr = node;
+	if (prev_ptr) *prev_ptr = prev;
+
+	return node ? bucket : NULL;
+
 }
 
 static void htab_delete (Htab *htab) {
 
 	if (htab) {
 		if (htab->table) free (htab->table);
+		if (htab->old_table) free (htab->old_table);
 		free (htab);
 	}
 
@@ -169,6 +385,12 @@ static Htab *htab_new (void) {
 		htab->size = 0;
 		htab->count = 0;
 
+		htab->old_table = NULL;
+		htab->old_size = 0;
+		htab->rehash_idx = 0;
+
+		htab->seed = 0;
+
 		htab->hash = NULL;
 
 		htab->key_create = NULL;
@@ -176,6 +398,8 @@ static Htab *htab_new (void) {
 		htab->key_compare = NULL;
 
 		htab->delete_data = NULL;
+
+		htab->mutex = NULL;
 	}
 
 	return htab;
@@ -200,6 +424,8 @@ void htab_set_key_create (
 // sets a method to correctly delete (free) your previous allocated key
 // a ptr to the allocated key if passed for you to correctly handle it
 // if not set, free will be used as default
+// if neither key_create nor key_delete are set, keys are copied
+// into the same allocation as their node
 void htab_set_key_delete (
 	Htab *htab, void (*key_delete)(void *)
 ) {
@@ -224,8 +450,9 @@ void htab_set_key_comparator (
 }
 
 // creates a new htab
-// size - how many buckets do you want - more buckets = less collisions
-// hash - custom method to hash the key for insertion, NULL for default
+// size - how many buckets to start with, rounded up to a power of 2
+// the table grows automatically when it has more elements than buckets
+// hash - custom method to hash the key for insertion, NULL for the default seeded hash
 // delete_data - custom method to delete your data, NULL for no delete when htab gets destroyed
 Htab *htab_create (
 	size_t size,
@@ -236,15 +463,13 @@ Htab *htab_create (
 	Htab *htab = htab_new ();
 	if (htab) {
 		if (size > 0) {
-			htab->size = size;
+			htab->size = 1;
+			while (htab->size < size) htab->size <<= 1;
 			
-			htab->table = (HtabBucket **) calloc (htab->size, sizeof (HtabBucket));
+			htab->table = (HtabBucket *) calloc (htab->size, sizeof (HtabBucket));
 			if (htab->table) {
-				for (size_t i = 0; i < htab->size; i++)
-					htab->table[i] = htab_bucket_new ();
-
-				htab->hash = hash ? hash : htab_generic_hash;
-				// htab->compare = compare ? compare : htab_generic_compare;
+				htab->seed = htab_hash_seed ();
+				htab->hash = hash;
 
 				htab->delete_data = delete_data;
 			}
@@ -320,24 +545,13 @@ bool htab_contains_key (
 	if (ht && key && key_size) {
 		(void) pthread_mutex_lock (ht->mutex);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-
-		HtabNode *node = ht->table[index]->start;
-		while (node && node->key && node->val) {
-			if (node->key_size == key_size) {
-				if (!htab_internal_key_compare (
-					ht, 
-					key, key_size, node->key, node->key_size
-				)) {
-					retval = true;
-					break;
-				}
+		if (ht->old_table) htab_rehash_step (ht, HTAB_REHASH_STEP);
 
-				else node = node->next;
-			}
-
-			else node = node->next;
-		}
+		HtabNode *node = NULL;
+		retval = htab_internal_find (
+			ht, key, key_size, htab_internal_hash (ht, key, key_size),
+			&node, NULL
+		) && node->val;
 
 		(void) pthread_mutex_unlock (ht->mutex);
 	}
@@ -356,55 +570,31 @@ int htab_insert (
 
 	int retval = 1;
 
-	if (ht && ht->hash && key && key_size && val && val_size) {
+	if (ht && ht->table && key && key_size && val && val_size) {
 		(void) pthread_mutex_lock (ht->mutex);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-		// printf ("size: %ld\n", ht->size);
-		// printf ("index: %ld\n", index);
+		if (ht->old_table) htab_rehash_step (ht, HTAB_REHASH_STEP);
 
-		HtabBucket *bucket = ht->table[index];
-		HtabNode *node = bucket->start;
-		if (node) {
-			while (
-				node->next
-				&& htab_internal_key_compare (
-					ht, key, key_size, node->key, node->key_size
-				)
-			) node = node->next;
-
-			if (htab_internal_key_compare (
-				ht,
-				key, key_size, node->key, node->key_size
-			)) {
-				node->next = htab_node_create (
-					key, key_size, val, val_size,
-					ht->key_create
-				);
-				
-				if (node->next) {
-					node = node->next;
-
-					bucket->count += 1;
-					ht->count += 1;
-
-					retval = 0;
-				}
-			}
-		}
-
-		else {
-			node = htab_node_create (
-				key, key_size, val, val_size,
-				ht->key_create
-			);
+		const u64 hash = htab_internal_hash (ht, key, key_size);
 
+		// a key can only be inserted once
+		HtabNode *node = NULL;
+		if (!htab_internal_find (ht, key, key_size, hash, &node, NULL)) {
+			node = htab_node_create (ht, key, key_size, hash, val, val_size);
 			if (node) {
+				// new nodes always go to the current table
+				HtabBucket *bucket = &ht->table[
+					htab_internal_index (ht, key, key_size, hash, ht->size)
+				];
+
+				node->next = bucket->start;
 				bucket->start = node;
 
 				bucket->count += 1;
 				ht->count += 1;
 
+				if (ht->count > (ht->size * HTAB_MAX_LOAD_FACTOR)) htab_grow (ht);
+
 				retval = 0;
 			}
 		}
@@ -427,26 +617,14 @@ void *htab_get (
 	if (ht && key) {
 		(void) pthread_mutex_lock (ht->mutex);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-		HtabNode *node = ht->table[index]->start;  
-		while (node && node->key && node->val) {
-			if (node->key_size == key_size) {
-				if (!htab_internal_key_compare (
-					ht,
-					key, key_size, node->key, node->key_size
-				)) {
-					retval = node->val;
-					break;
-				}
-
-				else {
-					node = node->next;
-				} 
-			}
+		if (ht->old_table) htab_rehash_step (ht, HTAB_REHASH_STEP);
 
-			else {
-				node = node->next;
-			}
+		HtabNode *node = NULL;
+		if (htab_internal_find (
+			ht, key, key_size, htab_internal_hash (ht, key, key_size),
+			&node, NULL
+		)) {
+			retval = node->val;
 		}
 
 		(void) pthread_mutex_unlock (ht->mutex);
@@ -465,34 +643,29 @@ void *htab_remove (
 
 	void *retval = NULL;
 
-	if (ht && key && ht->hash) {
+	if (ht && key && ht->table) {
 		(void) pthread_mutex_lock (ht->mutex);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-		HtabBucket *bucket = ht->table[index];
-		HtabNode *node = bucket->start;
-		HtabNode *prev = NULL;
-		while (node) {
-			if (!htab_internal_key_compare (
-				ht, 
-				key, key_size, node->key, node->key_size
-			)) {
-				if (!prev) ht->table[index]->start = ht->table[index]->start->next;
-				else prev->next = node->next;
+		if (ht->old_table) htab_rehash_step (ht, HTAB_REHASH_STEP);
 
-				retval = node->val;
+		HtabNode *node = NULL;
+		HtabNode *prev = NULL;
+		HtabBucket *bucket = htab_internal_find (
+			ht, key, key_size, htab_internal_hash (ht, key, key_size),
+			&node, &prev
+		);
 
-				node->val = NULL;
-				htab_node_delete (node, ht->key_delete, ht->delete_data);
+		if (bucket) {
+			if (!prev) bucket->start = node->next;
+			else prev->next = node->next;
 
-				bucket->count--;
-				ht->count--;
+			retval = node->val;
 
-				break;
-			}
+			node->val = NULL;
+			htab_node_delete (ht, node);
 
-			prev = node;
-			node = node->next;
+			bucket->count--;
+			ht->count--;
 		}
 
 		(void) pthread_mutex_unlock (ht->mutex);
@@ -508,15 +681,13 @@ void htab_destroy (Htab *ht) {
 		(void) pthread_mutex_lock (ht->mutex);
 
 		if (ht->table) {
-			for (size_t i = 0; i < ht->size; i++) {
-				if (ht->table[i]) {
-					htab_bucket_delete (
-						ht->table[i], 
-						ht->key_delete, 
-						ht->delete_data
-					);
-				}
-			}
+			for (size_t i = 0; i < ht->size; i++)
+				htab_bucket_delete (ht, &ht->table[i]);
+		}
+
+		if (ht->old_table) {
+			for (size_t i = ht->rehash_idx; i < ht->old_size; i++)
+				htab_bucket_delete (ht, &ht->old_table[i]);
 		}
 
 		(void) pthread_mutex_unlock (ht->mutex);
@@ -562,7 +733,16 @@ void htab_print (Htab *htab) {
 		(void) printf ("Htab's count: %lu\n", htab->count);
 
 		for (size_t idx = 0; idx < htab->size; idx++) {
-			htab_bucket_print (htab->table[idx], idx);
+			htab_bucket_print (&htab->table[idx], idx);
+		}
+
+		// the buckets that have not been moved yet
+		if (htab->old_table) {
+			(void) printf ("Htab's old table size: %lu\n", htab->old_size);
+
+			for (size_t idx = htab->rehash_idx; idx < htab->old_size; idx++) {
+				htab_bucket_print (&htab->old_table[idx], idx);
+			}
 		}
 
 		(void) printf ("\n\n");
@@ -0,0 +1,410 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/collections/htab.h"
+#include "cerver/collections/ohtab.h"
+
+#define OHTAB_SLOT_EMPTY			0
+#define OHTAB_SLOT_REMOVED			1
+
+#pragma region internal
+
+// real hashes never match the empty or removed slot values
+static inline u64 ohtab_hash (const OHtab *ht, const void *key) {
+
+	u64 hash = htab_hash_bytes (key, ht->key_size, ht->seed);
+
+	return (hash > OHTAB_SLOT_REMOVED) ? hash : hash + 2;
+
+}
+
+static inline u8 *ohtab_table_key (
+	const OHtab *ht, const OHtabTable *table, size_t idx
+) {
+
+	return table->keys + (idx * ht->key_size);
+
+}
+
+static u8 ohtab_table_init (
+	const OHtab *ht, OHtabTable *table, size_t size
+) {
+
+	u8 retval = 1;
+
+	table->hashes = (u64 *) calloc (size, sizeof (u64));
+	table->vals = (void **) calloc (size, sizeof (void *));
+	table->keys = (u8 *) malloc (size * ht->key_size);
+
+	if (table->hashes && table->vals && table->keys) {
+		table->size = size;
+
+		retval = 0;
+	}
+
+	else {
+		free (table->hashes);
+		free (table->vals);
+		free (table->keys);
+
+		(void) memset (table, 0, sizeof (OHtabTable));
+	}
+
+	return retval;
+
+}
+
+static void ohtab_table_end (OHtabTable *table) {
+
+	free (table->hashes);
+	free (table->vals);
+	free (table->keys);
+
+	(void) memset (table, 0, sizeof (OHtabTable));
+
+}
+
+// returns the slot where the key is or -1 if it was not found
+static long ohtab_table_find (
+	const OHtab *ht, const OHtabTable *table,
+	const void *key, u64 hash
+) {
+
+	long retval = -1;
+
+	if (table->size) {
+		const size_t mask = table->size - 1;
+		size_t idx = hash & mask;
+		while (table->hashes[idx] != OHTAB_SLOT_EMPTY) {
+			if (
+				(table->hashes[idx] == hash)
+				&& !memcmp (ohtab_table_key (ht, table, idx), key, ht->key_size)
+			) {
+				retval = (long) idx;
+				break;
+			}
+
+			idx = (idx + 1) & mask;
+		}
+	}
+
+	return retval;
+
+}
+
+// the table must have at least one empty slot
+static void ohtab_table_put (
+	const OHtab *ht, OHtabTable *table,
+	const void *key, u64 hash, void *val
+) {
+
+	const size_t mask = table->size - 1;
+	size_t idx = hash & mask;
+	while (table->hashes[idx] != OHTAB_SLOT_EMPTY) idx = (idx + 1) & mask;
+
+	table->hashes[idx] = hash;
+	table->vals[idx] = val;
+	(void) memcpy (ohtab_table_key (ht, table, idx), key, ht->key_size);
+
+}
+
+// removes the slot by moving back the next ones in its probe sequence,
+// so lookups never have to skip removed slots
+static void ohtab_table_shift_remove (
+	const OHtab *ht, OHtabTable *table, size_t idx
+) {
+
+	const size_t mask = table->size - 1;
+	size_t next = idx;
+	size_t home = 0;
+	for (;;) {
+		next = (next + 1) & mask;
+		if (table->hashes[next] == OHTAB_SLOT_EMPTY) break;
+
+		// the next slot can only be moved if its home is not between the hole & itself
+		home = table->hashes[next] & mask;
+		if (((next - home) & mask) >= ((next - idx) & mask)) {
+			table->hashes[idx] = table->hashes[next];
+			table->vals[idx] = table->vals[next];
+			(void) memcpy (
+				ohtab_table_key (ht, table, idx),
+				ohtab_table_key (ht, table, next),
+				ht->key_size
+			);
+
+			idx = next;
+		}
+	}
+
+	table->hashes[idx] = OHTAB_SLOT_EMPTY;
+	table->vals[idx] = NULL;
+
+}
+
+// moves the next slots from the old table to the new one
+// moved slots are marked as removed, so the old table can still be probed
+static void ohtab_rehash_step (OHtab *ht, size_t n_slots) {
+
+	OHtabTable *old = &ht->old_table;
+	while (old->size && n_slots--) {
+		if (old->hashes[ht->rehash_idx] > OHTAB_SLOT_REMOVED) {
+			ohtab_table_put (
+				ht, &ht->table,
+				ohtab_table_key (ht, old, ht->rehash_idx),
+				old->hashes[ht->rehash_idx], old->vals[ht->rehash_idx]
+			);
+
+			old->hashes[ht->rehash_idx] = OHTAB_SLOT_REMOVED;
+			ht->old_count -= 1;
+		}
+
+		ht->rehash_idx += 1;
+		if ((ht->rehash_idx == old->size) || !ht->old_count) {
+			ohtab_table_end (old);
+			ht->old_count = 0;
+			ht->rehash_idx = 0;
+		}
+	}
+
+}
+
+// starts moving the elements to a table with twice the slots
+static void ohtab_grow (OHtab *ht) {
+
+	// the previous resize must be completed first
+	if (ht->old_table.size) ohtab_rehash_step (ht, ht->old_table.size);
+
+	OHtabTable table = { 0 };
+	if (!ohtab_table_init (ht, &table, ht->table.size * 2)) {
+		ht->old_table = ht->table;
+		ht->old_count = ht->count;
+		ht->rehash_idx = 0;
+
+		ht->table = table;
+	}
+
+}
+
+static void ohtab_delete (OHtab *ht) {
+
+	if (ht) {
+		ohtab_table_end (&ht->table);
+		ohtab_table_end (&ht->old_table);
+
+		if (ht->rwlock) {
+			(void) pthread_rwlock_destroy (ht->rwlock);
+			free (ht->rwlock);
+		}
+
+		free (ht);
+	}
+
+}
+
+static OHtab *ohtab_new (void) {
+
+	OHtab *ht = (OHtab *) malloc (sizeof (OHtab));
+	if (ht) {
+		(void) memset (ht, 0, sizeof (OHtab));
+	}
+
+	return ht;
+
+}
+
+#pragma endregion
+
+// creates a new open addressing htab for keys of key_size bytes
+// init_size - how many slots to start with, rounded up to a power of 2
+// delete_data - custom method to delete your data, NULL for no delete when ohtab gets destroyed
+OHtab *ohtab_create (
+	size_t key_size, size_t init_size,
+	void (*delete_data)(void *data)
+) {
+
+	OHtab *ht = NULL;
+
+	if (key_size) {
+		ht = ohtab_new ();
+		if (ht) {
+			ht->key_size = key_size;
+
+			size_t size = OHTAB_MAX_LOAD_DEN;
+			while (size < init_size) size <<= 1;
+
+			ht->seed = htab_hash_seed ();
+			ht->delete_data = delete_data;
+
+			ht->rwlock = (pthread_rwlock_t *) malloc (sizeof (pthread_rwlock_t));
+			if (
+				ohtab_table_init (ht, &ht->table, size)
+				|| !ht->rwlock
+				|| pthread_rwlock_init (ht->rwlock, NULL)
+			) {
+				if (ht->rwlock) free (ht->rwlock);
+				ht->rwlock = NULL;
+
+				ohtab_delete (ht);
+				ht = NULL;
+			}
+		}
+	}
+
+	return ht;
+
+}
+
+// returns the current number of elements inside the ohtab
+size_t ohtab_size (OHtab *ht) {
+
+	size_t retval = 0;
+
+	if (ht) {
+		(void) pthread_rwlock_rdlock (ht->rwlock);
+
+		retval = ht->count;
+
+		(void) pthread_rwlock_unlock (ht->rwlock);
+	}
+
+	return retval;
+
+}
+
+// returns true if there is a value associated with the key
+bool ohtab_contains_key (OHtab *ht, const void *key) {
+
+	return ohtab_get (ht, key) != NULL;
+
+}
+
+// inserts a new value associated with its key
+// returns 0 on success, 1 on error or if the key is already in the ohtab
+int ohtab_insert (OHtab *ht, const void *key, void *val) {
+
+	int retval = 1;
+
+	if (ht && key && val) {
+		(void) pthread_rwlock_wrlock (ht->rwlock);
+
+		if (ht->old_table.size) ohtab_rehash_step (ht, OHTAB_REHASH_STEP);
+
+		const u64 hash = ohtab_hash (ht, key);
+
+		// a key can only be inserted once
+		if (
+			(ohtab_table_find (ht, &ht->table, key, hash) < 0)
+			&& (ohtab_table_find (ht, &ht->old_table, key, hash) < 0)
+			// there is always at least one empty slot
+			&& ((ht->count - ht->old_count) < (ht->table.size - 1))
+		) {
+			ohtab_table_put (ht, &ht->table, key, hash, val);
+			ht->count += 1;
+
+			if (
+				(ht->count * OHTAB_MAX_LOAD_DEN)
+				> (ht->table.size * OHTAB_MAX_LOAD_NUM)
+			) {
+				ohtab_grow (ht);
+			}
+
+			retval = 0;
+		}
+
+		(void) pthread_rwlock_unlock (ht->rwlock);
+	}
+
+	return retval;
+
+}
+
+// returns a ptr to the data associated with the key
+// returns NULL if no data was found
+void *ohtab_get (OHtab *ht, const void *key) {
+
+	void *retval = NULL;
+
+	if (ht && key) {
+		(void) pthread_rwlock_rdlock (ht->rwlock);
+
+		const u64 hash = ohtab_hash (ht, key);
+
+		long idx = ohtab_table_find (ht, &ht->table, key, hash);
+		if (idx >= 0) retval = ht->table.vals[idx];
+
+		else {
+			idx = ohtab_table_find (ht, &ht->old_table, key, hash);
+			if (idx >= 0) retval = ht->old_table.vals[idx];
+		}
+
+		(void) pthread_rwlock_unlock (ht->rwlock);
+	}
+
+	return retval;
+
+}
+
+// removes and returns the data associated with the key
+// the data should be deleted by the user
+// returns NULL if no data was found with the provided key
+void *ohtab_remove (OHtab *ht, const void *key) {
+
+	void *retval = NULL;
+
+	if (ht && key) {
+		(void) pthread_rwlock_wrlock (ht->rwlock);
+
+		if (ht->old_table.size) ohtab_rehash_step (ht, OHTAB_REHASH_STEP);
+
+		const u64 hash = ohtab_hash (ht, key);
+
+		long idx = ohtab_table_find (ht, &ht->table, key, hash);
+		if (idx >= 0) {
+			retval = ht->table.vals[idx];
+			ohtab_table_shift_remove (ht, &ht->table, (size_t) idx);
+
+			ht->count -= 1;
+		}
+
+		else {
+			// the old table is still being probed, so its slots are only marked
+			idx = ohtab_table_find (ht, &ht->old_table, key, hash);
+			if (idx >= 0) {
+				retval = ht->old_table.vals[idx];
+				ht->old_table.hashes[idx] = OHTAB_SLOT_REMOVED;
+				ht->old_table.vals[idx] = NULL;
+
+				ht->old_count -= 1;
+				ht->count -= 1;
+			}
+		}
+
+		(void) pthread_rwlock_unlock (ht->rwlock);
+	}
+
+	return retval;
+
+}
+
+void ohtab_destroy (OHtab *ht) {
+
+	if (ht) {
+		if (ht->delete_data) {
+			OHtabTable *tables[2] = { &ht->table, &ht->old_table };
+			for (unsigned int t = 0; t < 2; t++) {
+				for (size_t i = 0; i < tables[t]->size; i++) {
+					if (tables[t]->hashes[i] > OHTAB_SLOT_REMOVED)
+						ht->delete_data (tables[t]->vals[i]);
+				}
+			}
+		}
+
+		ohtab_delete (ht);
+	}
+
+}
@@ -1,15 +1,477 @@
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pthread.h>
 
 #include "cerver/collections/pool.h"
-#include "cerver/collections/dlist.h"
+
+typedef struct PoolThreadEntry {
+
+	uint64_t generation;
+	PoolCache *cache;
+
+} PoolThreadEntry;
+
+static Pool *pools[POOL_MAX_POOLS] = { 0 };
+static uint64_t pools_generation = 0;
+static pthread_mutex_t pools_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static _Thread_local PoolThreadEntry pool_thread_entries[POOL_MAX_POOLS];
+static _Thread_local bool pool_thread_registered = false;
+
+static pthread_key_t pool_thread_key;
+static pthread_once_t pool_thread_key_once = PTHREAD_ONCE_INIT;
 
 #pragma region internal
 
+// stats are only updated by the cache's owner
+// but can be read by any thread
+static inline void pool_stat_add (uint64_t *stat) {
+
+	__atomic_store_n (stat, *stat + 1, __ATOMIC_RELAXED);
+
+}
+
+static inline void pool_cache_update_n_elements (PoolCache *cache) {
+
+	__atomic_store_n (
+		&cache->n_elements,
+		(size_t) ((cache->loaded ? cache->loaded->n_elements : 0)
+			+ (cache->previous ? cache->previous->n_elements : 0)),
+		__ATOMIC_RELAXED
+	);
+
+}
+
+static void pool_stats_add (PoolStats *stats, const PoolStats *other) {
+
+	stats->hits += __atomic_load_n (&other->hits, __ATOMIC_RELAXED);
+	stats->misses += __atomic_load_n (&other->misses, __ATOMIC_RELAXED);
+	stats->pushes += __atomic_load_n (&other->pushes, __ATOMIC_RELAXED);
+	stats->released += __atomic_load_n (&other->released, __ATOMIC_RELAXED);
+
+}
+
+#pragma endregion
+
+#pragma region depot
+
+// gets an empty magazine from the depot or allocates a new one
+static PoolMagazine *pool_depot_get_empty (Pool *pool) {
+
+	(void) pthread_mutex_lock (&pool->depot_lock);
+
+	PoolMagazine *magazine = pool->empty;
+	if (magazine) {
+		pool->empty = magazine->next;
+		pool->depot_n_empty -= 1;
+	}
+
+	(void) pthread_mutex_unlock (&pool->depot_lock);
+
+	if (magazine) magazine->next = NULL;
+	else magazine = (PoolMagazine *) calloc (1, sizeof (PoolMagazine));
+
+	return magazine;
+
+}
+
+static void pool_depot_put_empty (Pool *pool, PoolMagazine *magazine) {
+
+	(void) pthread_mutex_lock (&pool->depot_lock);
+
+	if (pool->depot_n_empty < POOL_MAX_EMPTY_MAGAZINES) {
+		magazine->next = pool->empty;
+		pool->empty = magazine;
+		pool->depot_n_empty += 1;
+
+		magazine = NULL;
+	}
+
+	(void) pthread_mutex_unlock (&pool->depot_lock);
+
+	if (magazine) free (magazine);
+
+}
+
+// returns a magazine with at least one element, NULL if the depot is empty
+static PoolMagazine *pool_depot_get_full (Pool *pool) {
+
+	(void) pthread_mutex_lock (&pool->depot_lock);
+
+	PoolMagazine *magazine = pool->full;
+	if (magazine) {
+		pool->full = magazine->next;
+		pool->depot_n_elements -= magazine->n_elements;
+	}
+
+	(void) pthread_mutex_unlock (&pool->depot_lock);
+
+	if (magazine) magazine->next = NULL;
+
+	return magazine;
+
+}
+
+// keeps the magazine's elements if they fit in the pool's max retained
+// returns true if the magazine was kept
+static bool pool_depot_put_full (Pool *pool, PoolMagazine *magazine) {
+
+	bool retval = false;
+
+	(void) pthread_mutex_lock (&pool->depot_lock);
+
+	if (
+		!pool->max_retained
+		|| ((pool->depot_n_elements + magazine->n_elements) <= pool->max_retained)
+	) {
+		magazine->next = pool->full;
+		pool->full = magazine;
+		pool->depot_n_elements += magazine->n_elements;
+
+		retval = true;
+	}
+
+	(void) pthread_mutex_unlock (&pool->depot_lock);
+
+	return retval;
+
+}
+
+// inserts the data directly in the depot without checking its max retained
+// returns 0 on success, 1 on error
+static int pool_depot_insert (Pool *pool, void *data) {
+
+	int retval = 1;
+
+	(void) pthread_mutex_lock (&pool->depot_lock);
+
+	if (!pool->full || (pool->full->n_elements == POOL_MAGAZINE_SIZE)) {
+		PoolMagazine *magazine = pool->empty;
+		if (magazine) {
+			pool->empty = magazine->next;
+			pool->depot_n_empty -= 1;
+		}
+
+		else {
+			magazine = (PoolMagazine *) calloc (1, sizeof (PoolMagazine));
+		}
+
+		if (magazine) {
+			magazine->next = pool->full;
+			pool->full = magazine;
+		}
+	}
+
+	if (pool->full && (pool->full->n_elements < POOL_MAGAZINE_SIZE)) {
+		pool->full->elements[pool->full->n_elements] = data;
+		pool->full->n_elements += 1;
+		pool->depot_n_elements += 1;
+
+		retval = 0;
+	}
+
+	(void) pthread_mutex_unlock (&pool->depot_lock);
+
+	return retval;
+
+}
+
+static void pool_magazine_empty (Pool *pool, PoolMagazine *magazine, bool destroy) {
+
+	if (destroy && pool->destroy) {
+		for (unsigned int i = 0; i < magazine->n_elements; i++) {
+			pool->destroy (magazine->elements[i]);
+		}
+	}
+
+	magazine->n_elements = 0;
+
+}
+
+// gets rid of every element in the depot & frees its magazines
+static void pool_depot_empty (Pool *pool, bool destroy) {
+
+	(void) pthread_mutex_lock (&pool->depot_lock);
+
+	PoolMagazine *magazine = NULL;
+	while (pool->full) {
+		magazine = pool->full;
+		pool->full = magazine->next;
+
+		pool_magazine_empty (pool, magazine, destroy);
+		free (magazine);
+	}
+
+	while (pool->empty) {
+		magazine = pool->empty;
+		pool->empty = magazine->next;
+
+		free (magazine);
+	}
+
+	pool->depot_n_elements = 0;
+	pool->depot_n_empty = 0;
+
+	(void) pthread_mutex_unlock (&pool->depot_lock);
+
+}
+
+#pragma endregion
+
+#pragma region cache
+
+// returns the next element from the cache's magazines,
+// a full magazine is taken from the depot when both are empty
+static void *pool_cache_pop (Pool *pool, PoolCache *cache) {
+
+	void *data = NULL;
+
+	if (!cache->loaded || !cache->loaded->n_elements) {
+		if (cache->previous && cache->previous->n_elements) {
+			PoolMagazine *temp = cache->loaded;
+			cache->loaded = cache->previous;
+			cache->previous = temp;
+		}
+
+		else {
+			PoolMagazine *full = pool_depot_get_full (pool);
+			if (full) {
+				if (cache->previous) pool_depot_put_empty (pool, cache->previous);
+
+				cache->previous = cache->loaded;
+				cache->loaded = full;
+			}
+		}
+	}
+
+	if (cache->loaded && cache->loaded->n_elements) {
+		cache->loaded->n_elements -= 1;
+		data = cache->loaded->elements[cache->loaded->n_elements];
+
+		pool_stat_add (&cache->stats.hits);
+	}
+
+	else {
+		pool_stat_add (&cache->stats.misses);
+	}
+
+	pool_cache_update_n_elements (cache);
+
+	return data;
+
+}
+
+// adds the data to the cache's magazines,
+// a full magazine is moved to the depot when both are full
+// returns true if the data was kept
+static bool pool_cache_push (Pool *pool, PoolCache *cache, void *data) {
+
+	bool retval = false;
+
+	if (!cache->loaded) cache->loaded = pool_depot_get_empty (pool);
+
+	if (cache->loaded && (cache->loaded->n_elements == POOL_MAGAZINE_SIZE)) {
+		if (cache->previous && !cache->previous->n_elements) {
+			PoolMagazine *temp = cache->loaded;
+			cache->loaded = cache->previous;
+			cache->previous = temp;
+		}
+
+		else {
+			PoolMagazine *empty = pool_depot_get_empty (pool);
+			if (empty) {
+				if (!cache->previous || pool_depot_put_full (pool, cache->previous)) {
+					cache->previous = cache->loaded;
+					cache->loaded = empty;
+				}
+
+				// the depot already has its max retained elements
+				else {
+					pool_depot_put_empty (pool, empty);
+				}
+			}
+		}
+	}
+
+	if (cache->loaded && (cache->loaded->n_elements < POOL_MAGAZINE_SIZE)) {
+		cache->loaded->elements[cache->loaded->n_elements] = data;
+		cache->loaded->n_elements += 1;
+
+		pool_stat_add (&cache->stats.pushes);
+
+		retval = true;
+	}
+
+	else {
+		pool_stat_add (&cache->stats.released);
+	}
+
+	pool_cache_update_n_elements (cache);
+
+	return retval;
+
+}
+
+// gets rid of the cache's elements, its magazines are also freed if requested
+static void pool_cache_empty (
+	Pool *pool, PoolCache *cache, bool destroy, bool free_magazines
+) {
+
+	if (cache->loaded) pool_magazine_empty (pool, cache->loaded, destroy);
+	if (cache->previous) pool_magazine_empty (pool, cache->previous, destroy);
+
+	if (free_magazines) {
+		if (cache->loaded) free (cache->loaded);
+		if (cache->previous) free (cache->previous);
+
+		cache->loaded = NULL;
+		cache->previous = NULL;
+	}
+
+	pool_cache_update_n_elements (cache);
+
+}
+
+// moves the cache's elements to the depot before deleting it
+// the elements that don't fit in the depot are destroyed
+// must be called while holding the pools' lock
+static void pool_cache_release (Pool *pool, PoolCache *cache) {
+
+	for (PoolCache **prev = &pool->caches; *prev; prev = &(*prev)->next) {
+		if (*prev == cache) {
+			*prev = cache->next;
+			break;
+		}
+	}
+
+	PoolMagazine *magazines[2] = { cache->loaded, cache->previous };
+	for (unsigned int i = 0; i < 2; i++) {
+		if (magazines[i]) {
+			if (!magazines[i]->n_elements) {
+				pool_depot_put_empty (pool, magazines[i]);
+			}
+
+			else if (!pool_depot_put_full (pool, magazines[i])) {
+				pool_magazine_empty (pool, magazines[i], true);
+				free (magazines[i]);
+			}
+		}
+	}
+
+	pool_stats_add (&pool->stats, &cache->stats);
+
+	free (cache);
+
+}
+
+static void pool_thread_destroy (void *entries_ptr) {
+
+	(void) entries_ptr;
+
+	(void) pthread_mutex_lock (&pools_lock);
+
+	for (unsigned int i = 0; i < POOL_MAX_POOLS; i++) {
+		PoolThreadEntry *entry = &pool_thread_entries[i];
+		if (entry->cache) {
+			// the pool might have been deleted
+			if (pools[i] && (pools[i]->generation == entry->generation)) {
+				pool_cache_release (pools[i], entry->cache);
+			}
+
+			entry->generation = 0;
+			entry->cache = NULL;
+		}
+	}
+
+	(void) pthread_mutex_unlock (&pools_lock);
+
+	pool_thread_registered = false;
+
+}
+
+static void pool_thread_key_create (void) {
+
+	(void) pthread_key_create (&pool_thread_key, pool_thread_destroy);
+
+}
+
+// the key is only used to return the thread's elements when it exits
+static void pool_thread_register (void) {
+
+	(void) pthread_once (&pool_thread_key_once, pool_thread_key_create);
+	(void) pthread_setspecific (pool_thread_key, pool_thread_entries);
+
+	pool_thread_registered = true;
+
+}
+
+static PoolCache *pool_cache_register (Pool *pool, PoolThreadEntry *entry) {
+
+	PoolCache *cache = (PoolCache *) calloc (1, sizeof (PoolCache));
+	if (cache) {
+		(void) pthread_mutex_lock (&pools_lock);
+
+		cache->next = pool->caches;
+		pool->caches = cache;
+
+		(void) pthread_mutex_unlock (&pools_lock);
+
+		entry->generation = pool->generation;
+		entry->cache = cache;
+
+		if (!pool_thread_registered) pool_thread_register ();
+	}
+
+	return cache;
+
+}
+
+// returns the current thread's cache for the pool,
+// NULL if the pool's shared cache must be used
+static inline PoolCache *pool_cache_get (Pool *pool) {
+
+	PoolCache *cache = NULL;
+
+	if (pool->id) {
+		PoolThreadEntry *entry = &pool_thread_entries[pool->id - 1];
+		cache = (entry->generation == pool->generation) ?
+			entry->cache : pool_cache_register (pool, entry);
+	}
+
+	return cache;
+
+}
+
+// gets rid of every element in the pool
+// must be called while holding the pools' lock
+static void pool_empty (Pool *pool, bool destroy) {
+
+	for (PoolCache *cache = pool->caches; cache; cache = cache->next) {
+		pool_cache_empty (pool, cache, destroy, false);
+	}
+
+	(void) pthread_mutex_lock (&pool->shared_lock);
+	pool_cache_empty (pool, &pool->shared, destroy, false);
+	(void) pthread_mutex_unlock (&pool->shared_lock);
+
+	pool_depot_empty (pool, destroy);
+
+}
+
+#pragma endregion
+
+#pragma region main
+
 static Pool *pool_new (void) {
 
-	Pool *pool = (Pool *) malloc (sizeof (Pool));
+	Pool *pool = (Pool *) calloc (1, sizeof (Pool));
 	if (pool) {
-		pool->dlist = NULL;
+		pool->max_retained = POOL_DEFAULT_MAX_RETAINED;
+
+		(void) pthread_mutex_init (&pool->depot_lock, NULL);
+		(void) pthread_mutex_init (&pool->shared_lock, NULL);
 
 		pool->destroy = NULL;
 		pool->create = NULL;
@@ -21,7 +483,25 @@ static Pool *pool_new (void) {
 
 }
 
-#pragma endregion
+// assigns an id to the pool to be used by the threads' caches
+static void pool_register (Pool *pool) {
+
+	(void) pthread_mutex_lock (&pools_lock);
+
+	pools_generation += 1;
+	pool->generation = pools_generation;
+
+	for (unsigned int i = 0; i < POOL_MAX_POOLS; i++) {
+		if (!pools[i]) {
+			pools[i] = pool;
+			pool->id = i + 1;
+			break;
+		}
+	}
+
+	(void) pthread_mutex_unlock (&pools_lock);
+
+}
 
 // sets a destroy method to be used by the pool to correctly dispose data
 void pool_set_destroy (Pool *pool, void (*destroy)(void *data)) {
@@ -45,10 +525,34 @@ void pool_set_produce_if_empty (Pool *pool, bool produce) {
 
 }
 
+// sets the max n of elements kept in the pool's depot, 0 for no limit
+// each thread can also keep up to 2 * POOL_MAGAZINE_SIZE elements
+// elements pushed when the pool is full are destroyed
+void pool_set_max_retained (Pool *pool, size_t max_retained) {
+
+	if (pool) {
+		(void) pthread_mutex_lock (&pool->depot_lock);
+
+		pool->max_retained = max_retained;
+
+		(void) pthread_mutex_unlock (&pool->depot_lock);
+	}
+
+}
+
 // returns how many elements are inside the pool
 size_t pool_size (Pool *pool) {
 
-	return pool ? dlist_size (pool->dlist) : 0;
+	size_t size = 0;
+
+	if (pool) {
+		PoolStats stats = { 0 };
+		pool_get_stats (pool, &stats);
+
+		size = stats.n_elements;
+	}
+
+	return size;
 
 }
 
@@ -56,8 +560,9 @@ Pool *pool_create (void (*destroy)(void *data)) {
 
 	Pool *pool = pool_new ();
 	if (pool) {
-		pool->dlist = dlist_init (destroy, NULL);
 		pool->destroy = destroy;
+
+		pool_register (pool);
 	}
 
 	return pool;
@@ -78,12 +583,19 @@ int pool_init (
 		if (produce) {
 			int errors = 0;
 
+			void *data = NULL;
 			for (unsigned int i = 0; i < n_elements; i++) {
-				errors |= dlist_insert_after (
-					pool->dlist,
-					dlist_end (pool->dlist),
-					produce ()
-				);
+				data = produce ();
+				if (data) {
+					if (pool_depot_insert (pool, data)) {
+						if (pool->destroy) pool->destroy (data);
+						errors = 1;
+					}
+				}
+
+				else {
+					errors = 1;
+				}
 			}
 
 			retval = errors;
@@ -94,33 +606,54 @@ int pool_init (
 
 }
 
+// inserts the data in the current thread's cache
+// if the pool is full, the data is NOT kept & the caller still owns it
+// returns 0 on success, 1 on error
 int pool_push (Pool *pool, void *data) {
 
 	int retval = 1;
 
 	if (pool && data) {
-		retval = dlist_insert_after (
-			pool->dlist,
-			dlist_end (pool->dlist),
-			data
-		);
+		bool kept = false;
+
+		PoolCache *cache = pool_cache_get (pool);
+		if (cache) {
+			kept = pool_cache_push (pool, cache, data);
+		}
+
+		else {
+			(void) pthread_mutex_lock (&pool->shared_lock);
+			kept = pool_cache_push (pool, &pool->shared, data);
+			(void) pthread_mutex_unlock (&pool->shared_lock);
+		}
+
+		if (kept) retval = 0;
 	}
 
 	return retval;
 
 }
 
+// returns an element from the current thread's cache or from the pool's depot
+// elements are reused in LIFO order by each thread, so the last element
+// that a thread pushed is the first one it gets, instead of the oldest one
 void *pool_pop (Pool *pool) {
 
 	void *retval = NULL;
 
 	if (pool) {
-		retval = dlist_remove_element (
-			pool->dlist,
-			NULL
-		);
+		PoolCache *cache = pool_cache_get (pool);
+		if (cache) {
+			retval = pool_cache_pop (pool, cache);
+		}
 
-		if (!retval && pool->produce) {
+		else {
+			(void) pthread_mutex_lock (&pool->shared_lock);
+			retval = pool_cache_pop (pool, &pool->shared);
+			(void) pthread_mutex_unlock (&pool->shared_lock);
+		}
+
+		if (!retval && pool->produce && pool->create) {
 			retval = pool->create ();
 		}
 	}
@@ -129,21 +662,62 @@ void *pool_pop (Pool *pool) {
 
 }
 
-// only gets rid of the list elements, but the data is kept
+// gets the pool's stats adding the ones of every thread
+void pool_get_stats (Pool *pool, PoolStats *stats) {
+
+	if (pool && stats) {
+		PoolStats values = { 0 };
+
+		(void) pthread_mutex_lock (&pools_lock);
+
+		pool_stats_add (&values, &pool->stats);
+
+		for (PoolCache *cache = pool->caches; cache; cache = cache->next) {
+			values.n_elements += __atomic_load_n (&cache->n_elements, __ATOMIC_RELAXED);
+			pool_stats_add (&values, &cache->stats);
+		}
+
+		(void) pthread_mutex_unlock (&pools_lock);
+
+		(void) pthread_mutex_lock (&pool->shared_lock);
+		values.n_elements += pool->shared.n_elements;
+		pool_stats_add (&values, &pool->shared.stats);
+		(void) pthread_mutex_unlock (&pool->shared_lock);
+
+		(void) pthread_mutex_lock (&pool->depot_lock);
+		values.n_elements += pool->depot_n_elements;
+		(void) pthread_mutex_unlock (&pool->depot_lock);
+
+		*stats = values;
+	}
+
+}
+
+// only gets rid of the pool's elements, but the data is kept
 // this is usefull if another structure points to the same data
+// must not be called while other threads use the pool
 void pool_clear (Pool *pool) {
 
 	if (pool) {
-		dlist_clear (pool->dlist);
+		(void) pthread_mutex_lock (&pools_lock);
+
+		pool_empty (pool, false);
+
+		(void) pthread_mutex_unlock (&pools_lock);
 	}
 
 }
 
-// destroys all of the dlist's elements and their data but keeps the pool
+// destroys all of the pool's elements and their data but keeps the pool
+// must not be called while other threads use the pool
 void pool_reset (Pool *pool) {
 
 	if (pool) {
-		dlist_reset (pool->dlist);
+		(void) pthread_mutex_lock (&pools_lock);
+
+		pool_empty (pool, true);
+
+		(void) pthread_mutex_unlock (&pools_lock);
 	}
 
 }
@@ -152,9 +726,32 @@ void pool_reset (Pool *pool) {
 void pool_delete (Pool *pool) {
 
 	if (pool) {
-		dlist_delete (pool->dlist);
+		(void) pthread_mutex_lock (&pools_lock);
+
+		if (pool->id) pools[pool->id - 1] = NULL;
+
+		// the threads' entries are invalidated by the pool's generation
+		PoolCache *cache = NULL;
+		while (pool->caches) {
+			cache = pool->caches;
+			pool->caches = cache->next;
+
+			pool_cache_empty (pool, cache, true, true);
+			free (cache);
+		}
+
+		(void) pthread_mutex_unlock (&pools_lock);
+
+		pool_cache_empty (pool, &pool->shared, true, true);
+
+		pool_depot_empty (pool, true);
+
+		(void) pthread_mutex_destroy (&pool->depot_lock);
+		(void) pthread_mutex_destroy (&pool->shared_lock);
 
 		free (pool);
 	}
 
-}
\ No newline at end of file
+}
+
+#pragma endregion
\ No newline at end of file
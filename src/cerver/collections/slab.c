@@ -0,0 +1,249 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <pthread.h>
+
+#include "cerver/collections/slab.h"
+
+#include "cerver/utils/log.h"
+
+// thread local counters are added to the slab's ones after this many allocations
+#define SLAB_STATS_FLUSH					256
+
+typedef struct SlabCache {
+
+	void *head;                 // free objects linked using their first word
+	size_t n_free;
+
+	uint64_t hits;
+	uint64_t misses;
+
+} SlabCache;
+
+static size_t slabs_max_free = SLAB_DEFAULT_MAX_FREE;
+
+static Slab *slabs[SLAB_MAX_SLABS] = { 0 };
+static unsigned int n_slabs = 0;
+static pthread_mutex_t slabs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static _Thread_local SlabCache slab_caches[SLAB_MAX_SLABS];
+static _Thread_local bool slab_thread_registered = false;
+
+static pthread_key_t slab_thread_key;
+static pthread_once_t slab_thread_key_once = PTHREAD_ONCE_INIT;
+
+#pragma region internal
+
+static void slab_cache_flush_stats (Slab *slab, SlabCache *cache) {
+
+	(void) __atomic_add_fetch (&slab->hits, cache->hits, __ATOMIC_RELAXED);
+	(void) __atomic_add_fetch (&slab->misses, cache->misses, __ATOMIC_RELAXED);
+
+	cache->hits = 0;
+	cache->misses = 0;
+
+}
+
+static void slab_thread_destroy (void *caches_ptr) {
+
+	(void) caches_ptr;
+
+	slab_thread_cleanup ();
+
+}
+
+static void slab_thread_key_create (void) {
+
+	(void) pthread_key_create (&slab_thread_key, slab_thread_destroy);
+
+}
+
+// the key is only used to release the thread's free objects when it exits
+static void slab_thread_register (void) {
+
+	(void) pthread_once (&slab_thread_key_once, slab_thread_key_create);
+	(void) pthread_setspecific (slab_thread_key, slab_caches);
+
+	slab_thread_registered = true;
+
+}
+
+// assigns an id to the slab the first time it is used
+static unsigned int slab_register (Slab *slab) {
+
+	unsigned int id = 0;
+
+	(void) pthread_mutex_lock (&slabs_lock);
+
+	id = slab->id;
+	if (!id) {
+		if (n_slabs < SLAB_MAX_SLABS) {
+			slabs[n_slabs] = slab;
+			n_slabs += 1;
+			id = n_slabs;
+		}
+
+		else {
+			// slabs without a free list always use malloc ()
+			id = SLAB_MAX_SLABS + 1;
+		}
+
+		__atomic_store_n (&slab->id, id, __ATOMIC_RELEASE);
+	}
+
+	(void) pthread_mutex_unlock (&slabs_lock);
+
+	return id;
+
+}
+
+static inline SlabCache *slab_cache_get (Slab *slab) {
+
+	SlabCache *cache = NULL;
+
+	unsigned int id = __atomic_load_n (&slab->id, __ATOMIC_ACQUIRE);
+	if (!id) id = slab_register (slab);
+
+	if (id <= SLAB_MAX_SLABS) {
+		if (!slab_thread_registered) slab_thread_register ();
+
+		cache = &slab_caches[id - 1];
+	}
+
+	return cache;
+
+}
+
+#pragma endregion
+
+#pragma region public
+
+// sets the max n of free objects that each thread keeps for every slab
+// objects that are freed when the list is full are released with free ()
+// a value of 0 disables the free lists
+void slabs_set_max_free (size_t max_free) {
+
+	__atomic_store_n (&slabs_max_free, max_free, __ATOMIC_RELAXED);
+
+}
+
+// returns the max n of free objects that each thread keeps for every slab
+size_t slabs_get_max_free (void) {
+
+	return __atomic_load_n (&slabs_max_free, __ATOMIC_RELAXED);
+
+}
+
+// returns a new object from the current thread's free list or from malloc ()
+void *slab_alloc (Slab *slab) {
+
+	void *obj = NULL;
+
+	SlabCache *cache = slab_cache_get (slab);
+	if (cache) {
+		if (cache->head) {
+			obj = cache->head;
+			cache->head = *(void **) obj;
+			cache->n_free -= 1;
+
+			cache->hits += 1;
+		}
+
+		else {
+			obj = malloc (slab->obj_size);
+
+			cache->misses += 1;
+		}
+
+		if ((cache->hits + cache->misses) >= SLAB_STATS_FLUSH)
+			slab_cache_flush_stats (slab, cache);
+	}
+
+	else {
+		obj = malloc (slab->obj_size);
+
+		(void) __atomic_add_fetch (&slab->misses, 1, __ATOMIC_RELAXED);
+	}
+
+	return obj;
+
+}
+
+// keeps the object in the current thread's free list to be reused,
+// or releases it if the list is full
+void slab_free (Slab *slab, void *obj) {
+
+	if (obj) {
+		SlabCache *cache = slab_cache_get (slab);
+		if (cache && (cache->n_free < slabs_get_max_free ())) {
+			*(void **) obj = cache->head;
+			cache->head = obj;
+			cache->n_free += 1;
+		}
+
+		else {
+			free (obj);
+		}
+	}
+
+}
+
+// returns the n of allocations that were served from a free list
+uint64_t slab_get_hits (Slab *slab) {
+
+	return slab ? __atomic_load_n (&slab->hits, __ATOMIC_RELAXED) : 0;
+
+}
+
+// returns the n of allocations that required malloc ()
+uint64_t slab_get_misses (Slab *slab) {
+
+	return slab ? __atomic_load_n (&slab->misses, __ATOMIC_RELAXED) : 0;
+
+}
+
+// releases the free objects kept by the current thread
+// this is done automatically for threads that are not the main one
+void slab_thread_cleanup (void) {
+
+	(void) pthread_mutex_lock (&slabs_lock);
+	unsigned int count = n_slabs;
+	(void) pthread_mutex_unlock (&slabs_lock);
+
+	void *next = NULL;
+	for (unsigned int i = 0; i < count; i++) {
+		SlabCache *cache = &slab_caches[i];
+
+		while (cache->head) {
+			next = *(void **) cache->head;
+			free (cache->head);
+			cache->head = next;
+		}
+
+		cache->n_free = 0;
+
+		slab_cache_flush_stats (slabs[i], cache);
+	}
+
+}
+
+// prints the hits & misses of every slab that has been used
+void slabs_stats_print (void) {
+
+	(void) pthread_mutex_lock (&slabs_lock);
+
+	cerver_log_msg ("Slabs (max free per thread: %lu):", slabs_get_max_free ());
+	for (unsigned int i = 0; i < n_slabs; i++) {
+		cerver_log_msg (
+			"\t%s (%lu bytes) - hits: %lu - misses: %lu",
+			slabs[i]->name, slabs[i]->obj_size,
+			slab_get_hits (slabs[i]), slab_get_misses (slabs[i])
+		);
+	}
+
+	(void) pthread_mutex_unlock (&slabs_lock);
+
+}
+
+#pragma endregion
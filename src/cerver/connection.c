@@ -3,23 +3,34 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include <errno.h>
 #include <unistd.h>
 #include <time.h>
 
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <netinet/in.h>
+
+#include <linux/errqueue.h>
+
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
-#include "cerver/collections/htab.h"
+#include "cerver/collections/ohtab.h"
 #include "cerver/collections/dlist.h"
 
 #include "cerver/admin.h"
 #include "cerver/auth.h"
 #include "cerver/cerver.h"
 #include "cerver/client.h"
+#include "cerver/fdtable.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/reactor.h"
 #include "cerver/socket.h"
+#include "cerver/wheel.h"
 
 #include "cerver/threads/thread.h"
 
@@ -68,6 +79,9 @@ void connection_stats_print (Connection *connection) {
 			cerver_log_msg ("N packets received:        %ld", connection->stats->n_packets_received);
 			cerver_log_msg ("N packets sent:            %ld", connection->stats->n_packets_sent);
 
+			cerver_log_msg ("Total bytes zerocopy:      %ld", connection->stats->total_bytes_zerocopy);
+			cerver_log_msg ("N zerocopy copied:         %ld", connection->stats->n_zerocopy_copied);
+
 			cerver_log_msg ("\nReceived packets:");
 			packets_per_type_print (connection->stats->received_packets);
 
@@ -94,6 +108,706 @@ void connection_stats_print (Connection *connection) {
 
 #pragma endregion
 
+#pragma region send
+
+ConnectionSendQueue *connection_send_queue_create (
+	Cerver *cerver,
+	const size_t low_watermark, const size_t high_watermark
+) {
+
+	ConnectionSendQueue *send_queue = (ConnectionSendQueue *) malloc (sizeof (ConnectionSendQueue));
+	if (send_queue) {
+		// the buffer is only allocated the first time it is needed
+		send_queue->buffer = NULL;
+		send_queue->buffer_size = 0;
+
+		send_queue->start = 0;
+		send_queue->end = 0;
+
+		send_queue->low_watermark = low_watermark;
+		send_queue->high_watermark = high_watermark;
+
+		send_queue->congested = false;
+		send_queue->dropped = false;
+
+		send_queue->writable = false;
+
+		send_queue->coalesce = false;
+		send_queue->dirty = false;
+
+		send_queue->cerver = cerver;
+	}
+
+	return send_queue;
+
+}
+
+void connection_send_queue_delete (void *send_queue_ptr) {
+
+	if (send_queue_ptr) {
+		ConnectionSendQueue *send_queue = (ConnectionSendQueue *) send_queue_ptr;
+
+		if (send_queue->buffer) free (send_queue->buffer);
+
+		free (send_queue);
+	}
+
+}
+
+static inline size_t connection_send_queue_pending (
+	const ConnectionSendQueue *send_queue
+) {
+
+	return send_queue->end - send_queue->start;
+
+}
+
+// makes room for n more bytes after the pending ones
+// returns 0 on success, 1 on error
+static u8 connection_send_queue_reserve (
+	ConnectionSendQueue *send_queue, const size_t n
+) {
+
+	u8 retval = 0;
+
+	if ((send_queue->end + n) > send_queue->buffer_size) {
+		size_t pending = connection_send_queue_pending (send_queue);
+
+		// move the pending bytes to the start of the buffer
+		if (send_queue->start) {
+			if (pending) {
+				(void) memmove (
+					send_queue->buffer,
+					send_queue->buffer + send_queue->start,
+					pending
+				);
+			}
+
+			send_queue->start = 0;
+			send_queue->end = pending;
+		}
+
+		if ((pending + n) > send_queue->buffer_size) {
+			size_t new_size = send_queue->buffer_size ?
+				send_queue->buffer_size : CONNECTION_DEFAULT_SEND_QUEUE_SIZE;
+			while (new_size < (pending + n)) new_size *= 2;
+
+			char *buffer = (char *) realloc (send_queue->buffer, new_size);
+			if (buffer) {
+				send_queue->buffer = buffer;
+				send_queue->buffer_size = new_size;
+			}
+
+			else {
+				retval = 1;
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+// copies the buffers' remaining bytes after the pending ones
+// returns 0 on success, 1 on error
+static u8 connection_send_queue_push (
+	ConnectionSendQueue *send_queue,
+	const struct iovec *iov, unsigned int iov_count, const size_t size
+) {
+
+	u8 retval = 1;
+
+	if (!connection_send_queue_reserve (send_queue, size)) {
+		for (unsigned int i = 0; i < iov_count; i++) {
+			if (iov[i].iov_len) {
+				(void) memcpy (
+					send_queue->buffer + send_queue->end,
+					iov[i].iov_base, iov[i].iov_len
+				);
+
+				send_queue->end += iov[i].iov_len;
+			}
+		}
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// discards the pending bytes & shuts down the connection's socket,
+// so that the cerver's poll ends the connection
+static void connection_send_queue_drop (Connection *connection) {
+
+	ConnectionSendQueue *send_queue = connection->send_queue;
+
+	cerver_log (
+		LOG_TYPE_WARNING, LOG_TYPE_CONNECTION,
+		"Dropping connection with sock fd <%d> - %lu bytes are waiting to be sent!",
+		connection->socket->sock_fd, connection_send_queue_pending (send_queue)
+	);
+
+	send_queue->start = 0;
+	send_queue->end = 0;
+
+	send_queue->congested = false;
+	send_queue->dropped = true;
+
+	(void) shutdown (connection->socket->sock_fd, SHUT_RDWR);
+
+}
+
+// registers the sock fd to wait until it is writable
+// only when it is not already waiting
+static void connection_send_queue_set_writable (
+	Connection *connection, bool writable
+) {
+
+	ConnectionSendQueue *send_queue = connection->send_queue;
+
+	if (send_queue->writable != writable) {
+		if (!cerver_poll_set_writable (send_queue->cerver, connection, writable))
+			send_queue->writable = writable;
+	}
+
+}
+
+// returns the n of bytes waiting in the connection's send queue
+size_t connection_send_queue_get_pending (
+	const Connection *connection
+) {
+
+	size_t pending = 0;
+
+	if (connection) {
+		if (connection->send_queue)
+			pending = connection_send_queue_pending (connection->send_queue);
+	}
+
+	return pending;
+
+}
+
+// returns true if the connection has more bytes waiting to be sent
+// than its send queue low watermark
+// the application should stop sending data to the connection until
+// it is no longer congested to avoid it being dropped
+bool connection_is_congested (
+	const Connection *connection
+) {
+
+	bool congested = false;
+
+	if (connection) {
+		if (connection->send_queue)
+			congested = connection->send_queue->congested;
+	}
+
+	return congested;
+
+}
+
+// sends the buffers to the connection without blocking
+// anything that can't be sent is added to the connection's send queue
+// and the connection's sock fd is registered to wait until it is writable
+// the connection is dropped if its pending bytes exceed the high watermark
+// the socket's write mutex must be locked
+// returns 0 on success, 1 on error
+u8 connection_send_queue_send (
+	Connection *connection,
+	struct iovec *iov, unsigned int iov_count,
+	int flags, size_t *total_sent
+) {
+
+	u8 retval = 1;
+
+	ConnectionSendQueue *send_queue = connection->send_queue;
+	size_t actual_sent = 0;
+
+	if (!send_queue->dropped) {
+		bool was_empty = !connection_send_queue_pending (send_queue);
+
+		// coalesced bytes are sent when the connection is flushed
+		// & any pending bytes need to be sent first
+		if (send_queue->coalesce || !was_empty) retval = 0;
+
+		else if (!packet_send_iov (
+			connection->socket, iov, iov_count,
+			flags | MSG_DONTWAIT, &actual_sent
+		)) retval = 0;
+
+		// the socket's buffer is full
+		else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) retval = 0;
+
+		if (!retval) {
+			size_t size = 0;
+			for (unsigned int i = 0; i < iov_count; i++) size += iov[i].iov_len;
+
+			if (size) {
+				if (
+					((connection_send_queue_pending (send_queue) + size) > send_queue->high_watermark)
+					|| connection_send_queue_push (send_queue, iov, iov_count, size)
+				) {
+					connection_send_queue_drop (connection);
+					retval = 1;
+				}
+
+				else {
+					actual_sent += size;
+
+					send_queue->congested = (
+						connection_send_queue_pending (send_queue) > send_queue->low_watermark
+					);
+
+					if (send_queue->coalesce) {
+						if (send_queue->cerver) {
+							cerver_stats_add (send_queue->cerver->stats, CERVER_STATS_N_COALESCED_SENDS, 1);
+							cerver_stats_add (send_queue->cerver->stats, CERVER_STATS_COALESCED_BYTES, size);
+						}
+
+						if (!send_queue->dirty) {
+							send_queue->dirty = !cerver_coalesce_push (
+								send_queue->cerver, connection
+							);
+						}
+					}
+
+					else {
+						connection_send_queue_set_writable (connection, true);
+					}
+				}
+			}
+		}
+	}
+
+	if (total_sent) *total_sent = actual_sent;
+
+	return retval;
+
+}
+
+// sends as many pending bytes as possible without blocking,
+// used when the connection's sock fd is reported as writable
+// returns 0 on success, 1 on error
+u8 connection_send_queue_flush (
+	Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (connection) {
+		if (connection->send_queue) {
+			ConnectionSendQueue *send_queue = connection->send_queue;
+
+			(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+			send_queue->dirty = false;
+
+			size_t pending = connection_send_queue_pending (send_queue);
+			if (pending) {
+				if (send_queue->coalesce && send_queue->cerver) {
+					cerver_stats_add (send_queue->cerver->stats, CERVER_STATS_N_COALESCED_FLUSHES, 1);
+				}
+
+				struct iovec iov = {
+					.iov_base = send_queue->buffer + send_queue->start,
+					.iov_len = pending
+				};
+
+				size_t sent = 0;
+				if (!packet_send_iov (
+					connection->socket, &iov, 1, MSG_DONTWAIT, &sent
+				)) {
+					retval = 0;
+				}
+
+				else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+					retval = 0;
+				}
+
+				send_queue->start += sent;
+
+				// the connection is broken, so the pending bytes are discarded
+				if (retval) send_queue->start = send_queue->end;
+
+				if (send_queue->start == send_queue->end) {
+					send_queue->start = 0;
+					send_queue->end = 0;
+				}
+
+				send_queue->congested = (
+					connection_send_queue_pending (send_queue) > send_queue->low_watermark
+				);
+			}
+
+			else {
+				retval = 0;
+			}
+
+			// only wait for the sock fd to be writable while bytes are pending
+			connection_send_queue_set_writable (
+				connection, connection_send_queue_pending (send_queue) > 0
+			);
+
+			(void) pthread_mutex_unlock (connection->socket->write_mutex);
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region zerocopy
+
+static ConnectionZeroCopyBuffer *connection_zerocopy_buffer_new (void) {
+
+	ConnectionZeroCopyBuffer *buffer = (ConnectionZeroCopyBuffer *) malloc (sizeof (ConnectionZeroCopyBuffer));
+	if (buffer) {
+		buffer->first_id = 0;
+		buffer->n_sends = 0;
+		buffer->n_pending = 0;
+
+		buffer->data = NULL;
+		buffer->data_delete = NULL;
+	}
+
+	return buffer;
+
+}
+
+static void connection_zerocopy_buffer_delete (void *buffer_ptr) {
+
+	if (buffer_ptr) {
+		ConnectionZeroCopyBuffer *buffer = (ConnectionZeroCopyBuffer *) buffer_ptr;
+
+		if (buffer->data && buffer->data_delete)
+			buffer->data_delete (buffer->data);
+
+		free (buffer);
+	}
+
+}
+
+ConnectionZeroCopy *connection_zerocopy_create (void) {
+
+	ConnectionZeroCopy *zerocopy = (ConnectionZeroCopy *) malloc (sizeof (ConnectionZeroCopy));
+	if (zerocopy) {
+		zerocopy->enabled = false;
+		zerocopy->next_id = 0;
+
+		zerocopy->buffers = dlist_init (connection_zerocopy_buffer_delete, NULL);
+	}
+
+	return zerocopy;
+
+}
+
+// releases every pending payload
+void connection_zerocopy_delete (void *zerocopy_ptr) {
+
+	if (zerocopy_ptr) {
+		ConnectionZeroCopy *zerocopy = (ConnectionZeroCopy *) zerocopy_ptr;
+
+		dlist_delete (zerocopy->buffers);
+
+		free (zerocopy);
+	}
+
+}
+
+// returns the n of payloads sent using MSG_ZEROCOPY
+// that the kernel has not released yet
+size_t connection_zerocopy_get_pending (
+	const Connection *connection
+) {
+
+	size_t pending = 0;
+
+	if (connection) {
+		if (connection->zerocopy)
+			pending = connection->zerocopy->buffers->size;
+	}
+
+	return pending;
+
+}
+
+// creates the connection's zerocopy state & enables SO_ZEROCOPY in its sock fd
+// if the socket does not support it, every payload is copied
+static ConnectionZeroCopy *connection_zerocopy_get (Connection *connection) {
+
+	if (!connection->zerocopy) {
+		connection->zerocopy = connection_zerocopy_create ();
+		if (connection->zerocopy) {
+			int enable = 1;
+			connection->zerocopy->enabled = !setsockopt (
+				connection->socket->sock_fd,
+				SOL_SOCKET, SO_ZEROCOPY,
+				&enable, sizeof (int)
+			);
+		}
+	}
+
+	return connection->zerocopy;
+
+}
+
+// the kernel reports the ids of the completed zerocopy sends as a range
+static void connection_zerocopy_complete (
+	ConnectionZeroCopy *zerocopy, const u32 lo, const u32 hi
+) {
+
+	ConnectionZeroCopyBuffer *buffer = NULL;
+	ListElement *le = dlist_start (zerocopy->buffers);
+	ListElement *next = NULL;
+	while (le) {
+		next = le->next;
+
+		buffer = (ConnectionZeroCopyBuffer *) le->data;
+		for (u32 i = 0; i < buffer->n_sends; i++) {
+			if ((u32) (buffer->first_id + i - lo) <= (u32) (hi - lo))
+				buffer->n_pending -= 1;
+		}
+
+		if (!buffer->n_pending) {
+			connection_zerocopy_buffer_delete (
+				dlist_remove_element_unsafe (zerocopy->buffers, le)
+			);
+		}
+
+		le = next;
+	}
+
+}
+
+// the socket's write mutex must be locked
+static u8 connection_zerocopy_handle_completions_actual (
+	Connection *connection
+) {
+
+	u8 retval = 0;
+
+	ConnectionZeroCopy *zerocopy = connection->zerocopy;
+
+	char control[128] = { 0 };
+	struct msghdr msg = { 0 };
+	struct cmsghdr *cmsg = NULL;
+	struct sock_extended_err *serr = NULL;
+	for (;;) {
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof (control);
+
+		if (recvmsg (
+			connection->socket->sock_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT
+		) < 0) {
+			if (errno == EINTR) continue;
+
+			// the error queue has been drained
+			break;
+		}
+
+		for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+			if (
+				((cmsg->cmsg_level == SOL_IP) && (cmsg->cmsg_type == IP_RECVERR))
+				|| ((cmsg->cmsg_level == SOL_IPV6) && (cmsg->cmsg_type == IPV6_RECVERR))
+			) {
+				serr = (struct sock_extended_err *) CMSG_DATA (cmsg);
+				if (serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+					if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+						connection->stats->n_zerocopy_copied += 1;
+
+					connection_zerocopy_complete (
+						zerocopy, serr->ee_info, serr->ee_data
+					);
+				}
+
+				else {
+					retval = 1;
+				}
+			}
+		}
+	}
+
+	// check that the socket does not have a pending error
+	int error = 0;
+	socklen_t len = sizeof (int);
+	if (getsockopt (connection->socket->sock_fd, SOL_SOCKET, SO_ERROR, &error, &len) || error) {
+		retval = 1;
+	}
+
+	return retval;
+
+}
+
+// reads the connection's socket error queue & releases
+// every payload whose zerocopy sends have been completed
+// this is done by the cerver when its poll reports an error in the sock fd
+// & before each zerocopy send to the connection
+// returns 0 if the error queue only had zerocopy completions, 1 on a socket error
+u8 connection_zerocopy_handle_completions (
+	Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (connection) {
+		if (connection->zerocopy) {
+			(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+			retval = connection_zerocopy_handle_completions_actual (connection);
+
+			(void) pthread_mutex_unlock (connection->socket->write_mutex);
+		}
+	}
+
+	return retval;
+
+}
+
+// sends the buffer until it has been completely sent or an error occurs
+// each successful MSG_ZEROCOPY send gets the next id from the kernel
+static u8 connection_zerocopy_send_buffer (
+	Connection *connection, ConnectionZeroCopy *zerocopy,
+	const char *buffer, const size_t buffer_size,
+	int flags, size_t *actual_sent, u32 *n_sends
+) {
+
+	u8 retval = 0;
+
+	ssize_t sent = 0;
+	while (*actual_sent < buffer_size) {
+		sent = send (
+			connection->socket->sock_fd,
+			buffer + *actual_sent, buffer_size - *actual_sent,
+			flags
+		);
+
+		if (sent > 0) {
+			*actual_sent += (size_t) sent;
+
+			if (flags & MSG_ZEROCOPY) {
+				zerocopy->next_id += 1;
+				*n_sends += 1;
+			}
+		}
+
+		else if ((sent < 0) && (errno == EINTR)) continue;
+
+		// the socket's optmem limit has been reached,
+		// so the remaining bytes are copied
+		else if ((sent < 0) && (errno == ENOBUFS) && (flags & MSG_ZEROCOPY)) {
+			flags &= ~MSG_ZEROCOPY;
+		}
+
+		else {
+			// nothing was sent & errno was not set by send ()
+			if (!sent) errno = 0;
+
+			retval = 1;
+			break;
+		}
+	}
+
+	return retval;
+
+}
+
+// sends the header (copied) & then the data using MSG_ZEROCOPY
+// data_delete () is called with the data when the kernel no longer uses it,
+// or right away if the data had to be copied, even if the send fails
+// connections with a send queue never block & queue what can't be sent
+// the socket's write mutex must be locked
+// returns 0 on success, 1 on error
+u8 connection_zerocopy_send (
+	Connection *connection,
+	const void *header, const size_t header_size,
+	void *data, const size_t data_size, Action data_delete,
+	size_t *total_sent
+) {
+
+	u8 retval = 0;
+
+	ConnectionZeroCopy *zerocopy = connection_zerocopy_get (connection);
+	ConnectionSendQueue *send_queue = connection->send_queue;
+
+	size_t header_sent = 0;
+	size_t data_sent = 0;
+	size_t queued = 0;
+	u32 n_sends = 0;
+
+	if (zerocopy) (void) connection_zerocopy_handle_completions_actual (connection);
+
+	// coalesced & pending bytes need to be sent first, so the payload is copied
+	if (
+		zerocopy && zerocopy->enabled
+		&& (
+			!send_queue
+			|| (!send_queue->coalesce && !send_queue->dropped && !connection_send_queue_pending (send_queue))
+		)
+	) {
+		int flags = send_queue ? MSG_DONTWAIT : 0;
+
+		retval = connection_zerocopy_send_buffer (
+			connection, zerocopy,
+			(const char *) header, header_size,
+			flags | MSG_MORE, &header_sent, &n_sends
+		);
+
+		if (!retval) {
+			retval = connection_zerocopy_send_buffer (
+				connection, zerocopy,
+				(const char *) data, data_size,
+				flags | MSG_ZEROCOPY, &data_sent, &n_sends
+			);
+		}
+
+		connection->stats->total_bytes_zerocopy += data_sent;
+
+		// the socket's buffer is full
+		if (retval && send_queue && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+			retval = 0;
+	}
+
+	// the remaining bytes are copied & sent as any other packet
+	if (!retval && ((header_sent + data_sent) < (header_size + data_size))) {
+		struct iovec iov[2] = {
+			{ .iov_base = (char *) header + header_sent, .iov_len = header_size - header_sent },
+			{ .iov_base = (char *) data + data_sent, .iov_len = data_size - data_sent }
+		};
+
+		retval = send_queue ?
+			connection_send_queue_send (connection, iov, 2, 0, &queued) :
+			packet_send_iov (connection->socket, iov, 2, 0, &queued);
+	}
+
+	// the payload is only kept while the kernel uses its pages
+	ConnectionZeroCopyBuffer *buffer = NULL;
+	if (n_sends && (buffer = connection_zerocopy_buffer_new ())) {
+		buffer->first_id = zerocopy->next_id - n_sends;
+		buffer->n_sends = n_sends;
+		buffer->n_pending = n_sends;
+
+		buffer->data = data;
+		buffer->data_delete = data_delete;
+
+		(void) dlist_insert_at_end_unsafe (zerocopy->buffers, buffer);
+	}
+
+	else if (data && data_delete) {
+		data_delete (data);
+	}
+
+	if (total_sent) *total_sent = header_sent + data_sent + queued;
+
+	return retval;
+
+}
+
+#pragma endregion
+
 #pragma region main
 
 Connection *connection_new (void) {
@@ -103,6 +817,7 @@ Connection *connection_new (void) {
 		connection->name = NULL;
 
 		connection->socket = NULL;
+		connection->reactor = NULL;
 		connection->port = 0;
 		connection->protocol = CONNECTION_DEFAULT_PROTOCOL;
 		connection->use_ipv6 = CONNECTION_DEFAULT_USE_IPV6;
@@ -145,51 +860,102 @@ Connection *connection_new (void) {
 		connection->delete_auth_data = NULL;
 		connection->admin_auth = false;
 		connection->auth_packet = NULL;
+		wheel_timer_init (&connection->on_hold_timer, NULL, NULL);
 
 		connection->stats = NULL;
 
+		connection->send_queue = NULL;
+
+		connection->zerocopy = NULL;
+
 		connection->cond = NULL;
 		connection->mutex = NULL;
+
+		connection->references = 1;
+		connection->cerver = NULL;
 	}
 
 	return connection;
 
 }
 
-void connection_delete (void *ptr) {
+static void connection_delete_actual (Connection *connection) {
 
-	if (ptr) {
-		Connection *connection = (Connection *) ptr;
+	str_delete (connection->name);
 
-		str_delete (connection->name);
+	// move the socket to the cerver's socket pool to avoid destroying it
+	// to handle if any other thread is waiting to access the socket's mutex
+	// a socket that the pool can't keep is not destroyed either
+	if (connection->cerver) {
+		(void) cerver_sockets_pool_push (connection->cerver, connection->socket);
+		connection->socket = NULL;
+	}
 
-		socket_delete (connection->socket);
+	socket_delete (connection->socket);
 
-		if (connection->active) connection_end (connection);
+	if (connection->active) connection_end (connection);
 
-		str_delete (connection->ip);
+	str_delete (connection->ip);
 
-		cerver_report_delete (connection->cerver_report);
+	cerver_report_delete (connection->cerver_report);
 
-		sock_receive_delete (connection->sock_receive);
+	sock_receive_delete (connection->sock_receive);
 
-		if (connection->received_data && connection->received_data_delete)
-			connection->received_data_delete (connection->received_data);
+	if (connection->received_data && connection->received_data_delete)
+		connection->received_data_delete (connection->received_data);
 
-		if (connection->custom_receive_args) {
-			if (connection->custom_receive_args_delete) {
-				connection->custom_receive_args_delete (connection->custom_receive_args);
-			}
+	if (connection->custom_receive_args) {
+		if (connection->custom_receive_args_delete) {
+			connection->custom_receive_args_delete (connection->custom_receive_args);
 		}
+	}
 
-		connection_remove_auth_data (connection);
+	connection_remove_auth_data (connection);
+
+	connection_stats_delete (connection->stats);
+
+	connection_send_queue_delete (connection->send_queue);
 
-		connection_stats_delete (connection->stats);
+	connection_zerocopy_delete (connection->zerocopy);
 
-		pthread_cond_delete (connection->cond);
-		pthread_mutex_delete (connection->mutex);
+	pthread_cond_delete (connection->cond);
+	pthread_mutex_delete (connection->mutex);
 
-		free (connection);
+	free (connection);
+
+}
+
+// deletes the connection & all of its data
+// if packets that point to the connection are still queued in handlers,
+// it is deleted when the last one of them is released
+void connection_delete (void *ptr) {
+
+	if (ptr) {
+		Connection *connection = (Connection *) ptr;
+
+		(void) wheel_timer_cancel (&connection->on_hold_timer);
+
+		connection_release (connection);
+	}
+
+}
+
+// takes a reference to the connection, so it is not deleted
+// until the reference is released with connection_release ()
+void connection_retain (Connection *connection) {
+
+	(void) __atomic_add_fetch (&connection->references, 1, __ATOMIC_RELAXED);
+
+}
+
+// releases a reference to the connection
+// it is deleted when there are no more references to it
+void connection_release (Connection *connection) {
+
+	if (connection) {
+		if (!__atomic_sub_fetch (&connection->references, 1, __ATOMIC_ACQ_REL)) {
+			connection_delete_actual (connection);
+		}
 	}
 
 }
@@ -537,12 +1303,9 @@ void connection_drop (Cerver *cerver, Connection *connection) {
 		// close the socket
 		connection_end (connection);
 
-		if (cerver) {
-			// move the socket to the cerver's socket pool to avoid destroying it
-			// to handle if any other thread is waiting to access the socket's mutex
-			cerver_sockets_pool_push (cerver, connection->socket);
-			connection->socket = NULL;
-		}
+		// the socket is moved to the cerver's socket pool when the connection
+		// is deleted, after every packet that points to it was handled
+		connection->cerver = cerver;
 
 		connection_delete (connection);
 	}
@@ -558,9 +1321,8 @@ Connection *connection_get_by_sock_fd_from_on_hold (
 
 	if (cerver) {
 		const i32 *key = &sock_fd;
-		void *connection_data = htab_get (
-			cerver->on_hold_connection_sock_fd_map,
-			key, sizeof (i32)
+		void *connection_data = ohtab_get (
+			cerver->on_hold_connection_sock_fd_map, key
 		);
 
 		if (connection_data) connection = (Connection *) connection_data;
@@ -672,10 +1434,11 @@ u8 connection_register_to_cerver (
 	u8 retval = 1;
 
 	if (cerver && client && connection) {
-		// map the socket fd with the client
-		const void *key = &connection->socket->sock_fd;
-		retval = (u8) htab_insert (cerver->client_sock_fd_map, key, sizeof (i32),
-			client, sizeof (Client));
+		// map the socket fd with the client & the connection
+		retval = cerver_fd_table_set (
+			cerver->fd_table, connection->socket->sock_fd,
+			RECEIVE_TYPE_NORMAL, client, connection
+		);
 	}
 
 	return retval;
@@ -691,9 +1454,10 @@ u8 connection_unregister_from_cerver (
 	u8 retval = 1;
 
 	if (cerver && connection) {
-		// remove the sock fd from each map
-		const void *key = &connection->socket->sock_fd;
-		if (htab_remove (cerver->client_sock_fd_map, key, sizeof (i32))) {
+		// remove the sock fd from the cerver's table
+		if (!cerver_fd_table_remove (
+			cerver->fd_table, connection->socket->sock_fd, connection
+		)) {
 			// cerver_log_success (
 			// 	"Removed sock fd %d from cerver's %s client sock map.",
 			//     connection->socket->sock_fd, cerver->info->name->str
@@ -774,6 +1538,9 @@ u8 connection_remove_from_cerver (
 	if (cerver && connection) {
 		switch (cerver->handler_type) {
 			case CERVER_HANDLER_TYPE_POLL:
+			case CERVER_HANDLER_TYPE_EPOLL:
+			case CERVER_HANDLER_TYPE_REACTORS:
+			case CERVER_HANDLER_TYPE_IO_URING:
 				errors |= connection_unregister_from_cerver_poll (cerver, connection);
 				break;
 
@@ -0,0 +1,252 @@
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <sched.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/fdtable.h"
+#include "cerver/receive.h"
+
+#pragma region internal
+
+// returns the sock fd's entry, NULL if its chunk has not been allocated
+static inline CerverFdTableEntry *cerver_fd_table_entry_get (
+	const CerverFdTable *fd_table, const i32 sock_fd
+) {
+
+	CerverFdTableEntry *entry = NULL;
+
+	if ((sock_fd >= 0) && (sock_fd < CERVER_FD_TABLE_MAX_FDS)) {
+		CerverFdTableEntry *chunk = __atomic_load_n (
+			&fd_table->chunks[sock_fd >> CERVER_FD_TABLE_CHUNK_BITS], __ATOMIC_ACQUIRE
+		);
+
+		if (chunk) entry = &chunk[sock_fd & (CERVER_FD_TABLE_CHUNK_SIZE - 1)];
+	}
+
+	return entry;
+
+}
+
+// allocates the chunk of the sock fd if it does not exist
+// chunks are published with a compare & swap, so writers never lock
+static CerverFdTableEntry *cerver_fd_table_entry_create (
+	CerverFdTable *fd_table, const i32 sock_fd
+) {
+
+	CerverFdTableEntry *entry = cerver_fd_table_entry_get (fd_table, sock_fd);
+	if (!entry && (sock_fd >= 0) && (sock_fd < CERVER_FD_TABLE_MAX_FDS)) {
+		CerverFdTableEntry *chunk = (CerverFdTableEntry *) calloc (
+			CERVER_FD_TABLE_CHUNK_SIZE, sizeof (CerverFdTableEntry)
+		);
+
+		if (chunk) {
+			CerverFdTableEntry *expected = NULL;
+			if (!__atomic_compare_exchange_n (
+				&fd_table->chunks[sock_fd >> CERVER_FD_TABLE_CHUNK_BITS],
+				&expected, chunk,
+				false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE
+			)) {
+				// another writer has already created it
+				free (chunk);
+			}
+
+			entry = cerver_fd_table_entry_get (fd_table, sock_fd);
+		}
+	}
+
+	return entry;
+
+}
+
+// makes the entry's sequence odd, waiting for any other writer
+static inline u32 cerver_fd_table_entry_write_begin (CerverFdTableEntry *entry) {
+
+	u32 seq = __atomic_load_n (&entry->seq, __ATOMIC_RELAXED);
+	for (;;) {
+		if (seq & 1) {
+			(void) sched_yield ();
+			seq = __atomic_load_n (&entry->seq, __ATOMIC_RELAXED);
+		}
+
+		else if (__atomic_compare_exchange_n (
+			&entry->seq, &seq, seq + 1,
+			true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+		)) {
+			break;
+		}
+	}
+
+	// the odd sequence must be visible before any value
+	__atomic_thread_fence (__ATOMIC_RELEASE);
+
+	return seq;
+
+}
+
+static inline void cerver_fd_table_entry_write_end (
+	CerverFdTableEntry *entry, const u32 seq
+) {
+
+	__atomic_store_n (&entry->seq, seq + 2, __ATOMIC_RELEASE);
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+static CerverFdTable *cerver_fd_table_new (void) {
+
+	return (CerverFdTable *) calloc (1, sizeof (CerverFdTable));
+
+}
+
+void cerver_fd_table_delete (void *fd_table_ptr) {
+
+	if (fd_table_ptr) {
+		CerverFdTable *fd_table = (CerverFdTable *) fd_table_ptr;
+
+		for (u32 i = 0; i < CERVER_FD_TABLE_MAX_CHUNKS; i++) {
+			if (fd_table->chunks[i]) free (fd_table->chunks[i]);
+		}
+
+		free (fd_table_ptr);
+	}
+
+}
+
+// creates a new fd table with entries for the first size sock fds
+CerverFdTable *cerver_fd_table_create (const u32 size) {
+
+	CerverFdTable *fd_table = cerver_fd_table_new ();
+	if (fd_table) {
+		for (u32 sock_fd = 0; sock_fd < size; sock_fd += CERVER_FD_TABLE_CHUNK_SIZE) {
+			if (!cerver_fd_table_entry_create (fd_table, (i32) sock_fd)) {
+				cerver_fd_table_delete (fd_table);
+				fd_table = NULL;
+				break;
+			}
+		}
+	}
+
+	return fd_table;
+
+}
+
+// returns the current number of sock fds in the table
+u32 cerver_fd_table_size (const CerverFdTable *fd_table) {
+
+	return fd_table ? __atomic_load_n (&fd_table->n_entries, __ATOMIC_RELAXED) : 0;
+
+}
+
+// maps the sock fd with its client & connection
+// returns 0 on success, 1 on error
+u8 cerver_fd_table_set (
+	CerverFdTable *fd_table, const i32 sock_fd,
+	const ReceiveType receive_type,
+	struct _Client *client, struct _Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (fd_table && connection) {
+		CerverFdTableEntry *entry = cerver_fd_table_entry_create (fd_table, sock_fd);
+		if (entry) {
+			const u32 seq = cerver_fd_table_entry_write_begin (entry);
+
+			if (!__atomic_load_n (&entry->connection, __ATOMIC_RELAXED))
+				(void) __atomic_add_fetch (&fd_table->n_entries, 1, __ATOMIC_RELAXED);
+
+			__atomic_store_n (&entry->receive_type, (u32) receive_type, __ATOMIC_RELAXED);
+			__atomic_store_n (&entry->client, client, __ATOMIC_RELAXED);
+			__atomic_store_n (&entry->connection, connection, __ATOMIC_RELAXED);
+
+			cerver_fd_table_entry_write_end (entry, seq);
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+// removes the sock fd from the table
+// only if it is still mapped to the connection, or any if connection is NULL
+// returns 0 on success, 1 if the sock fd was not found
+u8 cerver_fd_table_remove (
+	CerverFdTable *fd_table, const i32 sock_fd,
+	const struct _Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (fd_table) {
+		CerverFdTableEntry *entry = cerver_fd_table_entry_get (fd_table, sock_fd);
+		if (entry) {
+			const u32 seq = cerver_fd_table_entry_write_begin (entry);
+
+			struct _Connection *current = __atomic_load_n (&entry->connection, __ATOMIC_RELAXED);
+			if (current && (!connection || (current == connection))) {
+				__atomic_store_n (&entry->receive_type, (u32) RECEIVE_TYPE_NONE, __ATOMIC_RELAXED);
+				__atomic_store_n (&entry->client, NULL, __ATOMIC_RELAXED);
+				__atomic_store_n (&entry->connection, NULL, __ATOMIC_RELAXED);
+
+				(void) __atomic_sub_fetch (&fd_table->n_entries, 1, __ATOMIC_RELAXED);
+
+				retval = 0;
+			}
+
+			cerver_fd_table_entry_write_end (entry, seq);
+		}
+	}
+
+	return retval;
+
+}
+
+// gets the values mapped to the sock fd without locking
+// returns true if the sock fd was found
+bool cerver_fd_table_get (
+	const CerverFdTable *fd_table, const i32 sock_fd,
+	ReceiveType *receive_type,
+	struct _Client **client, struct _Connection **connection
+) {
+
+	u32 type = RECEIVE_TYPE_NONE;
+	struct _Client *entry_client = NULL;
+	struct _Connection *entry_connection = NULL;
+
+	const CerverFdTableEntry *entry = fd_table ?
+		cerver_fd_table_entry_get (fd_table, sock_fd) : NULL;
+
+	if (entry) {
+		u32 seq = 0;
+		do {
+			seq = __atomic_load_n (&entry->seq, __ATOMIC_ACQUIRE);
+			if (seq & 1) {
+				(void) sched_yield ();
+				continue;
+			}
+
+			type = __atomic_load_n (&entry->receive_type, __ATOMIC_RELAXED);
+			entry_client = __atomic_load_n (&entry->client, __ATOMIC_RELAXED);
+			entry_connection = __atomic_load_n (&entry->connection, __ATOMIC_RELAXED);
+
+			// the values must be read before checking the sequence again
+			__atomic_thread_fence (__ATOMIC_ACQUIRE);
+		} while ((seq & 1) || (seq != __atomic_load_n (&entry->seq, __ATOMIC_RELAXED)));
+	}
+
+	if (receive_type) *receive_type = (ReceiveType) type;
+	if (client) *client = entry_client;
+	if (connection) *connection = entry_connection;
+
+	return entry_connection != NULL;
+
+}
+
+#pragma endregion
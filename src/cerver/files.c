@@ -684,10 +684,22 @@ static ssize_t file_send_actual (
 		cerver, client, connection,
 		actual_filename, filelen
 	)) {
+		// the file can't be sent before the connection's queued bytes
+		if (connection_send_queue_get_pending (connection)) {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_FILE,
+				"file_send_actual () - connection has pending bytes in its send queue"
+			);
+
+			retval = -1;
+		}
+
 		// send the actual file
-		retval = sendfile (
-			connection->socket->sock_fd, file_fd, NULL, filelen
-		);
+		else {
+			retval = sendfile (
+				connection->socket->sock_fd, file_fd, NULL, filelen
+			);
+		}
 	}
 
 	else {
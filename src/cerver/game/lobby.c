@@ -12,7 +12,7 @@
 #include "cerver/types/string.h"
 
 #include "cerver/collections/dlist.h"
-#include "cerver/collections/htab.h"
+#include "cerver/collections/ohtab.h"
 
 #include "cerver/socket.h"
 #include "cerver/cerver.h"
@@ -168,6 +168,9 @@ Lobby *lobby_new (void) {
 
         lobby->owner = NULL;
 
+        lobby->player_timeout = 0;
+        lobby->n_timed_out_players = 0;
+
         lobby->default_handler = true;
         lobby->handler = lobby_poll;
         lobby->packet_handler = NULL;
@@ -197,7 +200,7 @@ void lobby_delete (void *lobby_ptr) {
         str_delete (lobby->id);
 
         dlist_delete (lobby->players);
-        htab_destroy (lobby->sock_fd_player_map);
+        ohtab_destroy (lobby->sock_fd_player_map);
 
         if (lobby->players_fds) free (lobby->players_fds);
 
@@ -239,7 +242,7 @@ u8 lobby_init (GameCerver *game_cerver, Lobby *lobby) {
             );
             #endif
 
-            lobby->sock_fd_player_map = htab_create (LOBBY_DEFAULT_MAX_PLAYERS, NULL, NULL);
+            lobby->sock_fd_player_map = ohtab_create (sizeof (i32), LOBBY_DEFAULT_MAX_PLAYERS, NULL);
             lobby->players = dlist_init (player_delete, player_comparator_client_id);
             
             lobby->stats = lobby_stats_new ();
@@ -290,6 +293,15 @@ void lobby_set_game_settings (Lobby *lobby, void *game_settings, Action game_set
 
 }
 
+// sets the secs a player can be inactive before being dropped from the lobby
+// players are checked using the cerver's timer wheel, 0 to never drop them
+// the default lobby poll drops them, custom handlers need to call lobby_players_timeout_handle ()
+void lobby_set_player_timeout (Lobby *lobby, u32 player_timeout) {
+
+    if (lobby) lobby->player_timeout = player_timeout;
+
+}
+
 // sets the lobby game data and a function to delete it
 void lobby_set_game_data (Lobby *lobby, void *game_data, Action game_data_delete) {
 
@@ -477,7 +489,7 @@ u8 lobby_poll_register_connection (Lobby *lobby, Player *player, Connection *con
 
             // map the socket fd with the player
             const void *key = &connection->socket->sock_fd;
-            htab_insert (lobby->sock_fd_player_map, key, sizeof (i32), player, sizeof (Player));
+            ohtab_insert (lobby->sock_fd_player_map, key, player);
 
             retval = 0;
         }
@@ -555,6 +567,9 @@ void lobby_poll (void *ptr) {
         while (lobby->running) {
             poll_retval = poll (lobby->players_fds, lobby->max_players_fds, lobby->poll_timeout);
 
+            // drop the players whose timeout expired in the cerver's timer wheel
+            if (lobby_players_timeout_handle (lobby)) break;
+
             // poll failed
             if (poll_retval < 0) {
                 cerver_log (
@@ -851,6 +866,37 @@ u8 lobby_leave (Cerver *cerver, Lobby *lobby, Player *player) {
 
 }
 
+// drops the players whose timeout has expired from the lobby
+// must be called by the thread that handles the lobby's players
+// returns true if the lobby was deleted because it was left empty
+bool lobby_players_timeout_handle (Lobby *lobby) {
+
+    bool deleted = false;
+
+    if (lobby) {
+        if (__atomic_exchange_n (&lobby->n_timed_out_players, 0, __ATOMIC_ACQUIRE)) {
+            Player *player = NULL;
+            ListElement *next = NULL;
+            for (ListElement *le = dlist_start (lobby->players); le; le = next) {
+                next = le->next;
+                player = (Player *) le->data;
+
+                if (__atomic_load_n (&player->timed_out, __ATOMIC_ACQUIRE)) {
+                    // the lobby gets deleted when its last player leaves
+                    deleted = (lobby->n_current_players <= 1);
+
+                    (void) lobby_leave (lobby->cerver, lobby, player);
+
+                    if (deleted) break;
+                }
+            }
+        }
+    }
+
+    return deleted;
+
+}
+
 // starts the lobby's handler and/or update method in the cervers thpool
 u8 lobby_start (Cerver *cerver, Lobby *lobby) {
 
@@ -861,6 +907,14 @@ u8 lobby_start (Cerver *cerver, Lobby *lobby) {
         CerverLobby *cerver_lobby = cerver_lobby_new (cerver, lobby);
         lobby->running = true;
 
+        // inactive players are dropped by the cerver's timer wheel
+        if (lobby->player_timeout) {
+            for (ListElement *le = dlist_start (lobby->players); le; le = le->next)
+                (void) player_timeout_arm (lobby, (Player *) le->data);
+
+            (void) timer_wheel_start (cerver->timer_wheel);
+        }
+
         // check if the lobby has a handler method
         if (lobby->handler) {
             if (lobby->default_handler) lobby_poll_register_all_players (cerver, lobby);
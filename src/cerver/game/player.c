@@ -2,12 +2,14 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
 
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
 #include "cerver/client.h"
 #include "cerver/packets.h"
+#include "cerver/wheel.h"
 
 #include "cerver/game/game.h"
 #include "cerver/game/player.h"
@@ -17,12 +19,19 @@
 
 ListElement *player_get_le_from_lobby (Lobby *lobby, Player *player);
 
+static void player_timeout_expired (TimerWheel *wheel, void *player_ptr);
+
 Player *player_new (void) {
 
     Player *player = (Player *) malloc (sizeof (Player));
     if (player) {
         player->id = NULL;
         player->client = NULL;
+
+        player->lobby = NULL;
+        wheel_timer_init (&player->timeout_timer, player_timeout_expired, player);
+        player->timed_out = false;
+
         player->data = NULL;
         player->data_delete = NULL;
     }
@@ -36,6 +45,8 @@ void player_delete (void *player_ptr) {
     if (player_ptr) {
         Player *player = (Player *) player_ptr;
 
+        (void) wheel_timer_cancel (&player->timeout_timer);
+
         str_delete (player->id);
 
         player->client = NULL;
@@ -116,6 +127,11 @@ u8 player_register_to_lobby (Lobby *lobby, Player *player) {
             // if (!failed) {
                 dlist_insert_after (lobby->players, dlist_end (lobby->players), player);
 
+                player->lobby = lobby;
+
+                // players that join a running lobby start their timeout right away
+                if (lobby->running) (void) player_timeout_arm (lobby, player);
+
                 #ifdef CERVER_DEBUG
                 cerver_log (
                     LOG_TYPE_SUCCESS, LOG_TYPE_PLAYER,
@@ -168,6 +184,8 @@ u8 player_unregister_from_lobby (Lobby *lobby, Player *player) {
     if (lobby && player) {
         if (player->client) {
             // printf ("\nplayer_unregister_from_lobby client id: %li\n", player->client->id);
+            (void) wheel_timer_cancel (&player->timeout_timer);
+
             if (lobby->default_handler) {
                 // unregister all the player's client connections from the lobby
                 player_unregister_from_lobby_poll (lobby, player);
@@ -252,26 +270,75 @@ Player *player_get_by_sock_fd_list (Lobby *lobby, i32 sock_fd) {
 }
 
 // broadcasts a packet to all the players in the lobby
+// the packet is serialized only once & then sent to all the connections
 void player_broadcast_to_all (Cerver *cerver, const Lobby *lobby, Packet *packet, 
     Protocol protocol, int flags) {
 
     if (lobby && packet) {
-        Player *player = NULL;
-        for (ListElement *le = dlist_start (lobby->players); le; le = le->next) {
-            player = (Player *) le->data;
-
-            Connection *connection = NULL;
-            for (ListElement *le_sub = dlist_start (player->client->connections); le_sub; le_sub = le_sub->next) {
-                connection = (Connection *) le_sub->data;
-                packet_set_network_values (packet, cerver, player->client, connection, (Lobby *) lobby);
-                packet_send (packet, flags, NULL, false);
+        PacketBroadcast *broadcast = packet_broadcast_create (packet);
+        if (broadcast) {
+            for (ListElement *le = dlist_start (lobby->players); le; le = le->next) {
+                (void) packet_broadcast_add_client (broadcast, ((Player *) le->data)->client);
             }
+
+            (void) packet_broadcast_send (broadcast, cerver, (Lobby *) lobby, flags);
+
+            packet_broadcast_delete (broadcast);
         }
     }
 
 }
 
-// TODO:
-// this is used to clean disconnected players inside a lobby
-// if we haven't recieved any kind of input from a player, disconnect it 
-void checkPlayerTimeouts (void) {}
\ No newline at end of file
+// called by the cerver's timer wheel when the player's timeout expires
+// if the player's client has been active since it was armed, the timer is armed
+// again with the remaining time, so packets never need to touch the wheel
+// inactive players are only flagged, the lobby's thread is the one that drops them
+static void player_timeout_expired (TimerWheel *wheel, void *player_ptr) {
+
+    Player *player = (Player *) player_ptr;
+    Lobby *lobby = player->lobby;
+
+    if (lobby && player->client && lobby->player_timeout) {
+        const time_t inactive = time (NULL)
+            - __atomic_load_n (&player->client->last_activity, __ATOMIC_RELAXED);
+
+        if (inactive >= (time_t) lobby->player_timeout) {
+            #ifdef CERVER_DEBUG
+            cerver_log (
+                LOG_TYPE_DEBUG, LOG_TYPE_PLAYER,
+                "Player %s has been inactive more than %u secs, dropping it from lobby %s...",
+                player->id ? player->id->str : "no-id", lobby->player_timeout, lobby->id->str
+            );
+            #endif
+
+            __atomic_store_n (&player->timed_out, true, __ATOMIC_RELEASE);
+            (void) __atomic_add_fetch (&lobby->n_timed_out_players, 1, __ATOMIC_RELEASE);
+        }
+
+        else {
+            (void) timer_wheel_arm (
+                wheel, &player->timeout_timer,
+                (u64) (lobby->player_timeout - inactive) * 1000
+            );
+        }
+    }
+
+}
+
+// arms the player's timeout in the cerver's timer wheel
+// if the lobby has a player timeout
+// returns 0 on success, 1 if the player will not timeout
+u8 player_timeout_arm (Lobby *lobby, Player *player) {
+
+    u8 retval = 1;
+
+    if (lobby && player && lobby->player_timeout && lobby->cerver) {
+        retval = timer_wheel_arm (
+            lobby->cerver->timer_wheel, &player->timeout_timer,
+            (u64) lobby->player_timeout * 1000
+        );
+    }
+
+    return retval;
+
+}
\ No newline at end of file
@@ -3,22 +3,29 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include <time.h>
 #include <errno.h>
 
 #include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include "cerver/types/types.h"
 
-#include "cerver/collections/htab.h"
+#include "cerver/collections/slab.h"
 
 #include "cerver/auth.h"
 #include "cerver/cerver.h"
 #include "cerver/client.h"
 #include "cerver/connection.h"
 #include "cerver/events.h"
+#include "cerver/fdtable.h"
 #include "cerver/files.h"
 #include "cerver/handler.h"
 #include "cerver/packets.h"
+#include "cerver/reactor.h"
+#include "cerver/uring.h"
 #include "cerver/socket.h"
 
 #include "cerver/threads/thread.h"
@@ -34,14 +41,19 @@
 
 static int unique_handler_id = 0;
 
+static Slab handlers_data_slab = SLAB_INITIALIZER ("handlers-data", HandlerData);
+
 static HandlerData *handler_data_new (void) {
 
-	HandlerData *handler_data = (HandlerData *) malloc (sizeof (HandlerData));
+	HandlerData *handler_data = (HandlerData *) slab_alloc (&handlers_data_slab);
 	if (handler_data) {
 		handler_data->handler_id = 0;
 
 		handler_data->data = NULL;
 		handler_data->packet = NULL;
+
+		handler_data->packets = &handler_data->packet;
+		handler_data->n_packets = 1;
 	}
 
 	return handler_data;
@@ -50,7 +62,41 @@ static HandlerData *handler_data_new (void) {
 
 static void handler_data_delete (HandlerData *handler_data) {
 
-	if (handler_data) free (handler_data);
+	slab_free (&handlers_data_slab, handler_data);
+
+}
+
+// packets that are pushed together to a handler's job queue
+typedef struct HandlerBatch {
+
+	size_t n_packets;
+	Packet *packets[HANDLER_MAX_BATCH_SIZE];
+
+} HandlerBatch;
+
+static Slab handler_batches_slab = SLAB_INITIALIZER ("handler-batches", HandlerBatch);
+
+static HandlerBatch *handler_batch_new (void) {
+
+	HandlerBatch *batch = (HandlerBatch *) slab_alloc (&handler_batches_slab);
+	if (batch) {
+		batch->n_packets = 0;
+	}
+
+	return batch;
+
+}
+
+static void handler_batch_delete (HandlerBatch *batch) {
+
+	slab_free (&handler_batches_slab, batch);
+
+}
+
+// used to mark jobs whose args are a HandlerBatch, it is never called
+static void handler_batch_job (void *batch_ptr) {
+
+	(void) batch_ptr;
 
 }
 
@@ -72,6 +118,8 @@ static Handler *handler_new (void) {
 		handler->handler = NULL;
 		handler->direct_handle = false;
 
+		handler->batch_size = 0;
+
 		handler->job_queue = NULL;
 
 		handler->cerver = NULL;
@@ -82,12 +130,38 @@ static Handler *handler_new (void) {
 
 }
 
+// deletes the packets that were never handled,
+// so their clients' references are released
+static void handler_job_queue_release (JobQueue *job_queue) {
+
+	Job *job = NULL;
+	while ((job = job_queue_pull (job_queue))) {
+		if (job->method == handler_batch_job) {
+			HandlerBatch *batch = (HandlerBatch *) job->args;
+			for (size_t i = 0; i < batch->n_packets; i++)
+				packet_delete (batch->packets[i]);
+
+			handler_batch_delete (batch);
+		}
+
+		else {
+			packet_delete (job->args);
+		}
+
+		job_delete (job);
+	}
+
+}
+
 void handler_delete (void *handler_ptr) {
 
 	if (handler_ptr) {
 		Handler *handler = (Handler *) handler_ptr;
 
-		job_queue_delete (handler->job_queue);
+		if (handler->job_queue) {
+			handler_job_queue_release (handler->job_queue);
+			job_queue_delete (handler->job_queue);
+		}
 
 		free (handler_ptr);
 	}
@@ -165,53 +239,165 @@ void handler_set_direct_handle (Handler *handler, bool direct_handle) {
 
 }
 
+// sets the max n of packets that the handler method can get in one call
+// using HandlerData's packets & n_packets
+// app packets parsed from the same received buffer are queued as one job,
+// so the handler pays a single push & wake up for all of them
+// only used by cerver handlers that are not set to direct handle
+// the max value is HANDLER_MAX_BATCH_SIZE, 0 disables batches (default)
+void handler_set_batch_size (Handler *handler, size_t batch_size) {
+
+	if (handler) {
+		handler->batch_size = (batch_size > HANDLER_MAX_BATCH_SIZE) ?
+			HANDLER_MAX_BATCH_SIZE : batch_size;
+	}
+
+}
+
+// replaces the handler's job queue with a new one of the selected type
+// a JOB_QUEUE_TYPE_RING queue avoids locks but can only hold capacity packets,
+// any packet that does not fit will be dropped
+// must be called before the handler starts
+// returns 0 on success, 1 on error
+u8 handler_set_job_queue_type (
+	Handler *handler, JobQueueType type, size_t capacity
+) {
+
+	u8 retval = 1;
+
+	if (handler) {
+		JobQueue *job_queue = job_queue_create_with_type (type, capacity);
+		if (job_queue) {
+			job_queue_delete (handler->job_queue);
+			handler->job_queue = job_queue;
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+// the packet's type is read before the handler is called,
+// as the handler might have already deleted the packet
+static void cerver_handler_packet_delete (
+	Handler *handler, Packet *packet, const PacketType packet_type
+) {
+
+	switch (packet_type) {
+		case PACKET_TYPE_APP: {
+			if (handler->cerver->app_packet_handler_delete_packet)
+				packet_delete (packet);
+		} break;
+		case PACKET_TYPE_APP_ERROR: {
+			if (handler->cerver->app_error_packet_handler_delete_packet)
+				packet_delete (packet);
+		} break;
+		case PACKET_TYPE_CUSTOM: {
+			if (handler->cerver->custom_packet_handler_delete_packet)
+				packet_delete (packet);
+		} break;
+
+		default: packet_delete (packet); break;
+	}
+
+}
+
+// calls the handler method with all the packets that have been collected
+static void cerver_handler_call (Handler *handler, HandlerData *handler_data) {
+
+	if (handler_data->n_packets) {
+		handler_data->handler_id = handler->id;
+		handler_data->data = handler->data;
+		handler_data->packet = handler_data->packets[0];
+
+		PacketType packet_types[HANDLER_MAX_BATCH_SIZE];
+		for (size_t i = 0; i < handler_data->n_packets; i++)
+			packet_types[i] = handler_data->packets[i]->header->packet_type;
+
+		const u64 start = cerver_stats_latency_start (handler->cerver->stats);
+
+		handler->handler (handler_data);
+
+		// the packets of a handler are all of the same type
+		cerver_stats_handler_latency_end (
+			handler->cerver->stats,
+			packet_types[0],
+			start, handler_data->n_packets
+		);
+
+		for (size_t i = 0; i < handler_data->n_packets; i++)
+			cerver_handler_packet_delete (handler, handler_data->packets[i], packet_types[i]);
+
+		handler_data->n_packets = 0;
+	}
+
+}
+
+static inline void cerver_handler_add_packet (
+	Handler *handler, HandlerData *handler_data, Packet *packet
+) {
+
+	handler_data->packets[handler_data->n_packets] = packet;
+	handler_data->n_packets += 1;
+
+	if (handler_data->n_packets >= (handler->batch_size ? handler->batch_size : 1))
+		cerver_handler_call (handler, handler_data);
+
+}
+
 // while cerver is running, check for new jobs and handle them
+// every available job is handled before waiting again
 static void handler_do_while_cerver (Handler *handler) {
 
 	if (handler) {
 		Job *job = NULL;
-		Packet *packet = NULL;
-		PacketType packet_type = PACKET_TYPE_NONE;
+		HandlerBatch *batch = NULL;
+		Packet *packets[HANDLER_MAX_BATCH_SIZE] = { 0 };
 		HandlerData *handler_data = handler_data_new ();
+		handler_data->packets = packets;
+		handler_data->n_packets = 0;
 		while (handler->cerver->isRunning) {
-			bsem_wait (handler->job_queue->has_jobs);
+			job_queue_wait (handler->job_queue);
 
 			if (handler->cerver->isRunning) {
 				(void) pthread_mutex_lock (handler->cerver->handlers_lock);
 				handler->cerver->num_handlers_working += 1;
 				(void) pthread_mutex_unlock (handler->cerver->handlers_lock);
 
-				// read job from queue
-				job = job_queue_pull (handler->job_queue);
-				if (job) {
-					packet = (Packet *) job->args;
-					packet_type = packet->header->packet_type;
+				// read jobs from queue
+				while (
+					handler->cerver->isRunning
+					&& (job = job_queue_pull (handler->job_queue))
+				) {
+					cerver_stats_latency_end (
+						handler->cerver->stats,
+						CERVER_STATS_LATENCY_JOB_QUEUE_WAIT,
+						job->queued_time
+					);
 
-					handler_data->handler_id = handler->id;
-					handler_data->data = handler->data;
-					handler_data->packet = packet;
+					if (job->method == handler_batch_job) {
+						batch = (HandlerBatch *) job->args;
+						for (size_t i = 0; i < batch->n_packets; i++)
+							cerver_handler_add_packet (handler, handler_data, batch->packets[i]);
 
-					handler->handler (handler_data);
+						handler_batch_delete (batch);
+					}
+
+					else {
+						cerver_handler_add_packet (handler, handler_data, (Packet *) job->args);
+					}
 
 					job_delete (job);
+				}
 
-					switch (packet_type) {
-						case PACKET_TYPE_APP: {
-							if (handler->cerver->app_packet_handler_delete_packet)
-								packet_delete (packet);
-						} break;
-						case PACKET_TYPE_APP_ERROR: {
-							if (handler->cerver->app_error_packet_handler_delete_packet)
-								packet_delete (packet);
-						} break;
-						case PACKET_TYPE_CUSTOM: {
-							if (handler->cerver->custom_packet_handler_delete_packet)
-								packet_delete (packet);
-						} break;
+				// handle any packets left in an incomplete batch
+				cerver_handler_call (handler, handler_data);
 
-						default: packet_delete (packet); break;
-					}
-				}
+				// send what the handler coalesced while handling its jobs
+				if (handler->cerver->send_coalescing)
+					cerver_coalesce_flush (handler->cerver);
 
 				(void) pthread_mutex_lock (handler->cerver->handlers_lock);
 				handler->cerver->num_handlers_working -= 1;
@@ -232,7 +418,7 @@ static void handler_do_while_client (Handler *handler) {
 		Packet *packet = NULL;
 		HandlerData *handler_data = handler_data_new ();
 		while (handler->client->running) {
-			bsem_wait (handler->job_queue->has_jobs);
+			job_queue_wait (handler->job_queue);
 
 			if (handler->client->running) {
 				(void) pthread_mutex_lock (handler->client->handlers_lock);
@@ -274,7 +460,7 @@ static void handler_do_while_admin (Handler *handler) {
 		PacketType packet_type = PACKET_TYPE_NONE;
 		HandlerData *handler_data = handler_data_new ();
 		while (handler->cerver->isRunning) {
-			bsem_wait (handler->job_queue->has_jobs);
+			job_queue_wait (handler->job_queue);
 
 			if (handler->cerver->isRunning) {
 				(void) pthread_mutex_lock (handler->cerver->admin->handlers_lock);
@@ -284,6 +470,12 @@ static void handler_do_while_admin (Handler *handler) {
 				// read job from queue
 				job = job_queue_pull (handler->job_queue);
 				if (job) {
+					cerver_stats_latency_end (
+						handler->cerver->stats,
+						CERVER_STATS_LATENCY_JOB_QUEUE_WAIT,
+						job->queued_time
+					);
+
 					packet = (Packet *) job->args;
 					packet_type = packet->header->packet_type;
 
@@ -291,8 +483,14 @@ static void handler_do_while_admin (Handler *handler) {
 					handler_data->data = handler->data;
 					handler_data->packet = packet;
 
+					const u64 start = cerver_stats_latency_start (handler->cerver->stats);
+
 					handler->handler (handler_data);
 
+					cerver_stats_handler_latency_end (
+						handler->cerver->stats, packet_type, start, 1
+					);
+
 					job_delete (job);
 
 					switch (packet_type) {
@@ -469,14 +667,12 @@ SockReceive *sock_receive_new (void) {
 
 	SockReceive *sr = (SockReceive *) malloc (sizeof (SockReceive));
 	if (sr) {
-		sr->spare_packet = NULL;
-		sr->missing_packet = 0;
+		sr->buffer = NULL;
+		sr->size = 0;
+		sr->len = 0;
 
-		sr->header = NULL;
-		sr->header_end = NULL;
-		// sr->curr_header_pos = 0;
-		sr->remaining_header = 0;
-		sr->complete_header = false;
+		sr->max_size = SOCK_RECEIVE_DEFAULT_MAX_SIZE;
+		sr->last_used = 0;
 	}
 
 	return sr;
@@ -488,14 +684,253 @@ void sock_receive_delete (void *sock_receive_ptr) {
 	if (sock_receive_ptr) {
 		SockReceive *sock_receive = (SockReceive *) sock_receive_ptr;
 
-		packet_delete (sock_receive->spare_packet);
-		if (sock_receive->header) free (sock_receive->header);
+		if (sock_receive->buffer) free (sock_receive->buffer);
 
 		free (sock_receive_ptr);
 	}
 
 }
 
+// discards the bytes of the pending packet
+void sock_receive_reset (SockReceive *sock_receive) {
+
+	if (sock_receive) sock_receive->len = 0;
+
+}
+
+// makes sure the buffer can hold at least size bytes
+// returns 0 on success, 1 on error
+static u8 sock_receive_reserve (SockReceive *sock_receive, const size_t size) {
+
+	u8 retval = 0;
+
+	if (size > sock_receive->size) {
+		size_t new_size = sock_receive->size ? sock_receive->size : SOCK_RECEIVE_DEFAULT_SIZE;
+		while (new_size < size) new_size *= 2;
+
+		char *buffer = (char *) realloc (sock_receive->buffer, new_size);
+		if (buffer) {
+			sock_receive->buffer = buffer;
+			sock_receive->size = new_size;
+		}
+
+		else {
+			retval = 1;
+		}
+	}
+
+	return retval;
+
+}
+
+// copies bytes at the end of the pending packet
+// returns 0 on success, 1 on error
+static u8 sock_receive_push (
+	SockReceive *sock_receive, const char *data, const size_t size
+) {
+
+	u8 retval = 1;
+
+	if (!sock_receive_reserve (sock_receive, sock_receive->len + size)) {
+		(void) memcpy (sock_receive->buffer + sock_receive->len, data, size);
+		sock_receive->len += size;
+
+		sock_receive->last_used = time (NULL);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// an empty buffer that grew to reassemble big packets
+// goes back to its default size after being idle
+static void sock_receive_shrink (SockReceive *sock_receive) {
+
+	if (
+		!sock_receive->len
+		&& (sock_receive->size > SOCK_RECEIVE_DEFAULT_SIZE)
+		&& ((time (NULL) - sock_receive->last_used) >= SOCK_RECEIVE_DEFAULT_IDLE_SECS)
+	) {
+		char *buffer = (char *) realloc (sock_receive->buffer, SOCK_RECEIVE_DEFAULT_SIZE);
+		if (buffer) {
+			sock_receive->buffer = buffer;
+			sock_receive->size = SOCK_RECEIVE_DEFAULT_SIZE;
+		}
+	}
+
+}
+
+// returns the n of bytes that belong to the packet, 0 if it has an invalid size
+// upload requests take all the available bytes as the file follows the packet
+static size_t sock_receive_frame_size (
+	const SockReceive *sock_receive,
+	const PacketHeader *header, const size_t available
+) {
+
+	size_t frame_size = header->packet_size;
+
+	if ((frame_size < sizeof (PacketHeader)) || (frame_size > sock_receive->max_size)) {
+		cerver_log (
+			LOG_TYPE_WARNING, LOG_TYPE_PACKET,
+			"Got a packet of invalid size: %ld", frame_size
+		);
+
+		frame_size = 0;
+	}
+
+	else if (
+		(header->packet_type == PACKET_TYPE_REQUEST)
+		&& (header->request_type == REQUEST_PACKET_TYPE_SEND_FILE)
+		&& (available > frame_size)
+	) {
+		frame_size = available;
+	}
+
+	return frame_size;
+
+}
+
+// completes the pending packet with the bytes from the buffer
+// returns 0 to keep handling the buffer, 1 to stop
+static u8 sock_receive_handle_pending (
+	SockReceive *sock_receive,
+	char **end, size_t *remaining,
+	SockReceiveFrameHandler frame_handler, void *args
+) {
+
+	u8 retval = 0;
+
+	size_t to_copy = 0;
+
+	// complete the pending header
+	if (sock_receive->len < sizeof (PacketHeader)) {
+		to_copy = sizeof (PacketHeader) - sock_receive->len;
+		if (to_copy > *remaining) to_copy = *remaining;
+
+		if (!sock_receive_push (sock_receive, *end, to_copy)) {
+			*end += to_copy;
+			*remaining -= to_copy;
+		}
+
+		else {
+			sock_receive->len = 0;
+			retval = 1;
+		}
+	}
+
+	if (!retval && (sock_receive->len >= sizeof (PacketHeader))) {
+		size_t frame_size = sock_receive_frame_size (
+			sock_receive,
+			(PacketHeader *) sock_receive->buffer,
+			sock_receive->len + *remaining
+		);
+
+		if (frame_size) {
+			to_copy = frame_size - sock_receive->len;
+			if (to_copy > *remaining) to_copy = *remaining;
+
+			// the buffer only grows once to fit the complete packet
+			if (
+				!sock_receive_reserve (sock_receive, frame_size)
+				&& !sock_receive_push (sock_receive, *end, to_copy)
+			) {
+				*end += to_copy;
+				*remaining -= to_copy;
+
+				if (sock_receive->len == frame_size) {
+					// the buffer is not modified until the next receive
+					sock_receive->len = 0;
+
+					retval = frame_handler (
+						args,
+						(PacketHeader *) sock_receive->buffer,
+						sock_receive->buffer + sizeof (PacketHeader),
+						frame_size - sizeof (PacketHeader)
+					);
+				}
+			}
+
+			else {
+				sock_receive->len = 0;
+				retval = 1;
+			}
+		}
+
+		else {
+			sock_receive->len = 0;
+			retval = 1;
+		}
+	}
+
+	return retval;
+
+}
+
+// splits the received buffer into complete packets, packets that are
+// cut between receives are reassembled in the sock receive's buffer
+// every complete packet is handled by the frame handler
+// returns 0 when all the buffer was handled, 1 if the handler stopped or on error
+u8 sock_receive_handle_buffer (
+	SockReceive *sock_receive,
+	char *buffer, const size_t buffer_size,
+	SockReceiveFrameHandler frame_handler, void *args
+) {
+
+	u8 retval = 0;
+
+	char *end = buffer;
+	size_t remaining = buffer_size;
+
+	if (sock_receive->len) {
+		retval = sock_receive_handle_pending (
+			sock_receive, &end, &remaining, frame_handler, args
+		);
+	}
+
+	else {
+		sock_receive_shrink (sock_receive);
+	}
+
+	// complete packets are handled directly from the buffer
+	size_t frame_size = 0;
+	while (!retval && remaining) {
+		if (remaining < sizeof (PacketHeader)) {
+			retval = sock_receive_push (sock_receive, end, remaining);
+			break;
+		}
+
+		frame_size = sock_receive_frame_size (
+			sock_receive, (PacketHeader *) end, remaining
+		);
+
+		if (!frame_size) {
+			retval = 1;
+		}
+
+		else if (remaining < frame_size) {
+			retval = sock_receive_push (sock_receive, end, remaining);
+			break;
+		}
+
+		else {
+			retval = frame_handler (
+				args,
+				(PacketHeader *) end,
+				end + sizeof (PacketHeader),
+				frame_size - sizeof (PacketHeader)
+			);
+
+			end += frame_size;
+			remaining -= frame_size;
+		}
+	}
+
+	return retval;
+
+}
+
 #pragma endregion
 
 #pragma region handlers
@@ -889,43 +1324,246 @@ void cerver_test_packet_handler (Packet *packet) {
 
 }
 
-// handles an PACKET_TYPE_APP packet type
-static void cerver_app_packet_handler (Packet *packet) {
+// packets queued in a cerver's handler keep a reference to their client & connection,
+// so they are not deleted while they wait to be handled in another thread
+static inline void handler_packet_retain (
+	const Handler *handler, Packet *packet
+) {
 
-	if (packet->cerver->multiple_handlers) {
-		// select which handler to use
-		if (packet->header->handler_id < packet->cerver->n_handlers) {
-			if (packet->cerver->handlers[packet->header->handler_id]) {
-				// add the packet to the handler's job queueu to be handled
-				// as soon as the handler is available
-				if (job_queue_push (
-					packet->cerver->handlers[packet->header->handler_id]->job_queue,
-					job_create (NULL, packet)
-				)) {
-					cerver_log_error (
-						"Failed to push a new job to cerver's %s <%d> handler!",
-						packet->cerver->info->name->str, packet->header->handler_id
-					);
-				}
-			}
+	if (handler->type != HANDLER_TYPE_CLIENT) {
+		if (packet->client && !packet->client_ref) {
+			client_retain (packet->client);
+			packet->client_ref = true;
+		}
+
+		if (packet->connection && !packet->connection_ref) {
+			connection_retain (packet->connection);
+			packet->connection_ref = true;
 		}
 	}
 
-	else {
-		if (packet->cerver->app_packet_handler) {
-			if (packet->cerver->app_packet_handler->direct_handle) {
-				// printf ("app_packet_handler - direct handle!\n");
-				packet->cerver->app_packet_handler->handler (packet);
-				if (packet->cerver->app_packet_handler_delete_packet)
-					packet_delete (packet);
-			}
+}
 
-			else {
-				// add the packet to the handler's job queueu to be handled
+// pushes the packet to the handler's job queue to be handled
+// as soon as the handler is available
+// packet views are copied first as their buffer will be reused
+// the packet is deleted if it can't be queued
+// returns 0 on success, 1 on error
+u8 handler_push_packet (Handler *handler, Packet *packet) {
+
+	u8 retval = 1;
+
+	if (!packet_retain (packet)) {
+		handler_packet_retain (handler, packet);
+
+		Job *job = job_create (NULL, packet);
+		if (job) {
+			// client handlers don't have a cerver
+			if (handler->cerver)
+				job->queued_time = cerver_stats_latency_start (handler->cerver->stats);
+
+			retval = job_queue_push (handler->job_queue, job);
+			if (retval) job_delete (job);
+		}
+	}
+
+	// like when a ring queue is full
+	if (retval) packet_delete (packet);
+
+	return retval;
+
+}
+
+// packets for the same handler are collected while a received buffer
+// is being handled & then pushed as one job by handler_batch_flush ()
+static _Thread_local Handler *current_batch_handler = NULL;
+static _Thread_local HandlerBatch *current_batch = NULL;
+
+// pushes the packets that have been collected to the handler's job queue
+static void handler_batch_flush (void) {
+
+	if (current_batch) {
+		Handler *handler = current_batch_handler;
+		HandlerBatch *batch = current_batch;
+
+		current_batch_handler = NULL;
+		current_batch = NULL;
+
+		Job *job = job_create (handler_batch_job, batch);
+		if (job) job->queued_time = cerver_stats_latency_start (handler->cerver->stats);
+
+		if (!job || job_queue_push (handler->job_queue, job)) {
+			cerver_log_error (
+				"Failed to push a batch of %lu packets to cerver's %s handler!",
+				batch->n_packets, handler->cerver->info->name->str
+			);
+
+			for (size_t i = 0; i < batch->n_packets; i++)
+				packet_delete (batch->packets[i]);
+
+			handler_batch_delete (batch);
+			job_delete (job);
+		}
+	}
+
+}
+
+// adds the packet to the current batch of the handler,
+// a batch is pushed when it is full or when another handler is used
+// packet views are copied first as their buffer will be reused
+// the packet is deleted if it can't be added
+static u8 handler_batch_push_packet (Handler *handler, Packet *packet) {
+
+	u8 retval = 1;
+
+	if (!packet_retain (packet)) {
+		handler_packet_retain (handler, packet);
+
+		if (
+			current_batch
+			&& (
+				(current_batch_handler != handler)
+				|| (current_batch->n_packets >= handler->batch_size)
+			)
+		) {
+			handler_batch_flush ();
+		}
+
+		if (!current_batch) {
+			current_batch = handler_batch_new ();
+			current_batch_handler = handler;
+		}
+
+		if (current_batch) {
+			current_batch->packets[current_batch->n_packets] = packet;
+			current_batch->n_packets += 1;
+
+			retval = 0;
+		}
+	}
+
+	if (retval) packet_delete (packet);
+
+	return retval;
+
+}
+
+// app packets are added to a batch if the handler has a batch size
+static inline u8 cerver_app_handler_push_packet (
+	Handler *handler, Packet *packet
+) {
+
+	u8 retval = 1;
+
+	if (handler->batch_size) {
+		retval = handler_batch_push_packet (handler, packet);
+	}
+
+	else {
+		// keeps the packets of the connection in order
+		handler_batch_flush ();
+
+		retval = handler_push_packet (handler, packet);
+	}
+
+	return retval;
+
+}
+
+// spreads sequential ids & pointers between the handlers
+static inline unsigned int cerver_app_handler_hash (
+	const u64 key, const unsigned int n_handlers
+) {
+
+	return (unsigned int) (((key * 0x9E3779B97F4A7C15ULL) >> 32) % n_handlers);
+
+}
+
+// returns the idx of the handler that will handle the packet
+// based on the cerver's handlers routing
+static unsigned int cerver_app_handler_select (Packet *packet) {
+
+	unsigned int idx = 0;
+
+	switch (packet->cerver->handlers_routing) {
+		case CERVER_HANDLERS_ROUTING_CLIENT:
+			idx = cerver_app_handler_hash (
+				packet->client->id, packet->cerver->n_handlers
+			);
+			break;
+
+		case CERVER_HANDLERS_ROUTING_CONNECTION:
+			idx = cerver_app_handler_hash (
+				(u64) (uintptr_t) packet->connection >> 4, packet->cerver->n_handlers
+			);
+			break;
+
+		default:
+			idx = packet->header->handler_id;
+			break;
+	}
+
+	return idx;
+
+}
+
+// handles an PACKET_TYPE_APP packet type
+static void cerver_app_packet_handler (Packet *packet) {
+
+	if (packet->cerver->multiple_handlers) {
+		// select which handler to use
+		unsigned int idx = cerver_app_handler_select (packet);
+		if ((idx < packet->cerver->n_handlers) && packet->cerver->handlers[idx]) {
+			// add the packet to the handler's job queueu to be handled
+			// as soon as the handler is available
+			if (cerver_app_handler_push_packet (
+				packet->cerver->handlers[idx], packet
+			)) {
+				cerver_log_error (
+					"Failed to push a new job to cerver's %s <%u> handler!",
+					packet->cerver->info->name->str, idx
+				);
+			}
+		}
+
+		else {
+			#ifdef HANDLER_DEBUG
+			cerver_log_warning (
+				"Cerver %s does not have a <%u> handler!",
+				packet->cerver->info->name->str, idx
+			);
+			#endif
+
+			packet_delete (packet);
+		}
+	}
+
+	else {
+		if (packet->cerver->app_packet_handler) {
+			if (packet->cerver->app_packet_handler->direct_handle) {
+				// printf ("app_packet_handler - direct handle!\n");
+				// keeps the packets of the connection in order
+				handler_batch_flush ();
+
+				// the handler will keep the packet, so it can't be a view
+				if (!packet->cerver->app_packet_handler_delete_packet)
+					(void) packet_retain (packet);
+
+				const u64 start = cerver_stats_latency_start (packet->cerver->stats);
+
+				packet->cerver->app_packet_handler->handler (packet);
+
+				cerver_stats_handler_latency_end (packet->cerver->stats, PACKET_TYPE_APP, start, 1);
+
+				if (packet->cerver->app_packet_handler_delete_packet)
+					packet_delete (packet);
+			}
+
+			else {
+				// add the packet to the handler's job queueu to be handled
 				// as soon as the handler is available
-				if (job_queue_push (
-					packet->cerver->app_packet_handler->job_queue,
-					job_create (NULL, packet)
+				if (cerver_app_handler_push_packet (
+					packet->cerver->app_packet_handler, packet
 				)) {
 					cerver_log_error (
 						"Failed to push a new job to cerver's %s app_packet_handler!",
@@ -951,7 +1589,16 @@ static void cerver_app_error_packet_handler (Packet *packet) {
 	if (packet->cerver->app_error_packet_handler) {
 		if (packet->cerver->app_error_packet_handler->direct_handle) {
 			// printf ("app_error_packet_handler - direct handle!\n");
+			// the handler will keep the packet, so it can't be a view
+			if (!packet->cerver->app_error_packet_handler_delete_packet)
+				(void) packet_retain (packet);
+
+			const u64 start = cerver_stats_latency_start (packet->cerver->stats);
+
 			packet->cerver->app_error_packet_handler->handler (packet);
+
+			cerver_stats_handler_latency_end (packet->cerver->stats, PACKET_TYPE_APP_ERROR, start, 1);
+
 			if (packet->cerver->app_error_packet_handler_delete_packet)
 				packet_delete (packet);
 		}
@@ -959,9 +1606,8 @@ static void cerver_app_error_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->app_error_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->cerver->app_error_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s app_error_packet_handler!",
@@ -986,7 +1632,16 @@ static void cerver_custom_packet_handler (Packet *packet) {
 	if (packet->cerver->custom_packet_handler) {
 		if (packet->cerver->custom_packet_handler->direct_handle) {
 			// printf ("custom_packet_handler - direct handle!\n");
+			// the handler will keep the packet, so it can't be a view
+			if (!packet->cerver->custom_packet_handler_delete_packet)
+				(void) packet_retain (packet);
+
+			const u64 start = cerver_stats_latency_start (packet->cerver->stats);
+
 			packet->cerver->custom_packet_handler->handler (packet);
+
+			cerver_stats_handler_latency_end (packet->cerver->stats, PACKET_TYPE_CUSTOM, start, 1);
+
 			if (packet->cerver->custom_packet_handler_delete_packet)
 				packet_delete (packet);
 		}
@@ -994,9 +1649,8 @@ static void cerver_custom_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->custom_packet_handler->job_queue,
-				job_create (NULL, packet)
+			if (handler_push_packet (
+				packet->cerver->custom_packet_handler, packet
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s custom_packet_handler!",
@@ -1047,107 +1701,113 @@ static CerverHandlerError cerver_packet_handler_check_version (
 
 }
 
+// counts a received packet in the cerver, client, connection & lobby stats
+static inline void cerver_packet_handler_update_stats (const Packet *packet) {
+
+	const PacketType packet_type = packet->header->packet_type;
+
+	packets_per_type_add (cerver_stats_packets (packet->cerver->stats, false), packet_type, 1);
+	packets_per_type_add (packet->client->stats->received_packets, packet_type, 1);
+	packets_per_type_add (packet->connection->stats->received_packets, packet_type, 1);
+	if (packet->lobby) packets_per_type_add (packet->lobby->stats->received_packets, packet_type, 1);
+
+}
+
+static inline void cerver_packet_handler_update_bad_stats (const Packet *packet) {
+
+	(void) __atomic_add_fetch (
+		&cerver_stats_packets (packet->cerver->stats, false)->n_bad_packets, 1, __ATOMIC_RELAXED
+	);
+
+	(void) __atomic_add_fetch (&packet->client->stats->received_packets->n_bad_packets, 1, __ATOMIC_RELAXED);
+	(void) __atomic_add_fetch (&packet->connection->stats->received_packets->n_bad_packets, 1, __ATOMIC_RELAXED);
+
+	if (packet->lobby) {
+		(void) __atomic_add_fetch (&packet->lobby->stats->received_packets->n_bad_packets, 1, __ATOMIC_RELAXED);
+	}
+
+}
+
 static CerverHandlerError cerver_packet_handler_actual (
 	Packet *packet
 ) {
 
 	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
 
-	switch (packet->header->packet_type) {
+	// the packet may be deleted by its handler
+	Cerver *cerver = packet->cerver;
+	const PacketType packet_type = packet->header->packet_type;
+	const u64 start = cerver_stats_latency_start (cerver->stats);
+
+	// packets that are not batched can't be handled
+	// before the ones in the pending batch
+	if (packet_type != PACKET_TYPE_APP) handler_batch_flush ();
+
+	switch (packet_type) {
 		case PACKET_TYPE_NONE: break;
 
 		case PACKET_TYPE_CERVER: break;
 
 		case PACKET_TYPE_CLIENT:
-			packet->cerver->stats->received_packets->n_client_packets += 1;
-			packet->client->stats->received_packets->n_client_packets += 1;
-			packet->connection->stats->received_packets->n_client_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_client_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			error = cerver_client_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles an error from the client
 		case PACKET_TYPE_ERROR:
-			packet->cerver->stats->received_packets->n_error_packets += 1;
-			packet->client->stats->received_packets->n_error_packets += 1;
-			packet->connection->stats->received_packets->n_error_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_error_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			cerver_error_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles a request made from the client
 		case PACKET_TYPE_REQUEST:
-			packet->cerver->stats->received_packets->n_request_packets += 1;
-			packet->client->stats->received_packets->n_request_packets += 1;
-			packet->connection->stats->received_packets->n_request_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_request_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			cerver_request_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles authentication packets
 		case PACKET_TYPE_AUTH:
-			packet->cerver->stats->received_packets->n_auth_packets += 1;
-			packet->client->stats->received_packets->n_auth_packets += 1;
-			packet->connection->stats->received_packets->n_auth_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_auth_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			/* TODO: */
 			packet_delete (packet);
 			break;
 
 		// handles a game packet sent from the client
 		case PACKET_TYPE_GAME:
-			packet->cerver->stats->received_packets->n_game_packets += 1;
-			packet->client->stats->received_packets->n_game_packets += 1;
-			packet->connection->stats->received_packets->n_game_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_game_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			game_packet_handler (packet);
 			break;
 
 		// user set handler to handle app specific packets
 		case PACKET_TYPE_APP:
-			packet->cerver->stats->received_packets->n_app_packets += 1;
-			packet->client->stats->received_packets->n_app_packets += 1;
-			packet->connection->stats->received_packets->n_app_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_app_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			cerver_app_packet_handler (packet);
 			break;
 
 		// user set handler to handle app specific errors
 		case PACKET_TYPE_APP_ERROR:
-			packet->cerver->stats->received_packets->n_app_error_packets += 1;
-			packet->client->stats->received_packets->n_app_error_packets += 1;
-			packet->connection->stats->received_packets->n_app_error_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_app_error_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			cerver_app_error_packet_handler (packet);
 			break;
 
 		// custom packet hanlder
 		case PACKET_TYPE_CUSTOM:
-			packet->cerver->stats->received_packets->n_custom_packets += 1;
-			packet->client->stats->received_packets->n_custom_packets += 1;
-			packet->connection->stats->received_packets->n_custom_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_custom_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			cerver_custom_packet_handler (packet);
 			break;
 
 		// acknowledge the client we have received his test packet
 		case PACKET_TYPE_TEST:
-			packet->cerver->stats->received_packets->n_test_packets += 1;
-			packet->client->stats->received_packets->n_test_packets += 1;
-			packet->connection->stats->received_packets->n_test_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_test_packets += 1;
+			cerver_packet_handler_update_stats (packet);
 			cerver_test_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		default: {
-			packet->cerver->stats->received_packets->n_bad_packets += 1;
-			packet->client->stats->received_packets->n_bad_packets += 1;
-			packet->connection->stats->received_packets->n_bad_packets += 1;
-			if (packet->lobby) packet->lobby->stats->received_packets->n_bad_packets += 1;
+			cerver_packet_handler_update_bad_stats (packet);
 			#ifdef HANDLER_DEBUG
 			cerver_log (
 				LOG_TYPE_WARNING, LOG_TYPE_PACKET,
@@ -1159,6 +1819,20 @@ static CerverHandlerError cerver_packet_handler_actual (
 		} break;
 	}
 
+	// app packets record their latency where their handler is called
+	switch (packet_type) {
+		case PACKET_TYPE_CLIENT:
+		case PACKET_TYPE_ERROR:
+		case PACKET_TYPE_REQUEST:
+		case PACKET_TYPE_AUTH:
+		case PACKET_TYPE_GAME:
+		case PACKET_TYPE_TEST:
+			cerver_stats_handler_latency_end (cerver->stats, packet_type, start, 1);
+			break;
+
+		default: break;
+	}
+
 	return error;
 
 }
@@ -1197,6 +1871,12 @@ static u8 cerver_packet_select_handler (
 
 	u8 retval = 1;
 
+	cerver_stats_latency_end (
+		receive_handle->cerver->stats,
+		CERVER_STATS_LATENCY_RECEIVE_DISPATCH,
+		receive_handle->received_time
+	);
+
 	switch (receive_handle->type) {
 		case RECEIVE_TYPE_NONE: break;
 
@@ -1205,13 +1885,13 @@ static u8 cerver_packet_select_handler (
 			packet->client = receive_handle->client;
 			packet->connection = receive_handle->connection;
 
-			packet->cerver->stats->client_n_packets_received += 1;
-			packet->cerver->stats->total_n_packets_received += 1;
+			cerver_stats_add (packet->cerver->stats, CERVER_STATS_CLIENT_N_PACKETS_RECEIVED, 1);
+			cerver_stats_add (packet->cerver->stats, CERVER_STATS_TOTAL_N_PACKETS_RECEIVED, 1);
 
-			packet->client->stats->n_packets_received += 1;
+			(void) __atomic_add_fetch (&packet->client->stats->n_packets_received, 1, __ATOMIC_RELAXED);
 			packet->connection->stats->n_packets_received += 1;
 
-			if (packet->lobby) packet->lobby->stats->n_packets_received += 1;
+			if (packet->lobby) (void) __atomic_add_fetch (&packet->lobby->stats->n_packets_received, 1, __ATOMIC_RELAXED);
 
 			retval = cerver_packet_handler (packet);
 		} break;
@@ -1220,7 +1900,7 @@ static u8 cerver_packet_select_handler (
 			packet->cerver = receive_handle->cerver;
 			packet->connection = receive_handle->connection;
 
-			packet->cerver->stats->on_hold_n_packets_received += 1;
+			cerver_stats_add (packet->cerver->stats, CERVER_STATS_ON_HOLD_N_PACKETS_RECEIVED, 1);
 			packet->connection->stats->n_packets_received += 1;
 
 			retval = on_hold_packet_handler (packet);
@@ -1231,9 +1911,9 @@ static u8 cerver_packet_select_handler (
 			packet->connection = receive_handle->connection;
 			packet->client = receive_handle->admin->client;
 
-			packet->cerver->admin->stats->total_n_packets_received += 1;
+			(void) __atomic_add_fetch (&packet->cerver->admin->stats->total_n_packets_received, 1, __ATOMIC_RELAXED);
 
-			receive_handle->admin->client->stats->n_packets_received += 1;
+			(void) __atomic_add_fetch (&receive_handle->admin->client->stats->n_packets_received, 1, __ATOMIC_RELAXED);
 
 			packet->connection->stats->n_packets_received += 1;
 
@@ -1253,10 +1933,13 @@ static u8 cerver_packet_select_handler (
 
 u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd);
 
+static Slab receive_handles_slab = SLAB_INITIALIZER ("receive-handles", ReceiveHandle);
+static Slab cerver_receives_slab = SLAB_INITIALIZER ("cerver-receives", CerverReceive);
+
 static ReceiveHandle *receive_handle_new (void) {
 
 	ReceiveHandle *receive_handle =
-		(ReceiveHandle *) malloc (sizeof (ReceiveHandle));
+		(ReceiveHandle *) slab_alloc (&receive_handles_slab);
 
 	if (receive_handle) {
 		receive_handle->type = RECEIVE_TYPE_NONE;
@@ -1272,6 +1955,8 @@ static ReceiveHandle *receive_handle_new (void) {
 
 		receive_handle->buffer = NULL;
 		receive_handle->buffer_size = 0;
+
+		receive_handle->received_time = 0;
 	}
 
 	return receive_handle;
@@ -1280,13 +1965,13 @@ static ReceiveHandle *receive_handle_new (void) {
 
 void receive_handle_delete (void *receive_ptr) {
 	
-	if (receive_ptr) free (receive_ptr);
+	slab_free (&receive_handles_slab, receive_ptr);
 	
 }
 
 CerverReceive *cerver_receive_new (void) {
 
-	CerverReceive *cr = (CerverReceive *) malloc (sizeof (CerverReceive));
+	CerverReceive *cr = (CerverReceive *) slab_alloc (&cerver_receives_slab);
 	if (cr) {
 		cr->type = RECEIVE_TYPE_NONE;
 
@@ -1304,23 +1989,30 @@ CerverReceive *cerver_receive_new (void) {
 
 }
 
-void cerver_receive_delete (void *ptr) { if (ptr) free (ptr); }
+void cerver_receive_delete (void *ptr) { slab_free (&cerver_receives_slab, ptr); }
 
 static inline void cerver_receive_create_normal (
 	CerverReceive *cr,
 	Cerver *cerver, const i32 sock_fd
 ) {
 
-	cr->client = client_get_by_sock_fd (cerver, sock_fd);
-	if (cr->client) {
-		cr->connection = connection_get_by_sock_fd_from_client (cr->client, sock_fd);
-		if (cr->connection) {
-			cr->socket = cr->connection->socket;
-		}
+	// the client & the connection are found with a single lookup
+	ReceiveType receive_type = RECEIVE_TYPE_NONE;
+	if (
+		cerver_fd_table_get (
+			cerver->fd_table, sock_fd,
+			&receive_type, &cr->client, &cr->connection
+		)
+		&& (receive_type == RECEIVE_TYPE_NORMAL)
+	) {
+		cr->socket = cr->connection->socket;
 	}
 
 	// for what ever reason we have a rogue connection
 	else {
+		cr->client = NULL;
+		cr->connection = NULL;
+
 		// #ifdef CERVER_DEBUG
 		cerver_log_error (
 			"cerver_receive_create () - RECEIVE_TYPE_NORMAL - no client with sock fd <%d>",
@@ -1331,9 +2023,8 @@ static inline void cerver_receive_create_normal (
 		// remove the sock fd from the cerver's main poll array
 		cerver_poll_unregister_sock_fd (cerver, sock_fd);
 
-		// try to remove the sock fd from the cerver's map
-		const void *key = &sock_fd;
-		htab_remove (cerver->client_sock_fd_map, key, sizeof (i32));
+		// try to remove the sock fd from the cerver's table
+		(void) cerver_fd_table_remove (cerver->fd_table, sock_fd, NULL);
 
 		close (sock_fd);        // just close the socket
 	}
@@ -1453,318 +2144,214 @@ CerverReceive *cerver_receive_create_full (
 
 }
 
-static u8 cerver_receive_handle_spare_packet (
-	ReceiveHandle *receive_handle,
-	SockReceive *sock_receive,
-	size_t received_size,
-	char **end, size_t *buffer_pos
+// creates a packet for a complete packet found in the received buffer
+// & handles it based on the receive type
+// returns 0 to keep handling packets, 1 to stop
+static u8 cerver_receive_handle_frame (
+	void *receive_handle_ptr,
+	PacketHeader *header,
+	char *data, const size_t data_size
 ) {
 
-	u8 errors = 0;
-
-	if (sock_receive->header) {
-		// copy the remaining header size
-		(void) memcpy (
-			sock_receive->header_end,
-			(void *) *end,
-			sock_receive->remaining_header
-		);
-		
-		// *end += sock_receive->remaining_header;
-		// *buffer_pos += sock_receive->remaining_header;
-
-		// printf ("size in new header: %ld\n", ((PacketHeader *) sock_receive->header)->packet_size);
-		// packet_header_print (((PacketHeader *) sock_receive->header));
+	ReceiveHandle *receive_handle = (ReceiveHandle *) receive_handle_ptr;
 
-		sock_receive->complete_header = true;
+	u8 retval = 0;
+
+	Packet *packet = NULL;
+	if (
+		receive_handle->cerver->receive_packet_views
+		&& (receive_handle->type == RECEIVE_TYPE_NORMAL)
+		&& !(
+			(header->packet_type == PACKET_TYPE_REQUEST)
+			&& (header->request_type == REQUEST_PACKET_TYPE_SEND_FILE)
+		)
+	) {
+		// the packet is handled in place
+		packet = packet_create_view (header, data, data_size);
 	}
 
-	else if (sock_receive->spare_packet) {
-		size_t copy_to_spare = 0;
-		if (sock_receive->missing_packet < received_size)
-			copy_to_spare = sock_receive->missing_packet;
-
-		else copy_to_spare = received_size;
-
-		// printf ("copy to spare: %ld\n", copy_to_spare);
-
-		// append new data from buffer to the spare packet
-		if (copy_to_spare > 0) {
-			(void) packet_append_data (
-				sock_receive->spare_packet, (void *) *end, copy_to_spare
-			);
+	else {
+		packet = packet_new ();
+		if (packet) {
+			(void) packet_header_copy (&packet->header, header);
+			packet->packet_size = header->packet_size;
 
-			// check if we can handle the packet
-			size_t curr_packet_size = sock_receive->spare_packet->data_size + sizeof (PacketHeader);
-			if (sock_receive->spare_packet->header->packet_size == curr_packet_size) {
-				errors = cerver_packet_select_handler (
-					receive_handle, sock_receive->spare_packet
-				);
+			(void) packet_set_data (packet, (void *) data, data_size);
+		}
+	}
 
-				sock_receive->spare_packet = NULL;
-				sock_receive->missing_packet = 0;
-			}
+	if (packet) {
+		packet->cerver = receive_handle->cerver;
+		packet->lobby = receive_handle->lobby;
 
-			else {
-				sock_receive->missing_packet -= copy_to_spare;
-			}
+		retval = cerver_packet_select_handler (receive_handle, packet);
+	}
 
-			// offset for the buffer
-			if (copy_to_spare < received_size) *end += copy_to_spare;
-			*buffer_pos += copy_to_spare;
-			// printf ("buffer pos after copy to spare: %ld\n", *buffer_pos);
-		}
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_PACKET,
+			"Failed to create a new packet in cerver_handle_receive_buffer ()"
+		);
 	}
 
-	return errors;
+	return retval;
 
 }
 
-static void cerver_receive_handle_buffer_internal (
-	ReceiveHandle *receive_handle,
-	char *end, size_t buffer_pos
+// default cerver receive handler
+void cerver_receive_handle_buffer (
+	void *receive_handle_ptr
 ) {
 
-	Cerver *cerver = receive_handle->cerver;
-	// char *buffer = receive_handle->buffer;
-	// size_t buffer_size = receive_handle->buffer_size;
-	size_t received_size = receive_handle->received_size;
-	Lobby *lobby = receive_handle->lobby;
-
-	SockReceive *sock_receive = receive_handle->connection->sock_receive;
-
-	PacketHeader *header = NULL;
-	size_t packet_size = 0;
+	ReceiveHandle *receive_handle = (ReceiveHandle *) receive_handle_ptr;
 
-	size_t remaining_buffer_size = 0;
-	size_t packet_real_size = 0;
-	size_t to_copy_size = 0;
+	(void) sock_receive_handle_buffer (
+		receive_handle->connection->sock_receive,
+		receive_handle->buffer, receive_handle->received_size,
+		cerver_receive_handle_frame, receive_handle
+	);
 
-	bool spare_header = false;
+}
 
-	u8 stop_handler = 0;
-	do {
-		remaining_buffer_size = received_size - buffer_pos;
+// handles every complete packet in a datagram received from a udp peer
+// packets are never reassembled between datagrams, so the rest of
+// the datagram is discarded when an invalid or incomplete packet is found
+// returns 0 on success, 1 if the datagram had an invalid packet
+u8 cerver_receive_handle_datagram (
+	Cerver *cerver,
+	Client *client, Connection *connection,
+	char *buffer, const size_t received
+) {
 
-		if (sock_receive->complete_header) {
-			(void) packet_header_copy (&header, (PacketHeader *) sock_receive->header);
-			// header = ((PacketHeader *) sock_receive->header);
-			// packet_header_print (header);
+	u8 retval = 0;
+
+	const u64 received_time = cerver_stats_latency_start (cerver->stats);
+
+	cerver_stats_add (cerver->stats, CERVER_STATS_TOTAL_N_RECEIVES_DONE, 1);
+	cerver_stats_add (cerver->stats, CERVER_STATS_TOTAL_BYTES_RECEIVED, received);
+	cerver_stats_add (cerver->stats, CERVER_STATS_CLIENT_RECEIVES_DONE, 1);
+	cerver_stats_add (cerver->stats, CERVER_STATS_CLIENT_BYTES_RECEIVED, received);
+
+	(void) __atomic_add_fetch (&client->stats->n_receives_done, 1, __ATOMIC_RELAXED);
+	(void) __atomic_add_fetch (&client->stats->total_bytes_received, received, __ATOMIC_RELAXED);
+
+	// checked by the peer's inactive timer when it expires
+	const time_t now = time (NULL);
+	if (__atomic_load_n (&client->last_activity, __ATOMIC_RELAXED) != now)
+		__atomic_store_n (&client->last_activity, now, __ATOMIC_RELAXED);
+
+	connection->stats->n_receives_done += 1;
+	connection->stats->total_bytes_received += received;
+
+	ReceiveHandle receive_handle = {
+		.type = RECEIVE_TYPE_NORMAL,
+		.cerver = cerver,
+		.socket = connection->socket,
+		.connection = connection,
+		.client = client,
+		.admin = NULL,
+		.lobby = NULL,
+		.buffer = buffer,
+		.buffer_size = received,
+		.received_size = received,
+		.received_time = received_time
+	};
+
+	// a custom receive handler gets the whole datagram
+	if (cerver->handle_received_buffer != cerver_receive_handle_buffer) {
+		cerver->handle_received_buffer (&receive_handle);
+	}
 
-			end += sock_receive->remaining_header;
-			buffer_pos += sock_receive->remaining_header;
-			// printf ("buffer pos after copy to header: %ld\n", buffer_pos);
+	else {
+		char *end = buffer;
+		size_t remaining = received;
 
-			// reset sock header values
-			free (sock_receive->header);
-			sock_receive->header = NULL;
-			sock_receive->header_end = NULL;
-			// sock_receive->curr_header_pos = 0;
-			// sock_receive->remaining_header = 0;
-			sock_receive->complete_header = false;
+		size_t frame_size = 0;
+		while (remaining) {
+			frame_size = (remaining >= sizeof (PacketHeader)) ?
+				((PacketHeader *) end)->packet_size : 0;
 
-			spare_header = true;
-		}
+			if ((frame_size < sizeof (PacketHeader)) || (frame_size > remaining)) {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_WARNING, LOG_TYPE_PACKET,
+					"Got a datagram with an invalid packet in cerver %s",
+					cerver->info->name->str
+				);
+				#endif
 
-		else if (remaining_buffer_size >= sizeof (PacketHeader)) {
-			header = (PacketHeader *) end;
-			end += sizeof (PacketHeader);
-			buffer_pos += sizeof (PacketHeader);
+				retval = 1;
+				break;
+			}
 
-			// packet_header_print (header);
+			if (cerver_receive_handle_frame (
+				&receive_handle,
+				(PacketHeader *) end,
+				end + sizeof (PacketHeader),
+				frame_size - sizeof (PacketHeader)
+			)) break;
 
-			spare_header = false;
+			end += frame_size;
+			remaining -= frame_size;
 		}
+	}
 
-		if (header) {
-			// TODO: add check for max packet size
-			// check the packet size
-			packet_size = header->packet_size;
-			if ((packet_size > 0) /* && (packet_size < 65536) */) {
-				// printf ("packet_size: %ld\n", packet_size);
-				// printf ("first buffer pos: %ld\n", buffer_pos);
-
-				Packet *packet = packet_new ();
-				if (packet) {
-					packet_header_copy (&packet->header, header);
-					packet->packet_size = header->packet_size;
-					packet->cerver = cerver;
-					packet->lobby = lobby;
+	// push the packets that were collected for batch handlers
+	handler_batch_flush ();
 
-					if (spare_header) {
-						free (header);
-						header = NULL;
-					}
+	return retval;
 
-					// check for packet size and only copy what is in the current buffer
-					packet_real_size = packet->header->packet_size - sizeof (PacketHeader);
-					to_copy_size = 0;
-					if ((remaining_buffer_size - sizeof (PacketHeader)) < packet_real_size) {
-						sock_receive->spare_packet = packet;
+}
 
-						if (spare_header) to_copy_size = received_size - sock_receive->remaining_header;
-						else to_copy_size = remaining_buffer_size - sizeof (PacketHeader);
+// handles a failed receive from a connection associatd with a client
+// ends the connection to prevent seg faults or signals for bad sock fd
+void cerver_receive_handle_failed (CerverReceive *cr) {
 
-						sock_receive->missing_packet = packet_real_size - to_copy_size;
-					}
+	if (cr->socket) {
+		(void) pthread_mutex_lock (cr->socket->read_mutex);
 
-					else {
-						if (
-							(header->packet_type == PACKET_TYPE_REQUEST)
-							&& (header->request_type == REQUEST_PACKET_TYPE_SEND_FILE)
-						) {
-							to_copy_size = remaining_buffer_size - sizeof (PacketHeader);
+		if (cr->socket->sock_fd > 0) {
+			switch (cr->type) {
+				case RECEIVE_TYPE_NORMAL: {
+					// check if the socket belongs to a player inside a lobby
+					if (cr->lobby) {
+						if (cr->lobby->players->size > 0) {
+							(void) player_unregister_from_lobby (
+								cr->lobby,
+								player_get_by_sock_fd_list (
+									cr->lobby, cr->socket->sock_fd
+								)
+							);
 						}
+					}
 
-						else {
-							to_copy_size = packet_real_size;
-						}
+					(void) client_remove_connection_by_sock_fd (
+						cr->cerver, cr->client, cr->socket->sock_fd
+					);
+				} break;
 
-						packet_delete (sock_receive->spare_packet);
-						sock_receive->spare_packet = NULL;
-					}
+				case RECEIVE_TYPE_ON_HOLD: {
+					on_hold_connection_drop (cr->cerver, cr->connection);
+				} break;
 
-					// printf ("to copy size: %ld\n", to_copy_size);
-					(void) packet_set_data (packet, (void *) end, to_copy_size);
+				case RECEIVE_TYPE_ADMIN: {
+					(void) admin_remove_connection_by_sock_fd (
+						cr->cerver->admin, cr->admin, cr->socket->sock_fd
+					);
+				} break;
 
-					end += to_copy_size;
-					buffer_pos += to_copy_size;
-					// printf ("second buffer pos: %ld\n", buffer_pos);
+				default: break;
+			}
+		}
 
-					if (!sock_receive->spare_packet) {
-						stop_handler = cerver_packet_select_handler (
-							receive_handle, packet
-						);
-					}
+		(void) pthread_mutex_unlock (cr->socket->read_mutex);
+	}
 
-				}
-
-				else {
-					cerver_log (
-						LOG_TYPE_ERROR, LOG_TYPE_PACKET,
-						"Failed to create a new packet in cerver_handle_receive_buffer ()"
-					);
-				}
-			}
-
-			else {
-				cerver_log (
-					LOG_TYPE_WARNING, LOG_TYPE_PACKET,
-					"Got a packet of invalid size: %ld", packet_size
-				);
-
-				// FIXME: what to do next?
-
-				break;
-			}
-		}
-
-		else {
-			if (sock_receive->spare_packet) {
-				(void) packet_append_data (
-					sock_receive->spare_packet, (void *) end, remaining_buffer_size
-				);
-			}
-
-			else {
-				// handle part of a new header
-				// cerver_log_debug ("Handle part of a new header...");
-
-				// copy the piece of possible header that was cut of between recv ()
-				sock_receive->header = malloc (sizeof (PacketHeader));
-				(void) memcpy (sock_receive->header, (void *) end, remaining_buffer_size);
-
-				sock_receive->header_end = (char *) sock_receive->header;
-				sock_receive->header_end += remaining_buffer_size;
-
-				// sock_receive->curr_header_pos = remaining_buffer_size;
-				sock_receive->remaining_header = sizeof (PacketHeader) - remaining_buffer_size;
-
-				// printf ("curr header pos: %d\n", sock_receive->curr_header_pos);
-				// printf ("remaining header: %d\n", sock_receive->remaining_header);
-
-				buffer_pos += remaining_buffer_size;
-			}
-		}
-
-		header = NULL;
-	} while ((buffer_pos < received_size) && !stop_handler);
-
-}
-
-// default cerver receive handler
-void cerver_receive_handle_buffer (
-	void *receive_handle_ptr
-) {
-
-	ReceiveHandle *receive_handle = (ReceiveHandle *) receive_handle_ptr;
-	
-	char *end = receive_handle->buffer;
-	size_t buffer_pos = 0;
-
-	if (!cerver_receive_handle_spare_packet (
-		receive_handle,
-		receive_handle->connection->sock_receive,
-		receive_handle->received_size,
-		&end, &buffer_pos
-	)) {
-		cerver_receive_handle_buffer_internal (
-			receive_handle,
-			end, buffer_pos
-		);
-	}
-
-}
-
-// handles a failed receive from a connection associatd with a client
-// ends the connection to prevent seg faults or signals for bad sock fd
-void cerver_receive_handle_failed (CerverReceive *cr) {
-
-	if (cr->socket) {
-		(void) pthread_mutex_lock (cr->socket->read_mutex);
-
-		if (cr->socket->sock_fd > 0) {
-			switch (cr->type) {
-				case RECEIVE_TYPE_NORMAL: {
-					// check if the socket belongs to a player inside a lobby
-					if (cr->lobby) {
-						if (cr->lobby->players->size > 0) {
-							(void) player_unregister_from_lobby (
-								cr->lobby,
-								player_get_by_sock_fd_list (
-									cr->lobby, cr->socket->sock_fd
-								)
-							);
-						}
-					}
-
-					(void) client_remove_connection_by_sock_fd (
-						cr->cerver, cr->client, cr->socket->sock_fd
-					);
-				} break;
-
-				case RECEIVE_TYPE_ON_HOLD: {
-					on_hold_connection_drop (cr->cerver, cr->connection);
-				} break;
-
-				case RECEIVE_TYPE_ADMIN: {
-					(void) admin_remove_connection_by_sock_fd (
-						cr->cerver->admin, cr->admin, cr->socket->sock_fd
-					);
-				} break;
-
-				default: break;
-			}
-		}
-
-		(void) pthread_mutex_unlock (cr->socket->read_mutex);
-	}
-
-}
+}
 
 static inline void cerver_receive_success_receive_handle (
 	CerverReceive *cr,
-	const size_t received,
+	const size_t received, const u64 received_time,
 	char *packet_buffer, const size_t packet_buffer_size
 ) {
 
@@ -1785,10 +2372,15 @@ static inline void cerver_receive_success_receive_handle (
 		receive_handle->buffer_size = packet_buffer_size;
 		receive_handle->received_size = received;
 
+		receive_handle->received_time = received_time;
+
 		switch (receive_handle->cerver->handler_type) {
 			case CERVER_HANDLER_TYPE_NONE: break;
 
-			case CERVER_HANDLER_TYPE_POLL: {
+			case CERVER_HANDLER_TYPE_POLL:
+			case CERVER_HANDLER_TYPE_EPOLL:
+			case CERVER_HANDLER_TYPE_REACTORS:
+			case CERVER_HANDLER_TYPE_IO_URING: {
 				cr->cerver->handle_received_buffer (receive_handle);
 			} break;
 
@@ -1799,6 +2391,9 @@ static inline void cerver_receive_success_receive_handle (
 			default: break;
 		}
 
+		// push the packets that were collected for batch handlers
+		handler_batch_flush ();
+
 		receive_handle_delete (receive_handle);
 	}
 
@@ -1816,42 +2411,54 @@ static void cerver_receive_success (
 	//     cr->cerver->info->name->str, received, cr->socket->sock_fd
 	// );
 
+	const u64 received_time = cerver_stats_latency_start (cr->cerver->stats);
+
 	cr->socket->packet_buffer_size = received;
 
-	cr->cerver->stats->total_n_receives_done += 1;
-	cr->cerver->stats->total_bytes_received += received;
+	cerver_stats_add (cr->cerver->stats, CERVER_STATS_TOTAL_N_RECEIVES_DONE, 1);
+	cerver_stats_add (cr->cerver->stats, CERVER_STATS_TOTAL_BYTES_RECEIVED, received);
 
 	if (cr->lobby) {
-		cr->lobby->stats->n_receives_done += 1;
-		cr->lobby->stats->bytes_received += received;
+		(void) __atomic_add_fetch (&cr->lobby->stats->n_receives_done, 1, __ATOMIC_RELAXED);
+		(void) __atomic_add_fetch (&cr->lobby->stats->bytes_received, received, __ATOMIC_RELAXED);
 	}
 
 	switch (cr->type) {
 		case RECEIVE_TYPE_NORMAL: {
-			cr->cerver->stats->client_receives_done += 1;
-			cr->cerver->stats->client_bytes_received += received;
+			cerver_stats_add (cr->cerver->stats, CERVER_STATS_CLIENT_RECEIVES_DONE, 1);
+			cerver_stats_add (cr->cerver->stats, CERVER_STATS_CLIENT_BYTES_RECEIVED, received);
+
+			(void) __atomic_add_fetch (&cr->client->stats->n_receives_done, 1, __ATOMIC_RELAXED);
+			(void) __atomic_add_fetch (&cr->client->stats->total_bytes_received, received, __ATOMIC_RELAXED);
 
-			cr->client->stats->n_receives_done += 1;
-			cr->client->stats->total_bytes_received += received;
+			// checked by the client's inactive timer & its player timeout when they expire
+			const time_t now = time (NULL);
+			if (__atomic_load_n (&cr->client->last_activity, __ATOMIC_RELAXED) != now)
+				__atomic_store_n (&cr->client->last_activity, now, __ATOMIC_RELAXED);
 
 			cr->connection->stats->n_receives_done += 1;
 			cr->connection->stats->total_bytes_received += received;
+
+			if (cr->connection->reactor) {
+				cr->connection->reactor->stats->n_receives_done += 1;
+				cr->connection->reactor->stats->bytes_received += received;
+			}
 		} break;
 
 		case RECEIVE_TYPE_ON_HOLD: {
-			cr->cerver->stats->on_hold_receives_done += 1;
-			cr->cerver->stats->on_hold_bytes_received += received;
+			cerver_stats_add (cr->cerver->stats, CERVER_STATS_ON_HOLD_RECEIVES_DONE, 1);
+			cerver_stats_add (cr->cerver->stats, CERVER_STATS_ON_HOLD_BYTES_RECEIVED, received);
 
 			cr->connection->stats->n_receives_done += 1;
 			cr->connection->stats->total_bytes_received += received;
 		} break;
 
 		case RECEIVE_TYPE_ADMIN: {
-			cr->cerver->admin->stats->total_n_receives_done += 1;
-			cr->cerver->admin->stats->total_bytes_received += received;
+			(void) __atomic_add_fetch (&cr->cerver->admin->stats->total_n_receives_done, 1, __ATOMIC_RELAXED);
+			(void) __atomic_add_fetch (&cr->cerver->admin->stats->total_bytes_received, received, __ATOMIC_RELAXED);
 
-			cr->client->stats->n_receives_done += 1;
-			cr->client->stats->total_bytes_received += received;
+			(void) __atomic_add_fetch (&cr->client->stats->n_receives_done, 1, __ATOMIC_RELAXED);
+			(void) __atomic_add_fetch (&cr->client->stats->total_bytes_received, received, __ATOMIC_RELAXED);
 
 			cr->connection->stats->n_receives_done += 1;
 			cr->connection->stats->total_bytes_received += received;
@@ -1862,21 +2469,27 @@ static void cerver_receive_success (
 
 	cerver_receive_success_receive_handle (
 		cr,
-		received,
+		received, received_time,
 		packet_buffer, packet_buffer_size
 	);
 
 }
 
-void cerver_receive_internal (
+// performs a single recv () call in the connection's socket using the selected flags
+// returns 0 if data was received & handled, 1 if there is no more data to read
+// or if the connection has failed
+static u8 cerver_receive_actual (
 	CerverReceive *cr,
-	char *packet_buffer, const size_t packet_buffer_size
+	char *packet_buffer, const size_t packet_buffer_size,
+	const int flags
 ) {
 
+	u8 retval = 1;
+
 	ssize_t rc = recv (
 		cr->socket->sock_fd,
 		packet_buffer, packet_buffer_size,
-		0
+		flags
 	);
 
 	switch (rc) {
@@ -1918,9 +2531,26 @@ void cerver_receive_internal (
 				cr, rc,
 				packet_buffer, packet_buffer_size
 			);
+
+			retval = 0;
 		} break;
 	}
 
+	return retval;
+
+}
+
+void cerver_receive_internal (
+	CerverReceive *cr,
+	char *packet_buffer, const size_t packet_buffer_size
+) {
+
+	(void) cerver_receive_actual (
+		cr,
+		packet_buffer, packet_buffer_size,
+		0
+	);
+
 }
 
 // packet buffer only gets deleted if cerver_receive_handle_buffer () is used
@@ -2103,7 +2733,7 @@ static u8 cerver_register_new_connection_auth_required (
 		);
 		#endif
 
-		cerver->stats->total_on_hold_connections += 1;
+		(void) __atomic_add_fetch (&cerver->stats->total_on_hold_connections, 1, __ATOMIC_RELAXED);
 
 		connection->active = true;
 
@@ -2249,7 +2879,10 @@ u8 cerver_register_new_connection_normal_default_select_handler (
 	switch (cerver->handler_type) {
 		case CERVER_HANDLER_TYPE_NONE: break;
 
-		case CERVER_HANDLER_TYPE_POLL: {
+		case CERVER_HANDLER_TYPE_POLL:
+		case CERVER_HANDLER_TYPE_EPOLL:
+		case CERVER_HANDLER_TYPE_REACTORS:
+		case CERVER_HANDLER_TYPE_IO_URING: {
 			// nothing to be done, as connection will be handled by poll ()
 			// after being registered to the cerver
 			retval = 0;     // success
@@ -2342,12 +2975,15 @@ static inline u8 cerver_register_new_connection_select (
 }
 
 static void cerver_register_new_connection (
-	Cerver *cerver,
+	Cerver *cerver, CerverReactor *reactor,
 	const i32 new_fd, const struct sockaddr_storage client_address
 ) {
 
 	Connection *connection = cerver_connection_create (cerver, new_fd, client_address);
 	if (connection) {
+		// the connection will be handled by the reactor that accepted it
+		connection->reactor = reactor;
+
 		// #ifdef CERVER_DEBUG
 		cerver_log (
 			LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
@@ -2391,36 +3027,63 @@ static void cerver_register_new_connection (
 
 }
 
-// accepst a new connection to the cerver
-static void cerver_accept (void *cerver_ptr) {
+// accepts the pending connections in the selected listening socket
+// up to the cerver's accept budget, as the listening socket is non blocking,
+// except with CERVER_HANDLER_TYPE_THREADS that accepts one at a time
+// if a reactor is set, it will handle the new connections
+// the poll lock is only taken to register each new connection,
+// so the poll thread is never blocked by a whole batch
+static void cerver_accept_internal (
+	Cerver *cerver, const i32 sock, CerverReactor *reactor
+) {
 
-	if (cerver_ptr) {
-		Cerver *cerver = (Cerver *) cerver_ptr;
+	const bool batch = (cerver->handler_type != CERVER_HANDLER_TYPE_THREADS);
+	const u32 budget = batch ? cerver->accept_budget : 1;
 
-		struct sockaddr_storage client_address;
-		memset (&client_address, 0, sizeof (struct sockaddr_storage));
-		socklen_t socklen = sizeof (struct sockaddr_storage);
+	struct sockaddr_storage client_address;
+	socklen_t socklen = 0;
+
+	i32 new_fd = -1;
+	for (u32 accepted = 0; accepted < budget; accepted++) {
+		(void) memset (&client_address, 0, sizeof (struct sockaddr_storage));
+		socklen = sizeof (struct sockaddr_storage);
 
 		// accept the new connection
-		i32 new_fd = accept (cerver->sock, (struct sockaddr *) &client_address, &socklen);
-		if (new_fd > 0) {
+		new_fd = accept4 (
+			sock, (struct sockaddr *) &client_address, &socklen, SOCK_CLOEXEC
+		);
+
+		if (new_fd > -1) {
 			#ifdef HANDLER_DEBUG
 			cerver_log_debug ("Accepted fd: %d", new_fd);
 			#endif
-			cerver_register_new_connection (cerver, new_fd, client_address);
+			cerver_register_new_connection (cerver, reactor, new_fd, client_address);
 		}
 
 		else {
 			// if we get EWOULDBLOCK, we have accepted all connections
-			if (errno != EWOULDBLOCK) {
+			if ((errno != EWOULDBLOCK) && (errno != EAGAIN)) {
 				cerver_log (LOG_TYPE_ERROR, LOG_TYPE_CERVER, "Accept failed!");
 				perror ("Error");
 			}
+
+			break;
 		}
 	}
 
 }
 
+// accepst a new connection to the cerver
+static void cerver_accept (void *cerver_ptr) {
+
+	if (cerver_ptr) {
+		Cerver *cerver = (Cerver *) cerver_ptr;
+
+		cerver_accept_internal (cerver, cerver->sock, NULL);
+	}
+
+}
+
 #pragma endregion
 
 #pragma region register
@@ -2439,7 +3102,10 @@ u8 cerver_handler_register_connection (
 			case CERVER_HANDLER_TYPE_NONE: break;
 
 			// handle connection using the cerver's poll
-			case CERVER_HANDLER_TYPE_POLL: {
+			case CERVER_HANDLER_TYPE_POLL:
+			case CERVER_HANDLER_TYPE_EPOLL:
+			case CERVER_HANDLER_TYPE_REACTORS:
+			case CERVER_HANDLER_TYPE_IO_URING: {
 				retval = cerver_poll_register_connection (
 					cerver, connection
 				);
@@ -2478,15 +3144,39 @@ u8 cerver_realloc_main_poll_fds (Cerver *cerver) {
 		);
 
 		if (cerver->fds) {
-			#pragma GCC diagnostic push
-			#pragma GCC diagnostic ignored "-Wunused-value"
+			for (u32 i = current_max; i < cerver->max_n_fds; i++) {
+				cerver->fds[i].fd = -1;
+				cerver->fds[i].events = 0;
+				cerver->fds[i].revents = 0;
+			}
+
+			retval = 0;
+		}
+	}
 
-			for (u32 i = current_max; i < cerver->max_n_fds; i++)
-				cerver->fds[i].fd == -1;
+	return retval;
+
+}
 
-			#pragma GCC diagnostic pop
+// makes sure that the sock fd can be mapped to its idx in the cerver poll fds
+static u8 cerver_poll_fds_idx_reserve (Cerver *cerver, const i32 sock_fd) {
 
-			retval = 0;
+	u8 retval = 0;
+
+	if ((u32) sock_fd >= cerver->fds_idx_size) {
+		u32 new_size = cerver->fds_idx_size ? cerver->fds_idx_size : CERVER_DEFAULT_POLL_FDS;
+		while ((u32) sock_fd >= new_size) new_size *= 2;
+
+		i32 *fds_idx = (i32 *) realloc (cerver->fds_idx, new_size * sizeof (i32));
+		if (fds_idx) {
+			for (u32 i = cerver->fds_idx_size; i < new_size; i++) fds_idx[i] = -1;
+
+			cerver->fds_idx = fds_idx;
+			cerver->fds_idx_size = new_size;
+		}
+
+		else {
+			retval = 1;
 		}
 	}
 
@@ -2495,11 +3185,12 @@ u8 cerver_realloc_main_poll_fds (Cerver *cerver) {
 }
 
 // get a free index in the main cerver poll array
+// new fds are always added after the last one, so the next free idx is current_n_fds
 i32 cerver_poll_get_free_idx (Cerver *cerver) {
 
 	if (cerver) {
-		for (u32 i = 0; i < cerver->max_n_fds; i++)
-			if (cerver->fds[i].fd == -1) return i;
+		if (cerver->current_n_fds < cerver->max_n_fds)
+			return (i32) cerver->current_n_fds;
 	}
 
 	return -1;
@@ -2510,27 +3201,91 @@ i32 cerver_poll_get_free_idx (Cerver *cerver) {
 i32 cerver_poll_get_idx_by_sock_fd (Cerver *cerver, i32 sock_fd) {
 
 	if (cerver) {
-		for (u32 i = 0; i < cerver->max_n_fds; i++)
-			if (cerver->fds[i].fd == sock_fd) return i;
+		if ((sock_fd > -1) && ((u32) sock_fd < cerver->fds_idx_size))
+			return cerver->fds_idx[sock_fd];
 	}
 
 	return -1;
 
 }
 
+// adds a sock fd at the end of the active fds in the cerver poll fds
+// this does NOT update the cerver's connections stats
+// returns the idx where the sock fd was placed, -1 on error
+i32 cerver_poll_add_sock_fd (Cerver *cerver, const i32 sock_fd) {
+
+	i32 idx = -1;
+
+	if (cerver && (sock_fd > -1)) {
+		if (!cerver_poll_fds_idx_reserve (cerver, sock_fd)) {
+			idx = cerver_poll_get_free_idx (cerver);
+			if (idx > -1) {
+				cerver->fds[idx].fd = sock_fd;
+				cerver->fds[idx].events = POLLIN;
+				cerver->fds[idx].revents = 0;
+				cerver->fds_idx[sock_fd] = idx;
+				cerver->current_n_fds++;
+			}
+		}
+	}
+
+	return idx;
+
+}
+
+// removes the fd at idx by leaving a hole in its place
+// holes are only compacted by the poll thread between poll () calls,
+// so the fds that it is polling or walking never move
+static void cerver_poll_remove_idx (Cerver *cerver, const i32 idx) {
+
+	cerver->fds_idx[cerver->fds[idx].fd] = -1;
+
+	cerver->fds[idx].fd = -1;
+	cerver->fds[idx].events = 0;
+	cerver->fds[idx].revents = 0;
+
+	(void) __atomic_add_fetch (&cerver->n_removed_fds, 1, __ATOMIC_RELAXED);
+
+}
+
+// moves the active fds to the front of the poll array to fill the holes
+// left by the removed fds, only the poll thread calls it between poll () calls
+static void cerver_poll_compact (Cerver *cerver) {
+
+	(void) pthread_mutex_lock (cerver->poll_lock);
+
+	u32 n_fds = 0;
+	for (u32 idx = 0; idx < cerver->current_n_fds; idx++) {
+		if (cerver->fds[idx].fd > -1) {
+			if (idx != n_fds) {
+				cerver->fds[n_fds] = cerver->fds[idx];
+				cerver->fds_idx[cerver->fds[n_fds].fd] = (i32) n_fds;
+
+				cerver->fds[idx].fd = -1;
+				cerver->fds[idx].events = 0;
+				cerver->fds[idx].revents = 0;
+			}
+
+			n_fds++;
+		}
+	}
+
+	cerver->current_n_fds = n_fds;
+	__atomic_store_n (&cerver->n_removed_fds, 0, __ATOMIC_RELAXED);
+
+	(void) pthread_mutex_unlock (cerver->poll_lock);
+
+}
+
 static u8 cerver_poll_register_connection_internal (
 	Cerver *cerver, Connection *connection
 ) {
 
 	u8 retval = 1;
 
-	i32 idx = cerver_poll_get_free_idx (cerver);
+	i32 idx = cerver_poll_add_sock_fd (cerver, connection->socket->sock_fd);
 	if (idx > 0) {
-		cerver->fds[idx].fd = connection->socket->sock_fd;
-		cerver->fds[idx].events = POLLIN;
-		cerver->current_n_fds++;
-
-		cerver->stats->current_active_client_connections++;
+		(void) __atomic_add_fetch (&cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
 
 		#ifdef CERVER_DEBUG
 		cerver_log (
@@ -2556,6 +3311,58 @@ static u8 cerver_poll_register_connection_internal (
 
 }
 
+static u8 cerver_epoll_register_connection_internal (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	// connections are edge triggered, so they only wake up the main epoll
+	// when new data arrives & need to be drained on each wakeup
+	struct epoll_event event = { 0 };
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+	event.data.fd = connection->socket->sock_fd;
+
+	if (!epoll_ctl (
+		cerver->epoll_fd, EPOLL_CTL_ADD,
+		connection->socket->sock_fd, &event
+	)) {
+		cerver->current_n_fds++;
+
+		(void) __atomic_add_fetch (&cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Added sock fd <%d> to cerver %s MAIN epoll",
+			connection->socket->sock_fd, cerver->info->name->str
+		);
+		#endif
+
+		#ifdef CERVER_STATS
+		cerver_log (
+			LOG_TYPE_CERVER, LOG_TYPE_NONE,
+			"Cerver %s current active connections: %ld",
+			cerver->info->name->str,
+			cerver->stats->current_active_client_connections
+		);
+		#endif
+
+		retval = 0;
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Failed to add sock fd <%d> to cerver %s MAIN epoll!",
+			connection->socket->sock_fd, cerver->info->name->str
+		);
+	}
+
+	return retval;
+
+}
+
 // regsiters a client connection to the cerver's mains poll structure
 // and maps the sock fd to the client
 // returns 0 on success, 1 on error
@@ -2565,10 +3372,44 @@ u8 cerver_poll_register_connection (
 
 	u8 retval = 1;
 
-	if (cerver && connection) {
+	// only connections that are handled by a poll or an epoll
+	// can wait for their sock fd to be writable
+	if (
+		cerver && connection && !connection->send_queue
+		&& (cerver->send_queue || cerver->send_coalescing)
+		&& (cerver->handler_type != CERVER_HANDLER_TYPE_THREADS)
+	) {
+		connection->send_queue = connection_send_queue_create (
+			cerver,
+			cerver->send_queue_low_watermark, cerver->send_queue_high_watermark
+		);
+
+		if (connection->send_queue)
+			connection->send_queue->coalesce = cerver->send_coalescing;
+	}
+
+	// connections accepted by a reactor are only handled by its own epoll
+	if (cerver && connection && connection->reactor) {
+		retval = cerver_reactor_register_connection (
+			connection->reactor, connection
+		);
+	}
+
+	// receives are completed by the cerver's io_uring
+	else if (cerver && connection && cerver->uring) {
+		retval = cerver_uring_register_connection (cerver, connection);
+	}
+
+	else if (cerver && connection) {
 		pthread_mutex_lock (cerver->poll_lock);
 
-		if (!cerver_poll_register_connection_internal (
+		if (cerver->handler_type == CERVER_HANDLER_TYPE_EPOLL) {
+			retval = cerver_epoll_register_connection_internal (
+				cerver, connection
+			);
+		}
+
+		else if (!cerver_poll_register_connection_internal (
 			cerver, connection
 		)) {
 			retval = 0;
@@ -2606,53 +3447,114 @@ u8 cerver_poll_register_connection (
 
 }
 
-// removes a sock fd from the cerver's main poll array
-// returns 0 on success, 1 on error
-u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd) {
+static u8 cerver_poll_unregister_sock_fd_internal (
+	Cerver *cerver, const i32 sock_fd
+) {
 
 	u8 retval = 1;
 
-	if (cerver) {
-		pthread_mutex_lock (cerver->poll_lock);
+	// get the idx of the sock fd in the cerver poll fds
+	i32 idx = cerver_poll_get_idx_by_sock_fd (cerver, sock_fd);
+	if (idx > 0) {
+		cerver_poll_remove_idx (cerver, idx);
 
-		// get the idx of the sock fd in the cerver poll fds
-		i32 idx = cerver_poll_get_idx_by_sock_fd (cerver, sock_fd);
-		if (idx > 0) {
-			cerver->fds[idx].fd = -1;
-			cerver->fds[idx].events = -1;
-			cerver->current_n_fds--;
+		(void) __atomic_sub_fetch (&cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
 
-			cerver->stats->current_active_client_connections--;
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Removed sock fd <%d> from cerver %s MAIN poll, idx: %d",
+			sock_fd, cerver->info->name->str, idx
+		);
+		#endif
 
-			#ifdef CERVER_DEBUG
-			cerver_log (
-				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-				"Removed sock fd <%d> from cerver %s MAIN poll, idx: %d",
-				sock_fd, cerver->info->name->str, idx
-			);
-			#endif
+		#ifdef CERVER_STATS
+		cerver_log (
+			LOG_TYPE_CERVER, LOG_TYPE_NONE,
+			"Cerver %s current active connections: %ld",
+			cerver->info->name->str,
+			cerver->stats->current_active_client_connections
+		);
+		#endif
 
-			#ifdef CERVER_STATS
-			cerver_log (
-				LOG_TYPE_CERVER, LOG_TYPE_NONE,
-				"Cerver %s current active connections: %ld",
-				cerver->info->name->str,
-				cerver->stats->current_active_client_connections
-			);
-			#endif
+		retval = 0;     // removed the sock fd form the cerver poll
+	}
 
-			retval = 0;     // removed the sock fd form the cerver poll
-		}
+	else {
+		// #ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+			"Sock fd <%d> was NOT found in cerver %s MAIN poll!",
+			sock_fd, cerver->info->name->str
+		);
+		// #endif
+	}
 
-		else {
-			// #ifdef CERVER_DEBUG
-			cerver_log (
-				LOG_TYPE_WARNING, LOG_TYPE_CERVER,
-				"Sock fd <%d> was NOT found in cerver %s MAIN poll!",
-				sock_fd, cerver->info->name->str
-			);
-			// #endif
-		}
+	return retval;
+
+}
+
+static u8 cerver_epoll_unregister_sock_fd_internal (
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	u8 retval = 1;
+
+	if (!epoll_ctl (cerver->epoll_fd, EPOLL_CTL_DEL, sock_fd, NULL)) {
+		cerver->current_n_fds--;
+
+		(void) __atomic_sub_fetch (&cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Removed sock fd <%d> from cerver %s MAIN epoll",
+			sock_fd, cerver->info->name->str
+		);
+		#endif
+
+		#ifdef CERVER_STATS
+		cerver_log (
+			LOG_TYPE_CERVER, LOG_TYPE_NONE,
+			"Cerver %s current active connections: %ld",
+			cerver->info->name->str,
+			cerver->stats->current_active_client_connections
+		);
+		#endif
+
+		retval = 0;     // removed the sock fd form the cerver epoll
+	}
+
+	else {
+		// #ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+			"Sock fd <%d> was NOT found in cerver %s MAIN epoll!",
+			sock_fd, cerver->info->name->str
+		);
+		// #endif
+	}
+
+	return retval;
+
+}
+
+// removes a sock fd from the cerver's main poll array
+// returns 0 on success, 1 on error
+u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd) {
+
+	u8 retval = 1;
+
+	if (cerver && cerver->uring) {
+		retval = cerver_uring_unregister_sock_fd (cerver, sock_fd);
+	}
+
+	else if (cerver) {
+		pthread_mutex_lock (cerver->poll_lock);
+
+		retval = (cerver->handler_type == CERVER_HANDLER_TYPE_EPOLL) ?
+			cerver_epoll_unregister_sock_fd_internal (cerver, sock_fd) :
+			cerver_poll_unregister_sock_fd_internal (cerver, sock_fd);
 
 		pthread_mutex_unlock (cerver->poll_lock);
 	}
@@ -2665,8 +3567,94 @@ u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd) {
 // returns 0 on success, 1 on error
 u8 cerver_poll_unregister_connection (Cerver *cerver, Connection *connection) {
 
-	return (cerver && connection) ?
-		cerver_poll_unregister_sock_fd (cerver, connection->socket->sock_fd) : 1;
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		retval = connection->reactor ?
+			cerver_reactor_unregister_sock_fd (connection->reactor, connection->socket->sock_fd) :
+			cerver_poll_unregister_sock_fd (cerver, connection->socket->sock_fd);
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_epoll_set_writable (
+	int epoll_fd, const i32 sock_fd, bool writable
+) {
+
+	struct epoll_event event = { 0 };
+	event.events = writable ?
+		(EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET) : (EPOLLIN | EPOLLRDHUP | EPOLLET);
+	event.data.fd = sock_fd;
+
+	return (u8) (epoll_ctl (epoll_fd, EPOLL_CTL_MOD, sock_fd, &event) ? 1 : 0);
+
+}
+
+// a poll () that is already waiting only checks for POLLOUT
+// after it is called again, so it is woken up right away
+static u8 cerver_poll_set_writable_internal (
+	Cerver *cerver, const i32 sock_fd, bool writable
+) {
+
+	u8 retval = 1;
+	bool wake = false;
+
+	(void) pthread_mutex_lock (cerver->poll_lock);
+
+	i32 idx = cerver_poll_get_idx_by_sock_fd (cerver, sock_fd);
+	if (idx >= 0) {
+		wake = writable && !(cerver->fds[idx].events & POLLOUT);
+		cerver->fds[idx].events = writable ? (POLLIN | POLLOUT) : POLLIN;
+		retval = 0;
+	}
+
+	(void) pthread_mutex_unlock (cerver->poll_lock);
+
+	if (wake && (cerver->poll_wake_fd > -1))
+		(void) eventfd_write (cerver->poll_wake_fd, 1);
+
+	return retval;
+
+}
+
+// sets whether the cerver's poll (or the connection's reactor) waits
+// for the connection's sock fd to be writable to flush its send queue
+// returns 0 on success, 1 on error
+u8 cerver_poll_set_writable (
+	Cerver *cerver, Connection *connection, bool writable
+) {
+
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		if (connection->reactor) {
+			retval = cerver_epoll_set_writable (
+				connection->reactor->epoll_fd, connection->socket->sock_fd, writable
+			);
+		}
+
+		else if (cerver->uring) {
+			retval = cerver_uring_set_writable (
+				cerver->uring, connection->socket->sock_fd, writable
+			);
+		}
+
+		else if (cerver->handler_type == CERVER_HANDLER_TYPE_EPOLL) {
+			retval = cerver_epoll_set_writable (
+				cerver->epoll_fd, connection->socket->sock_fd, writable
+			);
+		}
+
+		else {
+			retval = cerver_poll_set_writable_internal (
+				cerver, connection->socket->sock_fd, writable
+			);
+		}
+	}
+
+	return retval;
 
 }
 
@@ -2689,7 +3677,7 @@ static inline void cerver_poll_handle_actual_accept (Cerver *cerver) {
 
 static inline void cerver_poll_handle_actual_receive (
 	Cerver *cerver,
-	struct pollfd *active_fd,
+	const i32 sock_fd, short revents,
 	char *packet_buffer
 ) {
 
@@ -2697,11 +3685,26 @@ static inline void cerver_poll_handle_actual_receive (
 	// there is no need of allocating a new structure each time
 	// we need to handle a connection
 	CerverReceive *cr = cerver_receive_create (
-		RECEIVE_TYPE_NORMAL, cerver, active_fd->fd
+		RECEIVE_TYPE_NORMAL, cerver, sock_fd
 	);
 
 	if (cr) {
-		switch (active_fd->revents) {
+		// the connection's send queue can be flushed
+		if (revents & POLLOUT) {
+			if (cr->connection) (void) connection_send_queue_flush (cr->connection);
+			revents &= ~POLLOUT;
+		}
+
+		// zerocopy completions are reported as errors in the sock fd
+		if ((revents & POLLERR) && cr->connection && cr->connection->zerocopy) {
+			if (!connection_zerocopy_handle_completions (cr->connection))
+				revents &= ~POLLERR;
+		}
+
+		switch (revents) {
+			// only the socket was writable
+			case 0: break;
+
 			// A connection setup has been completed or new data arrived
 			case POLLIN: {
 				// printf ("Receive fd: %d\n", cerver->fds[i].fd);
@@ -2732,7 +3735,7 @@ static inline void cerver_poll_handle_actual_receive (
 			case POLLPRI: break;
 
 			default: {
-				if (active_fd->revents != 0) {
+				if (revents != 0) {
 					cerver_receive_handle_failed (cr);
 				}
 			} break;
@@ -2744,21 +3747,38 @@ static inline void cerver_poll_handle_actual_receive (
 }
 
 static inline void cerver_poll_handle (
-	Cerver *cerver, char *packet_buffer
+	Cerver *cerver, char *packet_buffer, int n_ready
 ) {
 
 	// one or more fd(s) are readable, need to determine which ones they are
-	for (u32 idx = 0; idx < cerver->max_n_fds; idx++) {
-		if (cerver->fds[idx].fd > -1) {
+	// removed fds only leave a hole, so no fd moves while they are walked
+	i32 sock_fd = -1;
+	short revents = 0;
+	for (u32 idx = 0; idx < cerver->current_n_fds && n_ready > 0; idx++) {
+		revents = cerver->fds[idx].revents;
+		if (revents) {
+			sock_fd = cerver->fds[idx].fd;
+			cerver->fds[idx].revents = 0;
+			n_ready--;
+
+			// the fd was removed while poll () was waiting
+			if (sock_fd < 0) continue;
+
 			if (idx == 0) {
 				// the cerver's sock fd has an event
 				cerver_poll_handle_actual_accept (cerver);
 			}
 
+			// only wakes up the poll to wait for POLLOUT
+			else if (sock_fd == cerver->poll_wake_fd) {
+				eventfd_t value = 0;
+				(void) eventfd_read (sock_fd, &value);
+			}
+
 			else {
 				cerver_poll_handle_actual_receive (
 					cerver,
-					&cerver->fds[idx],
+					sock_fd, revents,
 					packet_buffer
 				);
 			}
@@ -2793,9 +3813,13 @@ u8 cerver_poll (Cerver *cerver) {
 		if (packet_buffer) {
 			int poll_retval = 0;
 			while (cerver->isRunning) {
+				// fill the holes left by the fds that were removed
+				if (__atomic_load_n (&cerver->n_removed_fds, __ATOMIC_RELAXED))
+					cerver_poll_compact (cerver);
+
 				poll_retval = poll (
 					cerver->fds,
-					cerver->max_n_fds,
+					cerver->current_n_fds,
 					cerver->poll_timeout
 				);
 
@@ -2821,9 +3845,12 @@ u8 cerver_poll (Cerver *cerver) {
 					} break;
 
 					default: {
-						cerver_poll_handle (cerver, packet_buffer);
+						cerver_poll_handle (cerver, packet_buffer, poll_retval);
 					} break;
 				}
+
+				// send what was coalesced during this iteration
+				if (cerver->send_coalescing) cerver_coalesce_flush (cerver);
 			}
 
 			#ifdef CERVER_DEBUG
@@ -2859,6 +3886,525 @@ u8 cerver_poll (Cerver *cerver) {
 
 #pragma endregion
 
+#pragma region epoll
+
+// gets the client & the connection associated with a sock fd
+// using the cerver's fd table
+static CerverReceive *cerver_reactor_receive_create (
+	CerverReactor *reactor, const i32 sock_fd
+) {
+
+	CerverReceive *cr = cerver_receive_new ();
+	if (cr) {
+		cr->type = RECEIVE_TYPE_NORMAL;
+
+		cr->cerver = reactor->cerver;
+
+		if (cerver_fd_table_get (
+			reactor->cerver->fd_table, sock_fd,
+			NULL, &cr->client, &cr->connection
+		)) {
+			cr->socket = cr->connection->socket;
+		}
+
+		// for what ever reason we have a rogue connection
+		else {
+			cerver_log_error (
+				"cerver_reactor_receive_create () - reactor %u - no client with sock fd <%d>",
+				reactor->id, sock_fd
+			);
+
+			// remove the sock fd from the reactor's epoll & the cerver's table
+			(void) cerver_reactor_unregister_sock_fd (reactor, sock_fd);
+			(void) cerver_fd_table_remove (reactor->cerver->fd_table, sock_fd, NULL);
+
+			close (sock_fd);        // just close the socket
+		}
+	}
+
+	return cr;
+
+}
+
+static inline void cerver_epoll_handle_actual_receive (
+	Cerver *cerver, CerverReactor *reactor,
+	struct epoll_event *event,
+	char *packet_buffer
+) {
+
+	CerverReceive *cr = reactor ?
+		cerver_reactor_receive_create (reactor, event->data.fd) :
+		cerver_receive_create (RECEIVE_TYPE_NORMAL, cerver, event->data.fd);
+
+	if (cr) {
+		u32 events = event->events;
+
+		// the connection's send queue can be flushed
+		if (cr->connection && (events & EPOLLOUT)) {
+			(void) connection_send_queue_flush (cr->connection);
+		}
+
+		// zerocopy completions are reported as errors in the sock fd
+		if ((events & EPOLLERR) && cr->connection && cr->connection->zerocopy) {
+			if (!connection_zerocopy_handle_completions (cr->connection))
+				events &= ~EPOLLERR;
+		}
+
+		if (cr->socket) {
+			// new data arrived or the other end has shut down
+			if (events & (EPOLLIN | EPOLLRDHUP)) {
+				// the connection is edge triggered, so we need to receive
+				// until the socket has been drained, any shutdown is handled
+				// when recv () returns 0
+				while (
+					(cr->socket->sock_fd > 0)
+					&& !cerver_receive_actual (
+						cr,
+						packet_buffer, cerver->receive_buffer_size,
+						MSG_DONTWAIT
+					)
+				);
+			}
+
+			// a disconnection or an asynchronous error without any pending data
+			else if (events & ~EPOLLOUT) {
+				cerver_receive_handle_failed (cr);
+			}
+		}
+
+		cerver_receive_delete (cr);
+	}
+
+}
+
+static inline void cerver_epoll_handle (
+	Cerver *cerver, CerverReactor *reactor,
+	const i32 sock,
+	struct epoll_event *events, const int n_events,
+	char *packet_buffer
+) {
+
+	// only the ready fds are returned
+	for (int i = 0; i < n_events; i++) {
+		if (events[i].data.fd == sock) {
+			// the listening sock fd has an event
+			if (reactor) cerver_accept_internal (cerver, sock, reactor);
+			else cerver_poll_handle_actual_accept (cerver);
+		}
+
+		else {
+			cerver_epoll_handle_actual_receive (
+				cerver, reactor,
+				&events[i],
+				packet_buffer
+			);
+		}
+	}
+
+}
+
+// handles the events in the epoll instance until the cerver
+// or the selected reactor (if any) stop running
+static u8 cerver_epoll_internal (
+	Cerver *cerver, CerverReactor *reactor,
+	const i32 epoll_fd, const i32 sock,
+	char *packet_buffer
+) {
+
+	u8 retval = 1;
+
+	struct epoll_event *events = (struct epoll_event *) calloc (
+		cerver->epoll_max_events, sizeof (struct epoll_event)
+	);
+
+	if (events) {
+		int epoll_retval = 0;
+		while (cerver->isRunning && (!reactor || reactor->running)) {
+			epoll_retval = epoll_wait (
+				epoll_fd,
+				events, (int) cerver->epoll_max_events,
+				(int) cerver->poll_timeout
+			);
+
+			switch (epoll_retval) {
+				case -1: {
+					// interrupted by a signal
+					if (errno != EINTR) {
+						cerver_log (
+							LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+							"Cerver %s main epoll has failed!",
+							cerver->info->name->str
+						);
+
+						perror ("Error");
+						cerver->isRunning = false;
+					}
+				} break;
+
+				case 0: break;
+
+				default: {
+					if (reactor) reactor->stats->n_events += (u64) epoll_retval;
+
+					cerver_epoll_handle (
+						cerver, reactor,
+						sock,
+						events, epoll_retval,
+						packet_buffer
+					);
+				} break;
+			}
+
+			// send what was coalesced during this iteration
+			if (cerver->send_coalescing) cerver_coalesce_flush (cerver);
+		}
+
+		free (events);
+
+		retval = 0;
+	}
+
+	else {
+		cerver_log_error (
+			"Failed to allocate cerver %s epoll events!",
+			cerver->info->name->str
+		);
+	}
+
+	return retval;
+
+}
+
+// cerver epoll loop to handle events only in the registered sockets that are ready
+u8 cerver_epoll (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		cerver_log (
+			LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+			"Cerver %s is ready in port %d!",
+			cerver->info->name->str, cerver->port
+		);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Waiting for connections..."
+		);
+		#endif
+
+		char *packet_buffer = (char *) calloc (
+			cerver->receive_buffer_size, sizeof (char)
+		);
+
+		if (packet_buffer) {
+			retval = cerver_epoll_internal (
+				cerver, NULL,
+				cerver->epoll_fd, cerver->sock,
+				packet_buffer
+			);
+
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_CERVER, LOG_TYPE_NONE,
+				"Cerver %s main epoll has stopped!",
+				cerver->info->name->str
+			);
+			#endif
+
+			free (packet_buffer);
+		}
+
+		else {
+			cerver_log_error (
+				"Failed to allocate cerver epoll's packet buffer!"
+			);
+		}
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Can't listen for connections on a NULL cerver!"
+		);
+	}
+
+	return retval;
+
+}
+
+// reactor epoll loop to accept & handle connections in its own socket
+// using the reactor's own structures
+u8 cerver_reactor_epoll (CerverReactor *reactor) {
+
+	u8 retval = 1;
+
+	if (reactor) {
+		Cerver *cerver = reactor->cerver;
+
+		cerver_log (
+			LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+			"Cerver %s reactor %u is ready in port %d!",
+			cerver->info->name->str, reactor->id, cerver->port
+		);
+
+		retval = cerver_epoll_internal (
+			cerver, reactor,
+			reactor->epoll_fd, reactor->sock,
+			reactor->packet_buffer
+		);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_CERVER, LOG_TYPE_NONE,
+			"Cerver %s reactor %u has stopped!",
+			cerver->info->name->str, reactor->id
+		);
+		#endif
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region io_uring
+
+static void cerver_uring_handle_accept (
+	Cerver *cerver, const struct io_uring_cqe *cqe
+) {
+
+	if (cqe->res > 0) {
+		struct sockaddr_storage client_address;
+		memset (&client_address, 0, sizeof (struct sockaddr_storage));
+		socklen_t socklen = sizeof (struct sockaddr_storage);
+
+		// the accept was completed without an address buffer
+		(void) getpeername (cqe->res, (struct sockaddr *) &client_address, &socklen);
+
+		#ifdef HANDLER_DEBUG
+		cerver_log_debug ("Accepted fd: %d", cqe->res);
+		#endif
+
+		cerver_register_new_connection (cerver, NULL, cqe->res, client_address);
+	}
+
+	else if (cqe->res != -ECANCELED) {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Cerver %s io_uring accept failed: %s",
+			cerver->info->name->str, strerror (-cqe->res)
+		);
+	}
+
+	// the multishot accept has stopped
+	if (!(cqe->flags & IORING_CQE_F_MORE) && cerver->isRunning) {
+		// the accept would fail again right away if
+		// the process has run out of fds, so it waits first
+		if ((cqe->res < 0) && (cqe->res != -ECANCELED)) {
+			if (cerver_uring_accept_retry (
+				cerver->uring, cerver->sock, CERVER_URING_ACCEPT_RETRY_TIMEOUT
+			)) {
+				cerver_log_error (
+					"Failed to submit cerver %s io_uring accept retry!",
+					cerver->info->name->str
+				);
+			}
+		}
+
+		else {
+			(void) cerver_uring_rearm (cerver->uring, cqe->user_data);
+		}
+	}
+
+}
+
+static void cerver_uring_handle_receive (
+	Cerver *cerver, const i32 sock_fd,
+	const struct io_uring_cqe *cqe
+) {
+
+	CerverUring *uring = cerver->uring;
+
+	char *buffer = NULL;
+	u16 buffer_id = 0;
+	if (cqe->flags & IORING_CQE_F_BUFFER) {
+		buffer_id = (u16) (cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+		buffer = cerver_uring_buffer_get (uring, buffer_id);
+	}
+
+	CerverReceive *cr = cerver_receive_create (
+		RECEIVE_TYPE_NORMAL, cerver, sock_fd
+	);
+
+	if (cr) {
+		if (cr->socket) {
+			if ((cqe->res > 0) && buffer) {
+				// the packets are handled in place,
+				// so the buffer can be reused right after
+				cerver_receive_success (
+					cr, (size_t) cqe->res,
+					buffer, uring->buffer_size
+				);
+
+				if (!(cqe->flags & IORING_CQE_F_MORE)) {
+					(void) cerver_uring_rearm (uring, cqe->user_data);
+				}
+			}
+
+			// all the provided buffers were in use
+			else if (cqe->res == -ENOBUFS) {
+				(void) cerver_uring_rearm (uring, cqe->user_data);
+			}
+
+			// the other end has shut down or the connection has failed
+			else {
+				#ifdef CERVER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+					"cerver_uring_handle_receive () - res: %d - sock fd: %d",
+					cqe->res, sock_fd
+				);
+				#endif
+
+				cerver_receive_handle_failed (cr);
+			}
+		}
+
+		cerver_receive_delete (cr);
+	}
+
+	if (buffer) cerver_uring_buffer_release (uring, buffer_id);
+
+}
+
+static void cerver_uring_handle_writable (
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	Connection *connection = NULL;
+	if (cerver_fd_table_get (cerver->fd_table, sock_fd, NULL, NULL, &connection)) {
+		// zerocopy completions also make the sock fd ready
+		if (connection->zerocopy)
+			(void) connection_zerocopy_handle_completions (connection);
+
+		(void) connection_send_queue_flush (connection);
+	}
+
+}
+
+static void cerver_uring_handle (Cerver *cerver) {
+
+	CerverUring *uring = cerver->uring;
+
+	struct io_uring_cqe *ready = NULL;
+	struct io_uring_cqe cqe = { 0 };
+	CerverUringOp op = CERVER_URING_OP_NONE;
+	i32 sock_fd = -1;
+	while ((ready = cerver_uring_peek (uring))) {
+		// the completion is copied to give back its space right away
+		cqe = *ready;
+		cerver_uring_advance (uring);
+
+		// completions of a sock fd that has been unregistered are ignored
+		if (!cerver_uring_user_data_get (uring, cqe.user_data, &op, &sock_fd)) {
+			if (cqe.flags & IORING_CQE_F_BUFFER) {
+				cerver_uring_buffer_release (
+					uring, (u16) (cqe.flags >> IORING_CQE_BUFFER_SHIFT)
+				);
+			}
+
+			continue;
+		}
+
+		switch (op) {
+			case CERVER_URING_OP_ACCEPT:
+				cerver_uring_handle_accept (cerver, &cqe);
+				break;
+
+			case CERVER_URING_OP_ACCEPT_RETRY:
+				if (cerver->isRunning)
+					(void) cerver_uring_accept (uring, sock_fd);
+				break;
+
+			case CERVER_URING_OP_RECEIVE:
+				cerver_uring_handle_receive (cerver, sock_fd, &cqe);
+				break;
+
+			case CERVER_URING_OP_WRITABLE:
+				cerver_uring_handle_writable (cerver, sock_fd);
+				break;
+
+			default: break;
+		}
+	}
+
+}
+
+// cerver io_uring loop to handle the accepts & receives completed by the kernel
+// there are no fds to scan, as each completion already references its sock fd
+u8 cerver_uring (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		cerver_log (
+			LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+			"Cerver %s is ready in port %d!",
+			cerver->info->name->str, cerver->port
+		);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Waiting for connections..."
+		);
+		#endif
+
+		if (!cerver_uring_accept (cerver->uring, cerver->sock)) {
+			while (cerver->isRunning) {
+				if (cerver_uring_wait (cerver->uring, cerver->poll_timeout)) {
+					cerver_uring_handle (cerver);
+				}
+
+				// send what was coalesced during this iteration
+				if (cerver->send_coalescing) cerver_coalesce_flush (cerver);
+			}
+
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_CERVER, LOG_TYPE_NONE,
+				"Cerver %s io_uring has stopped!",
+				cerver->info->name->str
+			);
+			#endif
+
+			retval = 0;
+		}
+
+		else {
+			cerver_log_error (
+				"Failed to submit cerver %s io_uring accept!",
+				cerver->info->name->str
+			);
+		}
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Can't listen for connections on a NULL cerver!"
+		);
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
 #pragma region threads
 
 // handle new connections in dedicated threads
@@ -2,20 +2,26 @@
 #include <string.h>
 #include <stdio.h>
 
-#ifdef PACKETS_DEBUG
 #include <errno.h>
-#endif
+#include <limits.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
+#include "cerver/collections/slab.h"
+
 #include "cerver/network.h"
 #include "cerver/packets.h"
 #include "cerver/cerver.h"
 #include "cerver/client.h"
+#include "cerver/connection.h"
+#include "cerver/udp.h"
+
+#include "cerver/threads/thread.h"
 
 #include "cerver/game/lobby.h"
 
@@ -23,6 +29,9 @@
 #include "cerver/utils/log.h"
 #endif
 
+static Slab packets_slab = SLAB_INITIALIZER ("packets", Packet);
+static Slab packets_headers_slab = SLAB_INITIALIZER ("packets-headers", PacketHeader);
+
 #pragma region protocol
 
 static ProtocolID protocol_id = 0;
@@ -118,13 +127,55 @@ void packets_per_type_print (PacketsPerType *packets_per_type) {
 
 }
 
+// atomically adds packets of the selected type
+// unknown types are counted as unknown packets
+void packets_per_type_add (
+	PacketsPerType *packets_per_type,
+	const PacketType packet_type, const u64 n_packets
+) {
+
+	u64 *counter = NULL;
+	switch (packet_type) {
+		case PACKET_TYPE_NONE: break;
+
+		case PACKET_TYPE_CERVER: counter = &packets_per_type->n_cerver_packets; break;
+		case PACKET_TYPE_CLIENT: counter = &packets_per_type->n_client_packets; break;
+		case PACKET_TYPE_ERROR: counter = &packets_per_type->n_error_packets; break;
+		case PACKET_TYPE_REQUEST: counter = &packets_per_type->n_request_packets; break;
+		case PACKET_TYPE_AUTH: counter = &packets_per_type->n_auth_packets; break;
+		case PACKET_TYPE_GAME: counter = &packets_per_type->n_game_packets; break;
+		case PACKET_TYPE_APP: counter = &packets_per_type->n_app_packets; break;
+		case PACKET_TYPE_APP_ERROR: counter = &packets_per_type->n_app_error_packets; break;
+		case PACKET_TYPE_CUSTOM: counter = &packets_per_type->n_custom_packets; break;
+		case PACKET_TYPE_TEST: counter = &packets_per_type->n_test_packets; break;
+
+		default: counter = &packets_per_type->n_unknown_packets; break;
+	}
+
+	if (counter) (void) __atomic_add_fetch (counter, n_packets, __ATOMIC_RELAXED);
+
+}
+
+// adds every counter of the source to the destination
+// the source counters are read atomically, as they can still be updated
+void packets_per_type_accumulate (
+	PacketsPerType *packets_per_type, const PacketsPerType *source
+) {
+
+	const u64 *counters = (const u64 *) source;
+	u64 *values = (u64 *) packets_per_type;
+	for (size_t i = 0; i < (sizeof (PacketsPerType) / sizeof (u64)); i++)
+		values[i] += __atomic_load_n (&counters[i], __ATOMIC_RELAXED);
+
+}
+
 #pragma endregion
 
 #pragma region header
 
 PacketHeader *packet_header_new (void) {
 
-	PacketHeader *header = (PacketHeader *) malloc (sizeof (PacketHeader));
+	PacketHeader *header = (PacketHeader *) slab_alloc (&packets_headers_slab);
 	if (header) {
 		(void) memset (header, 0, sizeof (PacketHeader));
 	}
@@ -135,7 +186,7 @@ PacketHeader *packet_header_new (void) {
 
 void packet_header_delete (PacketHeader *header) {
 	
-	if (header) free (header);
+	slab_free (&packets_headers_slab, header);
 	
 }
 
@@ -143,7 +194,7 @@ PacketHeader *packet_header_create (
 	PacketType packet_type, size_t packet_size, u32 req_type
 ) {
 
-	PacketHeader *header = (PacketHeader *) malloc (sizeof (PacketHeader));
+	PacketHeader *header = (PacketHeader *) slab_alloc (&packets_headers_slab);
 	if (header) {
 		header->packet_type = packet_type;
 		header->packet_size = packet_size;
@@ -178,7 +229,7 @@ u8 packet_header_copy (PacketHeader **dest, PacketHeader *source) {
 	u8 retval = 1;
 
 	if (source) {
-		*dest = (PacketHeader *) malloc (sizeof (PacketHeader));
+		*dest = (PacketHeader *) slab_alloc (&packets_headers_slab);
 		if (*dest) {
 			(void) memcpy (*dest, source, sizeof (PacketHeader));
 			retval = 0;
@@ -200,13 +251,16 @@ u8 packet_append_data (
 
 Packet *packet_new (void) {
 
-	Packet *packet = (Packet *) malloc (sizeof (Packet));
+	Packet *packet = (Packet *) slab_alloc (&packets_slab);
 	if (packet) {
 		packet->cerver = NULL;
 		packet->client = NULL;
 		packet->connection = NULL;
 		packet->lobby = NULL;
 
+		packet->client_ref = false;
+		packet->connection_ref = false;
+
 		packet->packet_type = PACKET_TYPE_NONE;
 		packet->req_type = 0;
 
@@ -253,23 +307,42 @@ void packet_delete (void *packet_ptr) {
 	if (packet_ptr) {
 		Packet *packet = (Packet *) packet_ptr;
 
+		if (packet->client_ref) {
+			client_release (packet->client);
+			packet->client_ref = false;
+		}
+
+		if (packet->connection_ref) {
+			connection_release (packet->connection);
+			packet->connection_ref = false;
+		}
+
 		packet->cerver = NULL;
 		packet->client = NULL;
 		packet->connection = NULL;
 		packet->lobby = NULL;
 
+		// a checked packet's version points to its data
+		if (
+			((char *) packet->version < (char *) packet->data)
+			|| ((char *) packet->version >= packet->data_end)
+		) {
+			packet_version_delete (packet->version);
+		}
+
 		if (!packet->data_ref) {
 			if (packet->data) free (packet->data);
 		}
 
-		packet_header_delete (packet->header);
-		packet_version_delete (packet->version);
+		// a view's header is part of its referenced packet
+		if (!packet_is_view (packet))
+			packet_header_delete (packet->header);
 
 		if (!packet->packet_ref) {
 			if (packet->packet) free (packet->packet);
 		}
 
-		free (packet);
+		slab_free (&packets_slab, packet);
 	}
 
 }
@@ -299,7 +372,7 @@ void packet_set_header (
 
 	if (packet && header) {
 		if (!packet->header)
-			packet->header = (PacketHeader *) malloc (sizeof (PacketHeader));
+			packet->header = (PacketHeader *) slab_alloc (&packets_headers_slab);
 
 		if (packet->header)
 			(void) memcpy (&packet->header, header, sizeof (PacketHeader));
@@ -317,7 +390,7 @@ void packet_set_header_values (
 ) {
 
 	if (packet) {
-		if (!packet->header) packet->header = (PacketHeader *) malloc (sizeof (PacketHeader));
+		if (!packet->header) packet->header = (PacketHeader *) slab_alloc (&packets_headers_slab);
 		if (packet->header) {
 			packet->header->packet_type = packet_type;
 			packet->header->packet_size = packet_size;
@@ -519,6 +592,108 @@ u8 packet_set_packet_ref (
 
 }
 
+// creates a packet that references a complete packet inside a buffer
+// the packet's header & data point to the buffer (packet_ref & data_ref are set),
+// so the view is only valid while the buffer is NOT modified
+// returns a newly allocated packet that should be deleted after use
+Packet *packet_create_view (
+	PacketHeader *header, char *data, const size_t data_size
+) {
+
+	Packet *packet = packet_new ();
+	if (packet) {
+		packet->header = header;
+		packet->packet = header;
+		packet->packet_size = header->packet_size;
+		packet->packet_ref = true;
+
+		packet->data = data;
+		packet->data_size = data_size;
+		packet->data_ptr = data;
+		packet->data_end = data + data_size;
+		packet->data_ref = true;
+	}
+
+	return packet;
+
+}
+
+// returns true if the packet's header & data reference an external buffer
+bool packet_is_view (const Packet *packet) {
+
+	return packet->packet_ref
+		&& packet->header
+		&& ((void *) packet->header == packet->packet);
+
+}
+
+// copies the header & data of a packet view into the packet,
+// so that it can be safely used after its buffer has been reused
+// does nothing if the packet already owns its values
+// returns 0 on success, 1 on error
+u8 packet_retain (Packet *packet) {
+
+	u8 retval = 1;
+
+	if (packet) {
+		if (packet_is_view (packet)) {
+			PacketHeader *header = NULL;
+			char *data = NULL;
+
+			(void) packet_header_copy (&header, packet->header);
+			if (header && packet->data_size) {
+				data = (char *) malloc (packet->data_size);
+				if (data) (void) memcpy (data, packet->data, packet->data_size);
+			}
+
+			if (header && (data || !packet->data_size)) {
+				char *old_data = (char *) packet->data;
+
+				// a checked packet's version points to its data
+				const bool version_in_data = packet->version
+					&& ((char *) packet->version >= old_data)
+					&& ((char *) packet->version < packet->data_end);
+
+				packet->header = header;
+				packet->packet = NULL;
+				packet->packet_ref = false;
+
+				if (data) {
+					packet->data_ptr = data + (packet->data_ptr - old_data);
+					packet->data_end = data + packet->data_size;
+
+					if (version_in_data) {
+						packet->version = (PacketVersion *) (data + ((char *) packet->version - old_data));
+					}
+				}
+
+				else {
+					packet->data_ptr = NULL;
+					packet->data_end = NULL;
+
+					if (version_in_data) packet->version = NULL;
+				}
+
+				packet->data = data;
+				packet->data_ref = false;
+
+				retval = 0;
+			}
+
+			else {
+				packet_header_delete (header);
+			}
+		}
+
+		else {
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
 // prepares the packet to be ready to be sent
 // returns 0 on sucess, 1 on error
 u8 packet_generate (Packet *packet) {
@@ -526,7 +701,10 @@ u8 packet_generate (Packet *packet) {
 	u8 retval = 0;
 
 	if (packet) {
-		if (packet->packet) {
+		// the packet's values must be owned before replacing its packet
+		(void) packet_retain (packet);
+
+		if (packet->packet && !packet->packet_ref) {
 			free (packet->packet);
 			packet->packet = NULL;
 			packet->packet_size = 0;
@@ -541,6 +719,7 @@ u8 packet_generate (Packet *packet) {
 
 		// create the packet buffer to be sent
 		packet->packet = malloc (packet->packet_size);
+		packet->packet_ref = false;
 		if (packet->packet) {
 			char *end = (char *) packet->packet;
 			(void) memcpy (end, packet->header, sizeof (PacketHeader));
@@ -638,29 +817,173 @@ Packet *packet_generate_request (
 
 }
 
-static inline u8 packet_send_tcp_actual (
-	const Packet *packet,
-	Connection *connection,
-	int flags, size_t *total_sent, bool raw
+// sends the buffers using as few sendmsg () calls as possible
+// continues after partial writes by advancing the iov array, so it is modified
+// and only the bytes that were not sent remain in it
+// the socket's write mutex is NOT locked
+// on error, errno is only set if sendmsg () failed, else it is 0
+// returns 0 on success, 1 on error
+u8 packet_send_iov (
+	Socket *socket,
+	struct iovec *iov, unsigned int iov_count,
+	int flags, size_t *total_sent
 ) {
 
+	u8 retval = 0;
+
+	size_t actual_sent = 0;
+	struct msghdr msg = { 0 };
 	ssize_t sent = 0;
-	char *p = raw ? (char *) packet->data : (char *) packet->packet;
-	size_t packet_size = raw ? packet->data_size : packet->packet_size;
+	size_t remaining = 0;
+	for (;;) {
+		// skip the buffers that have been completely sent
+		while (iov_count && !iov->iov_len) {
+			iov += 1;
+			iov_count -= 1;
+		}
+
+		if (!iov_count) break;
+
+		msg.msg_iov = iov;
+		msg.msg_iovlen = (iov_count > IOV_MAX) ? IOV_MAX : iov_count;
 
-	while (packet_size > 0) {
-		sent = send (connection->socket->sock_fd, p, packet_size, flags);
+		sent = sendmsg (socket->sock_fd, &msg, flags);
 		if (sent < 0) {
-			return 1;
+			if (errno == EINTR) continue;
+
+			retval = 1;
+			break;
+		}
+
+		// nothing was sent & errno was not set by sendmsg ()
+		if (!sent) {
+			errno = 0;
+
+			retval = 1;
+			break;
+		}
+
+		actual_sent += (size_t) sent;
+
+		remaining = (size_t) sent;
+		while (remaining && (remaining >= iov->iov_len)) {
+			remaining -= iov->iov_len;
+			iov->iov_len = 0;
+			iov += 1;
+			iov_count -= 1;
+		}
+
+		if (remaining) {
+			iov->iov_base = (char *) iov->iov_base + remaining;
+			iov->iov_len -= remaining;
+		}
+	}
+
+	if (total_sent) *total_sent = actual_sent;
+
+	return retval;
+
+}
+
+// a frame that has been partially sent can't be completed without a send queue,
+// and the peer would read the next frame from its middle, so the socket is
+// shut down & its handler drops the connection as a broken one
+// returns 0 on success, 1 on error
+static u8 packet_send_iov_frame (
+	Socket *socket,
+	struct iovec *iov, unsigned int iov_count,
+	int flags, size_t *total_sent
+) {
+
+	size_t actual_sent = 0;
+	u8 retval = packet_send_iov (socket, iov, iov_count, flags, &actual_sent);
+
+	if (
+		retval && actual_sent
+		&& ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+	) {
+		(void) shutdown (socket->sock_fd, SHUT_RDWR);
+		errno = EPIPE;
+	}
+
+	if (total_sent) *total_sent = actual_sent;
+
+	return retval;
+
+}
+
+// connections with a send queue never block & queue what can't be sent
+// the socket's write mutex must be locked
+static inline u8 packet_send_connection_iov (
+	Connection *connection,
+	struct iovec *iov, unsigned int iov_count,
+	int flags, size_t *total_sent
+) {
+
+	return connection->send_queue ?
+		connection_send_queue_send (connection, iov, iov_count, flags, total_sent) :
+		packet_send_iov_frame (connection->socket, iov, iov_count, flags, total_sent);
+
+}
+
+// packets that have not been generated are sent using their header & data,
+// without creating a new buffer to copy them
+// returns the n of iovecs that were set
+static inline unsigned int packet_send_iov_build (
+	const Packet *packet, bool raw,
+	PacketHeader *header, struct iovec iov[2]
+) {
+
+	unsigned int iov_count = 1;
+
+	if (raw) {
+		iov[0].iov_base = packet->data;
+		iov[0].iov_len = packet->data_size;
+	}
+
+	else if (packet->packet) {
+		iov[0].iov_base = packet->packet;
+		iov[0].iov_len = packet->packet_size;
+	}
+
+	else {
+		// the packet's data might have changed after its header was set
+		if (packet->header) {
+			*header = *packet->header;
+		}
+
+		else {
+			header->packet_type = packet->packet_type;
+			header->request_type = packet->req_type;
 		}
 
-		p += sent;
-		packet_size -= (size_t) sent;
+		header->packet_size = sizeof (PacketHeader) + packet->data_size;
+
+		iov[0].iov_base = header;
+		iov[0].iov_len = sizeof (PacketHeader);
+
+		iov[1].iov_base = packet->data;
+		iov[1].iov_len = packet->data_size;
+		iov_count = 2;
 	}
 
-	if (total_sent) *total_sent = (size_t) sent;
+	return iov_count;
 
-	return 0;
+}
+
+static inline u8 packet_send_tcp_actual (
+	const Packet *packet,
+	Connection *connection,
+	int flags, size_t *total_sent, bool raw
+) {
+
+	PacketHeader header = { 0 };
+	struct iovec iov[2] = { 0 };
+	const unsigned int iov_count = packet_send_iov_build (packet, raw, &header, iov);
+
+	return packet_send_connection_iov (
+		connection, iov, iov_count, flags, total_sent
+	);
 
 }
 
@@ -686,7 +1009,7 @@ static u8 packet_send_tcp (
 
 }
 
-// sends a packet to the socket in two parts, first the header & then the data
+// sends the packet's header & data in a single sendmsg ()
 // returns 0 on success, 1 on error
 static u8 packet_send_split_tcp (
 	const Packet *packet,
@@ -696,48 +1019,20 @@ static u8 packet_send_split_tcp (
 
 	u8 retval = 1;
 
-	if (packet && connection) {
-		(void) pthread_mutex_lock (connection->socket->write_mutex);
-
-		size_t actual_sent = 0;
-
-		// first send the header
-		bool fail = false;
-		ssize_t sent = 0;
-		char *p = (char *) packet->header;
-		size_t packet_size = sizeof (PacketHeader);
-
-		while (packet_size > 0) {
-			sent = send (connection->socket->sock_fd, p, packet_size, flags);
-			if (sent < 0) {
-				fail = true;
-				break;
-			}
-
-			p += sent;
-			actual_sent += (size_t) sent;
-			packet_size -= (size_t) sent;
-			fail = false;
-		}
+	if (packet && connection && packet->header) {
+		PacketHeader header = *packet->header;
+		header.packet_size = sizeof (PacketHeader) + packet->data_size;
 
-		// now send the data
-		if (!fail) {
-			sent = 0;
-			p = (char *) packet->data;
-			packet_size = packet->data_size;
-
-			while (packet_size > 0) {
-				sent = send (connection->socket->sock_fd, p, packet_size, flags);
-				if (sent < 0) break;
-				p += sent;
-				actual_sent += (size_t) sent;
-				packet_size -= (size_t) sent;
-			}
+		struct iovec iov[2] = {
+			{ .iov_base = &header, .iov_len = sizeof (PacketHeader) },
+			{ .iov_base = packet->data, .iov_len = packet->data_size }
+		};
 
-			if (total_sent) *total_sent = actual_sent;
+		(void) pthread_mutex_lock (connection->socket->write_mutex);
 
-			retval = 0;
-		}
+		retval = packet_send_connection_iov (
+			connection, iov, 2, flags, total_sent
+		);
 
 		(void) pthread_mutex_unlock (connection->socket->write_mutex);
 	}
@@ -746,17 +1041,25 @@ static u8 packet_send_split_tcp (
 
 }
 
-// #pragma GCC diagnostic push
-// #pragma GCC diagnostic ignored "-Wunused-function"
-// static u8 packet_send_udp (const void *packet, size_t packet_size) {
+// sends the packet as a single datagram to the connection's address
+// the whole packet must fit in MAX_UDP_PACKET_SIZE
+// returns 0 on success, 1 on error
+static u8 packet_send_udp (
+	const Packet *packet,
+	Connection *connection,
+	size_t *total_sent, bool raw
+) {
 
-// 	// TODO:
+	PacketHeader header = { 0 };
+	struct iovec iov[2] = { 0 };
+	const unsigned int iov_count = packet_send_iov_build (packet, raw, &header, iov);
 
-// 	return 0;
+	return cerver_udp_send (connection, iov, iov_count, total_sent);
 
-// }
-// #pragma GCC diagnostic pop
+}
 
+// the cerver's counters are sharded & the others are only shared
+// by the threads that send to the same client, connection or lobby
 static void packet_send_update_stats (
 	PacketType packet_type, size_t sent,
 	Cerver *cerver,
@@ -765,104 +1068,43 @@ static void packet_send_update_stats (
 ) {
 
 	if (cerver) {
-		cerver->stats->n_packets_sent += 1;
-		cerver->stats->total_bytes_sent += sent;
+		cerver_stats_add (cerver->stats, CERVER_STATS_N_PACKETS_SENT, 1);
+		cerver_stats_add (cerver->stats, CERVER_STATS_TOTAL_BYTES_SENT, sent);
+		packets_per_type_add (cerver_stats_packets (cerver->stats, true), packet_type, 1);
 	}
 
 	if (client) {
-		client->stats->n_packets_sent += 1;
-		client->stats->total_bytes_sent += sent;
+		(void) __atomic_add_fetch (&client->stats->n_packets_sent, 1, __ATOMIC_RELAXED);
+		(void) __atomic_add_fetch (&client->stats->total_bytes_sent, sent, __ATOMIC_RELAXED);
+		packets_per_type_add (client->stats->sent_packets, packet_type, 1);
 	}
 
-	connection->stats->n_packets_sent += 1;
-	connection->stats->total_bytes_sent += sent;
+	(void) __atomic_add_fetch (&connection->stats->n_packets_sent, 1, __ATOMIC_RELAXED);
+	(void) __atomic_add_fetch (&connection->stats->total_bytes_sent, sent, __ATOMIC_RELAXED);
+	packets_per_type_add (connection->stats->sent_packets, packet_type, 1);
 
 	if (lobby) {
-		lobby->stats->n_packets_sent += 1;
-		lobby->stats->bytes_sent += sent;
+		(void) __atomic_add_fetch (&lobby->stats->n_packets_sent, 1, __ATOMIC_RELAXED);
+		(void) __atomic_add_fetch (&lobby->stats->bytes_sent, sent, __ATOMIC_RELAXED);
+		packets_per_type_add (lobby->stats->sent_packets, packet_type, 1);
 	}
 
-	switch (packet_type) {
-		case PACKET_TYPE_NONE: break;
-
-		case PACKET_TYPE_CERVER:
-			if (cerver) cerver->stats->sent_packets->n_cerver_packets += 1;
-			if (client) client->stats->sent_packets->n_cerver_packets += 1;
-			connection->stats->sent_packets->n_cerver_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_cerver_packets += 1;
-			break;
-
-		case PACKET_TYPE_CLIENT:
-			if (cerver) cerver->stats->sent_packets->n_client_packets += 1;
-			if (client) client->stats->sent_packets->n_client_packets += 1;
-			connection->stats->sent_packets->n_client_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_client_packets += 1;
-			break;
-
-		case PACKET_TYPE_ERROR:
-			if (cerver) cerver->stats->sent_packets->n_error_packets += 1;
-			if (client) client->stats->sent_packets->n_error_packets += 1;
-			connection->stats->sent_packets->n_error_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_error_packets += 1;
-			break;
-
-		case PACKET_TYPE_REQUEST:
-			if (cerver) cerver->stats->sent_packets->n_request_packets += 1;
-			if (client) client->stats->sent_packets->n_request_packets += 1;
-			connection->stats->sent_packets->n_request_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_request_packets += 1;
-			break;
-
-		case PACKET_TYPE_AUTH:
-			if (cerver) cerver->stats->sent_packets->n_auth_packets += 1;
-			if (client) client->stats->sent_packets->n_auth_packets += 1;
-			connection->stats->sent_packets->n_auth_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_auth_packets += 1;
-			break;
-
-		case PACKET_TYPE_GAME:
-			if (cerver) cerver->stats->sent_packets->n_game_packets += 1;
-			if (client) client->stats->sent_packets->n_game_packets += 1;
-			connection->stats->sent_packets->n_game_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_game_packets += 1;
-			break;
-
-		case PACKET_TYPE_APP:
-			if (cerver) cerver->stats->sent_packets->n_app_packets += 1;
-			if (client) client->stats->sent_packets->n_app_packets += 1;
-			connection->stats->sent_packets->n_app_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_app_packets += 1;
-			break;
-
-		case PACKET_TYPE_APP_ERROR:
-			if (cerver) cerver->stats->sent_packets->n_app_error_packets += 1;
-			if (client) client->stats->sent_packets->n_app_error_packets += 1;
-			connection->stats->sent_packets->n_app_error_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_app_error_packets += 1;
-			break;
-
-		case PACKET_TYPE_CUSTOM:
-			if (cerver) cerver->stats->sent_packets->n_custom_packets += 1;
-			if (client) client->stats->sent_packets->n_custom_packets += 1;
-			connection->stats->sent_packets->n_custom_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_custom_packets += 1;
-			break;
+}
 
-		case PACKET_TYPE_TEST:
-			if (cerver) cerver->stats->sent_packets->n_test_packets += 1;
-			if (client) client->stats->sent_packets->n_test_packets += 1;
-			connection->stats->sent_packets->n_test_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_test_packets += 1;
-			break;
+// counts a packet that could not be sent
+static void packet_send_update_bad_stats (
+	Cerver *cerver, Client *client, Connection *connection
+) {
 
-		default:
-			if (cerver) cerver->stats->sent_packets->n_unknown_packets += 1;
-			if (client) client->stats->sent_packets->n_unknown_packets += 1;
-			connection->stats->sent_packets->n_unknown_packets += 1;
-			if (lobby) lobby->stats->sent_packets->n_unknown_packets += 1;
-			break;
+	if (cerver) {
+		(void) __atomic_add_fetch (
+			&cerver_stats_packets (cerver->stats, true)->n_bad_packets, 1, __ATOMIC_RELAXED
+		);
 	}
 
+	if (client) (void) __atomic_add_fetch (&client->stats->sent_packets->n_bad_packets, 1, __ATOMIC_RELAXED);
+	if (connection) (void) __atomic_add_fetch (&connection->stats->sent_packets->n_bad_packets, 1, __ATOMIC_RELAXED);
+
 }
 
 static inline u8 packet_send_internal (
@@ -881,10 +1123,14 @@ static inline u8 packet_send_internal (
 			case PROTOCOL_TCP: {
 				size_t sent = 0;
 
+				const u64 start = cerver ? cerver_stats_latency_start (cerver->stats) : 0;
+
 				if (!(split ? packet_send_split_tcp (packet, connection, flags, &sent)
 					: unsafe ? packet_send_tcp_actual (packet, connection, flags, &sent, raw) 
 						: packet_send_tcp (packet, connection, flags, &sent, raw))
 				) {
+					if (start) cerver_stats_latency_end (cerver->stats, CERVER_STATS_LATENCY_SEND, start);
+
 					if (total_sent) *total_sent = sent;
 
 					packet_send_update_stats (
@@ -902,16 +1148,38 @@ static inline u8 packet_send_internal (
 					(void) printf ("\n");
 					#endif
 
-					if (cerver) cerver->stats->sent_packets->n_bad_packets += 1;
-					if (client) client->stats->sent_packets->n_bad_packets += 1;
-					if (connection) connection->stats->sent_packets->n_bad_packets += 1;
+					packet_send_update_bad_stats (cerver, client, connection);
 
 					if (total_sent) *total_sent = 0;
 				}
 			} break;
 
-			case PROTOCOL_UDP:
-				break;
+			case PROTOCOL_UDP: {
+				size_t sent = 0;
+
+				if (!packet_send_udp (packet, connection, &sent, raw)) {
+					if (total_sent) *total_sent = sent;
+
+					packet_send_update_stats (
+						packet->packet_type, sent,
+						cerver, client, connection, lobby
+					);
+
+					retval = 0;
+				}
+
+				else {
+					#ifdef PACKETS_DEBUG
+					(void) printf ("\n");
+					perror ("packet_send_internal () - Error");
+					(void) printf ("\n");
+					#endif
+
+					packet_send_update_bad_stats (cerver, client, connection);
+
+					if (total_sent) *total_sent = 0;
+				}
+			} break;
 
 			default: break;
 		}
@@ -1009,79 +1277,151 @@ u8 packet_send_to_split (
 
 }
 
-static u8 packet_send_pieces_actual (
-	Socket *socket,
-	char *data, size_t data_size,
+// max n of pieces that are sent using an iov array in the stack
+#define PACKET_SEND_PIECES_STACK_IOV			16
+
+// sends a packet in pieces, taking the header from the packet's field
+// the header & all the pieces are sent using a single sendmsg ()
+// socket mutex will be locked for the entire operation
+// returns 0 on success, 1 on error
+u8 packet_send_pieces (
+	const Packet *packet,
+	void **pieces, size_t *sizes, u32 n_pieces,
 	int flags,
-	size_t *actual_sent
+	size_t *total_sent
 ) {
 
-	u8 retval = 0;
+	u8 retval = 1;
 
-	ssize_t sent = 0;
-	char *p = data;
-	while (data_size > 0) {
-		sent = send (socket->sock_fd, p, data_size, flags);
-		if (sent < 0) {
-			retval = 1;
-			break;
-		}
+	if (packet && pieces && sizes) {
+		struct iovec stack_iov[PACKET_SEND_PIECES_STACK_IOV + 1] = { 0 };
+		struct iovec *iov = (n_pieces > PACKET_SEND_PIECES_STACK_IOV) ?
+			(struct iovec *) malloc ((n_pieces + 1) * sizeof (struct iovec)) : stack_iov;
+
+		if (iov) {
+			iov[0].iov_base = packet->header;
+			iov[0].iov_len = sizeof (PacketHeader);
+
+			for (u32 i = 0; i < n_pieces; i++) {
+				iov[i + 1].iov_base = pieces[i];
+				iov[i + 1].iov_len = sizes[i];
+			}
+
+			size_t actual_sent = 0;
+
+			const u64 start = packet->cerver ?
+				cerver_stats_latency_start (packet->cerver->stats) : 0;
+
+			(void) pthread_mutex_lock (packet->connection->socket->write_mutex);
+
+			retval = packet_send_connection_iov (
+				packet->connection,
+				iov, n_pieces + 1,
+				flags,
+				&actual_sent
+			);
+
+			if (start && !retval)
+				cerver_stats_latency_end (packet->cerver->stats, CERVER_STATS_LATENCY_SEND, start);
+
+			packet_send_update_stats (
+				packet->packet_type, actual_sent,
+				packet->cerver, packet->client, packet->connection, packet->lobby
+			);
+
+			(void) pthread_mutex_unlock (packet->connection->socket->write_mutex);
 
-		p += sent;
-		*actual_sent += (size_t) sent;
-		data_size -= (size_t) sent;
+			if (total_sent) *total_sent = actual_sent;
+
+			if (iov != stack_iov) free (iov);
+		}
 	}
 
 	return retval;
 
 }
 
-// sends a packet in pieces, taking the header from the packet's field
-// sends each buffer as they are with they respective sizes
-// socket mutex will be locked for the entire operation
+// sends a large payload (like a snapshot) with a header of the selected types
+// without copying it into a new packet
+// payloads of at least the cerver's zerocopy threshold are sent using MSG_ZEROCOPY,
+// smaller ones, or if the socket does not support it, are copied by the kernel
+// the data must not be modified until data_delete () is called with it,
+// which happens when the kernel no longer uses its pages, even if the send fails
+// if data_delete is NULL, the data must be valid while the connection is active
 // returns 0 on success, 1 on error
-u8 packet_send_pieces (
-	const Packet *packet,
-	void **pieces, size_t *sizes, u32 n_pieces,
-	int flags,
-	size_t *total_sent
+u8 packet_send_large (
+	const PacketType packet_type, const u32 request_type,
+	void *data, const size_t data_size, Action data_delete,
+	size_t *total_sent,
+	struct _Cerver *cerver,
+	struct _Client *client, struct _Connection *connection,
+	struct _Lobby *lobby
 ) {
 
 	u8 retval = 1;
 
-	if (packet && pieces && sizes) {
-		(void) pthread_mutex_lock (packet->connection->socket->write_mutex);
-
-		size_t actual_sent = 0;
-
-		// first send the header
-		if (!packet_send_pieces_actual (
-			packet->connection->socket,
-			(char *) packet->header, sizeof (PacketHeader),
-			flags,
-			&actual_sent
-		)) {
-			// send the pieces of data
-			for (u32 i = 0; i < n_pieces; i++) {
-				(void) packet_send_pieces_actual (
-					packet->connection->socket,
-					(char *) pieces[i], sizes[i],
-					flags,
-					&actual_sent
+	if (data) {
+		if (connection && (connection->protocol == PROTOCOL_TCP)) {
+			PacketHeader header = {
+				.packet_type = packet_type,
+				.packet_size = sizeof (PacketHeader) + data_size,
+				.handler_id = 0,
+				.request_type = request_type,
+				.sock_fd = 0
+			};
+
+			size_t threshold = cerver ?
+				cerver->zerocopy_threshold : CERVER_DEFAULT_ZEROCOPY_THRESHOLD;
+
+			size_t sent = 0;
+
+			const u64 start = cerver ? cerver_stats_latency_start (cerver->stats) : 0;
+
+			(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+			if (threshold && (data_size >= threshold)) {
+				retval = connection_zerocopy_send (
+					connection,
+					&header, sizeof (PacketHeader),
+					data, data_size, data_delete,
+					&sent
 				);
 			}
 
-			retval = 0;
-		}
+			else {
+				struct iovec iov[2] = {
+					{ .iov_base = &header, .iov_len = sizeof (PacketHeader) },
+					{ .iov_base = data, .iov_len = data_size }
+				};
 
-		packet_send_update_stats (
-			packet->packet_type, actual_sent,
-			packet->cerver, packet->client, packet->connection, packet->lobby
-		);
+				retval = packet_send_connection_iov (
+					connection, iov, 2, 0, &sent
+				);
+
+				if (data_delete) data_delete (data);
+			}
+
+			if (!retval) {
+				if (start) cerver_stats_latency_end (cerver->stats, CERVER_STATS_LATENCY_SEND, start);
 
-		if (total_sent) *total_sent = actual_sent;
+				packet_send_update_stats (
+					packet_type, sent,
+					cerver, client, connection, lobby
+				);
+			}
+
+			else {
+				packet_send_update_bad_stats (cerver, client, connection);
+			}
+
+			(void) pthread_mutex_unlock (connection->socket->write_mutex);
+
+			if (total_sent) *total_sent = sent;
+		}
 
-		(void) pthread_mutex_unlock (packet->connection->socket->write_mutex);
+		else if (data_delete) {
+			data_delete (data);
+		}
 	}
 
 	return retval;
@@ -1099,24 +1439,14 @@ u8 packet_send_to_socket (
 	u8 retval = 0;
 
 	if (packet) {
-		ssize_t sent = 0;
-		const char *p = raw ? (char *) packet->data : (char *) packet->packet;
-		size_t packet_size = raw ? packet->data_size : packet->packet_size;
+		struct iovec iov = {
+			.iov_base = raw ? packet->data : packet->packet,
+			.iov_len = raw ? packet->data_size : packet->packet_size
+		};
 
 		(void) pthread_mutex_lock (socket->write_mutex);
 
-		while (packet_size > 0) {
-			sent = send (socket->sock_fd, p, packet_size, flags);
-			if (sent < 0) {
-				retval = 1;
-				break;
-			};
-
-			p += sent;
-			packet_size -= sent;
-		}
-
-		if (total_sent) *total_sent = (size_t) sent;
+		retval = packet_send_iov (socket, &iov, 1, flags, total_sent);
 
 		(void) pthread_mutex_unlock (socket->write_mutex);
 	}
@@ -1231,4 +1561,352 @@ bool packet_check (Packet *packet) {
 
 }
 
-#pragma endregion
\ No newline at end of file
+#pragma endregion
+
+#pragma region broadcast
+
+static PacketBroadcast *packet_broadcast_new (void) {
+
+	PacketBroadcast *broadcast = (PacketBroadcast *) malloc (sizeof (PacketBroadcast));
+	if (broadcast) {
+		(void) memset (broadcast, 0, sizeof (PacketBroadcast));
+	}
+
+	return broadcast;
+
+}
+
+static void packet_broadcast_delete_actual (PacketBroadcast *broadcast) {
+
+	if (broadcast->buffer) free (broadcast->buffer);
+	if (broadcast->recipients) free (broadcast->recipients);
+
+	pthread_mutex_delete (broadcast->mutex);
+	pthread_cond_delete (broadcast->done);
+
+	free (broadcast);
+
+}
+
+// releases a reference to the broadcast
+// it is deleted when there are no more references to it
+void packet_broadcast_delete (void *broadcast_ptr) {
+
+	if (broadcast_ptr) {
+		PacketBroadcast *broadcast = (PacketBroadcast *) broadcast_ptr;
+
+		if (!__atomic_sub_fetch (&broadcast->references, 1, __ATOMIC_ACQ_REL)) {
+			packet_broadcast_delete_actual (broadcast);
+		}
+	}
+
+}
+
+static inline void packet_broadcast_retain (PacketBroadcast *broadcast) {
+
+	(void) __atomic_add_fetch (&broadcast->references, 1, __ATOMIC_RELAXED);
+
+}
+
+// creates a new broadcast by serializing the packet's header & data
+// into a single buffer that will be shared by all the recipients
+// the packet can be safely deleted after this call
+// returns a new broadcast that should be deleted after use
+PacketBroadcast *packet_broadcast_create (const Packet *packet) {
+
+	PacketBroadcast *broadcast = NULL;
+
+	if (packet) {
+		broadcast = packet_broadcast_new ();
+		if (broadcast) {
+			broadcast->packet_type = packet->packet_type;
+			broadcast->references = 1;
+
+			broadcast->buffer_size = packet->packet ?
+				packet->packet_size : sizeof (PacketHeader) + packet->data_size;
+			broadcast->buffer = malloc (broadcast->buffer_size);
+
+			broadcast->recipients = (PacketBroadcastRecipient *) calloc (
+				PACKET_BROADCAST_DEFAULT_RECIPIENTS, sizeof (PacketBroadcastRecipient)
+			);
+			broadcast->max_recipients = PACKET_BROADCAST_DEFAULT_RECIPIENTS;
+
+			broadcast->mutex = pthread_mutex_new ();
+			broadcast->done = pthread_cond_new ();
+
+			if (
+				broadcast->buffer && broadcast->recipients
+				&& broadcast->mutex && broadcast->done
+			) {
+				if (packet->packet) {
+					(void) memcpy (broadcast->buffer, packet->packet, packet->packet_size);
+				}
+
+				else {
+					char *end = (char *) broadcast->buffer;
+
+					PacketHeader header = {
+						.packet_type = packet->packet_type,
+						.request_type = packet->req_type
+					};
+
+					if (packet->header) header = *packet->header;
+
+					// the packet's data might have changed after its header was set
+					header.packet_size = broadcast->buffer_size;
+
+					(void) memcpy (end, &header, sizeof (PacketHeader));
+
+					if (packet->data_size) {
+						end += sizeof (PacketHeader);
+						(void) memcpy (end, packet->data, packet->data_size);
+					}
+				}
+			}
+
+			else {
+				packet_broadcast_delete_actual (broadcast);
+				broadcast = NULL;
+			}
+		}
+	}
+
+	return broadcast;
+
+}
+
+// adds a connection to the broadcast's recipients
+// returns 0 on success, 1 on error
+u8 packet_broadcast_add (
+	PacketBroadcast *broadcast,
+	Client *client, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (broadcast && connection) {
+		if (broadcast->n_recipients == broadcast->max_recipients) {
+			size_t max_recipients = broadcast->max_recipients * 2;
+			PacketBroadcastRecipient *recipients = (PacketBroadcastRecipient *) realloc (
+				broadcast->recipients, max_recipients * sizeof (PacketBroadcastRecipient)
+			);
+
+			if (recipients) {
+				broadcast->recipients = recipients;
+				broadcast->max_recipients = max_recipients;
+			}
+		}
+
+		if (broadcast->n_recipients < broadcast->max_recipients) {
+			broadcast->recipients[broadcast->n_recipients] = (PacketBroadcastRecipient) {
+				.client = client,
+				.connection = connection,
+				.sent = 0,
+				.result = 1
+			};
+
+			broadcast->n_recipients += 1;
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+// adds all of the client's connections to the broadcast's recipients
+// returns 0 on success, 1 on error
+u8 packet_broadcast_add_client (
+	PacketBroadcast *broadcast, Client *client
+) {
+
+	u8 retval = 1;
+
+	if (broadcast && client) {
+		retval = 0;
+		for (ListElement *le = dlist_start (client->connections); le; le = le->next) {
+			retval |= packet_broadcast_add (broadcast, client, (Connection *) le->data);
+		}
+	}
+
+	return retval;
+
+}
+
+// the cerver & lobby stats are updated only once for the whole broadcast
+static void packet_broadcast_update_stats (
+	const PacketBroadcast *broadcast,
+	Cerver *cerver, Lobby *lobby
+) {
+
+	if (cerver) {
+		cerver_stats_add (cerver->stats, CERVER_STATS_N_PACKETS_SENT, broadcast->n_sent);
+		cerver_stats_add (cerver->stats, CERVER_STATS_TOTAL_BYTES_SENT, broadcast->bytes_sent);
+
+		PacketsPerType *sent_packets = cerver_stats_packets (cerver->stats, true);
+		(void) __atomic_add_fetch (&sent_packets->n_bad_packets, broadcast->n_failed, __ATOMIC_RELAXED);
+		packets_per_type_add (sent_packets, broadcast->packet_type, broadcast->n_sent);
+	}
+
+	if (lobby) {
+		(void) __atomic_add_fetch (&lobby->stats->n_packets_sent, broadcast->n_sent, __ATOMIC_RELAXED);
+		(void) __atomic_add_fetch (&lobby->stats->bytes_sent, broadcast->bytes_sent, __ATOMIC_RELAXED);
+		packets_per_type_add (lobby->stats->sent_packets, broadcast->packet_type, broadcast->n_sent);
+	}
+
+}
+
+static void packet_broadcast_send_to_recipient (
+	const PacketBroadcast *broadcast,
+	PacketBroadcastRecipient *recipient
+) {
+
+	Connection *connection = recipient->connection;
+
+	recipient->sent = 0;
+	recipient->result = 1;
+
+	if (connection->protocol == PROTOCOL_TCP) {
+		struct iovec iov = {
+			.iov_base = broadcast->buffer,
+			.iov_len = broadcast->buffer_size
+		};
+
+		(void) pthread_mutex_lock (connection->socket->write_mutex);
+
+		recipient->result = packet_send_connection_iov (
+			connection, &iov, 1, broadcast->flags, &recipient->sent
+		);
+
+		(void) pthread_mutex_unlock (connection->socket->write_mutex);
+	}
+
+	if (!recipient->result) {
+		packet_send_update_stats (
+			broadcast->packet_type, recipient->sent,
+			NULL, recipient->client, connection, NULL
+		);
+	}
+
+	else {
+		packet_send_update_bad_stats (NULL, recipient->client, connection);
+	}
+
+}
+
+// sends chunks until there are no more left to take
+static void packet_broadcast_send_chunks (PacketBroadcast *broadcast) {
+
+	size_t chunk = 0;
+	bool taken = false;
+	size_t start = 0;
+	size_t end = 0;
+
+	for (;;) {
+		(void) pthread_mutex_lock (broadcast->mutex);
+		chunk = broadcast->next_chunk;
+		taken = (chunk < broadcast->n_chunks);
+		if (taken) broadcast->next_chunk += 1;
+		(void) pthread_mutex_unlock (broadcast->mutex);
+
+		if (!taken) break;
+
+		start = chunk * PACKET_BROADCAST_CHUNK_SIZE;
+		end = start + PACKET_BROADCAST_CHUNK_SIZE;
+		if (end > broadcast->n_recipients) end = broadcast->n_recipients;
+
+		for (size_t idx = start; idx < end; idx++) {
+			packet_broadcast_send_to_recipient (broadcast, &broadcast->recipients[idx]);
+		}
+
+		(void) pthread_mutex_lock (broadcast->mutex);
+		broadcast->done_chunks += 1;
+		if (broadcast->done_chunks == broadcast->n_chunks) {
+			(void) pthread_cond_signal (broadcast->done);
+		}
+		(void) pthread_mutex_unlock (broadcast->mutex);
+	}
+
+}
+
+// a thpool job that holds a reference to the broadcast,
+// as it can start after all the chunks have already been sent
+static void packet_broadcast_job (void *broadcast_ptr) {
+
+	PacketBroadcast *broadcast = (PacketBroadcast *) broadcast_ptr;
+
+	packet_broadcast_send_chunks (broadcast);
+
+	packet_broadcast_delete (broadcast);
+
+}
+
+// sends the broadcast's buffer to all of its recipients
+// chunks are sent in parallel by the cerver's thpool (if any)
+// & by the calling thread, that waits until all of them are done
+// returns 0 if the packet was sent to all the recipients, 1 on any error
+u8 packet_broadcast_send (
+	PacketBroadcast *broadcast,
+	Cerver *cerver, Lobby *lobby,
+	int flags
+) {
+
+	u8 retval = 1;
+
+	if (broadcast) {
+		(void) pthread_mutex_lock (broadcast->mutex);
+		broadcast->flags = flags;
+		broadcast->n_chunks = (broadcast->n_recipients + PACKET_BROADCAST_CHUNK_SIZE - 1)
+			/ PACKET_BROADCAST_CHUNK_SIZE;
+		broadcast->next_chunk = 0;
+		broadcast->done_chunks = 0;
+		(void) pthread_mutex_unlock (broadcast->mutex);
+
+		// the calling thread handles one of the chunks
+		if (cerver && cerver->thpool && (broadcast->n_chunks > 1)) {
+			size_t n_jobs = broadcast->n_chunks - 1;
+			size_t n_threads = (size_t) thpool_get_num_threads_alive (cerver->thpool);
+			if (n_jobs > n_threads) n_jobs = n_threads;
+
+			for (size_t i = 0; i < n_jobs; i++) {
+				packet_broadcast_retain (broadcast);
+				if (thpool_add_work (cerver->thpool, packet_broadcast_job, broadcast)) {
+					packet_broadcast_delete (broadcast);
+					break;
+				}
+			}
+		}
+
+		packet_broadcast_send_chunks (broadcast);
+
+		(void) pthread_mutex_lock (broadcast->mutex);
+		while (broadcast->done_chunks < broadcast->n_chunks) {
+			(void) pthread_cond_wait (broadcast->done, broadcast->mutex);
+		}
+		(void) pthread_mutex_unlock (broadcast->mutex);
+
+		broadcast->n_sent = 0;
+		broadcast->n_failed = 0;
+		broadcast->bytes_sent = 0;
+		for (size_t idx = 0; idx < broadcast->n_recipients; idx++) {
+			if (!broadcast->recipients[idx].result) {
+				broadcast->n_sent += 1;
+				broadcast->bytes_sent += broadcast->recipients[idx].sent;
+			}
+
+			else {
+				broadcast->n_failed += 1;
+			}
+		}
+
+		packet_broadcast_update_stats (broadcast, cerver, lobby);
+
+		retval = broadcast->n_failed ? 1 : 0;
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
@@ -0,0 +1,464 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <unistd.h>
+#include <pthread.h>
+
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#include "cerver/types/types.h"
+
+
+#include "cerver/cerver.h"
+#include "cerver/connection.h"
+#include "cerver/handler.h"
+#include "cerver/network.h"
+#include "cerver/reactor.h"
+#include "cerver/socket.h"
+
+#include "cerver/threads/thread.h"
+
+#include "cerver/utils/log.h"
+
+#pragma region main
+
+CerverReactor *cerver_reactor_new (void) {
+
+	CerverReactor *reactor = (CerverReactor *) malloc (sizeof (CerverReactor));
+	if (reactor) {
+		reactor->id = 0;
+		reactor->cerver = NULL;
+
+		reactor->running = false;
+		reactor->thread_id = 0;
+
+		reactor->sock = -1;
+		reactor->epoll_fd = -1;
+		reactor->current_n_fds = 0;
+
+		reactor->packet_buffer = NULL;
+
+		reactor->lock = NULL;
+
+		reactor->stats = NULL;
+	}
+
+	return reactor;
+
+}
+
+void cerver_reactor_delete (void *reactor_ptr) {
+
+	if (reactor_ptr) {
+		CerverReactor *reactor = (CerverReactor *) reactor_ptr;
+
+		// the first reactor uses the cerver's socket
+		if (reactor->id && (reactor->sock > -1)) close (reactor->sock);
+		if (reactor->epoll_fd > -1) close (reactor->epoll_fd);
+
+		if (reactor->packet_buffer) free (reactor->packet_buffer);
+
+		pthread_mutex_delete (reactor->lock);
+
+		free (reactor_ptr);
+	}
+
+}
+
+// creates a new reactor with its own epoll instance & receive buffer
+// the listening socket is created when calling cerver_reactors_listen ()
+CerverReactor *cerver_reactor_create (
+	Cerver *cerver, const u32 id
+) {
+
+	CerverReactor *reactor = cerver_reactor_new ();
+	if (reactor) {
+		reactor->id = id;
+		reactor->cerver = cerver;
+
+		reactor->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+
+		reactor->packet_buffer = (char *) calloc (
+			cerver->receive_buffer_size, sizeof (char)
+		);
+
+		reactor->lock = pthread_mutex_new ();
+
+		if (
+			(reactor->epoll_fd < 0)
+			|| !reactor->packet_buffer
+			|| !reactor->lock
+		) {
+			cerver_reactor_delete (reactor);
+			reactor = NULL;
+		}
+	}
+
+	return reactor;
+
+}
+
+// creates the cerver's reactors based on its n_reactors value
+// and sets up their stats inside cerver stats
+// returns 0 on success, 1 on error
+u8 cerver_reactors_init (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	cerver->reactors = (CerverReactor **) calloc (
+		cerver->n_reactors, sizeof (CerverReactor *)
+	);
+
+	cerver->stats->reactors_stats = (CerverReactorStats *) calloc (
+		cerver->n_reactors, sizeof (CerverReactorStats)
+	);
+
+	if (cerver->reactors && cerver->stats->reactors_stats) {
+		cerver->stats->n_reactors = cerver->n_reactors;
+
+		u8 errors = 0;
+		for (u32 i = 0; i < cerver->n_reactors; i++) {
+			cerver->reactors[i] = cerver_reactor_create (cerver, i);
+			if (cerver->reactors[i]) {
+				cerver->reactors[i]->stats = &cerver->stats->reactors_stats[i];
+			}
+
+			else {
+				cerver_log_error (
+					"Failed to create cerver %s reactor %u!",
+					cerver->info->name->str, i
+				);
+
+				errors = 1;
+			}
+		}
+
+		retval = errors;
+	}
+
+	else {
+		cerver_log_error (
+			"Failed to allocate cerver %s reactors!",
+			cerver->info->name->str
+		);
+	}
+
+	return retval;
+
+}
+
+// deletes all the cerver's reactors
+void cerver_reactors_delete (Cerver *cerver) {
+
+	if (cerver->reactors) {
+		for (u32 i = 0; i < cerver->n_reactors; i++) {
+			cerver_reactor_delete (cerver->reactors[i]);
+		}
+
+		free (cerver->reactors);
+		cerver->reactors = NULL;
+	}
+
+}
+
+#pragma endregion
+
+#pragma region start
+
+// creates a new non blocking socket that can be bound
+// to the same address & port as the cerver's main socket
+static i32 cerver_reactor_create_socket (Cerver *cerver) {
+
+	i32 sock = socket (
+		(cerver->use_ipv6 ? AF_INET6 : AF_INET),
+		SOCK_STREAM | SOCK_NONBLOCK, 0
+	);
+
+	if (sock > -1) {
+		if (!sock_set_reusable (sock)) {
+			if (bind (
+				sock,
+				(const struct sockaddr *) &cerver->address,
+				sizeof (struct sockaddr_storage)
+			)) {
+				close (sock);
+				sock = -1;
+			}
+		}
+
+		else {
+			close (sock);
+			sock = -1;
+		}
+	}
+
+	return sock;
+
+}
+
+static u8 cerver_reactor_listen (Cerver *cerver, CerverReactor *reactor) {
+
+	u8 retval = 1;
+
+	reactor->sock = reactor->id ?
+		cerver_reactor_create_socket (cerver) : cerver->sock;
+
+	if (reactor->sock > -1) {
+		if (!listen (reactor->sock, cerver->connection_queue)) {
+			// the listening socket is kept level triggered, so any pending
+			// connection will be reported again if it was not accepted
+			struct epoll_event event = { 0 };
+			event.events = EPOLLIN;
+			event.data.fd = reactor->sock;
+
+			if (!epoll_ctl (reactor->epoll_fd, EPOLL_CTL_ADD, reactor->sock, &event)) {
+				reactor->current_n_fds++;
+
+				retval = 0;
+			}
+		}
+	}
+
+	if (retval) {
+		cerver_log_error (
+			"Failed to listen in cerver %s reactor %u socket!",
+			cerver->info->name->str, reactor->id
+		);
+	}
+
+	return retval;
+
+}
+
+// opens each reactor's SO_REUSEPORT listening socket & starts listening in it
+// the first reactor uses the cerver's main socket
+// returns 0 on success, 1 on error
+u8 cerver_reactors_listen (Cerver *cerver) {
+
+	u8 errors = 0;
+
+	for (u32 i = 0; i < cerver->n_reactors; i++) {
+		errors |= cerver_reactor_listen (cerver, cerver->reactors[i]);
+	}
+
+	return errors;
+
+}
+
+static void *cerver_reactor_thread (void *reactor_ptr) {
+
+	CerverReactor *reactor = (CerverReactor *) reactor_ptr;
+
+	char thread_name[THREAD_NAME_BUFFER_LEN] = { 0 };
+	(void) snprintf (
+		thread_name, THREAD_NAME_BUFFER_LEN,
+		"%s-reactor-%u", reactor->cerver->info->name->str, reactor->id
+	);
+
+	(void) thread_set_name (thread_name);
+
+	(void) cerver_reactor_epoll (reactor);
+
+	return NULL;
+
+}
+
+// starts every reactor loop in a dedicated thread,
+// except for the first one that is handled in the calling thread
+// if a thread fails to start, the ones already started are stopped
+// returns 0 on success, 1 on error
+u8 cerver_reactors_start (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	u8 errors = 0;
+	for (u32 i = 0; i < cerver->n_reactors; i++) {
+		cerver->reactors[i]->running = true;
+	}
+
+	for (u32 i = 1; i < cerver->n_reactors; i++) {
+		if (pthread_create (
+			&cerver->reactors[i]->thread_id,
+			NULL,
+			cerver_reactor_thread,
+			cerver->reactors[i]
+		)) {
+			cerver_log_error (
+				"Failed to create cerver %s reactor %u thread!",
+				cerver->info->name->str, i
+			);
+
+			cerver->reactors[i]->thread_id = 0;
+
+			errors = 1;
+			break;
+		}
+	}
+
+	if (!errors) {
+		retval = cerver_reactor_epoll (cerver->reactors[0]);
+	}
+
+	else {
+		// stop the reactors that were already started
+		cerver_reactors_end (cerver);
+	}
+
+	return retval;
+
+}
+
+// stops all the reactors & waits for their threads to finish
+void cerver_reactors_end (Cerver *cerver) {
+
+	if (cerver->reactors) {
+		for (u32 i = 0; i < cerver->n_reactors; i++) {
+			cerver->reactors[i]->running = false;
+		}
+
+		for (u32 i = 1; i < cerver->n_reactors; i++) {
+			if (cerver->reactors[i]->thread_id) {
+				(void) pthread_join (cerver->reactors[i]->thread_id, NULL);
+				cerver->reactors[i]->thread_id = 0;
+			}
+		}
+	}
+
+}
+
+#pragma endregion
+
+#pragma region register
+
+// registers a connection that was accepted by the reactor to its epoll
+// returns 0 on success, 1 on error
+u8 cerver_reactor_register_connection (
+	CerverReactor *reactor, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (reactor && connection) {
+		// connections are edge triggered, so they only wake up the reactor
+		// when new data arrives & need to be drained on each wakeup
+		struct epoll_event event = { 0 };
+		event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+		event.data.fd = connection->socket->sock_fd;
+
+		(void) pthread_mutex_lock (reactor->lock);
+
+		if (!epoll_ctl (
+			reactor->epoll_fd, EPOLL_CTL_ADD,
+			connection->socket->sock_fd, &event
+		)) {
+			reactor->current_n_fds++;
+
+			reactor->stats->current_active_connections++;
+			reactor->stats->total_connections++;
+
+			retval = 0;
+		}
+
+		(void) pthread_mutex_unlock (reactor->lock);
+
+		if (!retval) {
+			// the main stats are shared by all the reactors
+			(void) __atomic_add_fetch (&reactor->cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
+
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"Added sock fd <%d> to cerver %s reactor %u",
+				connection->socket->sock_fd,
+				reactor->cerver->info->name->str, reactor->id
+			);
+			#endif
+		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to add sock fd <%d> to cerver %s reactor %u!",
+				connection->socket->sock_fd,
+				reactor->cerver->info->name->str, reactor->id
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+// removes a sock fd from the reactor's epoll
+// returns 0 on success, 1 on error
+u8 cerver_reactor_unregister_sock_fd (
+	CerverReactor *reactor, const i32 sock_fd
+) {
+
+	u8 retval = 1;
+
+	if (reactor) {
+		(void) pthread_mutex_lock (reactor->lock);
+
+		if (!epoll_ctl (reactor->epoll_fd, EPOLL_CTL_DEL, sock_fd, NULL)) {
+			reactor->current_n_fds--;
+
+			reactor->stats->current_active_connections--;
+
+			retval = 0;
+		}
+
+		(void) pthread_mutex_unlock (reactor->lock);
+
+		if (!retval) {
+			(void) __atomic_sub_fetch (&reactor->cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
+
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"Removed sock fd <%d> from cerver %s reactor %u",
+				sock_fd, reactor->cerver->info->name->str, reactor->id
+			);
+			#endif
+		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+				"Sock fd <%d> was NOT found in cerver %s reactor %u!",
+				sock_fd, reactor->cerver->info->name->str, reactor->id
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region stats
+
+// prints the stats of each of the cerver's reactors
+void cerver_reactors_stats_print (Cerver *cerver) {
+
+	if (cerver) {
+		CerverReactorStats *stats = NULL;
+		for (u32 i = 0; i < cerver->stats->n_reactors; i++) {
+			stats = &cerver->stats->reactors_stats[i];
+
+			cerver_log_msg ("\nReactor %u:", i);
+			cerver_log_msg ("Current active connections:    %ld", stats->current_active_connections);
+			cerver_log_msg ("Total connections:             %ld", stats->total_connections);
+			cerver_log_msg ("Events handled:                %ld", stats->n_events);
+			cerver_log_msg ("Receives done:                 %ld", stats->n_receives_done);
+			cerver_log_msg ("Bytes received:                %ld", stats->bytes_received);
+		}
+	}
+
+}
+
+#pragma endregion
@@ -1,19 +1,31 @@
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
 
 #include "cerver/collections/dlist.h"
+#include "cerver/collections/slab.h"
 
 #include "cerver/threads/jobs.h"
 #include "cerver/threads/bsem.h"
+#include "cerver/threads/thread.h"
 
 void job_queue_clear (JobQueue *job_queue);
 
+// n of times an idle consumer checks a ring queue before sleeping
+#define JOB_QUEUE_RING_SPIN					128
+
+static Slab jobs_slab = SLAB_INITIALIZER ("jobs", Job);
+
 Job *job_new (void) {
 
-	Job *job = (Job *) malloc (sizeof (Job));
+	Job *job = (Job *) slab_alloc (&jobs_slab);
 	if (job) {
 		// job->prev = NULL;
 		job->method = NULL;
 		job->args = NULL;
+
+		job->queued_time = 0;
 	}
 
 	return job;
@@ -22,7 +34,7 @@ Job *job_new (void) {
 
 void job_delete (void *job_ptr) {
 
-	if (job_ptr) free (job_ptr);
+	slab_free (&jobs_slab, job_ptr);
 
 }
 
@@ -38,10 +50,276 @@ Job *job_create (void (*method) (void *args), void *args) {
 
 }
 
+const char *job_queue_type_to_string (const JobQueueType type) {
+
+	switch (type) {
+		#define XX(num, name, string, description) case JOB_QUEUE_TYPE_##name: return #string;
+		JOB_QUEUE_TYPE_MAP(XX)
+		#undef XX
+	}
+
+	return job_queue_type_to_string (JOB_QUEUE_TYPE_NONE);
+
+}
+
+const char *job_queue_type_description (const JobQueueType type) {
+
+	switch (type) {
+		#define XX(num, name, string, description) case JOB_QUEUE_TYPE_##name: return #description;
+		JOB_QUEUE_TYPE_MAP(XX)
+		#undef XX
+	}
+
+	return job_queue_type_description (JOB_QUEUE_TYPE_NONE);
+
+}
+
+#pragma region ring
+
+static size_t job_queue_ring_capacity (size_t capacity) {
+
+	size_t retval = 2;
+	while (retval < capacity) retval <<= 1;
+
+	return retval;
+
+}
+
+static u8 job_queue_ring_init (JobQueue *job_queue, size_t capacity) {
+
+	u8 retval = 1;
+
+	capacity = job_queue_ring_capacity (capacity);
+
+	job_queue->cells = (JobQueueCell *) malloc (capacity * sizeof (JobQueueCell));
+	if (job_queue->cells) {
+		for (size_t i = 0; i < capacity; i++) {
+			job_queue->cells[i].sequence = i;
+			job_queue->cells[i].job = NULL;
+		}
+
+		job_queue->mask = capacity - 1;
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// based on Dmitry Vyukov's bounded MPMC queue
+// every cell's sequence is equal to its position when it can be written
+// and to its position + 1 when it has a job that can be read
+static int job_queue_ring_push (JobQueue *job_queue, Job *job) {
+
+	JobQueueCell *cell = NULL;
+	size_t pos = __atomic_load_n (&job_queue->enqueue_pos, __ATOMIC_RELAXED);
+	for (;;) {
+		cell = &job_queue->cells[pos & job_queue->mask];
+		size_t sequence = __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+		if (!diff) {
+			if (__atomic_compare_exchange_n (
+				&job_queue->enqueue_pos, &pos, pos + 1,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+			)) break;
+		}
+
+		// the queue is full
+		else if (diff < 0) return 1;
+
+		else pos = __atomic_load_n (&job_queue->enqueue_pos, __ATOMIC_RELAXED);
+	}
+
+	cell->job = job;
+	__atomic_store_n (&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+
+	// pairs with the fence in job_queue_ring_wait ()
+	// so either we see the waiter or the waiter sees the new job
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	if (__atomic_load_n (&job_queue->waiters, __ATOMIC_RELAXED)) {
+		(void) __atomic_add_fetch (&job_queue->signal, 1, __ATOMIC_RELEASE);
+		thread_futex_wake (&job_queue->signal, 1);
+	}
+
+	return 0;
+
+}
+
+static Job *job_queue_ring_pull (JobQueue *job_queue) {
+
+	JobQueueCell *cell = NULL;
+	size_t pos = __atomic_load_n (&job_queue->dequeue_pos, __ATOMIC_RELAXED);
+	for (;;) {
+		cell = &job_queue->cells[pos & job_queue->mask];
+		size_t sequence = __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+		if (!diff) {
+			if (__atomic_compare_exchange_n (
+				&job_queue->dequeue_pos, &pos, pos + 1,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+			)) break;
+		}
+
+		// the queue is empty
+		else if (diff < 0) return NULL;
+
+		else pos = __atomic_load_n (&job_queue->dequeue_pos, __ATOMIC_RELAXED);
+	}
+
+	Job *job = cell->job;
+	__atomic_store_n (&cell->sequence, pos + job_queue->mask + 1, __ATOMIC_RELEASE);
+
+	return job;
+
+}
+
+static bool job_queue_ring_is_empty (JobQueue *job_queue) {
+
+	size_t pos = __atomic_load_n (&job_queue->dequeue_pos, __ATOMIC_RELAXED);
+	JobQueueCell *cell = &job_queue->cells[pos & job_queue->mask];
+
+	return ((intptr_t) __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE)
+		- (intptr_t) (pos + 1)) < 0;
+
+}
+
+static void job_queue_ring_wait (JobQueue *job_queue) {
+
+	// jobs usually arrive in bursts, so spin for a bit before sleeping
+	for (unsigned int i = 0; i < JOB_QUEUE_RING_SPIN; i++) {
+		if (!job_queue_ring_is_empty (job_queue)) return;
+		thread_cpu_relax ();
+	}
+
+	unsigned int signal = __atomic_load_n (&job_queue->signal, __ATOMIC_ACQUIRE);
+
+	(void) __atomic_add_fetch (&job_queue->waiters, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+	// the futex returns right away if the signal changed after we read it
+	if (job_queue_ring_is_empty (job_queue))
+		thread_futex_wait (&job_queue->signal, signal);
+
+	(void) __atomic_sub_fetch (&job_queue->waiters, 1, __ATOMIC_RELAXED);
+
+}
+
+static void job_queue_ring_wake_all (JobQueue *job_queue) {
+
+	(void) __atomic_add_fetch (&job_queue->signal, 1, __ATOMIC_SEQ_CST);
+	thread_futex_wake (&job_queue->signal, INT_MAX);
+
+}
+
+static void job_queue_ring_clear (JobQueue *job_queue) {
+
+	Job *job = NULL;
+	while ((job = job_queue_ring_pull (job_queue))) job_delete (job);
+
+}
+
+#pragma endregion
+
+#pragma region list
+
+static void job_queue_list_delete (JobQueue *job_queue) {
+
+	pthread_mutex_lock (job_queue->rwmutex);
+
+	// job_queue_clear (job_queue);
+	dlist_delete (job_queue->queue);
+
+	pthread_mutex_unlock (job_queue->rwmutex);
+	pthread_mutex_destroy (job_queue->rwmutex);
+	free (job_queue->rwmutex);
+
+	bsem_delete (job_queue->has_jobs);
+
+}
+
+static void job_queue_list_init (JobQueue *job_queue) {
+
+	job_queue->queue = dlist_init (job_delete, NULL);
+
+	job_queue->rwmutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+	pthread_mutex_init (job_queue->rwmutex, NULL);
+
+	job_queue->has_jobs = bsem_new ();
+	bsem_init (job_queue->has_jobs, 0);
+
+}
+
+static int job_queue_list_push (JobQueue *job_queue, Job *job) {
+
+	int retval = 1;
+
+	pthread_mutex_lock (job_queue->rwmutex);
+
+	// job->prev = NULL;
+	// switch (job_queue->size) {
+	// 	case 0:
+	// 		job_queue->front = job;
+	// 		job_queue->rear = job;
+	// 		break;
+
+	// 	default:
+	// 		job->prev = job_queue->rear;
+	// 		job_queue->rear = job;
+	// 		break;
+	// }
+
+	retval = dlist_insert_after (
+		job_queue->queue,
+		dlist_end (job_queue->queue),
+		job
+	);
+
+	bsem_post (job_queue->has_jobs);
+
+	pthread_mutex_unlock (job_queue->rwmutex);
+
+	return retval;
+
+}
+
+static Job *job_queue_list_pull (JobQueue *job_queue) {
+
+	Job *retval = NULL;
+
+	pthread_mutex_lock (job_queue->rwmutex);
+
+	switch (job_queue->queue->size) {
+		case 0: break;
+
+		case 1:
+			// remove at the start of the list
+			retval = (Job *) dlist_remove_element (job_queue->queue, NULL);
+			break;
+
+		default:
+			// remove at the start of the list
+			retval = (Job *) dlist_remove_element (job_queue->queue, NULL);
+			bsem_post (job_queue->has_jobs);
+			break;
+	}
+
+	pthread_mutex_unlock (job_queue->rwmutex);
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region public
+
 JobQueue *job_queue_new (void) {
 
 	JobQueue *job_queue = (JobQueue *) malloc (sizeof (JobQueue));
 	if (job_queue) {
+		job_queue->type = JOB_QUEUE_TYPE_NONE;
+
 		// job_queue->front = NULL;
 		// job_queue->rear = NULL;
 
@@ -51,6 +329,15 @@ JobQueue *job_queue_new (void) {
 
 		job_queue->rwmutex = NULL;
 		job_queue->has_jobs = NULL;
+
+		job_queue->cells = NULL;
+		job_queue->mask = 0;
+
+		job_queue->enqueue_pos = 0;
+		job_queue->dequeue_pos = 0;
+
+		job_queue->signal = 0;
+		job_queue->waiters = 0;
 	}
 
 	return job_queue;
@@ -62,33 +349,62 @@ void job_queue_delete (void *job_queue_ptr) {
 	if (job_queue_ptr) {
 		JobQueue *job_queue = (JobQueue *) job_queue_ptr;
 
-		pthread_mutex_lock (job_queue->rwmutex);
-
-		// job_queue_clear (job_queue);
-		dlist_delete (job_queue->queue);
+		switch (job_queue->type) {
+			case JOB_QUEUE_TYPE_LIST:
+				job_queue_list_delete (job_queue);
+				break;
 
-		pthread_mutex_unlock (job_queue->rwmutex);
-		pthread_mutex_destroy (job_queue->rwmutex);
-		free (job_queue->rwmutex);
+			case JOB_QUEUE_TYPE_RING:
+				job_queue_ring_clear (job_queue);
+				free (job_queue->cells);
+				break;
 
-		bsem_delete (job_queue->has_jobs);
+			default: break;
+		}
 
 		free (job_queue);
 	}
 
 }
 
+// creates a JOB_QUEUE_TYPE_LIST job queue
 JobQueue *job_queue_create (void) {
 
+	return job_queue_create_with_type (JOB_QUEUE_TYPE_LIST, 0);
+
+}
+
+// creates a job queue of the selected type
+// capacity is only used by JOB_QUEUE_TYPE_RING queues
+// and is rounded up to the next power of two
+JobQueue *job_queue_create_with_type (
+	JobQueueType type, size_t capacity
+) {
+
 	JobQueue *job_queue = job_queue_new ();
 	if (job_queue) {
-		job_queue->queue = dlist_init (job_delete, NULL);
+		job_queue->type = type;
+
+		switch (type) {
+			case JOB_QUEUE_TYPE_LIST:
+				job_queue_list_init (job_queue);
+				break;
 
-		job_queue->rwmutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
-		pthread_mutex_init (job_queue->rwmutex, NULL);
+			case JOB_QUEUE_TYPE_RING:
+				if (job_queue_ring_init (
+					job_queue,
+					capacity ? capacity : JOB_QUEUE_DEFAULT_CAPACITY
+				)) {
+					job_queue_delete (job_queue);
+					job_queue = NULL;
+				}
+				break;
 
-		job_queue->has_jobs = bsem_new ();
-		bsem_init (job_queue->has_jobs, 0);
+			default:
+				job_queue_delete (job_queue);
+				job_queue = NULL;
+				break;
+		}
 	}
 
 	return job_queue;
@@ -96,36 +412,23 @@ JobQueue *job_queue_create (void) {
 }
 
 // add a new job to the queue
-// returns 0 on success, 1 on error
+// returns 0 on success, 1 on error or if a ring queue is full
 int job_queue_push (JobQueue *job_queue, Job *job) {
 
 	int retval = 1;
 
 	if (job_queue && job) {
-		pthread_mutex_lock (job_queue->rwmutex);
-
-		// job->prev = NULL;
-		// switch (job_queue->size) {
-		// 	case 0:
-		// 		job_queue->front = job;
-		// 		job_queue->rear = job;
-		// 		break;
-
-		// 	default:
-		// 		job->prev = job_queue->rear;
-		// 		job_queue->rear = job;
-		// 		break;
-		// }
-
-		retval = dlist_insert_after (
-			job_queue->queue,
-			dlist_end (job_queue->queue),
-			job
-		);
+		switch (job_queue->type) {
+			case JOB_QUEUE_TYPE_LIST:
+				retval = job_queue_list_push (job_queue, job);
+				break;
 
-		bsem_post (job_queue->has_jobs);
+			case JOB_QUEUE_TYPE_RING:
+				retval = job_queue_ring_push (job_queue, job);
+				break;
 
-		pthread_mutex_unlock (job_queue->rwmutex);
+			default: break;
+		}
 	}
 
 	return retval;
@@ -138,37 +441,108 @@ Job *job_queue_pull (JobQueue *job_queue) {
 	Job *retval = NULL;
 
 	if (job_queue) {
-		pthread_mutex_lock (job_queue->rwmutex);
-
-		switch (job_queue->queue->size) {
-			case 0: break;
-
-			case 1:
-				// remove at the start of the list
-				retval = (Job *) dlist_remove_element (job_queue->queue, NULL);
+		switch (job_queue->type) {
+			case JOB_QUEUE_TYPE_LIST:
+				retval = job_queue_list_pull (job_queue);
 				break;
 
-			default:
-				// remove at the start of the list
-				retval = (Job *) dlist_remove_element (job_queue->queue, NULL);
-				bsem_post (job_queue->has_jobs);
+			case JOB_QUEUE_TYPE_RING:
+				retval = job_queue_ring_pull (job_queue);
 				break;
+
+			default: break;
 		}
+	}
+
+	return retval;
+
+}
 
-		pthread_mutex_unlock (job_queue->rwmutex);
+// returns the current n of jobs in the queue
+size_t job_queue_size (JobQueue *job_queue) {
+
+	size_t retval = 0;
+
+	if (job_queue) {
+		switch (job_queue->type) {
+			case JOB_QUEUE_TYPE_LIST:
+				pthread_mutex_lock (job_queue->rwmutex);
+				retval = job_queue->queue->size;
+				pthread_mutex_unlock (job_queue->rwmutex);
+				break;
+
+			case JOB_QUEUE_TYPE_RING: {
+				size_t dequeue_pos = __atomic_load_n (&job_queue->dequeue_pos, __ATOMIC_ACQUIRE);
+				size_t enqueue_pos = __atomic_load_n (&job_queue->enqueue_pos, __ATOMIC_ACQUIRE);
+				if (enqueue_pos > dequeue_pos) retval = enqueue_pos - dequeue_pos;
+			} break;
+
+			default: break;
+		}
 	}
 
 	return retval;
 
 }
 
+// blocks the calling thread until the queue may have jobs
+// or until job_queue_wake_all () gets called
+// job_queue_pull () can still return NULL after this returns
+void job_queue_wait (JobQueue *job_queue) {
+
+	if (job_queue) {
+		switch (job_queue->type) {
+			case JOB_QUEUE_TYPE_LIST:
+				bsem_wait (job_queue->has_jobs);
+				break;
+
+			case JOB_QUEUE_TYPE_RING:
+				job_queue_ring_wait (job_queue);
+				break;
+
+			default: break;
+		}
+	}
+
+}
+
+// wakes up every thread waiting on the queue
+void job_queue_wake_all (JobQueue *job_queue) {
+
+	if (job_queue) {
+		switch (job_queue->type) {
+			case JOB_QUEUE_TYPE_LIST:
+				bsem_post_all (job_queue->has_jobs);
+				break;
+
+			case JOB_QUEUE_TYPE_RING:
+				job_queue_ring_wake_all (job_queue);
+				break;
+
+			default: break;
+		}
+	}
+
+}
+
 // clears the job queue -> destroys all jobs
 void job_queue_clear (JobQueue *job_queue) {
 
 	if (job_queue) {
-		dlist_reset (job_queue->queue);
+		switch (job_queue->type) {
+			case JOB_QUEUE_TYPE_LIST:
+				dlist_reset (job_queue->queue);
+				bsem_reset (job_queue->has_jobs);
+				break;
 
-		bsem_reset (job_queue->has_jobs);
+			case JOB_QUEUE_TYPE_RING:
+				job_queue_ring_clear (job_queue);
+				break;
+
+			default: break;
+		}
 	}
 
-}
\ No newline at end of file
+}
+
+#pragma endregion
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <limits.h>
+
 #include <time.h>
 #include <unistd.h>
 // #include <errno.h>
@@ -13,11 +15,38 @@
 #endif
 
 #include "cerver/threads/thpool.h"
-#include "cerver/threads/bsem.h"
 #include "cerver/threads/jobs.h"
+#include "cerver/threads/thread.h"
+
+// n of times an idle work stealing thread looks for jobs before sleeping
+#define THPOOL_WORK_STEALING_SPIN			64
 
 static void *thread_do (void *thread_ptr);
 
+const char *thpool_type_to_string (const ThpoolType type) {
+
+	switch (type) {
+		#define XX(num, name, string, description) case THPOOL_TYPE_##name: return #string;
+		THPOOL_TYPE_MAP(XX)
+		#undef XX
+	}
+
+	return thpool_type_to_string (THPOOL_TYPE_NONE);
+
+}
+
+const char *thpool_type_description (const ThpoolType type) {
+
+	switch (type) {
+		#define XX(num, name, string, description) case THPOOL_TYPE_##name: return #description;
+		THPOOL_TYPE_MAP(XX)
+		#undef XX
+	}
+
+	return thpool_type_description (THPOOL_TYPE_NONE);
+
+}
+
 #pragma region thread
 
 struct _PoolThread {
@@ -26,10 +55,17 @@ struct _PoolThread {
 	pthread_t thread_id;
 	Thpool *thpool;
 
+	// THPOOL_TYPE_WORK_STEALING
+	JobQueue *job_queue;
+	unsigned int seed;                  // used to select victims
+
 };
 
 typedef struct _PoolThread PoolThread;
 
+// the pool thread that is running in the current thread (if any)
+static _Thread_local PoolThread *current_pool_thread = NULL;
+
 static PoolThread *pool_thread_new (void) {
 
 	PoolThread *thread = (PoolThread *) malloc (sizeof (PoolThread));
@@ -37,6 +73,9 @@ static PoolThread *pool_thread_new (void) {
 		thread->id = -1;
 		thread->thread_id = 0;
 		thread->thpool = NULL;
+
+		thread->job_queue = NULL;
+		thread->seed = 0;
 	}
 
 	return thread;
@@ -45,7 +84,13 @@ static PoolThread *pool_thread_new (void) {
 
 static void pool_thread_delete (void *thread_ptr) {
 
-	if (thread_ptr) free (thread_ptr);
+	if (thread_ptr) {
+		PoolThread *thread = (PoolThread *) thread_ptr;
+
+		job_queue_delete (thread->job_queue);
+
+		free (thread_ptr);
+	}
 
 }
 
@@ -55,6 +100,14 @@ static PoolThread *pool_thread_create (int id, Thpool *thpool) {
 	if (thread) {
 		thread->id = id;
 		thread->thpool = thpool;
+
+		if (thpool->type == THPOOL_TYPE_WORK_STEALING) {
+			thread->job_queue = job_queue_create_with_type (
+				JOB_QUEUE_TYPE_RING, THPOOL_WORKER_QUEUE_CAPACITY
+			);
+
+			thread->seed = (unsigned int) id * 2654435761u + 1;
+		}
 	}
 
 	return thread;
@@ -87,6 +140,8 @@ static Thpool *thpool_new (void) {
 	if (thpool) {
 		thpool->name = NULL;
 
+		thpool->type = THPOOL_TYPE_SHARED;
+
 		thpool->n_threads = 0;
 		thpool->threads = NULL;
 
@@ -98,6 +153,10 @@ static Thpool *thpool_new (void) {
 		thpool->threads_all_idle = NULL;
 
 		thpool->job_queue = NULL;
+
+		thpool->signal = 0;
+		thpool->idle = 0;
+		thpool->next_thread = 0;
 	}
 
 	return thpool;
@@ -134,14 +193,197 @@ static void thpool_delete (void *thpool_ptr) {
 
 #pragma endregion
 
+#pragma region work stealing
+
+// wakes up one idle thread if there are any
+static void thpool_work_stealing_notify (Thpool *thpool) {
+
+	// pairs with the fence in thpool_work_stealing_park ()
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	if (__atomic_load_n (&thpool->idle, __ATOMIC_RELAXED)) {
+		(void) __atomic_add_fetch (&thpool->signal, 1, __ATOMIC_RELEASE);
+		thread_futex_wake (&thpool->signal, 1);
+	}
+
+}
+
+static void thpool_work_stealing_wake_all (Thpool *thpool) {
+
+	(void) __atomic_add_fetch (&thpool->signal, 1, __ATOMIC_SEQ_CST);
+	thread_futex_wake (&thpool->signal, INT_MAX);
+
+}
+
+// works added by a pool thread go to its own queue,
+// any other work is spread between the threads
+static int thpool_work_stealing_push (Thpool *thpool, Job *job) {
+
+	int retval = 1;
+
+	unsigned int idx = 0;
+	if (current_pool_thread && (current_pool_thread->thpool == thpool)) {
+		idx = (unsigned int) current_pool_thread->id;
+	}
+
+	else {
+		idx = __atomic_fetch_add (&thpool->next_thread, 1, __ATOMIC_RELAXED);
+	}
+
+	for (unsigned int i = 0; i < thpool->n_threads; i++) {
+		PoolThread *thread = thpool->threads[(idx + i) % thpool->n_threads];
+		if (thread && !job_queue_push (thread->job_queue, job)) {
+			retval = 0;
+			break;
+		}
+	}
+
+	// every thread's queue is full
+	if (retval) retval = job_queue_push (thpool->job_queue, job);
+
+	if (!retval) thpool_work_stealing_notify (thpool);
+
+	return retval;
+
+}
+
+// gets a job from the thread's own queue,
+// or steals one starting from a random thread
+static Job *thpool_work_stealing_next (Thpool *thpool, PoolThread *thread) {
+
+	Job *job = job_queue_pull (thread->job_queue);
+	if (!job && (thpool->n_threads > 1)) {
+		// xorshift
+		thread->seed ^= thread->seed << 13;
+		thread->seed ^= thread->seed >> 17;
+		thread->seed ^= thread->seed << 5;
+
+		unsigned int start = thread->seed % thpool->n_threads;
+		for (unsigned int i = 0; i < thpool->n_threads; i++) {
+			PoolThread *victim = thpool->threads[(start + i) % thpool->n_threads];
+			// threads are still being created by thpool_init ()
+			if (victim && (victim != thread)) {
+				job = job_queue_pull (victim->job_queue);
+				if (job) break;
+			}
+		}
+	}
+
+	if (!job) job = job_queue_pull (thpool->job_queue);
+
+	return job;
+
+}
+
+static bool thpool_work_stealing_has_jobs (Thpool *thpool) {
+
+	bool retval = false;
+
+	for (unsigned int i = 0; i < thpool->n_threads; i++) {
+		if (thpool->threads[i] && job_queue_size (thpool->threads[i]->job_queue)) {
+			retval = true;
+			break;
+		}
+	}
+
+	if (!retval) retval = (job_queue_size (thpool->job_queue) > 0);
+
+	return retval;
+
+}
+
+static void thpool_work_stealing_park (Thpool *thpool) {
+
+	for (unsigned int i = 0; i < THPOOL_WORK_STEALING_SPIN; i++) {
+		if (thpool_work_stealing_has_jobs (thpool)) return;
+		thread_cpu_relax ();
+	}
+
+	unsigned int signal = __atomic_load_n (&thpool->signal, __ATOMIC_ACQUIRE);
+
+	(void) __atomic_add_fetch (&thpool->idle, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+	// the futex returns right away if the signal changed after we read it
+	if (thpool->keep_alive && !thpool_work_stealing_has_jobs (thpool))
+		thread_futex_wait (&thpool->signal, signal);
+
+	(void) __atomic_sub_fetch (&thpool->idle, 1, __ATOMIC_RELAXED);
+
+}
+
+// a thread is marked as working while it is able to get jobs,
+// instead of taking the thpool's mutex for every job
+static void thread_do_work_stealing (PoolThread *thread) {
+
+	Thpool *thpool = thread->thpool;
+
+	Job *job = NULL;
+	while (thpool->keep_alive) {
+		(void) __atomic_add_fetch (&thpool->num_threads_working, 1, __ATOMIC_SEQ_CST);
+
+		while (thpool->keep_alive && (job = thpool_work_stealing_next (thpool, thread))) {
+			if (job->method)
+				job->method (job->args);
+
+			job_delete (job);
+		}
+
+		if (!__atomic_sub_fetch (&thpool->num_threads_working, 1, __ATOMIC_SEQ_CST)) {
+			pthread_mutex_lock (thpool->mutex);
+			pthread_cond_signal (thpool->threads_all_idle);
+			pthread_mutex_unlock (thpool->mutex);
+		}
+
+		if (thpool->keep_alive) thpool_work_stealing_park (thpool);
+	}
+
+}
+
+#pragma endregion
+
 #pragma region internal
 
+static void thread_do_shared (PoolThread *thread) {
+
+	Thpool *thpool = thread->thpool;
+
+	while (thpool->keep_alive) {
+		job_queue_wait (thpool->job_queue);
+		if (thpool->keep_alive) {
+			pthread_mutex_lock (thpool->mutex);
+			thpool->num_threads_working += 1;
+			pthread_mutex_unlock (thpool->mutex);
+
+			// get job to execute
+			Job *job = job_queue_pull (thpool->job_queue);
+			if (job) {
+				if (job->method)
+					job->method (job->args);
+
+				job_delete (job);
+			}
+
+			pthread_mutex_lock (thpool->mutex);
+
+			thpool->num_threads_working -= 1;
+
+			if (!thpool->num_threads_working)
+				pthread_cond_signal (thpool->threads_all_idle);
+
+			pthread_mutex_unlock (thpool->mutex);
+		}
+	}
+
+}
+
 static void *thread_do (void *thread_ptr) {
 
 	if (thread_ptr) {
 		PoolThread *thread = (PoolThread *) thread_ptr;
 		Thpool *thpool = thread->thpool;
 
+		current_pool_thread = thread;
+
 		// set name
 		if (thpool->name) {
 			char thread_name[64] = { 0 };
@@ -154,31 +396,14 @@ static void *thread_do (void *thread_ptr) {
 		thpool->num_threads_alive += 1;
 		pthread_mutex_unlock (thpool->mutex);
 
-		while (thpool->keep_alive) {
-			bsem_wait (thpool->job_queue->has_jobs);
-			if (thpool->keep_alive) {
-				pthread_mutex_lock (thpool->mutex);
-				thpool->num_threads_working += 1;
-				pthread_mutex_unlock (thpool->mutex);
-
-				// get job to execute
-				Job *job = job_queue_pull (thpool->job_queue);
-				if (job) {
-					if (job->method)
-						job->method (job->args);
-
-					job_delete (job);
-				}
-
-				pthread_mutex_lock (thpool->mutex);
-
-				thpool->num_threads_working -= 1;
+		switch (thpool->type) {
+			case THPOOL_TYPE_WORK_STEALING:
+				thread_do_work_stealing (thread);
+				break;
 
-				if (!thpool->num_threads_working)
-					pthread_cond_signal (thpool->threads_all_idle);
-
-				pthread_mutex_unlock (thpool->mutex);
-			}
+			default:
+				thread_do_shared (thread);
+				break;
 		}
 
 		pthread_mutex_lock (thpool->mutex);
@@ -190,6 +415,31 @@ static void *thread_do (void *thread_ptr) {
 
 }
 
+// gets the n of jobs that are waiting in the thpool's queues
+static size_t thpool_get_n_jobs (Thpool *thpool) {
+
+	size_t n_jobs = job_queue_size (thpool->job_queue);
+
+	if (thpool->type == THPOOL_TYPE_WORK_STEALING) {
+		for (unsigned int i = 0; i < thpool->n_threads; i++) {
+			if (thpool->threads[i])
+				n_jobs += job_queue_size (thpool->threads[i]->job_queue);
+		}
+	}
+
+	return n_jobs;
+
+}
+
+static void thpool_wake_all (Thpool *thpool) {
+
+	job_queue_wake_all (thpool->job_queue);
+
+	if (thpool->type == THPOOL_TYPE_WORK_STEALING)
+		thpool_work_stealing_wake_all (thpool);
+
+}
+
 #pragma endregion
 
 #pragma region public
@@ -200,7 +450,7 @@ Thpool *thpool_create (unsigned int n_threads) {
 	Thpool *thpool = thpool_new ();
 	if (thpool) {
 		thpool->n_threads = n_threads;
-		thpool->threads = (PoolThread **) calloc (thpool->n_threads, sizeof (PoolThread));
+		thpool->threads = (PoolThread **) calloc (thpool->n_threads, sizeof (PoolThread *));
 		if (thpool->threads) {
 			thpool->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
 			pthread_mutex_init (thpool->mutex, NULL);
@@ -232,8 +482,13 @@ unsigned int thpool_init (Thpool *thpool) {
 	if (thpool) {
 		// initialize threads
 		thpool->keep_alive = true;
+		// every slot is set before any thread starts
+		// as workers look into the other threads' queues
 		for (unsigned int i = 0; i < thpool->n_threads; i++) {
 			thpool->threads[i] = pool_thread_create (i, thpool);
+		}
+
+		for (unsigned int i = 0; i < thpool->n_threads; i++) {
 			pool_thread_init (thpool->threads[i]);
 		}
 
@@ -263,6 +518,42 @@ void thpool_set_name (Thpool *thpool, const char *name) {
 
 }
 
+// sets the thpool's type, the default is THPOOL_TYPE_SHARED
+// in THPOOL_TYPE_WORK_STEALING each thread gets its own lock-free queue,
+// works added from outside the thpool are spread between the threads
+// and idle threads steal jobs from random threads
+// must be called before thpool_init ()
+void thpool_set_type (Thpool *thpool, const ThpoolType type) {
+
+	if (thpool) thpool->type = type;
+
+}
+
+// replaces the thpool's job queue with a new one of the selected type
+// a JOB_QUEUE_TYPE_RING queue avoids locks but thpool_add_work ()
+// fails when it already has capacity jobs waiting
+// must be called before thpool_init ()
+// returns 0 on success, 1 on error
+unsigned int thpool_set_job_queue_type (
+	Thpool *thpool, JobQueueType type, size_t capacity
+) {
+
+	unsigned int retval = 1;
+
+	if (thpool) {
+		JobQueue *job_queue = job_queue_create_with_type (type, capacity);
+		if (job_queue) {
+			job_queue_delete (thpool->job_queue);
+			thpool->job_queue = job_queue;
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
 // gets the current number of threads that are alive (running) in the thpool
 unsigned int thpool_get_num_threads_alive (Thpool *thpool) {
 
@@ -335,7 +626,17 @@ int thpool_add_work (Thpool *thpool, void (*work) (void *), void *args) {
 
 	if (thpool && work) {
 		Job *job = job_create (work, args);
-		retval = job_queue_push (thpool->job_queue, job);
+		switch (thpool->type) {
+			case THPOOL_TYPE_WORK_STEALING:
+				retval = thpool_work_stealing_push (thpool, job);
+				break;
+
+			default:
+				retval = job_queue_push (thpool->job_queue, job);
+				break;
+		}
+
+		if (retval) job_delete (job);
 	}
 
 	return retval;
@@ -348,7 +649,7 @@ void thpool_wait (Thpool *thpool) {
 	if (thpool) {
 		pthread_mutex_lock (thpool->mutex);
 
-		while (thpool->job_queue->queue->size || thpool->num_threads_working) {
+		while (thpool_get_n_jobs (thpool) || thpool->num_threads_working) {
 			pthread_cond_wait (thpool->threads_all_idle, thpool->mutex);
 		}
 
@@ -370,14 +671,14 @@ void thpool_destroy (Thpool *thpool) {
 		double tpassed = 0.0;
 		time (&start);
 		while ((tpassed < timeout) && thpool->num_threads_alive){
-			bsem_post_all (thpool->job_queue->has_jobs);
+			thpool_wake_all (thpool);
 			time (&end);
 			tpassed = difftime (end,start);
 		}
 
 		// poll remaining threads
 		while (thpool->num_threads_alive){
-			bsem_post_all (thpool->job_queue->has_jobs);
+			thpool_wake_all (thpool);
 			sleep (1);
 		}
 
@@ -3,8 +3,11 @@
 
 #include <errno.h>
 
+#include <unistd.h>
 #include <pthread.h>
 #include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #include "cerver/types/types.h"
 
@@ -107,4 +110,23 @@ void pthread_cond_delete (pthread_cond_t *cond) {
 
 }
 
+#pragma endregion
+
+#pragma region futex
+
+// sleeps while the value at addr is equal to value
+// can return early, so callers should check their condition again
+void thread_futex_wait (unsigned int *addr, unsigned int value) {
+
+	(void) syscall (SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+
+}
+
+// wakes up to count threads sleeping on addr
+void thread_futex_wake (unsigned int *addr, int count) {
+
+	(void) syscall (SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+
+}
+
 #pragma endregion
\ No newline at end of file
@@ -0,0 +1,780 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/collections/dlist.h"
+#include "cerver/collections/ohtab.h"
+
+#include "cerver/cerver.h"
+#include "cerver/client.h"
+#include "cerver/connection.h"
+#include "cerver/events.h"
+#include "cerver/handler.h"
+#include "cerver/network.h"
+#include "cerver/udp.h"
+#include "cerver/wheel.h"
+
+#include "cerver/threads/thread.h"
+
+#include "cerver/utils/log.h"
+
+// the worker whose loop is running in the current thread,
+// so the replies sent by its handlers can be batched
+static _Thread_local CerverUdpWorker *udp_current_worker = NULL;
+
+static void cerver_udp_worker_flush (CerverUdpWorker *worker);
+
+#pragma region address
+
+static void cerver_udp_address_key (
+	const struct sockaddr_storage *address, CerverUdpAddress *key
+) {
+
+	(void) memset (key, 0, sizeof (CerverUdpAddress));
+
+	key->family = address->ss_family;
+	if (address->ss_family == AF_INET6) {
+		const struct sockaddr_in6 *addr = (const struct sockaddr_in6 *) address;
+		key->port = addr->sin6_port;
+		key->scope_id = addr->sin6_scope_id;
+		(void) memcpy (key->addr, &addr->sin6_addr, sizeof (struct in6_addr));
+	}
+
+	else {
+		const struct sockaddr_in *addr = (const struct sockaddr_in *) address;
+		key->port = addr->sin_port;
+		(void) memcpy (key->addr, &addr->sin_addr, sizeof (struct in_addr));
+	}
+
+}
+
+static inline socklen_t cerver_udp_address_len (
+	const struct sockaddr_storage *address
+) {
+
+	return (address->ss_family == AF_INET6) ?
+		sizeof (struct sockaddr_in6) : sizeof (struct sockaddr_in);
+
+}
+
+#pragma endregion
+
+#pragma region peers
+
+static inline Connection *cerver_udp_peer_connection (const Client *client) {
+
+	ListElement *le = dlist_start (client->connections);
+
+	return le ? (Connection *) le->data : NULL;
+
+}
+
+// removes the peer from the worker's map & deletes it
+static void cerver_udp_peer_remove (CerverUdpWorker *worker, Client *client) {
+
+	Connection *connection = cerver_udp_peer_connection (client);
+
+	CerverUdpAddress key = { 0 };
+	if (connection) cerver_udp_address_key (&connection->address, &key);
+
+	if (connection && ohtab_remove (worker->peers, &key)) {
+		worker->stats.current_peers -= 1;
+
+		cerver_event_trigger (
+			CERVER_EVENT_CLIENT_DROPPED,
+			worker->cerver,
+			client, connection
+		);
+
+		client_delete (client);
+	}
+
+}
+
+// udp peers never disconnect, so they are removed once they have
+// not sent any datagram in the cerver's max inactive time
+static void cerver_udp_peer_expired (TimerWheel *wheel, void *client_ptr) {
+
+	CerverUdpWorker *worker = (CerverUdpWorker *) wheel->data;
+	Client *client = (Client *) client_ptr;
+
+	const time_t inactive = time (NULL)
+		- __atomic_load_n (&client->last_activity, __ATOMIC_RELAXED);
+
+	if (inactive >= (time_t) worker->cerver->max_inactive_time) {
+		#ifdef CLIENT_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+			"Removing inactive udp peer %lu from cerver %s worker %u",
+			client->id, worker->cerver->info->name->str, worker->id
+		);
+		#endif
+
+		cerver_udp_peer_remove (worker, client);
+	}
+
+	else {
+		(void) timer_wheel_arm (
+			wheel, &client->inactive_timer,
+			(u64) (worker->cerver->max_inactive_time - inactive) * 1000
+		);
+	}
+
+}
+
+// creates a new client with a connection to the address
+// that uses the worker's socket to send its replies
+static Client *cerver_udp_peer_create (
+	CerverUdpWorker *worker,
+	const CerverUdpAddress *key, const struct sockaddr_storage *address
+) {
+
+	Cerver *cerver = worker->cerver;
+
+	Client *client = client_create_with_connection (cerver, worker->sock, *address);
+	if (client) {
+		if (!ohtab_insert (worker->peers, key, client)) {
+			worker->stats.current_peers += 1;
+			worker->stats.total_peers += 1;
+
+			client->last_activity = time (NULL);
+
+			if (worker->timer_wheel) {
+				wheel_timer_init (&client->inactive_timer, cerver_udp_peer_expired, client);
+				(void) timer_wheel_arm (
+					worker->timer_wheel, &client->inactive_timer,
+					(u64) cerver->max_inactive_time * 1000
+				);
+			}
+
+			Connection *connection = cerver_udp_peer_connection (client);
+
+			#ifdef CLIENT_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+				"New udp peer %lu from %s:%u in cerver %s worker %u",
+				client->id, connection->ip ? connection->ip->str : "?", connection->port,
+				cerver->info->name->str, worker->id
+			);
+			#endif
+
+			cerver_event_trigger (
+				CERVER_EVENT_CLIENT_CONNECTED,
+				cerver,
+				client, connection
+			);
+		}
+
+		else {
+			client_delete (client);
+			client = NULL;
+		}
+	}
+
+	return client;
+
+}
+
+// returns the client mapped to the source address,
+// a new one is created the first time that the address is seen
+static inline Client *cerver_udp_peer_get (
+	CerverUdpWorker *worker, const struct sockaddr_storage *address
+) {
+
+	CerverUdpAddress key = { 0 };
+	cerver_udp_address_key (address, &key);
+
+	Client *client = (Client *) ohtab_get (worker->peers, &key);
+	if (!client) client = cerver_udp_peer_create (worker, &key, address);
+
+	return client;
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+static CerverUdpWorker *cerver_udp_worker_new (void) {
+
+	CerverUdpWorker *worker = (CerverUdpWorker *) malloc (sizeof (CerverUdpWorker));
+	if (worker) {
+		(void) memset (worker, 0, sizeof (CerverUdpWorker));
+
+		worker->sock = -1;
+	}
+
+	return worker;
+
+}
+
+void cerver_udp_worker_delete (void *worker_ptr) {
+
+	if (worker_ptr) {
+		CerverUdpWorker *worker = (CerverUdpWorker *) worker_ptr;
+
+		// the first worker uses the cerver's socket
+		if (worker->id && (worker->sock > -1)) close (worker->sock);
+
+		if (worker->receive_msgs) free (worker->receive_msgs);
+		if (worker->receive_iovs) free (worker->receive_iovs);
+		if (worker->receive_addresses) free (worker->receive_addresses);
+		if (worker->receive_buffers) free (worker->receive_buffers);
+
+		if (worker->send_msgs) free (worker->send_msgs);
+		if (worker->send_iovs) free (worker->send_iovs);
+		if (worker->send_addresses) free (worker->send_addresses);
+		if (worker->send_buffers) free (worker->send_buffers);
+
+		// the peers cancel their timers when they are deleted
+		if (worker->peers) ohtab_destroy (worker->peers);
+		timer_wheel_delete (worker->timer_wheel);
+
+		free (worker_ptr);
+	}
+
+}
+
+// points each message to its own address & buffer
+static void cerver_udp_worker_batch_init (
+	struct mmsghdr *msgs, struct iovec *iovs,
+	struct sockaddr_storage *addresses, char *buffers,
+	const u32 batch_size, const size_t datagram_size
+) {
+
+	for (u32 i = 0; i < batch_size; i++) {
+		iovs[i].iov_base = buffers + (i * datagram_size);
+		iovs[i].iov_len = datagram_size;
+
+		msgs[i].msg_hdr.msg_name = &addresses[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+}
+
+// creates a new worker with its own receive & send batches
+// the socket is created when calling cerver_udp_bind ()
+CerverUdpWorker *cerver_udp_worker_create (
+	Cerver *cerver, const u32 id
+) {
+
+	CerverUdpWorker *worker = cerver_udp_worker_new ();
+	if (worker) {
+		worker->id = id;
+		worker->cerver = cerver;
+
+		worker->batch_size = cerver->udp_batch_size;
+		worker->datagram_size = (cerver->receive_buffer_size < MAX_UDP_PACKET_SIZE) ?
+			cerver->receive_buffer_size : MAX_UDP_PACKET_SIZE;
+
+		worker->receive_msgs = (struct mmsghdr *) calloc (worker->batch_size, sizeof (struct mmsghdr));
+		worker->receive_iovs = (struct iovec *) calloc (worker->batch_size, sizeof (struct iovec));
+		worker->receive_addresses = (struct sockaddr_storage *) calloc (worker->batch_size, sizeof (struct sockaddr_storage));
+		worker->receive_buffers = (char *) malloc (worker->batch_size * worker->datagram_size);
+
+		worker->send_msgs = (struct mmsghdr *) calloc (worker->batch_size, sizeof (struct mmsghdr));
+		worker->send_iovs = (struct iovec *) calloc (worker->batch_size, sizeof (struct iovec));
+		worker->send_addresses = (struct sockaddr_storage *) calloc (worker->batch_size, sizeof (struct sockaddr_storage));
+		worker->send_buffers = (char *) malloc (worker->batch_size * worker->datagram_size);
+
+		worker->peers = ohtab_create (
+			sizeof (CerverUdpAddress), CERVER_UDP_PEERS_INIT, client_delete
+		);
+
+		if (cerver->inactive_clients) {
+			worker->timer_wheel = timer_wheel_create (CERVER_TIMER_WHEEL_TICK, worker);
+		}
+
+		if (
+			!worker->receive_msgs || !worker->receive_iovs
+			|| !worker->receive_addresses || !worker->receive_buffers
+			|| !worker->send_msgs || !worker->send_iovs
+			|| !worker->send_addresses || !worker->send_buffers
+			|| !worker->peers
+			|| (cerver->inactive_clients && !worker->timer_wheel)
+		) {
+			cerver_udp_worker_delete (worker);
+			worker = NULL;
+		}
+
+		else {
+			cerver_udp_worker_batch_init (
+				worker->receive_msgs, worker->receive_iovs,
+				worker->receive_addresses, worker->receive_buffers,
+				worker->batch_size, worker->datagram_size
+			);
+
+			cerver_udp_worker_batch_init (
+				worker->send_msgs, worker->send_iovs,
+				worker->send_addresses, worker->send_buffers,
+				worker->batch_size, worker->datagram_size
+			);
+		}
+	}
+
+	return worker;
+
+}
+
+// creates the cerver's udp workers based on its udp_n_workers value
+// returns 0 on success, 1 on error
+u8 cerver_udp_init (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	cerver->udp_workers = (CerverUdpWorker **) calloc (
+		cerver->udp_n_workers, sizeof (CerverUdpWorker *)
+	);
+
+	if (cerver->udp_workers) {
+		u8 errors = 0;
+		for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+			cerver->udp_workers[i] = cerver_udp_worker_create (cerver, i);
+			if (!cerver->udp_workers[i]) {
+				cerver_log_error (
+					"Failed to create cerver %s udp worker %u!",
+					cerver->info->name->str, i
+				);
+
+				errors = 1;
+			}
+		}
+
+		retval = errors;
+	}
+
+	else {
+		cerver_log_error (
+			"Failed to allocate cerver %s udp workers!",
+			cerver->info->name->str
+		);
+	}
+
+	return retval;
+
+}
+
+// deletes all the cerver's udp workers & their peers
+void cerver_udp_delete (Cerver *cerver) {
+
+	if (cerver->udp_workers) {
+		for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+			cerver_udp_worker_delete (cerver->udp_workers[i]);
+		}
+
+		free (cerver->udp_workers);
+		cerver->udp_workers = NULL;
+	}
+
+}
+
+#pragma endregion
+
+#pragma region start
+
+// creates a new non blocking socket that can be bound
+// to the same address & port as the cerver's main socket
+static i32 cerver_udp_create_socket (Cerver *cerver) {
+
+	i32 sock = socket (
+		(cerver->use_ipv6 ? AF_INET6 : AF_INET),
+		SOCK_DGRAM | SOCK_NONBLOCK, 0
+	);
+
+	if (sock > -1) {
+		if (
+			sock_set_reusable (sock)
+			|| bind (
+				sock,
+				(const struct sockaddr *) &cerver->address,
+				sizeof (struct sockaddr_storage)
+			)
+		) {
+			close (sock);
+			sock = -1;
+		}
+	}
+
+	return sock;
+
+}
+
+// binds each worker's SO_REUSEPORT socket to the cerver's address
+// the first worker uses the cerver's main socket
+// returns 0 on success, 1 on error
+u8 cerver_udp_bind (Cerver *cerver) {
+
+	u8 errors = 0;
+
+	CerverUdpWorker *worker = NULL;
+	for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+		worker = cerver->udp_workers[i];
+		worker->sock = worker->id ? cerver_udp_create_socket (cerver) : cerver->sock;
+
+		if (worker->sock < 0) {
+			cerver_log_error (
+				"Failed to bind cerver %s udp worker %u socket!",
+				cerver->info->name->str, worker->id
+			);
+
+			errors = 1;
+		}
+	}
+
+	return errors;
+
+}
+
+// handles a received datagram using the client of its source address
+static inline void cerver_udp_worker_handle_datagram (
+	CerverUdpWorker *worker, const u32 idx
+) {
+
+	const struct mmsghdr *msg = &worker->receive_msgs[idx];
+
+	worker->stats.n_datagrams_received += 1;
+	worker->stats.bytes_received += msg->msg_len;
+
+	// datagrams bigger than the receive buffer can't be handled
+	if (msg->msg_hdr.msg_flags & MSG_TRUNC) {
+		worker->stats.n_bad_datagrams += 1;
+	}
+
+	else {
+		Client *client = cerver_udp_peer_get (worker, &worker->receive_addresses[idx]);
+		Connection *connection = client ? cerver_udp_peer_connection (client) : NULL;
+		if (connection) {
+			if (cerver_receive_handle_datagram (
+				worker->cerver,
+				client, connection,
+				(char *) worker->receive_iovs[idx].iov_base, msg->msg_len
+			)) {
+				worker->stats.n_bad_datagrams += 1;
+			}
+		}
+	}
+
+}
+
+// receives & handles every pending datagram in batches
+static void cerver_udp_worker_receive (CerverUdpWorker *worker) {
+
+	int received = 0;
+	do {
+		// the kernel sets the length of each address
+		for (u32 i = 0; i < worker->batch_size; i++) {
+			worker->receive_msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+		}
+
+		received = recvmmsg (
+			worker->sock,
+			worker->receive_msgs, worker->batch_size,
+			MSG_DONTWAIT, NULL
+		);
+
+		if (received > 0) {
+			worker->stats.n_receives_done += 1;
+
+			for (u32 i = 0; i < (u32) received; i++) {
+				cerver_udp_worker_handle_datagram (worker, i);
+			}
+
+			// send the replies of the whole batch at once
+			cerver_udp_worker_flush (worker);
+		}
+	} while ((received == (int) worker->batch_size) && worker->running);
+
+}
+
+// the worker's loop, waits for datagrams & expires inactive peers
+static u8 cerver_udp_worker_loop (CerverUdpWorker *worker) {
+
+	Cerver *cerver = worker->cerver;
+
+	cerver_log (
+		LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+		"Cerver %s udp worker %u is ready in port %d!",
+		cerver->info->name->str, worker->id, cerver->port
+	);
+
+	udp_current_worker = worker;
+
+	struct pollfd pfd = { .fd = worker->sock, .events = POLLIN, .revents = 0 };
+
+	int poll_retval = 0;
+	while (cerver->isRunning && worker->running) {
+		poll_retval = poll (&pfd, 1, (int) cerver->poll_timeout);
+		if (poll_retval > 0) {
+			cerver_udp_worker_receive (worker);
+		}
+
+		else if ((poll_retval < 0) && (errno != EINTR)) {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Cerver %s udp worker %u poll has failed!",
+				cerver->info->name->str, worker->id
+			);
+
+			perror ("Error");
+			break;
+		}
+
+		// the peers' timers are only handled in the worker's thread
+		if (worker->timer_wheel) (void) timer_wheel_advance (worker->timer_wheel);
+	}
+
+	cerver_udp_worker_flush (worker);
+
+	udp_current_worker = NULL;
+
+	#ifdef CERVER_DEBUG
+	cerver_log (
+		LOG_TYPE_CERVER, LOG_TYPE_NONE,
+		"Cerver %s udp worker %u has stopped!",
+		cerver->info->name->str, worker->id
+	);
+	#endif
+
+	return 0;
+
+}
+
+static void *cerver_udp_worker_thread (void *worker_ptr) {
+
+	CerverUdpWorker *worker = (CerverUdpWorker *) worker_ptr;
+
+	char thread_name[THREAD_NAME_BUFFER_LEN] = { 0 };
+	(void) snprintf (
+		thread_name, THREAD_NAME_BUFFER_LEN,
+		"%s-udp-%u", worker->cerver->info->name->str, worker->id
+	);
+
+	(void) thread_set_name (thread_name);
+
+	(void) cerver_udp_worker_loop (worker);
+
+	return NULL;
+
+}
+
+// starts every worker loop in a dedicated thread,
+// except for the first one that is handled in the calling thread
+// if a thread can't be created, the workers that were started are stopped
+// returns 0 on success, 1 on error
+u8 cerver_udp_start (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	u8 errors = 0;
+	for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+		cerver->udp_workers[i]->running = true;
+	}
+
+	for (u32 i = 1; i < cerver->udp_n_workers; i++) {
+		if (pthread_create (
+			&cerver->udp_workers[i]->thread_id,
+			NULL,
+			cerver_udp_worker_thread,
+			cerver->udp_workers[i]
+		)) {
+			cerver_log_error (
+				"Failed to create cerver %s udp worker %u thread!",
+				cerver->info->name->str, i
+			);
+
+			cerver->udp_workers[i]->running = false;
+			cerver->udp_workers[i]->thread_id = 0;
+
+			errors = 1;
+		}
+	}
+
+	if (!errors) {
+		retval = cerver_udp_worker_loop (cerver->udp_workers[0]);
+	}
+
+	// the workers that were started are stopped
+	else {
+		cerver_udp_end (cerver);
+	}
+
+	return retval;
+
+}
+
+// stops all the udp workers & waits for their threads to finish
+void cerver_udp_end (Cerver *cerver) {
+
+	if (cerver->udp_workers) {
+		for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+			cerver->udp_workers[i]->running = false;
+		}
+
+		for (u32 i = 1; i < cerver->udp_n_workers; i++) {
+			if (cerver->udp_workers[i]->thread_id) {
+				(void) pthread_join (cerver->udp_workers[i]->thread_id, NULL);
+				cerver->udp_workers[i]->thread_id = 0;
+			}
+		}
+	}
+
+}
+
+#pragma endregion
+
+#pragma region send
+
+// sends the replies that were batched in the worker's thread
+// a datagram that can't be sent is dropped
+static void cerver_udp_worker_flush (CerverUdpWorker *worker) {
+
+	u32 sent = 0;
+	int retval = 0;
+	while (sent < worker->n_sends) {
+		retval = sendmmsg (
+			worker->sock,
+			&worker->send_msgs[sent], worker->n_sends - sent,
+			MSG_NOSIGNAL
+		);
+
+		if (retval > 0) {
+			worker->stats.n_sends_done += 1;
+			worker->stats.n_datagrams_sent += (u64) retval;
+
+			sent += (u32) retval;
+		}
+
+		else if (errno != EINTR) {
+			worker->stats.n_datagrams_dropped += 1;
+
+			sent += 1;
+		}
+	}
+
+	worker->n_sends = 0;
+
+}
+
+// sends the iovecs as a single datagram to the connection's address
+// sends from a worker's thread are batched & sent after handling its datagrams
+// returns 0 on success, 1 on error
+u8 cerver_udp_send (
+	Connection *connection,
+	const struct iovec *iov, unsigned int iov_count,
+	size_t *total_sent
+) {
+
+	u8 retval = 1;
+
+	size_t size = 0;
+	for (unsigned int i = 0; i < iov_count; i++) size += iov[i].iov_len;
+
+	CerverUdpWorker *worker = udp_current_worker;
+
+	if (size <= MAX_UDP_PACKET_SIZE) {
+		if (
+			worker
+			&& (connection->socket->sock_fd == worker->sock)
+			&& (size <= worker->datagram_size)
+		) {
+			if (worker->n_sends == worker->batch_size) cerver_udp_worker_flush (worker);
+
+			const u32 idx = worker->n_sends;
+
+			char *end = (char *) worker->send_iovs[idx].iov_base;
+			for (unsigned int i = 0; i < iov_count; i++) {
+				(void) memcpy (end, iov[i].iov_base, iov[i].iov_len);
+				end += iov[i].iov_len;
+			}
+
+			worker->send_iovs[idx].iov_len = size;
+
+			(void) memcpy (&worker->send_addresses[idx], &connection->address, sizeof (struct sockaddr_storage));
+			worker->send_msgs[idx].msg_hdr.msg_namelen = cerver_udp_address_len (&connection->address);
+
+			worker->n_sends += 1;
+
+			retval = 0;
+		}
+
+		// sent directly from any other thread
+		else {
+			struct msghdr msg = {
+				.msg_name = &connection->address,
+				.msg_namelen = cerver_udp_address_len (&connection->address),
+				.msg_iov = (struct iovec *) iov,
+				.msg_iovlen = iov_count,
+				.msg_control = NULL,
+				.msg_controllen = 0,
+				.msg_flags = 0
+			};
+
+			if (sendmsg (connection->socket->sock_fd, &msg, MSG_NOSIGNAL) == (ssize_t) size) {
+				retval = 0;
+			}
+		}
+	}
+
+	if (total_sent) *total_sent = retval ? 0 : size;
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region stats
+
+// returns the n of peers that are currently mapped in every worker
+u64 cerver_udp_get_n_peers (Cerver *cerver) {
+
+	u64 n_peers = 0;
+
+	if (cerver && cerver->udp_workers) {
+		for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+			n_peers += ohtab_size (cerver->udp_workers[i]->peers);
+		}
+	}
+
+	return n_peers;
+
+}
+
+// prints the stats of each of the cerver's udp workers
+void cerver_udp_stats_print (Cerver *cerver) {
+
+	if (cerver && cerver->udp_workers) {
+		CerverUdpWorkerStats *stats = NULL;
+		for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+			stats = &cerver->udp_workers[i]->stats;
+
+			cerver_log_msg ("\nUdp worker %u:", i);
+			cerver_log_msg ("Current peers:                 %lu", stats->current_peers);
+			cerver_log_msg ("Total peers:                   %lu", stats->total_peers);
+			cerver_log_msg ("Receives done:                 %lu", stats->n_receives_done);
+			cerver_log_msg ("Datagrams received:            %lu", stats->n_datagrams_received);
+			cerver_log_msg ("Bytes received:                %lu", stats->bytes_received);
+			cerver_log_msg ("Bad datagrams:                 %lu", stats->n_bad_datagrams);
+			cerver_log_msg ("Sends done:                    %lu", stats->n_sends_done);
+			cerver_log_msg ("Datagrams sent:                %lu", stats->n_datagrams_sent);
+			cerver_log_msg ("Datagrams dropped:             %lu", stats->n_datagrams_dropped);
+		}
+	}
+
+}
+
+#pragma endregion
@@ -0,0 +1,742 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/cerver.h"
+#include "cerver/connection.h"
+#include "cerver/socket.h"
+#include "cerver/uring.h"
+
+#include "cerver/threads/thread.h"
+
+#include "cerver/utils/log.h"
+
+#define CERVER_URING_PROBE_OPS				256
+
+#define CERVER_URING_OP_SHIFT				56
+#define CERVER_URING_GENERATION_SHIFT		32
+#define CERVER_URING_GENERATION_MASK		0xffffff
+
+#pragma region syscalls
+
+static inline int cerver_uring_sys_setup (
+	unsigned int entries, struct io_uring_params *params
+) {
+
+	return (int) syscall (__NR_io_uring_setup, entries, params);
+
+}
+
+static inline int cerver_uring_sys_enter (
+	int ring_fd, unsigned int to_submit, unsigned int min_complete,
+	unsigned int flags, void *arg, size_t arg_size
+) {
+
+	return (int) syscall (
+		__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, arg_size
+	);
+
+}
+
+static inline int cerver_uring_sys_register (
+	int ring_fd, unsigned int opcode, void *arg, unsigned int n_args
+) {
+
+	return (int) syscall (__NR_io_uring_register, ring_fd, opcode, arg, n_args);
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+// multishot receives & the provided buffers ring were added in 6.0,
+// the same release as IORING_OP_SEND_ZC, so it is used to check for them
+bool cerver_uring_is_supported (void) {
+
+	bool retval = false;
+
+	struct io_uring_params params = { 0 };
+	int ring_fd = cerver_uring_sys_setup (2, &params);
+	if (ring_fd > -1) {
+		size_t probe_size = sizeof (struct io_uring_probe)
+			+ CERVER_URING_PROBE_OPS * sizeof (struct io_uring_probe_op);
+
+		struct io_uring_probe *probe = (struct io_uring_probe *) calloc (1, probe_size);
+		if (probe) {
+			if (!cerver_uring_sys_register (
+				ring_fd, IORING_REGISTER_PROBE, probe, CERVER_URING_PROBE_OPS
+			)) {
+				retval = (params.features & IORING_FEAT_EXT_ARG)
+					&& (params.features & IORING_FEAT_SINGLE_MMAP)
+					&& (probe->last_op >= IORING_OP_SEND_ZC)
+					&& (probe->ops[IORING_OP_ACCEPT].flags & IO_URING_OP_SUPPORTED)
+					&& (probe->ops[IORING_OP_RECV].flags & IO_URING_OP_SUPPORTED)
+					&& (probe->ops[IORING_OP_POLL_ADD].flags & IO_URING_OP_SUPPORTED)
+					&& (probe->ops[IORING_OP_ASYNC_CANCEL].flags & IO_URING_OP_SUPPORTED);
+			}
+
+			free (probe);
+		}
+
+		(void) close (ring_fd);
+	}
+
+	return retval;
+
+}
+
+static CerverUring *cerver_uring_new (void) {
+
+	CerverUring *uring = (CerverUring *) malloc (sizeof (CerverUring));
+	if (uring) {
+		(void) memset (uring, 0, sizeof (CerverUring));
+
+		uring->ring_fd = -1;
+	}
+
+	return uring;
+
+}
+
+void cerver_uring_delete (void *uring_ptr) {
+
+	if (uring_ptr) {
+		CerverUring *uring = (CerverUring *) uring_ptr;
+
+		// closing the ring cancels all of its requests
+		if (uring->ring_fd > -1) (void) close (uring->ring_fd);
+
+		if (uring->sqes) (void) munmap (uring->sqes, uring->sqes_size);
+		if (uring->sq_ring) (void) munmap (uring->sq_ring, uring->sq_ring_size);
+
+		if (uring->buf_ring) (void) munmap (uring->buf_ring, uring->buf_ring_size);
+		if (uring->buffers) free (uring->buffers);
+
+		if (uring->fds) free (uring->fds);
+
+		pthread_mutex_delete (uring->lock);
+
+		free (uring_ptr);
+	}
+
+}
+
+// maps the submission & completion queues using a single mmap ()
+static u8 cerver_uring_map (
+	CerverUring *uring, struct io_uring_params *params
+) {
+
+	u8 retval = 1;
+
+	uring->sq_ring_size = params->sq_off.array + params->sq_entries * sizeof (u32);
+	uring->cq_ring_size = params->cq_off.cqes + params->cq_entries * sizeof (struct io_uring_cqe);
+	if (uring->cq_ring_size > uring->sq_ring_size) uring->sq_ring_size = uring->cq_ring_size;
+
+	void *ring = mmap (
+		NULL, uring->sq_ring_size,
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		uring->ring_fd, IORING_OFF_SQ_RING
+	);
+
+	uring->sqes_size = params->sq_entries * sizeof (struct io_uring_sqe);
+	void *sqes = mmap (
+		NULL, uring->sqes_size,
+		PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		uring->ring_fd, IORING_OFF_SQES
+	);
+
+	if ((ring != MAP_FAILED) && (sqes != MAP_FAILED)) {
+		char *base = (char *) ring;
+
+		uring->sq_ring = ring;
+		uring->sq_head = (u32 *) (base + params->sq_off.head);
+		uring->sq_tail = (u32 *) (base + params->sq_off.tail);
+		uring->sq_mask = *(u32 *) (base + params->sq_off.ring_mask);
+		uring->sq_array = (u32 *) (base + params->sq_off.array);
+		uring->sqes = (struct io_uring_sqe *) sqes;
+
+		uring->cq_ring = ring;
+		uring->cq_head = (u32 *) (base + params->cq_off.head);
+		uring->cq_tail = (u32 *) (base + params->cq_off.tail);
+		uring->cq_mask = *(u32 *) (base + params->cq_off.ring_mask);
+		uring->cqes = (struct io_uring_cqe *) (base + params->cq_off.cqes);
+
+		retval = 0;
+	}
+
+	else {
+		if (ring != MAP_FAILED) (void) munmap (ring, uring->sq_ring_size);
+		if (sqes != MAP_FAILED) (void) munmap (sqes, uring->sqes_size);
+	}
+
+	return retval;
+
+}
+
+// registers the provided buffers ring & gives it all the buffers
+static u8 cerver_uring_buffers_init (
+	CerverUring *uring, const u32 n_buffers, const u32 buffer_size
+) {
+
+	u8 retval = 1;
+
+	// the ring's entries must be a power of 2
+	uring->n_buffers = 1;
+	while (uring->n_buffers < n_buffers) uring->n_buffers <<= 1;
+
+	uring->buffer_size = buffer_size;
+
+	uring->buf_ring_size = uring->n_buffers * sizeof (struct io_uring_buf);
+	void *buf_ring = mmap (
+		NULL, uring->buf_ring_size,
+		PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+		-1, 0
+	);
+
+	uring->buffers = (char *) malloc ((size_t) uring->n_buffers * buffer_size);
+
+	if ((buf_ring != MAP_FAILED) && uring->buffers) {
+		uring->buf_ring = (struct io_uring_buf_ring *) buf_ring;
+
+		struct io_uring_buf_reg reg = { 0 };
+		reg.ring_addr = (u64) (uintptr_t) buf_ring;
+		reg.ring_entries = uring->n_buffers;
+		reg.bgid = CERVER_URING_BUFFERS_GROUP;
+
+		if (!cerver_uring_sys_register (uring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1)) {
+			for (u32 i = 0; i < uring->n_buffers; i++) {
+				cerver_uring_buffer_release (uring, (u16) i);
+			}
+
+			retval = 0;
+		}
+	}
+
+	else if (buf_ring != MAP_FAILED) {
+		(void) munmap (buf_ring, uring->buf_ring_size);
+	}
+
+	return retval;
+
+}
+
+// creates a new io_uring instance with its provided buffers ring
+// returns a new uring on success, NULL on error
+CerverUring *cerver_uring_create (
+	const u32 entries, const u32 n_buffers, const u32 buffer_size
+) {
+
+	CerverUring *uring = cerver_uring_new ();
+	if (uring) {
+		struct io_uring_params params = { 0 };
+		params.flags = IORING_SETUP_SUBMIT_ALL;
+
+		uring->ring_fd = cerver_uring_sys_setup (entries, &params);
+
+		uring->lock = pthread_mutex_new ();
+
+		if (
+			(uring->ring_fd < 0)
+			|| !uring->lock
+			|| cerver_uring_map (uring, &params)
+			|| cerver_uring_buffers_init (uring, n_buffers, buffer_size)
+		) {
+			cerver_uring_delete (uring);
+			uring = NULL;
+		}
+	}
+
+	return uring;
+
+}
+
+#pragma endregion
+
+#pragma region requests
+
+// makes sure that the sock fd can be mapped to its requests state
+// the uring's lock must be locked
+static u8 cerver_uring_fds_reserve (CerverUring *uring, const i32 sock_fd) {
+
+	u8 retval = 0;
+
+	if ((u32) sock_fd >= uring->fds_size) {
+		u32 new_size = uring->fds_size ? uring->fds_size : CERVER_DEFAULT_POLL_FDS;
+		while ((u32) sock_fd >= new_size) new_size *= 2;
+
+		CerverUringFd *fds = (CerverUringFd *) realloc (
+			uring->fds, new_size * sizeof (CerverUringFd)
+		);
+
+		if (fds) {
+			(void) memset (
+				fds + uring->fds_size, 0,
+				(new_size - uring->fds_size) * sizeof (CerverUringFd)
+			);
+
+			uring->fds = fds;
+			uring->fds_size = new_size;
+		}
+
+		else {
+			retval = 1;
+		}
+	}
+
+	return retval;
+
+}
+
+// the uring's lock must be locked
+static inline u64 cerver_uring_user_data (
+	CerverUring *uring, const CerverUringOp op, const i32 sock_fd
+) {
+
+	u64 generation = ((u32) sock_fd < uring->fds_size) ?
+		(uring->fds[sock_fd].generation & CERVER_URING_GENERATION_MASK) : 0;
+
+	return ((u64) op << CERVER_URING_OP_SHIFT)
+		| (generation << CERVER_URING_GENERATION_SHIFT)
+		| (u64) (u32) sock_fd;
+
+}
+
+// gets the operation & the sock fd from a completion's user data
+// returns false if the sock fd was unregistered after the request was submitted
+bool cerver_uring_user_data_get (
+	CerverUring *uring, const u64 user_data,
+	CerverUringOp *op, i32 *sock_fd
+) {
+
+	bool retval = false;
+
+	*op = (CerverUringOp) (user_data >> CERVER_URING_OP_SHIFT);
+	*sock_fd = (i32) (u32) user_data;
+
+	if (
+		(*op == CERVER_URING_OP_ACCEPT)
+		|| (*op == CERVER_URING_OP_ACCEPT_RETRY)
+	) {
+		retval = true;
+	}
+
+	else {
+		u32 generation = (u32) (user_data >> CERVER_URING_GENERATION_SHIFT)
+			& CERVER_URING_GENERATION_MASK;
+
+		(void) pthread_mutex_lock (uring->lock);
+
+		if ((u32) *sock_fd < uring->fds_size) {
+			CerverUringFd *fd = &uring->fds[*sock_fd];
+			retval = ((fd->generation & CERVER_URING_GENERATION_MASK) == generation);
+
+			// the writable request is done, so it can be submitted again
+			if (retval && (*op == CERVER_URING_OP_WRITABLE)) fd->writable = false;
+		}
+
+		(void) pthread_mutex_unlock (uring->lock);
+	}
+
+	return retval;
+
+}
+
+// gets the next free sqe, NULL if the submission queue is full
+// the uring's lock must be locked
+static struct io_uring_sqe *cerver_uring_get_sqe (CerverUring *uring) {
+
+	struct io_uring_sqe *sqe = NULL;
+
+	u32 head = __atomic_load_n (uring->sq_head, __ATOMIC_ACQUIRE);
+	u32 tail = *uring->sq_tail;
+
+	if ((tail - head) <= uring->sq_mask) {
+		u32 idx = tail & uring->sq_mask;
+
+		sqe = &uring->sqes[idx];
+		(void) memset (sqe, 0, sizeof (struct io_uring_sqe));
+
+		uring->sq_array[idx] = idx;
+		__atomic_store_n (uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	return sqe;
+
+}
+
+// submits every sqe that has not been consumed by the kernel
+// the uring's lock must be locked
+static u8 cerver_uring_submit (CerverUring *uring) {
+
+	u8 retval = 0;
+
+	u32 pending = *uring->sq_tail - __atomic_load_n (uring->sq_head, __ATOMIC_ACQUIRE);
+	while (pending) {
+		int submitted = cerver_uring_sys_enter (uring->ring_fd, pending, 0, 0, NULL, 0);
+		if (submitted < 0) {
+			if (errno == EINTR) continue;
+
+			retval = 1;
+			break;
+		}
+
+		pending -= ((u32) submitted < pending) ? (u32) submitted : pending;
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_uring_prep_multishot (
+	CerverUring *uring, const u64 user_data
+) {
+
+	u8 retval = 1;
+
+	const CerverUringOp op = (CerverUringOp) (user_data >> CERVER_URING_OP_SHIFT);
+	const i32 sock_fd = (i32) (u32) user_data;
+
+	struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+	if (sqe) {
+		sqe->fd = sock_fd;
+		sqe->user_data = user_data;
+
+		switch (op) {
+			case CERVER_URING_OP_ACCEPT:
+				sqe->opcode = IORING_OP_ACCEPT;
+				sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+				break;
+
+			// each completion selects one of the provided buffers
+			case CERVER_URING_OP_RECEIVE:
+				sqe->opcode = IORING_OP_RECV;
+				sqe->ioprio = IORING_RECV_MULTISHOT;
+				sqe->flags = IOSQE_BUFFER_SELECT;
+				sqe->buf_group = CERVER_URING_BUFFERS_GROUP;
+				break;
+
+			default: break;
+		}
+
+		retval = cerver_uring_submit (uring);
+	}
+
+	return retval;
+
+}
+
+// submits a multishot accept in the listening socket
+// returns 0 on success, 1 on error
+u8 cerver_uring_accept (CerverUring *uring, const i32 sock) {
+
+	u8 retval = 1;
+
+	if (uring) {
+		(void) pthread_mutex_lock (uring->lock);
+
+		retval = cerver_uring_prep_multishot (
+			uring, cerver_uring_user_data (uring, CERVER_URING_OP_ACCEPT, sock)
+		);
+
+		(void) pthread_mutex_unlock (uring->lock);
+	}
+
+	return retval;
+
+}
+
+// submits a timeout that completes with a CERVER_URING_OP_ACCEPT_RETRY
+// after which the accept in the listening socket should be submitted again
+// returns 0 on success, 1 on error
+u8 cerver_uring_accept_retry (
+	CerverUring *uring, const i32 sock, const u32 timeout
+) {
+
+	u8 retval = 1;
+
+	if (uring) {
+		(void) pthread_mutex_lock (uring->lock);
+
+		struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+		if (sqe) {
+			// the timespec is read when the sqe is submitted
+			uring->accept_retry_ts.tv_sec = timeout / 1000;
+			uring->accept_retry_ts.tv_nsec = (long long) (timeout % 1000) * 1000000;
+
+			sqe->opcode = IORING_OP_TIMEOUT;
+			sqe->fd = -1;
+			sqe->addr = (u64) (uintptr_t) &uring->accept_retry_ts;
+			sqe->len = 1;
+			sqe->user_data = cerver_uring_user_data (
+				uring, CERVER_URING_OP_ACCEPT_RETRY, sock
+			);
+
+			retval = cerver_uring_submit (uring);
+		}
+
+		(void) pthread_mutex_unlock (uring->lock);
+	}
+
+	return retval;
+
+}
+
+// submits again a multishot request that has stopped
+// only if its sock fd has not been unregistered
+// returns 0 on success, 1 on error
+u8 cerver_uring_rearm (CerverUring *uring, const u64 user_data) {
+
+	u8 retval = 1;
+
+	if (uring) {
+		const CerverUringOp op = (CerverUringOp) (user_data >> CERVER_URING_OP_SHIFT);
+		const i32 sock_fd = (i32) (u32) user_data;
+
+		(void) pthread_mutex_lock (uring->lock);
+
+		if (
+			(op == CERVER_URING_OP_ACCEPT)
+			|| (cerver_uring_user_data (uring, op, sock_fd) == user_data)
+		) {
+			retval = cerver_uring_prep_multishot (uring, user_data);
+		}
+
+		(void) pthread_mutex_unlock (uring->lock);
+	}
+
+	return retval;
+
+}
+
+// starts receiving in the connection's sock fd
+// returns 0 on success, 1 on error
+u8 cerver_uring_register_connection (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	CerverUring *uring = cerver->uring;
+	const i32 sock_fd = connection->socket->sock_fd;
+
+	(void) pthread_mutex_lock (uring->lock);
+
+	if (!cerver_uring_fds_reserve (uring, sock_fd)) {
+		uring->fds[sock_fd].generation += 1;
+		uring->fds[sock_fd].writable = false;
+
+		retval = cerver_uring_prep_multishot (
+			uring, cerver_uring_user_data (uring, CERVER_URING_OP_RECEIVE, sock_fd)
+		);
+	}
+
+	(void) pthread_mutex_unlock (uring->lock);
+
+	if (!retval) {
+		(void) pthread_mutex_lock (cerver->poll_lock);
+		cerver->current_n_fds++;
+		(void) __atomic_add_fetch (&cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
+		(void) pthread_mutex_unlock (cerver->poll_lock);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Added sock fd <%d> to cerver %s io_uring",
+			sock_fd, cerver->info->name->str
+		);
+		#endif
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Failed to add sock fd <%d> to cerver %s io_uring!",
+			sock_fd, cerver->info->name->str
+		);
+	}
+
+	return retval;
+
+}
+
+// cancels every request of the sock fd & ignores their pending completions
+// the cancel is submitted right away, so the requests no longer hold
+// a reference to the socket when it gets closed
+// returns 0 on success, 1 on error
+u8 cerver_uring_unregister_sock_fd (
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	u8 retval = 1;
+
+	CerverUring *uring = cerver->uring;
+
+	(void) pthread_mutex_lock (uring->lock);
+
+	if ((sock_fd > -1) && ((u32) sock_fd < uring->fds_size)) {
+		uring->fds[sock_fd].generation += 1;
+		uring->fds[sock_fd].writable = false;
+
+		struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+		if (sqe) {
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->fd = sock_fd;
+			sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+			sqe->user_data = cerver_uring_user_data (uring, CERVER_URING_OP_CANCEL, sock_fd);
+
+			retval = cerver_uring_submit (uring);
+		}
+	}
+
+	(void) pthread_mutex_unlock (uring->lock);
+
+	if (!retval) {
+		(void) pthread_mutex_lock (cerver->poll_lock);
+		cerver->current_n_fds--;
+		(void) __atomic_sub_fetch (&cerver->stats->current_active_client_connections, 1, __ATOMIC_RELAXED);
+		(void) pthread_mutex_unlock (cerver->poll_lock);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Removed sock fd <%d> from cerver %s io_uring",
+			sock_fd, cerver->info->name->str
+		);
+		#endif
+	}
+
+	return retval;
+
+}
+
+// waits for the sock fd to be writable, the request is only submitted once
+// a one shot poll is used, so nothing is done when writable is false
+// returns 0 on success, 1 on error
+u8 cerver_uring_set_writable (
+	CerverUring *uring, const i32 sock_fd, bool writable
+) {
+
+	u8 retval = 0;
+
+	if (writable) {
+		(void) pthread_mutex_lock (uring->lock);
+
+		if (
+			((u32) sock_fd < uring->fds_size)
+			&& !uring->fds[sock_fd].writable
+		) {
+			struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+			if (sqe) {
+				sqe->opcode = IORING_OP_POLL_ADD;
+				sqe->fd = sock_fd;
+				sqe->poll32_events = POLLOUT;
+				sqe->user_data = cerver_uring_user_data (uring, CERVER_URING_OP_WRITABLE, sock_fd);
+
+				retval = cerver_uring_submit (uring);
+				if (!retval) uring->fds[sock_fd].writable = true;
+			}
+
+			else {
+				retval = 1;
+			}
+		}
+
+		(void) pthread_mutex_unlock (uring->lock);
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region completions
+
+// gets the provided buffer that was used in a receive
+char *cerver_uring_buffer_get (
+	CerverUring *uring, const u16 buffer_id
+) {
+
+	return uring->buffers + ((size_t) buffer_id * uring->buffer_size);
+
+}
+
+// gives back a provided buffer after its data has been handled
+// buffers are only released by the thread that handles the completions
+void cerver_uring_buffer_release (
+	CerverUring *uring, const u16 buffer_id
+) {
+
+	struct io_uring_buf_ring *buf_ring = uring->buf_ring;
+
+	u16 tail = buf_ring->tail;
+	struct io_uring_buf *buf = &buf_ring->bufs[tail & (uring->n_buffers - 1)];
+
+	buf->addr = (u64) (uintptr_t) cerver_uring_buffer_get (uring, buffer_id);
+	buf->len = uring->buffer_size;
+	buf->bid = buffer_id;
+
+	__atomic_store_n (&buf_ring->tail, (u16) (tail + 1), __ATOMIC_RELEASE);
+
+}
+
+// waits until there is at least one completion or the timeout expires
+// returns the number of completions that are ready
+u32 cerver_uring_wait (CerverUring *uring, const u32 timeout) {
+
+	u32 ready = *uring->cq_head;
+
+	if (__atomic_load_n (uring->cq_tail, __ATOMIC_ACQUIRE) == ready) {
+		struct __kernel_timespec ts = {
+			.tv_sec = timeout / 1000,
+			.tv_nsec = (long long) (timeout % 1000) * 1000000
+		};
+
+		struct io_uring_getevents_arg arg = { 0 };
+		arg.ts = (u64) (uintptr_t) &ts;
+
+		// a timeout or a signal just return without completions
+		(void) cerver_uring_sys_enter (
+			uring->ring_fd, 0, 1,
+			IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+			&arg, sizeof (struct io_uring_getevents_arg)
+		);
+	}
+
+	return __atomic_load_n (uring->cq_tail, __ATOMIC_ACQUIRE) - ready;
+
+}
+
+// gets the next ready completion, NULL if there are none
+struct io_uring_cqe *cerver_uring_peek (CerverUring *uring) {
+
+	u32 head = *uring->cq_head;
+
+	return (__atomic_load_n (uring->cq_tail, __ATOMIC_ACQUIRE) != head) ?
+		&uring->cqes[head & uring->cq_mask] : NULL;
+
+}
+
+// marks the completion returned by cerver_uring_peek () as handled
+void cerver_uring_advance (CerverUring *uring) {
+
+	__atomic_store_n (uring->cq_head, *uring->cq_head + 1, __ATOMIC_RELEASE);
+
+}
+
+#pragma endregion
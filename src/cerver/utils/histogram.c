@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/utils/histogram.h"
+
+Histogram *histogram_new (void) {
+
+	Histogram *histogram = (Histogram *) malloc (sizeof (Histogram));
+	if (histogram) {
+		histogram_reset (histogram);
+	}
+
+	return histogram;
+
+}
+
+void histogram_delete (void *histogram_ptr) {
+
+	if (histogram_ptr) free (histogram_ptr);
+
+}
+
+// sets every value back to 0
+void histogram_reset (Histogram *histogram) {
+
+	if (histogram) (void) memset (histogram, 0, sizeof (Histogram));
+
+}
+
+// values smaller than the number of sub buckets have their own bucket
+// bigger values use the sub bucket of their top bits in the group of their power of two
+static inline u32 histogram_bucket_idx (const u64 value) {
+
+	u32 idx = HISTOGRAM_N_BUCKETS - 1;
+
+	if (value < HISTOGRAM_SUB_BUCKETS) {
+		idx = (u32) value;
+	}
+
+	else if (value < (1ULL << HISTOGRAM_MAX_BITS)) {
+		const u32 shift = (u32) (63 - __builtin_clzll (value)) - HISTOGRAM_SUB_BUCKETS_BITS;
+
+		idx = ((shift + 1) << HISTOGRAM_SUB_BUCKETS_BITS)
+			+ (u32) ((value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+	}
+
+	return idx;
+
+}
+
+// returns the highest value that is counted in the bucket
+static inline u64 histogram_bucket_highest (const u32 idx) {
+
+	const u32 group = idx >> HISTOGRAM_SUB_BUCKETS_BITS;
+	const u64 sub_bucket = idx & (HISTOGRAM_SUB_BUCKETS - 1);
+
+	return group ?
+		((HISTOGRAM_SUB_BUCKETS + sub_bucket + 1) << (group - 1)) - 1 : sub_bucket;
+
+}
+
+// atomically records the value n times
+void histogram_record_n (
+	Histogram *histogram, const u64 value, const u64 n
+) {
+
+	if (histogram && n) {
+		(void) __atomic_add_fetch (
+			&histogram->buckets[histogram_bucket_idx (value)], n, __ATOMIC_RELAXED
+		);
+
+		(void) __atomic_add_fetch (&histogram->count, n, __ATOMIC_RELAXED);
+		(void) __atomic_add_fetch (&histogram->sum, value * n, __ATOMIC_RELAXED);
+
+		// only a new max is written
+		u64 max = __atomic_load_n (&histogram->max, __ATOMIC_RELAXED);
+		while ((value > max) && !__atomic_compare_exchange_n (
+			&histogram->max, &max, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+		));
+	}
+
+}
+
+// atomically records the value
+void histogram_record (
+	Histogram *histogram, const u64 value
+) {
+
+	histogram_record_n (histogram, value, 1);
+
+}
+
+// adds every value of the source to the histogram
+// the source values are read atomically, as they can still be recorded
+void histogram_accumulate (
+	Histogram *histogram, const Histogram *source
+) {
+
+	if (histogram && source) {
+		histogram->count += __atomic_load_n (&source->count, __ATOMIC_RELAXED);
+		histogram->sum += __atomic_load_n (&source->sum, __ATOMIC_RELAXED);
+
+		const u64 max = __atomic_load_n (&source->max, __ATOMIC_RELAXED);
+		if (max > histogram->max) histogram->max = max;
+
+		for (u32 i = 0; i < HISTOGRAM_N_BUCKETS; i++)
+			histogram->buckets[i] += __atomic_load_n (&source->buckets[i], __ATOMIC_RELAXED);
+	}
+
+}
+
+// returns the number of values that have been recorded
+u64 histogram_get_count (const Histogram *histogram) {
+
+	return histogram ? __atomic_load_n (&histogram->count, __ATOMIC_RELAXED) : 0;
+
+}
+
+// returns the mean of the recorded values
+u64 histogram_get_mean (const Histogram *histogram) {
+
+	u64 mean = 0;
+
+	if (histogram) {
+		const u64 count = __atomic_load_n (&histogram->count, __ATOMIC_RELAXED);
+		if (count) mean = __atomic_load_n (&histogram->sum, __ATOMIC_RELAXED) / count;
+	}
+
+	return mean;
+
+}
+
+// returns the biggest recorded value
+u64 histogram_get_max (const Histogram *histogram) {
+
+	return histogram ? __atomic_load_n (&histogram->max, __ATOMIC_RELAXED) : 0;
+
+}
+
+// returns the highest value of the bucket where the percentile (0 - 100) is
+// like 50 for the median, 99 or 99.9 for the tail
+// returns 0 if no value has been recorded
+u64 histogram_get_percentile (
+	const Histogram *histogram, const double percentile
+) {
+
+	u64 value = 0;
+
+	if (histogram) {
+		// the buckets are used as the total, as the count
+		// may not match them while values are being recorded
+		u64 total = 0;
+		for (u32 i = 0; i < HISTOGRAM_N_BUCKETS; i++)
+			total += __atomic_load_n (&histogram->buckets[i], __ATOMIC_RELAXED);
+
+		if (total) {
+			double position = ((double) total * percentile) / 100;
+			u64 target = (u64) position;
+			if ((double) target < position) target += 1;
+			if (!target) target = 1;
+			if (target > total) target = total;
+
+			u32 idx = 0;
+			u64 seen = 0;
+			for (; idx < (HISTOGRAM_N_BUCKETS - 1); idx++) {
+				seen += __atomic_load_n (&histogram->buckets[idx], __ATOMIC_RELAXED);
+				if (seen >= target) break;
+			}
+
+			// values in the last bucket can be bigger than its highest value
+			const u64 max = __atomic_load_n (&histogram->max, __ATOMIC_RELAXED);
+			value = histogram_bucket_highest (idx);
+			if ((idx == (HISTOGRAM_N_BUCKETS - 1)) || (value > max)) value = max;
+		}
+	}
+
+	return value;
+
+}
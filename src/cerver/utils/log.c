@@ -1,12 +1,20 @@
+// the public methods are defined here, so they are never filtered
+#define CERVER_LOG_NO_FILTER
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 
 #include <stdarg.h>
+#include <errno.h>
 #include <time.h>
 #include <unistd.h>
+#include <pthread.h>
+
+#include <sys/uio.h>
 
+#include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
 #include "cerver/collections/pool.h"
@@ -51,6 +59,9 @@ static unsigned int log_file_update_interval = LOG_DEFAULT_UPDATE_INTERVAL;
 
 static bool quiet = false;
 
+static bool log_async = false;
+static unsigned int log_async_ring_size = LOG_ASYNC_DEFAULT_RING_SIZE;
+
 // returns the current log output type
 LogOutputType cerver_log_get_output_type (void) {
 
@@ -146,6 +157,653 @@ void cerver_log_set_local_time (bool value) { use_local_time = value; }
 // any other type will be ignored
 void cerver_log_set_quiet (bool value) { quiet = value; }
 
+// enables asynchronous logging, must be set before cerver_init ()
+// each thread pushes its messages to its own lock free ring of ring_size bytes
+// and a writer thread formats & writes them in batches, 0 for default size
+// messages that don't fit in their thread's ring are dropped
+void cerver_log_set_async (bool value, unsigned int ring_size) {
+
+	log_async = value;
+
+	// rings wrap around using a mask
+	unsigned int size = LOG_ASYNC_MIN_RING_SIZE;
+	while ((size < ring_size) && (size < (1U << 30))) size <<= 1;
+
+	log_async_ring_size = ring_size ? size : LOG_ASYNC_DEFAULT_RING_SIZE;
+
+}
+
+#pragma endregion
+
+#pragma region async
+
+#define LOG_ASYNC_RECORD_ALIGN				8
+#define LOG_ASYNC_PREFIX_SIZE				128
+
+// max iovecs of a single writev () in linux
+#define LOG_ASYNC_IOV_MAX					1024
+
+typedef enum CerverLogRecordType {
+
+	CERVER_LOG_RECORD_TYPE_PADDING		= 0,	// skips the end of the ring
+	CERVER_LOG_RECORD_TYPE_NORMAL		= 1,
+	CERVER_LOG_RECORD_TYPE_RAW			= 2
+
+} CerverLogRecordType;
+
+// a message that has been pushed to a ring
+typedef struct CerverLogRecord {
+
+	u32 size;							// bytes used in the ring
+	u8 type;
+
+	u8 first_type;
+	u8 second_type;
+	u8 output_type;
+	u8 time_type;
+
+	u32 message_len;
+	time_t timestamp;
+
+	char message[];
+
+} CerverLogRecord;
+
+// single producer single consumer ring,
+// only its owner thread pushes & only the writer thread pops
+// head & tail are in different cache lines so they don't bounce
+typedef struct CerverLogRing {
+
+	u64 head;
+	bool pushing;						// the owner is using the buffer
+	u8 head_padding[55];
+
+	u64 tail;
+	u8 tail_padding[56];
+
+	bool owned;
+	char *buffer;
+
+} CerverLogRing;
+
+// rings are never moved, so a thread keeps its ring until it exits
+static CerverLogRing log_async_rings[LOG_ASYNC_MAX_RINGS] = { 0 };
+
+static bool log_async_running = false;
+static pthread_t log_async_writer_id;
+
+static u64 log_async_dropped = 0;
+
+static _Thread_local CerverLogRing *log_async_thread_ring = NULL;
+static _Thread_local bool log_async_thread_ring_failed = false;
+
+static pthread_key_t log_async_key;
+static pthread_once_t log_async_key_once = PTHREAD_ONCE_INIT;
+
+// releases the thread's ring when the thread exits
+static void cerver_log_async_ring_release (void *ring_ptr) {
+
+	__atomic_store_n (&((CerverLogRing *) ring_ptr)->owned, false, __ATOMIC_RELEASE);
+
+}
+
+static void cerver_log_async_key_create (void) {
+
+	(void) pthread_key_create (&log_async_key, cerver_log_async_ring_release);
+
+}
+
+// claims a free ring for the calling thread the first time it logs
+// returns NULL if every ring is being used
+static CerverLogRing *cerver_log_async_ring_get (void) {
+
+	CerverLogRing *ring = log_async_thread_ring;
+	if (!ring && !log_async_thread_ring_failed) {
+		(void) pthread_once (&log_async_key_once, cerver_log_async_key_create);
+
+		for (unsigned int i = 0; i < LOG_ASYNC_MAX_RINGS; i++) {
+			bool expected = false;
+			if (__atomic_compare_exchange_n (
+				&log_async_rings[i].owned, &expected, true,
+				false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+			)) {
+				ring = &log_async_rings[i];
+				break;
+			}
+		}
+
+		if (ring) {
+			(void) pthread_setspecific (log_async_key, ring);
+			log_async_thread_ring = ring;
+		}
+
+		// the thread will log synchronously
+		else log_async_thread_ring_failed = true;
+	}
+
+	return ring;
+
+}
+
+// marks the thread's ring as being used before checking
+// that the writer is still running, so cerver_log_async_stop ()
+// waits for it before releasing the ring's buffer
+// returns NULL if the message must be logged synchronously
+static CerverLogRing *cerver_log_async_ring_enter (void) {
+
+	CerverLogRing *ring = cerver_log_async_ring_get ();
+	if (ring) {
+		__atomic_store_n (&ring->pushing, true, __ATOMIC_SEQ_CST);
+
+		const bool running = __atomic_load_n (&log_async_running, __ATOMIC_SEQ_CST);
+
+		// the buffer is released when the writer stops
+		if (running && !ring->buffer) ring->buffer = (char *) malloc (log_async_ring_size);
+
+		if (!running || !ring->buffer) {
+			__atomic_store_n (&ring->pushing, false, __ATOMIC_RELEASE);
+			ring = NULL;
+		}
+	}
+
+	return ring;
+
+}
+
+static inline void cerver_log_async_ring_exit (CerverLogRing *ring) {
+
+	__atomic_store_n (&ring->pushing, false, __ATOMIC_RELEASE);
+
+}
+
+// copies the message to the end of the ring
+// if it doesn't fit, it is dropped & counted
+static void cerver_log_async_ring_push (
+	CerverLogRing *ring,
+	CerverLogRecordType type,
+	LogType first_type, LogType second_type,
+	LogTimeType time_type, LogOutputType output_type,
+	const char *message, size_t message_len
+) {
+
+	const u64 mask = (u64) log_async_ring_size - 1;
+
+	const u64 needed = (
+		sizeof (CerverLogRecord) + message_len + (LOG_ASYNC_RECORD_ALIGN - 1)
+	) & ~((u64) LOG_ASYNC_RECORD_ALIGN - 1);
+
+	u64 head = ring->head;
+	const u64 tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+
+	// records never wrap, the end of the ring is skipped instead
+	const u64 contiguous = log_async_ring_size - (head & mask);
+	const u64 padding = (needed > contiguous) ? contiguous : 0;
+
+	if (((head - tail) + padding + needed) <= log_async_ring_size) {
+		if (padding) {
+			CerverLogRecord *skip = (CerverLogRecord *) &ring->buffer[head & mask];
+			skip->size = (u32) padding;
+			skip->type = CERVER_LOG_RECORD_TYPE_PADDING;
+
+			head += padding;
+		}
+
+		CerverLogRecord *record = (CerverLogRecord *) &ring->buffer[head & mask];
+		record->size = (u32) needed;
+		record->type = (u8) type;
+		record->first_type = (u8) first_type;
+		record->second_type = (u8) second_type;
+		record->output_type = (u8) output_type;
+		record->time_type = (u8) time_type;
+		record->message_len = (u32) message_len;
+		record->timestamp = (time_type != LOG_TIME_TYPE_NONE) ? time (NULL) : 0;
+		(void) memcpy (record->message, message, message_len);
+
+		// publishes the record to the writer
+		__atomic_store_n (&ring->head, head + needed, __ATOMIC_RELEASE);
+	}
+
+	else {
+		(void) __atomic_add_fetch (&log_async_dropped, 1, __ATOMIC_RELAXED);
+	}
+
+}
+
+// formats the message in the caller's thread & pushes it to its ring
+// returns 0 on success, 1 if the message must be logged synchronously
+static u8 cerver_log_async_push (
+	CerverLogRecordType type,
+	LogType first_type, LogType second_type,
+	LogTimeType time_type, LogOutputType output_type,
+	const char *format, va_list args
+) {
+
+	u8 retval = 1;
+
+	CerverLogRing *ring = __atomic_load_n (&log_async_running, __ATOMIC_ACQUIRE) ?
+		cerver_log_async_ring_enter () : NULL;
+
+	if (ring) {
+		char message[LOG_MESSAGE_SIZE];
+		int len = format ? vsnprintf (message, LOG_MESSAGE_SIZE, format, args) : 0;
+		if (len < 0) len = 0;
+		else if (len >= LOG_MESSAGE_SIZE) len = LOG_MESSAGE_SIZE - 1;
+
+		cerver_log_async_ring_push (
+			ring, type,
+			first_type, second_type,
+			time_type, output_type,
+			message, (size_t) len
+		);
+
+		cerver_log_async_ring_exit (ring);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_log_async_push_line_break (LogOutputType output_type) {
+
+	u8 retval = 1;
+
+	CerverLogRing *ring = __atomic_load_n (&log_async_running, __ATOMIC_ACQUIRE) ?
+		cerver_log_async_ring_enter () : NULL;
+
+	if (ring) {
+		cerver_log_async_ring_push (
+			ring, CERVER_LOG_RECORD_TYPE_RAW,
+			LOG_TYPE_NONE, LOG_TYPE_NONE,
+			LOG_TIME_TYPE_NONE, output_type,
+			"\n", 1
+		);
+
+		cerver_log_async_ring_exit (ring);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// the iovecs that will be written to an output with a single writev ()
+typedef struct CerverLogBatch {
+
+	int fd;
+
+	// a record can be written twice to the same output
+	struct iovec iov[LOG_ASYNC_BATCH_SIZE * 6];
+	int n_iov;
+
+} CerverLogBatch;
+
+// only used by the writer thread
+static CerverLogBatch log_async_batches[3] = {
+	{ .fd = STDOUT_FILENO }, { .fd = STDERR_FILENO }, { .fd = -1 }
+};
+
+static char log_async_prefixes[LOG_ASYNC_BATCH_SIZE * 2][LOG_ASYNC_PREFIX_SIZE];
+static unsigned int log_async_n_prefixes = 0;
+
+static time_t log_async_datetime_timestamp = 0;
+static LogTimeType log_async_datetime_type = LOG_TIME_TYPE_NONE;
+static char log_async_datetime[LOG_DATETIME_SIZE] = { 0 };
+
+// datetimes are only created again when the second changes
+static const char *cerver_log_async_datetime (
+	const time_t timestamp, const LogTimeType time_type
+) {
+
+	if (
+		(timestamp != log_async_datetime_timestamp)
+		|| (time_type != log_async_datetime_type)
+	) {
+		struct tm timeinfo = { 0 };
+		if (use_local_time) (void) localtime_r (&timestamp, &timeinfo);
+		else (void) gmtime_r (&timestamp, &timeinfo);
+
+		switch (time_type) {
+			case LOG_TIME_TYPE_TIME: (void) strftime (log_async_datetime, LOG_DATETIME_SIZE, "%T", &timeinfo); break;
+			case LOG_TIME_TYPE_DATE: (void) strftime (log_async_datetime, LOG_DATETIME_SIZE, "%d/%m/%y", &timeinfo); break;
+			case LOG_TIME_TYPE_BOTH: (void) strftime (log_async_datetime, LOG_DATETIME_SIZE, "%d/%m/%y - %T", &timeinfo); break;
+
+			default: log_async_datetime[0] = '\0'; break;
+		}
+
+		log_async_datetime_timestamp = timestamp;
+		log_async_datetime_type = time_type;
+	}
+
+	return log_async_datetime;
+
+}
+
+static const char *cerver_log_async_color (LogType first_type) {
+
+	switch (first_type) {
+		case LOG_TYPE_ERROR: return LOG_COLOR_RED;
+		case LOG_TYPE_WARNING: return LOG_COLOR_YELLOW;
+		case LOG_TYPE_SUCCESS: return LOG_COLOR_GREEN;
+		case LOG_TYPE_DEBUG: return LOG_COLOR_MAGENTA;
+		case LOG_TYPE_TEST: return LOG_COLOR_CYAN;
+		case LOG_TYPE_CERVER: return LOG_COLOR_BLUE;
+		case LOG_TYPE_EVENT: return LOG_COLOR_MAGENTA;
+
+		default: return "";
+	}
+
+}
+
+// creates the text that goes before the record's message
+// using the same formats as the synchronous methods
+// returns the text that goes after it
+static const char *cerver_log_async_prefix_create (
+	const CerverLogRecord *record, bool colors,
+	char *prefix
+) {
+
+	const char *suffix = "\n";
+
+	const LogType first_type = (LogType) record->first_type;
+	const LogType second_type = (LogType) record->second_type;
+
+	int len = 0;
+	if (record->time_type != LOG_TIME_TYPE_NONE) {
+		len = snprintf (
+			prefix, LOG_ASYNC_PREFIX_SIZE, "[%s]",
+			cerver_log_async_datetime (record->timestamp, (LogTimeType) record->time_type)
+		);
+	}
+
+	const char *color = colors ? cerver_log_async_color (first_type) : "";
+	const char *reset = color[0] ? LOG_COLOR_RESET : "";
+
+	if (first_type == LOG_TYPE_NONE) {
+		if (record->time_type != LOG_TIME_TYPE_NONE)
+			(void) snprintf (prefix + len, LOG_ASYNC_PREFIX_SIZE - len, ": ");
+	}
+
+	else if ((first_type == LOG_TYPE_DEBUG) || (first_type == LOG_TYPE_TEST)) {
+		// only the first type is colored
+		if (second_type != LOG_TYPE_NONE) {
+			(void) snprintf (
+				prefix + len, LOG_ASYNC_PREFIX_SIZE - len, "%s%s%s%s: ",
+				color, log_get_msg_type (first_type), reset, log_get_msg_type (second_type)
+			);
+		}
+
+		else {
+			(void) snprintf (
+				prefix + len, LOG_ASYNC_PREFIX_SIZE - len, "%s%s: %s",
+				color, log_get_msg_type (first_type), reset
+			);
+		}
+	}
+
+	else {
+		(void) snprintf (
+			prefix + len, LOG_ASYNC_PREFIX_SIZE - len, "%s%s%s: ",
+			color, log_get_msg_type (first_type),
+			(second_type != LOG_TYPE_NONE) ? log_get_msg_type (second_type) : ""
+		);
+
+		if (reset[0]) suffix = "\n" LOG_COLOR_RESET;
+	}
+
+	return suffix;
+
+}
+
+static void cerver_log_async_batch_add (
+	CerverLogBatch *batch,
+	const char *prefix, const char *message, size_t message_len,
+	const char *suffix
+) {
+
+	if (prefix && prefix[0]) {
+		batch->iov[batch->n_iov].iov_base = (void *) prefix;
+		batch->iov[batch->n_iov].iov_len = strlen (prefix);
+		batch->n_iov += 1;
+	}
+
+	if (message_len) {
+		batch->iov[batch->n_iov].iov_base = (void *) message;
+		batch->iov[batch->n_iov].iov_len = message_len;
+		batch->n_iov += 1;
+	}
+
+	if (suffix && suffix[0]) {
+		batch->iov[batch->n_iov].iov_base = (void *) suffix;
+		batch->iov[batch->n_iov].iov_len = strlen (suffix);
+		batch->n_iov += 1;
+	}
+
+}
+
+// writes the whole batch, retrying on partial writes
+static void cerver_log_async_batch_write (CerverLogBatch *batch) {
+
+	struct iovec *iov = batch->iov;
+	int n_iov = batch->n_iov;
+
+	while (n_iov > 0) {
+		ssize_t written = writev (batch->fd, iov, (n_iov > LOG_ASYNC_IOV_MAX) ? LOG_ASYNC_IOV_MAX : n_iov);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		while ((n_iov > 0) && ((size_t) written >= iov->iov_len)) {
+			written -= (ssize_t) iov->iov_len;
+			iov++;
+			n_iov--;
+		}
+
+		if (n_iov > 0) {
+			iov->iov_base = (char *) iov->iov_base + written;
+			iov->iov_len -= (size_t) written;
+		}
+	}
+
+	batch->n_iov = 0;
+
+}
+
+static void cerver_log_async_batches_write (void) {
+
+	for (unsigned int i = 0; i < 3; i++) {
+		if (log_async_batches[i].n_iov) cerver_log_async_batch_write (&log_async_batches[i]);
+	}
+
+	log_async_n_prefixes = 0;
+
+}
+
+// adds the record to the batch of each of its outputs
+static void cerver_log_async_record_add (const CerverLogRecord *record) {
+
+	const LogType first_type = (LogType) record->first_type;
+	const bool std = (record->output_type == LOG_OUTPUT_TYPE_STD)
+		|| (record->output_type == LOG_OUTPUT_TYPE_BOTH);
+	const bool file = (record->output_type == LOG_OUTPUT_TYPE_FILE)
+		|| (record->output_type == LOG_OUTPUT_TYPE_BOTH);
+
+	// errors & warnings go to stderr
+	const bool error = (record->type == CERVER_LOG_RECORD_TYPE_NORMAL)
+		&& ((first_type == LOG_TYPE_ERROR) || (first_type == LOG_TYPE_WARNING));
+
+	if (std) {
+		CerverLogBatch *batch = &log_async_batches[error ? 1 : 0];
+		if (record->type == CERVER_LOG_RECORD_TYPE_RAW) {
+			cerver_log_async_batch_add (batch, NULL, record->message, record->message_len, NULL);
+		}
+
+		else {
+			char *prefix = log_async_prefixes[log_async_n_prefixes++];
+			const char *suffix = cerver_log_async_prefix_create (record, true, prefix);
+			cerver_log_async_batch_add (batch, prefix, record->message, record->message_len, suffix);
+		}
+	}
+
+	if (file) {
+		// same as cerver_log_get_stream ()
+		CerverLogBatch *batch = logfile ? &log_async_batches[2] : &log_async_batches[error ? 1 : 0];
+		if (record->type == CERVER_LOG_RECORD_TYPE_RAW) {
+			cerver_log_async_batch_add (batch, NULL, record->message, record->message_len, NULL);
+		}
+
+		else {
+			char *prefix = log_async_prefixes[log_async_n_prefixes++];
+			const char *suffix = cerver_log_async_prefix_create (record, false, prefix);
+			cerver_log_async_batch_add (batch, prefix, record->message, record->message_len, suffix);
+		}
+	}
+
+}
+
+// writes every record that has been pushed to the ring
+// returns the number of records that were written
+static unsigned int cerver_log_async_ring_write (CerverLogRing *ring) {
+
+	unsigned int n_records = 0;
+	unsigned int n_batched = 0;
+
+	const u64 mask = (u64) log_async_ring_size - 1;
+
+	u64 tail = ring->tail;
+	const u64 head = __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE);
+
+	while (tail < head) {
+		const CerverLogRecord *record = (const CerverLogRecord *) &ring->buffer[tail & mask];
+		if (record->type != CERVER_LOG_RECORD_TYPE_PADDING) {
+			cerver_log_async_record_add (record);
+			n_batched += 1;
+			n_records += 1;
+		}
+
+		tail += record->size;
+
+		// the space is only released after the messages have been written
+		if (n_batched == LOG_ASYNC_BATCH_SIZE) {
+			cerver_log_async_batches_write ();
+			__atomic_store_n (&ring->tail, tail, __ATOMIC_RELEASE);
+			n_batched = 0;
+		}
+	}
+
+	if (n_batched) cerver_log_async_batches_write ();
+	__atomic_store_n (&ring->tail, tail, __ATOMIC_RELEASE);
+
+	return n_records;
+
+}
+
+static unsigned int cerver_log_async_write (void) {
+
+	unsigned int n_records = 0;
+
+	log_async_batches[2].fd = logfile ? fileno (logfile) : -1;
+
+	for (unsigned int i = 0; i < LOG_ASYNC_MAX_RINGS; i++) {
+		if (__atomic_load_n (&log_async_rings[i].head, __ATOMIC_ACQUIRE) != log_async_rings[i].tail)
+			n_records += cerver_log_async_ring_write (&log_async_rings[i]);
+	}
+
+	return n_records;
+
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+static void *cerver_log_async_writer (void *data) {
+
+	(void) thread_set_name ("cerver-log");
+
+	const struct timespec interval = {
+		.tv_sec = 0, .tv_nsec = LOG_ASYNC_WRITER_INTERVAL * 1000000
+	};
+
+	while (__atomic_load_n (&log_async_running, __ATOMIC_ACQUIRE)) {
+		if (!cerver_log_async_write ()) (void) nanosleep (&interval, NULL);
+	}
+
+	// writes every message that was pushed before stopping
+	while (cerver_log_async_write ()) ;
+
+	return NULL;
+
+}
+
+#pragma GCC diagnostic pop
+
+static void cerver_log_async_start (void) {
+
+	__atomic_store_n (&log_async_running, true, __ATOMIC_RELEASE);
+	if (pthread_create (&log_async_writer_id, NULL, cerver_log_async_writer, NULL)) {
+		__atomic_store_n (&log_async_running, false, __ATOMIC_RELEASE);
+
+		(void) fprintf (stderr, "\n\nFailed to create log writer thread!\n\n");
+	}
+
+}
+
+static void cerver_log_async_stop (void) {
+
+	if (__atomic_exchange_n (&log_async_running, false, __ATOMIC_SEQ_CST)) {
+		// waits for the threads that are still pushing a message
+		const struct timespec interval = { .tv_sec = 0, .tv_nsec = 100000 };
+		for (unsigned int i = 0; i < LOG_ASYNC_MAX_RINGS; i++) {
+			while (__atomic_load_n (&log_async_rings[i].pushing, __ATOMIC_SEQ_CST))
+				(void) nanosleep (&interval, NULL);
+		}
+
+		(void) pthread_join (log_async_writer_id, NULL);
+
+		// rings keep their owners, only their buffers are released
+		for (unsigned int i = 0; i < LOG_ASYNC_MAX_RINGS; i++) {
+			if (log_async_rings[i].buffer) {
+				free (log_async_rings[i].buffer);
+				log_async_rings[i].buffer = NULL;
+			}
+
+			log_async_rings[i].head = 0;
+			log_async_rings[i].tail = 0;
+		}
+	}
+
+}
+
+// returns the number of messages that have been dropped
+// because the ring of their thread was full
+u64 cerver_log_get_dropped (void) {
+
+	return __atomic_load_n (&log_async_dropped, __ATOMIC_RELAXED);
+
+}
+
+// waits until the writer thread has written every pushed message
+void cerver_log_flush (void) {
+
+	const struct timespec interval = { .tv_sec = 0, .tv_nsec = 1000000 };
+
+	for (unsigned int i = 0; i < LOG_ASYNC_MAX_RINGS; i++) {
+		const u64 head = __atomic_load_n (&log_async_rings[i].head, __ATOMIC_ACQUIRE);
+		while (
+			__atomic_load_n (&log_async_running, __ATOMIC_ACQUIRE)
+			&& (__atomic_load_n (&log_async_rings[i].tail, __ATOMIC_ACQUIRE) < head)
+		) {
+			(void) nanosleep (&interval, NULL);
+		}
+	}
+
+	if (logfile) (void) fflush (logfile);
+
+}
+
 #pragma endregion
 
 #pragma region internal
@@ -443,6 +1101,13 @@ static void cerver_log_internal (
 	LogOutputType log_output_type
 ) {
 
+	if (!cerver_log_async_push (
+		CERVER_LOG_RECORD_TYPE_NORMAL,
+		first_type, second_type,
+		log_time_type, log_output_type,
+		format, args
+	)) return;
+
 	CerverLog *log = (CerverLog *) pool_pop (log_pool);
 	if (log) {
 		if (first_type != LOG_TYPE_NONE) cerver_log_header_create (log, first_type, second_type);
@@ -464,7 +1129,7 @@ static void cerver_log_internal (
 			);
 		}
 
-		(void) pool_push (log_pool, log);
+		if (pool_push (log_pool, log)) cerver_log_delete (log);
 	}
 
 }
@@ -476,6 +1141,13 @@ static void cerver_log_internal_with_time (
 	LogOutputType log_output_type
 ) {
 
+	if (!cerver_log_async_push (
+		CERVER_LOG_RECORD_TYPE_NORMAL,
+		first_type, second_type,
+		LOG_TIME_TYPE_BOTH, log_output_type,
+		format, args
+	)) return;
+
 	CerverLog *log = (CerverLog *) pool_pop (log_pool);
 	if (log) {
 		if (first_type != LOG_TYPE_NONE) cerver_log_header_create (log, first_type, second_type);
@@ -487,7 +1159,7 @@ static void cerver_log_internal_with_time (
 			LOG_TIME_TYPE_BOTH, log_output_type
 		);
 
-		(void) pool_push (log_pool, log);
+		if (pool_push (log_pool, log)) cerver_log_delete (log);
 	}
 
 }
@@ -498,6 +1170,13 @@ static void cerver_log_internal_raw (
 	LogOutputType log_output_type
 ) {
 
+	if (!cerver_log_async_push (
+		CERVER_LOG_RECORD_TYPE_RAW,
+		LOG_TYPE_NONE, LOG_TYPE_NONE,
+		LOG_TIME_TYPE_NONE, log_output_type,
+		format, args
+	)) return;
+
 	CerverLog *log = (CerverLog *) pool_pop (log_pool);
 	if (log) {
 		(void) vsnprintf (log->message, LOG_MESSAGE_SIZE, format, args);
@@ -514,7 +1193,7 @@ static void cerver_log_internal_raw (
 			default: break;
 		}
 
-		(void) pool_push (log_pool, log);
+		if (pool_push (log_pool, log)) cerver_log_delete (log);
 	}
 
 }
@@ -747,6 +1426,8 @@ void cerver_log_raw (const char *msg, ...) {
 // prints a line break, equivalent to printf ("\n")
 void cerver_log_line_break (void) {
 
+	if (!cerver_log_async_push_line_break (log_global_output_type)) return;
+
 	switch (log_global_output_type) {
 		case LOG_OUTPUT_TYPE_STD:
 			(void) fprintf (stdout, "\n");
@@ -821,10 +1502,15 @@ void cerver_log_init (void) {
 		default: break;
 	}
 
+	if (log_async && !log_async_running) cerver_log_async_start ();
+
 }
 
 void cerver_log_end (void) {
 
+	// writes every pending message before closing the log file
+	cerver_log_async_stop ();
+
 	update_log_file = false;
 
 	if (logfile) {
@@ -833,6 +1519,7 @@ void cerver_log_end (void) {
 	}
 
 	str_delete (logs_pathname);
+	logs_pathname = NULL;
 
 	pool_delete (log_pool);
 	log_pool = NULL;
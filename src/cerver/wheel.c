@@ -0,0 +1,443 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <time.h>
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/wheel.h"
+
+#include "cerver/threads/thread.h"
+
+#include "cerver/utils/log.h"
+
+#define TIMER_WHEEL_SLOT_MASK			(TIMER_WHEEL_SLOTS - 1)
+
+static inline u64 timer_wheel_now (void) {
+
+	struct timespec now = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &now);
+
+	return ((u64) now.tv_sec * 1000) + ((u64) now.tv_nsec / 1000000);
+
+}
+
+#pragma region timer
+
+// sets the method that will be called when the timer expires
+void wheel_timer_init (
+	WheelTimer *timer,
+	void (*callback)(struct _TimerWheel *wheel, void *data), void *data
+) {
+
+	if (timer) {
+		(void) memset (timer, 0, sizeof (WheelTimer));
+
+		timer->callback = callback;
+		timer->data = data;
+	}
+
+}
+
+// returns true if the timer is waiting to expire
+bool wheel_timer_is_armed (WheelTimer *timer) {
+
+	bool retval = false;
+
+	TimerWheel *wheel = timer ? __atomic_load_n (&timer->wheel, __ATOMIC_ACQUIRE) : NULL;
+	if (wheel) {
+		(void) pthread_mutex_lock (wheel->lock);
+
+		retval = timer->armed;
+
+		(void) pthread_mutex_unlock (wheel->lock);
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region internal
+
+// adds the timer to the level where its expiration fits
+static void timer_wheel_insert (TimerWheel *wheel, WheelTimer *timer) {
+
+	u64 delta = timer->expires - wheel->current;
+
+	unsigned int level = 0;
+	while (
+		(level < (TIMER_WHEEL_LEVELS - 1))
+		&& (delta >= (1ULL << ((level + 1) * TIMER_WHEEL_SLOT_BITS)))
+	) level++;
+
+	WheelTimer **slot = &wheel->slots[level][
+		(timer->expires >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK
+	];
+
+	timer->prev = NULL;
+	timer->next = *slot;
+	if (*slot) (*slot)->prev = timer;
+	*slot = timer;
+
+}
+
+static void timer_wheel_unlink (TimerWheel *wheel, WheelTimer *timer) {
+
+	if (timer->prev) timer->prev->next = timer->next;
+	else {
+		// the timer is the head of its slot
+		for (unsigned int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+			WheelTimer **slot = &wheel->slots[level][
+				(timer->expires >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK
+			];
+
+			if (*slot == timer) {
+				*slot = timer->next;
+				break;
+			}
+		}
+	}
+
+	if (timer->next) timer->next->prev = timer->prev;
+
+	timer->next = NULL;
+	timer->prev = NULL;
+
+}
+
+// moves the timers of the slot to the lower levels
+// returns the index of the slot
+static unsigned int timer_wheel_cascade (TimerWheel *wheel, unsigned int level) {
+
+	const unsigned int idx = (unsigned int) (
+		(wheel->current >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK
+	);
+
+	WheelTimer *timer = wheel->slots[level][idx];
+	wheel->slots[level][idx] = NULL;
+
+	WheelTimer *next = NULL;
+	while (timer) {
+		next = timer->next;
+		timer_wheel_insert (wheel, timer);
+		timer = next;
+	}
+
+	return idx;
+
+}
+
+// moves the wheel to its next tick & expires the timers of its slot
+// the lock is released while calling each timer callback
+static u32 timer_wheel_tick (TimerWheel *wheel) {
+
+	u32 n_expired = 0;
+
+	wheel->current += 1;
+
+	// when a level wraps, the next slot of the level above is moved down
+	if (!(wheel->current & TIMER_WHEEL_SLOT_MASK)) {
+		unsigned int level = 1;
+		while (!timer_wheel_cascade (wheel, level) && (level < (TIMER_WHEEL_LEVELS - 1)))
+			level++;
+	}
+
+	WheelTimer **slot = &wheel->slots[0][wheel->current & TIMER_WHEEL_SLOT_MASK];
+
+	WheelTimer *timer = NULL;
+	while ((timer = *slot)) {
+		timer_wheel_unlink (wheel, timer);
+		timer->armed = false;
+		wheel->n_timers -= 1;
+
+		wheel->running_timer = timer;
+		wheel->running_thread = pthread_self ();
+
+		void (*callback)(struct _TimerWheel *, void *) = timer->callback;
+		void *data = timer->data;
+
+		(void) pthread_mutex_unlock (wheel->lock);
+
+		// the timer might be deleted by its callback
+		if (callback) callback (wheel, data);
+
+		(void) pthread_mutex_lock (wheel->lock);
+
+		wheel->running_timer = NULL;
+		(void) pthread_cond_broadcast (wheel->callback_done);
+
+		n_expired += 1;
+	}
+
+	return n_expired;
+
+}
+
+static TimerWheel *timer_wheel_new (void) {
+
+	TimerWheel *wheel = (TimerWheel *) malloc (sizeof (TimerWheel));
+	if (wheel) {
+		(void) memset (wheel, 0, sizeof (TimerWheel));
+	}
+
+	return wheel;
+
+}
+
+static pthread_cond_t *timer_wheel_cond_create (void) {
+
+	pthread_cond_t *cond = (pthread_cond_t *) malloc (sizeof (pthread_cond_t));
+	if (cond) {
+		// the wheel thread waits using monotonic time
+		pthread_condattr_t attr;
+		(void) pthread_condattr_init (&attr);
+		(void) pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+		(void) pthread_cond_init (cond, &attr);
+		(void) pthread_condattr_destroy (&attr);
+	}
+
+	return cond;
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+void timer_wheel_delete (void *wheel_ptr) {
+
+	if (wheel_ptr) {
+		TimerWheel *wheel = (TimerWheel *) wheel_ptr;
+
+		timer_wheel_stop (wheel);
+
+		pthread_mutex_delete (wheel->lock);
+		pthread_cond_delete (wheel->callback_done);
+		pthread_cond_delete (wheel->thread_cond);
+
+		free (wheel_ptr);
+	}
+
+}
+
+// creates a new timer wheel that advances every tick milliseconds
+// data - passed to every timer callback, like the structure that owns the wheel
+TimerWheel *timer_wheel_create (const u32 tick, void *data) {
+
+	TimerWheel *wheel = timer_wheel_new ();
+	if (wheel) {
+		wheel->tick = tick ? tick : TIMER_WHEEL_DEFAULT_TICK;
+		wheel->start = timer_wheel_now ();
+
+		wheel->data = data;
+
+		wheel->lock = pthread_mutex_new ();
+		wheel->callback_done = pthread_cond_new ();
+		wheel->thread_cond = timer_wheel_cond_create ();
+
+		if (!wheel->lock || !wheel->callback_done || !wheel->thread_cond) {
+			timer_wheel_delete (wheel);
+			wheel = NULL;
+		}
+	}
+
+	return wheel;
+
+}
+
+// returns the n of timers that are waiting to expire
+u64 timer_wheel_get_n_timers (TimerWheel *wheel) {
+
+	u64 retval = 0;
+
+	if (wheel) {
+		(void) pthread_mutex_lock (wheel->lock);
+
+		retval = wheel->n_timers;
+
+		(void) pthread_mutex_unlock (wheel->lock);
+	}
+
+	return retval;
+
+}
+
+// arms the timer to expire after timeout milliseconds
+// if the timer was already armed, it is moved to its new expiration
+// returns 0 on success, 1 on error
+u8 timer_wheel_arm (
+	TimerWheel *wheel, WheelTimer *timer, const u64 timeout
+) {
+
+	u8 retval = 1;
+
+	if (wheel && timer) {
+		// a timer can only be armed in one wheel at a time
+		TimerWheel *previous = __atomic_load_n (&timer->wheel, __ATOMIC_ACQUIRE);
+		if (previous && (previous != wheel)) (void) wheel_timer_cancel (timer);
+
+		(void) pthread_mutex_lock (wheel->lock);
+
+		if (timer->armed) timer_wheel_unlink (wheel, timer);
+		else wheel->n_timers += 1;
+
+		// timers expire at least one tick from now
+		u64 ticks = (timeout + wheel->tick - 1) / wheel->tick;
+		if (!ticks) ticks = 1;
+		if (ticks > TIMER_WHEEL_MAX_TICKS) ticks = TIMER_WHEEL_MAX_TICKS;
+
+		__atomic_store_n (&timer->wheel, wheel, __ATOMIC_RELEASE);
+		timer->expires = wheel->current + ticks;
+		timer->armed = true;
+
+		timer_wheel_insert (wheel, timer);
+
+		(void) pthread_mutex_unlock (wheel->lock);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// removes the timer from its wheel if it is armed
+// if its callback is running in another thread, waits until it has finished
+// returns 0 if the timer was armed, 1 if not
+u8 wheel_timer_cancel (WheelTimer *timer) {
+
+	u8 retval = 1;
+
+	// the wheel of a timer is only set while holding the wheel's lock
+	TimerWheel *wheel = timer ? __atomic_load_n (&timer->wheel, __ATOMIC_ACQUIRE) : NULL;
+	if (wheel) {
+		(void) pthread_mutex_lock (wheel->lock);
+
+		if (timer->armed) {
+			timer_wheel_unlink (wheel, timer);
+			timer->armed = false;
+			wheel->n_timers -= 1;
+
+			retval = 0;
+		}
+
+		// the callback can cancel its own timer
+		while (
+			(wheel->running_timer == timer)
+			&& !pthread_equal (wheel->running_thread, pthread_self ())
+		) {
+			(void) pthread_cond_wait (wheel->callback_done, wheel->lock);
+		}
+
+		(void) pthread_mutex_unlock (wheel->lock);
+	}
+
+	return retval;
+
+}
+
+// expires every timer up to the current time
+// returns the n of timers that have expired
+u32 timer_wheel_advance (TimerWheel *wheel) {
+
+	u32 n_expired = 0;
+
+	if (wheel) {
+		const u64 target = (timer_wheel_now () - wheel->start) / wheel->tick;
+
+		(void) pthread_mutex_lock (wheel->lock);
+
+		while (wheel->current < target) n_expired += timer_wheel_tick (wheel);
+
+		(void) pthread_mutex_unlock (wheel->lock);
+	}
+
+	return n_expired;
+
+}
+
+static void *timer_wheel_thread (void *wheel_ptr) {
+
+	TimerWheel *wheel = (TimerWheel *) wheel_ptr;
+
+	(void) thread_set_name ("timer-wheel");
+
+	struct timespec wait = { 0 };
+
+	(void) pthread_mutex_lock (wheel->lock);
+
+	while (wheel->thread_running) {
+		(void) clock_gettime (CLOCK_MONOTONIC, &wait);
+		wait.tv_sec += wheel->tick / 1000;
+		wait.tv_nsec += (long) (wheel->tick % 1000) * 1000000;
+		if (wait.tv_nsec >= 1000000000) {
+			wait.tv_sec += 1;
+			wait.tv_nsec -= 1000000000;
+		}
+
+		(void) pthread_cond_timedwait (wheel->thread_cond, wheel->lock, &wait);
+
+		if (wheel->thread_running) {
+			const u64 target = (timer_wheel_now () - wheel->start) / wheel->tick;
+			while (wheel->current < target) (void) timer_wheel_tick (wheel);
+		}
+	}
+
+	(void) pthread_mutex_unlock (wheel->lock);
+
+	return NULL;
+
+}
+
+// starts a thread that advances the wheel every tick
+// returns 0 on success or if it is already running, 1 on error
+u8 timer_wheel_start (TimerWheel *wheel) {
+
+	u8 retval = 1;
+
+	if (wheel) {
+		(void) pthread_mutex_lock (wheel->lock);
+
+		if (wheel->thread_running) retval = 0;
+		else {
+			wheel->thread_running = true;
+			if (!pthread_create (&wheel->thread_id, NULL, timer_wheel_thread, wheel)) {
+				retval = 0;
+			}
+
+			else {
+				wheel->thread_running = false;
+
+				cerver_log_error ("timer_wheel_start () - failed to create wheel thread!");
+			}
+		}
+
+		(void) pthread_mutex_unlock (wheel->lock);
+	}
+
+	return retval;
+
+}
+
+// stops the wheel thread & waits for it to finish
+void timer_wheel_stop (TimerWheel *wheel) {
+
+	if (wheel && wheel->lock) {
+		(void) pthread_mutex_lock (wheel->lock);
+
+		const bool running = wheel->thread_running;
+		wheel->thread_running = false;
+		if (running) (void) pthread_cond_signal (wheel->thread_cond);
+
+		(void) pthread_mutex_unlock (wheel->lock);
+
+		if (running) (void) pthread_join (wheel->thread_id, NULL);
+	}
+
+}
+
+#pragma endregion
@@ -4,8 +4,22 @@
 #include <stdbool.h>
 
 #include <time.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <arpa/inet.h>
 
 #include <cerver/cerver.h>
+#include <cerver/fdtable.h>
+#include <cerver/handler.h>
+#include <cerver/packets.h>
+#include <cerver/udp.h>
+#include <cerver/uring.h>
+#include <cerver/wheel.h>
 
 #include "../test.h"
 
@@ -60,6 +74,512 @@ static void test_cerver_base_configuration (void) {
 
 }
 
+#define TEST_STATS_N_THREADS			4
+#define TEST_STATS_N_PACKETS			100000
+
+static void *test_cerver_stats_thread (void *stats_ptr) {
+
+	CerverStats *stats = (CerverStats *) stats_ptr;
+
+	for (unsigned int i = 0; i < TEST_STATS_N_PACKETS; i++) {
+		cerver_stats_add (stats, CERVER_STATS_N_PACKETS_SENT, 1);
+		cerver_stats_add (stats, CERVER_STATS_TOTAL_BYTES_SENT, 8);
+		packets_per_type_add (cerver_stats_packets (stats, true), PACKET_TYPE_APP, 1);
+
+		cerver_stats_latency_end (stats, CERVER_STATS_LATENCY_SEND, cerver_stats_latency_start (stats));
+		cerver_stats_handler_latency_end (stats, PACKET_TYPE_APP, cerver_stats_latency_start (stats), 1);
+	}
+
+	return NULL;
+
+}
+
+// counters updated by many threads are added together in the snapshot
+static void test_cerver_stats_snapshot (void) {
+
+	Cerver *cerver = test_cerver_create ();
+
+	test_check_unsigned_eq (cerver_set_latency_histograms (cerver, true), 0, NULL);
+
+	pthread_t threads[TEST_STATS_N_THREADS] = { 0 };
+	for (unsigned int i = 0; i < TEST_STATS_N_THREADS; i++)
+		test_check_int_eq (pthread_create (&threads[i], NULL, test_cerver_stats_thread, cerver->stats), 0, NULL);
+
+	for (unsigned int i = 0; i < TEST_STATS_N_THREADS; i++)
+		(void) pthread_join (threads[i], NULL);
+
+	CerverStats *snapshot = cerver_stats_get_snapshot (cerver);
+	test_check_ptr (snapshot);
+	test_check_unsigned_eq (snapshot->n_packets_sent, TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+	test_check_unsigned_eq (snapshot->total_bytes_sent, TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS * 8, NULL);
+	test_check_unsigned_eq (snapshot->sent_packets->n_app_packets, TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+	test_check_unsigned_eq (snapshot->received_packets->n_app_packets, 0, NULL);
+
+	test_check_unsigned_eq (histogram_get_count (cerver_stats_get_latency (snapshot, CERVER_STATS_LATENCY_SEND)), TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+	test_check_unsigned_eq (histogram_get_count (cerver_stats_get_latency (snapshot, CERVER_STATS_LATENCY_RECEIVE_DISPATCH)), 0, NULL);
+	test_check_unsigned_eq (histogram_get_count (cerver_stats_get_latency (snapshot, CERVER_STATS_LATENCY_HANDLER)), TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+	test_check_unsigned_eq (histogram_get_count (cerver_stats_get_handler_latency (snapshot, PACKET_TYPE_APP)), TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+
+	cerver_stats_snapshot_delete (snapshot);
+
+	// the deprecated fields get the values of the last snapshot
+	test_check_unsigned_eq (cerver->stats->n_packets_sent, TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+	test_check_unsigned_eq (cerver->stats->sent_packets->n_app_packets, TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+
+	test_check_unsigned_eq (cerver_stats_get_counter (cerver, CERVER_STATS_N_PACKETS_SENT), TEST_STATS_N_THREADS * TEST_STATS_N_PACKETS, NULL);
+	test_check_unsigned_eq (cerver_stats_get_counter (cerver, CERVER_STATS_TOTAL_N_PACKETS_RECEIVED), 0, NULL);
+
+	// no histograms are kept after they are disabled
+	test_check_unsigned_eq (cerver_set_latency_histograms (cerver, false), 0, NULL);
+	snapshot = cerver_stats_get_snapshot (cerver);
+	test_check_null_ptr (cerver_stats_get_latency (snapshot, CERVER_STATS_LATENCY_SEND));
+	cerver_stats_snapshot_delete (snapshot);
+
+	cerver_delete (cerver);
+
+}
+
+// sock fds are mapped directly to their client & connection
+static void test_cerver_fd_table (void) {
+
+	CerverFdTable *fd_table = cerver_fd_table_create (CERVER_FD_TABLE_CHUNK_SIZE);
+	test_check_ptr (fd_table);
+
+	int client_data = 0, connection_data = 0, other_data = 0;
+	Client *client = (Client *) &client_data;
+	Connection *connection = (Connection *) &connection_data;
+	Connection *other = (Connection *) &other_data;
+
+	ReceiveType receive_type = RECEIVE_TYPE_NONE;
+	Client *found_client = NULL;
+	Connection *found_connection = NULL;
+
+	// sock fds bigger than the first chunk allocate a new one
+	const i32 sock_fds[] = { 5, CERVER_FD_TABLE_CHUNK_SIZE * 4 + 3 };
+	for (unsigned int i = 0; i < 2; i++) {
+		test_check_unsigned_eq (cerver_fd_table_set (
+			fd_table, sock_fds[i], RECEIVE_TYPE_NORMAL, client, connection
+		), 0, NULL);
+
+		test_check_true (cerver_fd_table_get (
+			fd_table, sock_fds[i], &receive_type, &found_client, &found_connection
+		));
+		test_check_int_eq (receive_type, RECEIVE_TYPE_NORMAL, NULL);
+		test_check_ptr_eq (found_client, client);
+		test_check_ptr_eq (found_connection, connection);
+	}
+
+	test_check_unsigned_eq (cerver_fd_table_size (fd_table), 2, NULL);
+	test_check_false (cerver_fd_table_get (fd_table, 6, NULL, NULL, NULL));
+	test_check_false (cerver_fd_table_get (fd_table, -1, NULL, NULL, NULL));
+	test_check_unsigned_eq (cerver_fd_table_set (
+		fd_table, CERVER_FD_TABLE_MAX_FDS, RECEIVE_TYPE_NORMAL, client, connection
+	), 1, NULL);
+
+	// only the connection that is mapped can be removed
+	test_check_unsigned_eq (cerver_fd_table_remove (fd_table, 5, other), 1, NULL);
+	test_check_unsigned_eq (cerver_fd_table_remove (fd_table, 5, connection), 0, NULL);
+	test_check_unsigned_eq (cerver_fd_table_remove (fd_table, sock_fds[1], NULL), 0, NULL);
+	test_check_false (cerver_fd_table_get (fd_table, 5, &receive_type, &found_client, NULL));
+	test_check_int_eq (receive_type, RECEIVE_TYPE_NONE, NULL);
+	test_check_null_ptr (found_client);
+	test_check_unsigned_eq (cerver_fd_table_size (fd_table), 0, NULL);
+
+	cerver_fd_table_delete (fd_table);
+
+}
+
+static void test_cerver_timer_wheel_expired (TimerWheel *wheel, void *count_ptr) {
+
+	(void) wheel;
+
+	*(unsigned int *) count_ptr += 1;
+
+}
+
+// timers expire in order, even after being moved down from an upper level
+static void test_cerver_timer_wheel (void) {
+
+	TimerWheel *wheel = timer_wheel_create (1, NULL);
+	test_check_ptr (wheel);
+
+	unsigned int short_count = 0, long_count = 0, cancelled_count = 0;
+	WheelTimer short_timer, long_timer, cancelled_timer;
+	wheel_timer_init (&short_timer, test_cerver_timer_wheel_expired, &short_count);
+	wheel_timer_init (&long_timer, test_cerver_timer_wheel_expired, &long_count);
+	wheel_timer_init (&cancelled_timer, test_cerver_timer_wheel_expired, &cancelled_count);
+
+	test_check_unsigned_eq (timer_wheel_arm (wheel, &short_timer, 5), 0, NULL);
+	test_check_unsigned_eq (timer_wheel_arm (wheel, &long_timer, 200), 0, NULL);
+	test_check_unsigned_eq (timer_wheel_arm (wheel, &cancelled_timer, 5), 0, NULL);
+	test_check_unsigned_eq (timer_wheel_get_n_timers (wheel), 3, NULL);
+
+	test_check_unsigned_eq (wheel_timer_cancel (&cancelled_timer), 0, NULL);
+	test_check_unsigned_eq (wheel_timer_cancel (&cancelled_timer), 1, NULL);
+
+	const struct timespec wait = { .tv_sec = 0, .tv_nsec = 50000000 };
+	(void) nanosleep (&wait, NULL);
+	(void) timer_wheel_advance (wheel);
+
+	test_check_unsigned_eq (short_count, 1, NULL);
+	test_check_unsigned_eq (long_count, 0, NULL);
+	test_check_true (wheel_timer_is_armed (&long_timer));
+
+	// re-arming only moves the timer
+	test_check_unsigned_eq (timer_wheel_arm (wheel, &long_timer, 100), 0, NULL);
+	test_check_unsigned_eq (timer_wheel_get_n_timers (wheel), 1, NULL);
+
+	for (unsigned int i = 0; i < 6; i++) {
+		(void) nanosleep (&wait, NULL);
+		(void) timer_wheel_advance (wheel);
+	}
+
+	test_check_unsigned_eq (short_count, 1, NULL);
+	test_check_unsigned_eq (long_count, 1, NULL);
+	test_check_unsigned_eq (cancelled_count, 0, NULL);
+	test_check_unsigned_eq (timer_wheel_get_n_timers (wheel), 0, NULL);
+
+	timer_wheel_delete (wheel);
+
+}
+
+static void test_cerver_packet_retain (void) {
+
+	char buffer[sizeof (PacketHeader) + sizeof (PacketVersion) + 16] = { 0 };
+
+	PacketHeader *header = (PacketHeader *) buffer;
+	header->packet_type = PACKET_TYPE_APP;
+	header->packet_size = sizeof (buffer);
+
+	char *data = buffer + sizeof (PacketHeader);
+	const size_t data_size = sizeof (buffer) - sizeof (PacketHeader);
+
+	Packet *packet = packet_create_view (header, data, data_size);
+	test_check_ptr (packet);
+	test_check_true (packet_is_view (packet));
+
+	// as a checked packet, the version points to its data
+	packet->version = (PacketVersion *) data;
+	packet->data_ptr = data + sizeof (PacketVersion);
+
+	test_check_unsigned_eq (packet_retain (packet), 0, NULL);
+	test_check_false (packet_is_view (packet));
+	test_check_ptr_ne ((char *) packet->data, data);
+	test_check_ptr_eq (packet->version, packet->data);
+	test_check_ptr_eq (packet->data_ptr, (char *) packet->data + sizeof (PacketVersion));
+
+	packet_delete (packet);
+
+}
+
+#define TEST_ECHO_PORT					7010
+#define TEST_ECHO_MESSAGE				"hello there!"
+
+// sends back the same data using the received packet's request type
+static void test_cerver_echo_handler (void *packet_ptr) {
+
+	Packet *packet = (Packet *) packet_ptr;
+
+	Packet response = {
+		.cerver = packet->cerver,
+		.client = packet->client,
+		.connection = packet->connection,
+
+		.packet_type = PACKET_TYPE_APP,
+		.req_type = packet->header->request_type,
+
+		.data_size = packet->data_size,
+		.data = packet->data
+	};
+
+	(void) packet_send (&response, 0, NULL, false);
+
+}
+
+static void *test_cerver_echo_start (void *cerver_ptr) {
+
+	(void) cerver_start ((Cerver *) cerver_ptr);
+
+	return NULL;
+
+}
+
+static Cerver *test_cerver_echo_create (
+	const Protocol protocol, const CerverHandlerType handler_type
+) {
+
+	Cerver *cerver = cerver_create (
+		CERVER_TYPE_CUSTOM, "test-echo",
+		TEST_ECHO_PORT, protocol, false,
+		CERVER_DEFAULT_CONNECTION_QUEUE
+	);
+
+	test_check_ptr (cerver);
+
+	cerver_set_reusable_address_flags (cerver, true);
+	cerver_set_handler_type (cerver, handler_type);
+	cerver_set_poll_time_out (cerver, 100);
+
+	Handler *app_handler = handler_create (test_cerver_echo_handler);
+	handler_set_direct_handle (app_handler, true);
+	cerver_set_app_handlers (cerver, app_handler, NULL);
+
+	return cerver;
+
+}
+
+static int test_cerver_echo_connect (const int type) {
+
+	int sock_fd = socket (AF_INET, type, 0);
+	test_check_int_gt (sock_fd, -1);
+
+	struct timeval timeout = { .tv_sec = 2, .tv_usec = 0 };
+	(void) setsockopt (sock_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (struct timeval));
+
+	struct sockaddr_in address = {
+		.sin_family = AF_INET,
+		.sin_port = htons (TEST_ECHO_PORT)
+	};
+
+	address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+	test_check_int_eq (
+		connect (sock_fd, (struct sockaddr *) &address, sizeof (struct sockaddr_in)),
+		0, NULL
+	);
+
+	return sock_fd;
+
+}
+
+static void test_cerver_echo_send (const int sock_fd, const u32 request_type) {
+
+	char buffer[sizeof (PacketHeader) + sizeof (TEST_ECHO_MESSAGE)] = { 0 };
+
+	PacketHeader *header = (PacketHeader *) buffer;
+	header->packet_type = PACKET_TYPE_APP;
+	header->packet_size = sizeof (buffer);
+	header->request_type = request_type;
+
+	(void) memcpy (buffer + sizeof (PacketHeader), TEST_ECHO_MESSAGE, sizeof (TEST_ECHO_MESSAGE));
+
+	test_check_int_eq (
+		send (sock_fd, buffer, sizeof (buffer), 0),
+		(int) sizeof (buffer), NULL
+	);
+
+}
+
+// checks the data of a received app packet,
+// the packets that the cerver sends when a client connects are skipped
+static void test_cerver_echo_receive_tcp (const int sock_fd, const u32 request_type) {
+
+	char buffer[4096] = { 0 };
+	PacketHeader header = { 0 };
+
+	do {
+		test_check_int_eq (
+			recv (sock_fd, &header, sizeof (PacketHeader), MSG_WAITALL),
+			(int) sizeof (PacketHeader), NULL
+		);
+
+		test_check (header.packet_size >= sizeof (PacketHeader), NULL);
+		test_check (header.packet_size <= (sizeof (PacketHeader) + sizeof (buffer)), NULL);
+
+		size_t data_size = header.packet_size - sizeof (PacketHeader);
+		if (data_size) {
+			test_check_int_eq (
+				recv (sock_fd, buffer, data_size, MSG_WAITALL),
+				(int) data_size, NULL
+			);
+		}
+	} while (header.packet_type != PACKET_TYPE_APP);
+
+	test_check_unsigned_eq (header.request_type, request_type, NULL);
+	test_check_unsigned_eq (header.packet_size, sizeof (PacketHeader) + sizeof (TEST_ECHO_MESSAGE), NULL);
+	test_check_str_eq (buffer, TEST_ECHO_MESSAGE, NULL);
+
+}
+
+// waits up to a second for the cerver to get the expected n of clients
+static void test_cerver_echo_wait_clients (Cerver *cerver, const u64 n_clients) {
+
+	for (unsigned int i = 0; i < 100; i++) {
+		if (__atomic_load_n (&cerver->stats->current_n_connected_clients, __ATOMIC_RELAXED) == n_clients)
+			break;
+
+		(void) usleep (10000);
+	}
+
+	test_check_unsigned_eq (cerver->stats->current_n_connected_clients, n_clients, NULL);
+
+}
+
+static void test_cerver_uring_echo (void) {
+
+	if (!cerver_uring_is_supported ()) {
+		(void) printf ("io_uring is not supported, skipping its echo test...\n");
+		return;
+	}
+
+	Cerver *cerver = test_cerver_echo_create (PROTOCOL_TCP, CERVER_HANDLER_TYPE_IO_URING);
+
+	pthread_t thread_id = 0;
+	test_check_int_eq (pthread_create (&thread_id, NULL, test_cerver_echo_start, cerver), 0, NULL);
+
+	// wait for the cerver to listen
+	for (unsigned int i = 0; i < 100 && !cerver->isRunning; i++) (void) usleep (10000);
+	test_check_true (cerver->isRunning);
+
+	int first = test_cerver_echo_connect (SOCK_STREAM);
+	int second = test_cerver_echo_connect (SOCK_STREAM);
+	test_cerver_echo_wait_clients (cerver, 2);
+
+	for (u32 i = 0; i < 8; i++) {
+		test_cerver_echo_send (first, i);
+		test_cerver_echo_send (second, i + 100);
+
+		test_cerver_echo_receive_tcp (first, i);
+		test_cerver_echo_receive_tcp (second, i + 100);
+	}
+
+	// the cerver drops the connections when they are closed
+	(void) close (first);
+	test_cerver_echo_wait_clients (cerver, 1);
+
+	(void) close (second);
+	test_cerver_echo_wait_clients (cerver, 0);
+
+	// the loop stops after its timeout & then the cerver can be deleted
+	test_check_unsigned_eq (cerver_shutdown (cerver), 0, NULL);
+	(void) pthread_join (thread_id, NULL);
+
+	test_check_unsigned_eq (cerver_teardown (cerver), 0, NULL);
+
+}
+
+// sends a single datagram with a packet for each request type
+static void test_cerver_echo_send_datagram (
+	const int sock_fd, const u32 first_request, const u32 n_packets
+) {
+
+	const size_t packet_size = sizeof (PacketHeader) + sizeof (TEST_ECHO_MESSAGE);
+
+	char buffer[4 * (sizeof (PacketHeader) + sizeof (TEST_ECHO_MESSAGE))] = { 0 };
+	test_check (n_packets <= 4, NULL);
+
+	for (u32 i = 0; i < n_packets; i++) {
+		char *end = buffer + (i * packet_size);
+
+		PacketHeader *header = (PacketHeader *) end;
+		header->packet_type = PACKET_TYPE_APP;
+		header->packet_size = packet_size;
+		header->request_type = first_request + i;
+
+		(void) memcpy (end + sizeof (PacketHeader), TEST_ECHO_MESSAGE, sizeof (TEST_ECHO_MESSAGE));
+	}
+
+	test_check_int_eq (
+		send (sock_fd, buffer, n_packets * packet_size, 0),
+		(int) (n_packets * packet_size), NULL
+	);
+
+}
+
+// checks the app packets of the received datagrams until
+// one has been received for each request type, in order
+static void test_cerver_echo_receive_udp (
+	const int sock_fd, const u32 first_request, const u32 n_packets
+) {
+
+	char buffer[MAX_UDP_PACKET_SIZE] = { 0 };
+
+	u32 received = 0;
+	while (received < n_packets) {
+		ssize_t size = recv (sock_fd, buffer, sizeof (buffer), 0);
+		test_check (size >= (ssize_t) sizeof (PacketHeader), "Failed to receive datagram!");
+
+		char *end = buffer;
+		size_t remaining = (size_t) size;
+		while (remaining >= sizeof (PacketHeader)) {
+			PacketHeader *header = (PacketHeader *) end;
+			test_check (header->packet_size >= sizeof (PacketHeader), NULL);
+			test_check (header->packet_size <= remaining, NULL);
+
+			if (header->packet_type == PACKET_TYPE_APP) {
+				test_check_unsigned_eq (header->request_type, first_request + received, NULL);
+				test_check_unsigned_eq (header->packet_size, sizeof (PacketHeader) + sizeof (TEST_ECHO_MESSAGE), NULL);
+				test_check_str_eq (end + sizeof (PacketHeader), TEST_ECHO_MESSAGE, NULL);
+
+				received += 1;
+			}
+
+			end += header->packet_size;
+			remaining -= header->packet_size;
+		}
+	}
+
+}
+
+static void test_cerver_udp_echo (void) {
+
+	Cerver *cerver = test_cerver_echo_create (PROTOCOL_UDP, CERVER_HANDLER_TYPE_POLL);
+	cerver_set_udp_values (cerver, 2, 8);
+
+	pthread_t thread_id = 0;
+	test_check_int_eq (pthread_create (&thread_id, NULL, test_cerver_echo_start, cerver), 0, NULL);
+
+	for (unsigned int i = 0; i < 100 && !cerver->isRunning; i++) (void) usleep (10000);
+	test_check_true (cerver->isRunning);
+
+	// a peer is created for the address of each socket
+	int first = test_cerver_echo_connect (SOCK_DGRAM);
+	int second = test_cerver_echo_connect (SOCK_DGRAM);
+
+	for (u32 i = 0; i < 8; i++) {
+		test_cerver_echo_send_datagram (first, i, 1);
+		test_cerver_echo_send_datagram (second, i + 100, 1);
+
+		test_cerver_echo_receive_udp (first, i, 1);
+		test_cerver_echo_receive_udp (second, i + 100, 1);
+	}
+
+	test_check_unsigned_eq (cerver_udp_get_n_peers (cerver), 2, NULL);
+
+	// the replies to the packets of the same datagram are sent together
+	// & many datagrams can be received before replying to them
+	for (u32 i = 0; i < 4; i++)
+		test_cerver_echo_send_datagram (first, 200 + (i * 4), 4);
+
+	test_cerver_echo_receive_udp (first, 200, 16);
+
+	test_check_unsigned_eq (cerver_udp_get_n_peers (cerver), 2, NULL);
+
+	(void) close (first);
+	(void) close (second);
+
+	test_check_unsigned_eq (cerver_shutdown (cerver), 0, NULL);
+	(void) pthread_join (thread_id, NULL);
+
+	CerverUdpWorkerStats stats = { 0 };
+	for (u32 i = 0; i < cerver->udp_n_workers; i++) {
+		stats.total_peers += cerver->udp_workers[i]->stats.total_peers;
+		stats.n_datagrams_received += cerver->udp_workers[i]->stats.n_datagrams_received;
+		stats.n_bad_datagrams += cerver->udp_workers[i]->stats.n_bad_datagrams;
+		stats.n_sends_done += cerver->udp_workers[i]->stats.n_sends_done;
+		stats.n_datagrams_sent += cerver->udp_workers[i]->stats.n_datagrams_sent;
+	}
+
+	test_check_unsigned_eq (stats.total_peers, 2, NULL);
+	test_check_unsigned_eq (stats.n_datagrams_received, 20, NULL);
+	test_check_unsigned_eq (stats.n_bad_datagrams, 0, NULL);
+	test_check_unsigned_eq (stats.n_datagrams_sent, 32, NULL);
+	test_check (stats.n_sends_done < stats.n_datagrams_sent, NULL);
+
+	test_check_unsigned_eq (cerver_teardown (cerver), 0, NULL);
+
+}
+
 int main (int argc, char **argv) {
 
 	srand ((unsigned) time (NULL));
@@ -68,6 +588,18 @@ int main (int argc, char **argv) {
 
 	test_cerver_base_configuration ();
 
+	test_cerver_stats_snapshot ();
+
+	test_cerver_fd_table ();
+
+	test_cerver_timer_wheel ();
+
+	test_cerver_packet_retain ();
+
+	test_cerver_uring_echo ();
+
+	test_cerver_udp_echo ();
+
 	(void) printf ("\nDone with CERVER tests!\n\n");
 
 	return 0;
@@ -31,6 +31,12 @@ int main (int argc, char **argv) {
 
 	collections_tests_htab ();
 
+	collections_tests_ohtab ();
+
+	collections_tests_pool ();
+
+	collections_tests_slab ();
+
 	(void) printf ("\nDone with COLLECTIONS tests!\n\n");
 
 	cerver_log_end ();
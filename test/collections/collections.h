@@ -7,4 +7,10 @@ extern int collections_tests_dlist (void);
 
 extern void collections_tests_htab (void);
 
+extern void collections_tests_ohtab (void);
+
+extern void collections_tests_pool (void);
+
+extern void collections_tests_slab (void);
+
 #endif
\ No newline at end of file
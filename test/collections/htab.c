@@ -274,6 +274,7 @@ static void test_htab_int_remove_multiple (void) {
 	// insert a new value
 	unsigned int final_value = 18;
 	key = &final_value;
+	data = data_new (final_value, value);
 	int result = htab_insert (
 		map,
 		key, sizeof (unsigned int),
@@ -419,6 +420,58 @@ static void test_htab_int_get_multple (void) {
 
 }
 
+// insert more values than buckets so the map grows
+// while values are also removed in the middle of the resize
+static void test_htab_int_resize (void) {
+
+	Htab *map = test_htab_create ();
+
+	unsigned int idx = 0;
+	for (idx = 0; idx < 1000; idx++) {
+		const void *key = &idx;
+		int result = htab_insert (
+			map,
+			key, sizeof (unsigned int),
+			data_new (idx, idx * 2), sizeof (Data)
+		);
+
+		test_check_int_eq (result, 0, NULL);
+
+		// remove every 4th value
+		if (!(idx % 4)) {
+			Data *removed = (Data *) htab_remove (map, key, sizeof (unsigned int));
+			test_check_ptr (removed);
+			test_check_unsigned_eq (removed->idx, idx, NULL);
+			data_delete (removed);
+		}
+	}
+
+	test_check_int_eq ((int) map->count, 750, NULL);
+	test_check_true ((map->size >= 750));
+
+	// the same key can not be inserted twice
+	idx = 1;
+	Data *data = data_new (idx, 0);
+	test_check_int_eq (htab_insert (map, &idx, sizeof (unsigned int), data, sizeof (Data)), 1, NULL);
+	data_delete (data);
+
+	for (idx = 0; idx < 1000; idx++) {
+		const void *key = &idx;
+		Data *found = (Data *) htab_get (map, key, sizeof (unsigned int));
+		if (idx % 4) {
+			test_check_ptr (found);
+			test_check_unsigned_eq (found->value, idx * 2, NULL);
+		}
+
+		else {
+			test_check_null_ptr (found);
+		}
+	}
+
+	htab_destroy (map);
+
+}
+
 void collections_tests_htab (void) {
 
 	(void) printf ("Testing COLLECTIONS htab...\n");
@@ -435,6 +488,8 @@ void collections_tests_htab (void) {
 
 	test_htab_int_get_multple ();
 
+	test_htab_int_resize ();
+
 	(void) printf ("Done!\n");
 
 }
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cerver/types/types.h>
+
+#include <cerver/collections/ohtab.h>
+
+#include "../test.h"
+
+#include "data.h"
+
+static OHtab *test_ohtab_create (void) {
+
+	OHtab *map = ohtab_create (sizeof (i32), OHTAB_DEFAULT_INIT_SIZE, data_delete);
+
+	test_check_ptr (map);
+	test_check_int_eq ((int) map->table.size, OHTAB_DEFAULT_INIT_SIZE, NULL);
+	test_check_int_eq ((int) ohtab_size (map), 0, NULL);
+
+	return map;
+
+}
+
+// insert, get & remove a single value
+static void test_ohtab_single (void) {
+
+	OHtab *map = test_ohtab_create ();
+
+	i32 sock_fd = 5;
+	Data *data = data_new (0, 1);
+
+	test_check_int_eq (ohtab_insert (map, &sock_fd, data), 0, NULL);
+	test_check_int_eq (ohtab_insert (map, &sock_fd, data), 1, NULL);
+	test_check_int_eq (ohtab_insert (map, &sock_fd, NULL), 1, NULL);
+	test_check_int_eq ((int) ohtab_size (map), 1, NULL);
+
+	test_check_true (ohtab_contains_key (map, &sock_fd));
+	test_check_ptr_eq (ohtab_get (map, &sock_fd), data);
+
+	i32 bad_sock_fd = 6;
+	test_check_false (ohtab_contains_key (map, &bad_sock_fd));
+	test_check_null_ptr (ohtab_remove (map, &bad_sock_fd));
+	test_check_null_ptr (ohtab_get (map, NULL));
+
+	test_check_ptr_eq (ohtab_remove (map, &sock_fd), data);
+	test_check_int_eq ((int) ohtab_size (map), 0, NULL);
+	test_check_null_ptr (ohtab_get (map, &sock_fd));
+
+	data_delete (data);
+
+	ohtab_destroy (map);
+
+}
+
+// insert more values than slots so the map grows
+// while values are also removed in the middle of the resize
+static void test_ohtab_resize (void) {
+
+	OHtab *map = test_ohtab_create ();
+
+	i32 sock_fd = 0;
+	for (sock_fd = 0; sock_fd < 1000; sock_fd++) {
+		test_check_int_eq (
+			ohtab_insert (map, &sock_fd, data_new ((unsigned int) sock_fd, 0)), 0, NULL
+		);
+
+		// remove every 3rd value
+		if (!(sock_fd % 3)) {
+			Data *removed = (Data *) ohtab_remove (map, &sock_fd);
+			test_check_ptr (removed);
+			test_check_int_eq ((int) removed->idx, sock_fd, NULL);
+			data_delete (removed);
+		}
+	}
+
+	test_check_int_eq ((int) ohtab_size (map), 666, NULL);
+	test_check_true ((map->table.size >= 666));
+
+	for (sock_fd = 0; sock_fd < 1000; sock_fd++) {
+		Data *found = (Data *) ohtab_get (map, &sock_fd);
+		if (sock_fd % 3) {
+			test_check_ptr (found);
+			test_check_int_eq ((int) found->idx, sock_fd, NULL);
+		}
+
+		else {
+			test_check_null_ptr (found);
+		}
+	}
+
+	// remove the rest
+	for (sock_fd = 0; sock_fd < 1000; sock_fd++) {
+		if (sock_fd % 3) data_delete (ohtab_remove (map, &sock_fd));
+	}
+
+	test_check_int_eq ((int) ohtab_size (map), 0, NULL);
+
+	ohtab_destroy (map);
+
+}
+
+void collections_tests_ohtab (void) {
+
+	(void) printf ("Testing COLLECTIONS ohtab...\n");
+
+	test_ohtab_single ();
+
+	test_ohtab_resize ();
+
+	(void) printf ("Done!\n");
+
+}
@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <cerver/collections/pool.h>
+
+#include "../test.h"
+
+#include "data.h"
+
+static void *test_pool_data_create (void) {
+
+	return data_new (0, 0);
+
+}
+
+// pushed elements are popped by the same thread
+static void test_pool_reuse (void) {
+
+	Pool *pool = pool_create (data_delete);
+	test_check_ptr (pool);
+
+	test_check_int_eq (pool_init (pool, test_pool_data_create, 8), 0, NULL);
+	test_check_unsigned_eq (pool_size (pool), 8, NULL);
+
+	void *first = pool_pop (pool);
+	test_check_ptr (first);
+	test_check_unsigned_eq (pool_size (pool), 7, NULL);
+
+	test_check_int_eq (pool_push (pool, first), 0, NULL);
+	test_check_ptr_eq (pool_pop (pool), first);
+
+	// the pool only produces elements if it is enabled
+	for (unsigned int i = 0; i < 7; i++) data_delete (pool_pop (pool));
+	test_check_null_ptr (pool_pop (pool));
+
+	pool_set_create (pool, test_pool_data_create);
+	pool_set_produce_if_empty (pool, true);
+
+	void *produced = pool_pop (pool);
+	test_check_ptr (produced);
+
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.hits, 9, NULL);
+	test_check_unsigned_eq (stats.misses, 2, NULL);
+	test_check_unsigned_eq (stats.pushes, 1, NULL);
+
+	data_delete (first);
+	data_delete (produced);
+
+	pool_delete (pool);
+
+}
+
+// elements that don't fit in the pool are given back to the caller
+static void test_pool_max_retained (void) {
+
+	Pool *pool = pool_create (data_delete);
+	test_check_ptr (pool);
+
+	pool_set_max_retained (pool, POOL_MAGAZINE_SIZE);
+
+	void *data = NULL;
+	for (unsigned int i = 0; i < (POOL_MAGAZINE_SIZE * 4); i++) {
+		data = data_new (i, i);
+		test_check_int_eq (pool_push (pool, data), (i < (POOL_MAGAZINE_SIZE * 3)) ? 0 : 1, NULL);
+		if (i >= (POOL_MAGAZINE_SIZE * 3)) data_delete (data);
+	}
+
+	// the thread's magazines & one magazine in the depot
+	test_check_unsigned_eq (pool_size (pool), POOL_MAGAZINE_SIZE * 3, NULL);
+
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.released, POOL_MAGAZINE_SIZE, NULL);
+
+	pool_reset (pool);
+	test_check_unsigned_eq (pool_size (pool), 0, NULL);
+
+	pool_delete (pool);
+
+}
+
+static void *test_pool_thread (void *pool_ptr) {
+
+	Pool *pool = (Pool *) pool_ptr;
+
+	void *elements[64] = { 0 };
+	for (unsigned int i = 0; i < 1000; i++) {
+		for (unsigned int j = 0; j < 64; j++) {
+			elements[j] = pool_pop (pool);
+			test_check_ptr (elements[j]);
+		}
+
+		for (unsigned int j = 0; j < 64; j++) (void) pool_push (pool, elements[j]);
+	}
+
+	return NULL;
+
+}
+
+// the elements kept by threads are returned to the pool when they exit
+static void test_pool_threads (void) {
+
+	Pool *pool = pool_create (data_delete);
+	test_check_ptr (pool);
+
+	pool_set_create (pool, test_pool_data_create);
+	pool_set_produce_if_empty (pool, true);
+
+	pthread_t threads[4];
+	for (unsigned int i = 0; i < 4; i++)
+		test_check_int_eq (pthread_create (&threads[i], NULL, test_pool_thread, pool), 0, NULL);
+
+	for (unsigned int i = 0; i < 4; i++)
+		(void) pthread_join (threads[i], NULL);
+
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.n_elements, stats.misses, NULL);
+	test_check_unsigned_eq (stats.hits + stats.misses, 4 * 1000 * 64, NULL);
+	test_check_unsigned_eq (stats.pushes, 4 * 1000 * 64, NULL);
+
+	pool_delete (pool);
+
+}
+
+void collections_tests_pool (void) {
+
+	(void) printf ("Testing COLLECTIONS pool...\n");
+
+	test_pool_reuse ();
+
+	test_pool_max_retained ();
+
+	test_pool_threads ();
+
+	(void) printf ("Done!\n");
+
+}
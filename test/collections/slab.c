@@ -0,0 +1,111 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <cerver/collections/slab.h>
+
+#include "../test.h"
+
+#include "data.h"
+
+static Slab test_slab = SLAB_INITIALIZER ("test", Data);
+
+// freed objects are reused by the same thread
+static void test_slab_reuse (void) {
+
+	uint64_t hits = slab_get_hits (&test_slab);
+	uint64_t misses = slab_get_misses (&test_slab);
+
+	void *first = slab_alloc (&test_slab);
+	test_check_ptr (first);
+
+	slab_free (&test_slab, first);
+
+	void *second = slab_alloc (&test_slab);
+	test_check_ptr_eq (first, second);
+
+	slab_free (&test_slab, second);
+
+	// counters are flushed when the thread's free objects are released
+	slab_thread_cleanup ();
+
+	test_check_unsigned_eq (slab_get_hits (&test_slab), hits + 1, NULL);
+	test_check_unsigned_eq (slab_get_misses (&test_slab), misses + 1, NULL);
+
+}
+
+// objects are released when the free list is full
+static void test_slab_max_free (void) {
+
+	size_t max_free = slabs_get_max_free ();
+	slabs_set_max_free (1);
+
+	void *first = slab_alloc (&test_slab);
+	void *second = slab_alloc (&test_slab);
+	test_check_ptr (first);
+	test_check_ptr (second);
+
+	slab_free (&test_slab, first);
+	slab_free (&test_slab, second);
+
+	test_check_ptr_eq (slab_alloc (&test_slab), first);
+	void *third = slab_alloc (&test_slab);
+	test_check_ptr (third);
+
+	free (first);
+	free (third);
+
+	slabs_set_max_free (max_free);
+
+	slab_thread_cleanup ();
+
+}
+
+static void *test_slab_thread (void *args) {
+
+	void **objs = (void **) args;
+
+	for (unsigned int i = 0; i < 64; i++) {
+		objs[i] = slab_alloc (&test_slab);
+		test_check_ptr (objs[i]);
+	}
+
+	for (unsigned int i = 0; i < 64; i++) slab_free (&test_slab, objs[i]);
+
+	return NULL;
+
+}
+
+// objects freed in other threads are released when they exit
+static void test_slab_threads (void) {
+
+	void *objs[4][64];
+
+	pthread_t threads[4];
+	for (unsigned int i = 0; i < 4; i++)
+		test_check_int_eq (pthread_create (&threads[i], NULL, test_slab_thread, objs[i]), 0, NULL);
+
+	for (unsigned int i = 0; i < 4; i++)
+		(void) pthread_join (threads[i], NULL);
+
+	bool all_counted = slab_get_misses (&test_slab) >= 256;
+	test_check_true (all_counted);
+
+}
+
+void collections_tests_slab (void) {
+
+	(void) printf ("Testing COLLECTIONS slab...\n");
+
+	test_slab_reuse ();
+
+	test_slab_max_free ();
+
+	test_slab_threads ();
+
+	(void) printf ("Done!\n");
+
+}
@@ -3,7 +3,16 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <arpa/inet.h>
+
 #include <cerver/connection.h>
+#include <cerver/handler.h>
+#include <cerver/packets.h>
 
 #include "test.h"
 
@@ -37,12 +46,402 @@ static void test_connection_base_configuration (void) {
 
 }
 
+#define TEST_SOCK_RECEIVE_N_PACKETS		3
+
+static const size_t test_sock_receive_data_sizes[TEST_SOCK_RECEIVE_N_PACKETS] = {
+	16, 0, 10000
+};
+
+typedef struct TestSockReceive {
+
+	unsigned int n_frames;
+	size_t total_data;
+
+} TestSockReceive;
+
+static u8 test_sock_receive_frame_handler (
+	void *args,
+	PacketHeader *header,
+	char *data, const size_t data_size
+) {
+
+	TestSockReceive *test = (TestSockReceive *) args;
+
+	test_check_unsigned_eq (header->request_type, test->n_frames, NULL);
+	test_check_unsigned_eq (
+		data_size, test_sock_receive_data_sizes[test->n_frames], NULL
+	);
+	test_check_unsigned_eq (header->packet_size, sizeof (PacketHeader) + data_size, NULL);
+
+	for (size_t i = 0; i < data_size; i++)
+		test_check_int_eq (data[i], (char) (i + test->n_frames), NULL);
+
+	test->n_frames += 1;
+	test->total_data += data_size;
+
+	return 0;
+
+}
+
+static char *test_sock_receive_create_stream (size_t *stream_size) {
+
+	*stream_size = 0;
+	for (unsigned int i = 0; i < TEST_SOCK_RECEIVE_N_PACKETS; i++)
+		*stream_size += sizeof (PacketHeader) + test_sock_receive_data_sizes[i];
+
+	char *stream = (char *) calloc (*stream_size, sizeof (char));
+	char *end = stream;
+	for (unsigned int i = 0; i < TEST_SOCK_RECEIVE_N_PACKETS; i++) {
+		PacketHeader header = {
+			.packet_type = PACKET_TYPE_APP,
+			.packet_size = sizeof (PacketHeader) + test_sock_receive_data_sizes[i],
+			.handler_id = 0,
+			.request_type = i,
+			.sock_fd = 0
+		};
+
+		(void) memcpy (end, &header, sizeof (PacketHeader));
+		end += sizeof (PacketHeader);
+
+		for (size_t j = 0; j < test_sock_receive_data_sizes[i]; j++)
+			*end++ = (char) (j + i);
+	}
+
+	return stream;
+
+}
+
+// feeds the same stream in chunks of different sizes
+// to cut packets in every possible place
+static void test_connection_sock_receive (void) {
+
+	size_t stream_size = 0;
+	char *stream = test_sock_receive_create_stream (&stream_size);
+
+	const size_t chunk_sizes[] = { 1, 3, sizeof (PacketHeader) - 1, 100, 4096, stream_size };
+	for (unsigned int i = 0; i < ARRAY_SIZE (chunk_sizes); i++) {
+		SockReceive *sock_receive = sock_receive_new ();
+		test_check_ptr (sock_receive);
+
+		TestSockReceive test = { 0, 0 };
+
+		size_t chunk = 0;
+		for (size_t pos = 0; pos < stream_size; pos += chunk) {
+			chunk = chunk_sizes[i];
+			if (chunk > (stream_size - pos)) chunk = stream_size - pos;
+
+			test_check_unsigned_eq (
+				sock_receive_handle_buffer (
+					sock_receive,
+					stream + pos, chunk,
+					test_sock_receive_frame_handler, &test
+				),
+				0, NULL
+			);
+		}
+
+		test_check_unsigned_eq (test.n_frames, TEST_SOCK_RECEIVE_N_PACKETS, NULL);
+		test_check_unsigned_eq (test.total_data, 10016, NULL);
+		test_check_unsigned_eq (sock_receive->len, 0, NULL);
+
+		sock_receive_delete (sock_receive);
+	}
+
+	free (stream);
+
+}
+
+#define TEST_SEND_QUEUE_CHUNK			4096
+#define TEST_SEND_QUEUE_N_CHUNKS		256
+
+// sends more than what the socket can take without blocking,
+// then reads everything in the other end while flushing the queue
+static void test_connection_send_queue (void) {
+
+	int fds[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), 0, NULL);
+
+	Connection *connection = connection_create_empty ();
+	connection->socket->sock_fd = fds[0];
+	connection->send_queue = connection_send_queue_create (
+		NULL, 64 * 1024, TEST_SEND_QUEUE_CHUNK * TEST_SEND_QUEUE_N_CHUNKS
+	);
+
+	char chunk[TEST_SEND_QUEUE_CHUNK] = { 0 };
+	for (size_t i = 0; i < TEST_SEND_QUEUE_N_CHUNKS; i++) {
+		(void) memset (chunk, (int) i, TEST_SEND_QUEUE_CHUNK);
+
+		struct iovec iov = { .iov_base = chunk, .iov_len = TEST_SEND_QUEUE_CHUNK };
+		size_t sent = 0;
+		test_check_unsigned_eq (
+			connection_send_queue_send (connection, &iov, 1, 0, &sent), 0, NULL
+		);
+
+		test_check_unsigned_eq (sent, TEST_SEND_QUEUE_CHUNK, NULL);
+	}
+
+	test_check (connection_send_queue_get_pending (connection) > 0, NULL);
+	test_check (connection_is_congested (connection), NULL);
+
+	size_t received = 0;
+	char buffer[TEST_SEND_QUEUE_CHUNK] = { 0 };
+	while (received < (TEST_SEND_QUEUE_CHUNK * TEST_SEND_QUEUE_N_CHUNKS)) {
+		ssize_t n = recv (fds[1], buffer, TEST_SEND_QUEUE_CHUNK, MSG_DONTWAIT);
+		if (n > 0) {
+			for (ssize_t j = 0; j < n; j++)
+				test_check_int_eq (buffer[j], (char) ((received + j) / TEST_SEND_QUEUE_CHUNK), NULL);
+
+			received += (size_t) n;
+		}
+
+		else {
+			test_check_unsigned_eq (connection_send_queue_flush (connection), 0, NULL);
+		}
+	}
+
+	test_check_unsigned_eq (connection_send_queue_get_pending (connection), 0, NULL);
+	test_check (!connection_is_congested (connection), NULL);
+
+	// the other end stops reading, so it gets dropped
+	u8 result = 0;
+	for (size_t i = 0; !result && (i < (2 * TEST_SEND_QUEUE_N_CHUNKS)); i++) {
+		struct iovec iov = { .iov_base = chunk, .iov_len = TEST_SEND_QUEUE_CHUNK };
+		result = connection_send_queue_send (connection, &iov, 1, 0, NULL);
+	}
+
+	test_check_unsigned_eq (result, 1, NULL);
+	test_check (connection->send_queue->dropped, NULL);
+	test_check_unsigned_eq (connection_send_queue_get_pending (connection), 0, NULL);
+
+	(void) close (fds[0]);
+	(void) close (fds[1]);
+
+	connection_delete (connection);
+
+}
+
+// coalesced sends are only appended until the connection is flushed
+static void test_connection_send_queue_coalesce (void) {
+
+	int fds[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), 0, NULL);
+
+	Connection *connection = connection_create_empty ();
+	connection->socket->sock_fd = fds[0];
+	connection->send_queue = connection_send_queue_create (
+		NULL,
+		CONNECTION_DEFAULT_SEND_QUEUE_LOW_WATERMARK,
+		CONNECTION_DEFAULT_SEND_QUEUE_HIGH_WATERMARK
+	);
+
+	connection->send_queue->coalesce = true;
+
+	char small[16] = { 0 };
+	for (int i = 0; i < 100; i++) {
+		(void) memset (small, i, sizeof (small));
+
+		struct iovec iov = { .iov_base = small, .iov_len = sizeof (small) };
+		test_check_unsigned_eq (
+			connection_send_queue_send (connection, &iov, 1, 0, NULL), 0, NULL
+		);
+	}
+
+	char buffer[100 * sizeof (small)] = { 0 };
+	test_check_int_eq ((int) recv (fds[1], buffer, sizeof (buffer), MSG_DONTWAIT), -1, NULL);
+	test_check_unsigned_eq (connection_send_queue_get_pending (connection), sizeof (buffer), NULL);
+
+	test_check_unsigned_eq (connection_send_queue_flush (connection), 0, NULL);
+	test_check_unsigned_eq (connection_send_queue_get_pending (connection), 0, NULL);
+
+	test_check_int_eq ((int) recv (fds[1], buffer, sizeof (buffer), MSG_WAITALL), (int) sizeof (buffer), NULL);
+	for (size_t i = 0; i < sizeof (buffer); i++)
+		test_check_int_eq (buffer[i], (char) (i / sizeof (small)), NULL);
+
+	(void) close (fds[0]);
+	(void) close (fds[1]);
+
+	connection_delete (connection);
+
+}
+
+#define TEST_BROADCAST_N_CONNECTIONS			(PACKET_BROADCAST_CHUNK_SIZE + 8)
+
+// the packet is serialized once & the failed recipients are reported
+static void test_connection_broadcast (void) {
+
+	int fds[TEST_BROADCAST_N_CONNECTIONS][2] = { 0 };
+	Connection *connections[TEST_BROADCAST_N_CONNECTIONS] = { 0 };
+
+	const char *message = "broadcast";
+	Packet *packet = packet_create (PACKET_TYPE_APP, 0, message, strlen (message));
+	PacketBroadcast *broadcast = packet_broadcast_create (packet);
+	test_check_ptr (broadcast);
+
+	packet_delete (packet);
+
+	for (size_t i = 0; i < TEST_BROADCAST_N_CONNECTIONS; i++) {
+		test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, fds[i]), 0, NULL);
+
+		connections[i] = connection_create_empty ();
+		connections[i]->socket->sock_fd = fds[i][0];
+
+		test_check_unsigned_eq (packet_broadcast_add (broadcast, NULL, connections[i]), 0, NULL);
+	}
+
+	// the last recipient is closed, so its send fails
+	(void) close (fds[TEST_BROADCAST_N_CONNECTIONS - 1][1]);
+
+	test_check_unsigned_eq (packet_broadcast_send (broadcast, NULL, NULL, MSG_NOSIGNAL), 1, NULL);
+	test_check_unsigned_eq (broadcast->n_sent, TEST_BROADCAST_N_CONNECTIONS - 1, NULL);
+	test_check_unsigned_eq (broadcast->n_failed, 1, NULL);
+	test_check_unsigned_eq (broadcast->recipients[TEST_BROADCAST_N_CONNECTIONS - 1].result, 1, NULL);
+
+	char buffer[sizeof (PacketHeader) + 16] = { 0 };
+	for (size_t i = 0; i < TEST_BROADCAST_N_CONNECTIONS - 1; i++) {
+		test_check_int_eq (
+			(int) recv (fds[i][1], buffer, sizeof (buffer), MSG_DONTWAIT),
+			(int) (sizeof (PacketHeader) + strlen (message)), NULL
+		);
+
+		test_check_unsigned_eq (((PacketHeader *) buffer)->packet_type, PACKET_TYPE_APP, NULL);
+		test_check (!memcmp (buffer + sizeof (PacketHeader), message, strlen (message)), NULL);
+		test_check_unsigned_eq (connections[i]->stats->n_packets_sent, 1, NULL);
+
+		(void) close (fds[i][1]);
+	}
+
+	packet_broadcast_delete (broadcast);
+
+	for (size_t i = 0; i < TEST_BROADCAST_N_CONNECTIONS; i++) {
+		(void) close (fds[i][0]);
+		connection_delete (connections[i]);
+	}
+
+}
+
+#define TEST_ZEROCOPY_SIZE			(512 * 1024)
+
+static bool test_zerocopy_released = false;
+
+static void test_zerocopy_data_delete (void *data) {
+
+	test_zerocopy_released = true;
+
+	free (data);
+
+}
+
+// the large payload is only released after the kernel reports its completion
+static void test_connection_zerocopy (void) {
+
+	struct sockaddr_in address = { 0 };
+	socklen_t len = sizeof (struct sockaddr_in);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+	int listen_fd = socket (AF_INET, SOCK_STREAM, 0);
+	test_check_int_eq (bind (listen_fd, (struct sockaddr *) &address, len), 0, NULL);
+	test_check_int_eq (listen (listen_fd, 1), 0, NULL);
+	test_check_int_eq (getsockname (listen_fd, (struct sockaddr *) &address, &len), 0, NULL);
+
+	int fds[2] = { socket (AF_INET, SOCK_STREAM, 0), -1 };
+	test_check_int_eq (connect (fds[0], (struct sockaddr *) &address, len), 0, NULL);
+	fds[1] = accept (listen_fd, NULL, NULL);
+	test_check (fds[1] > 0, NULL);
+
+	Connection *connection = connection_create_empty ();
+	connection->socket->sock_fd = fds[0];
+	connection->send_queue = connection_send_queue_create (
+		NULL, TEST_ZEROCOPY_SIZE, 2 * TEST_ZEROCOPY_SIZE
+	);
+
+	char *data = (char *) malloc (TEST_ZEROCOPY_SIZE);
+	for (size_t i = 0; i < TEST_ZEROCOPY_SIZE; i++) data[i] = (char) i;
+
+	size_t sent = 0;
+	test_check_unsigned_eq (
+		packet_send_large (
+			PACKET_TYPE_APP, 0,
+			data, TEST_ZEROCOPY_SIZE, test_zerocopy_data_delete,
+			&sent,
+			NULL, NULL, connection, NULL
+		), 0, NULL
+	);
+
+	test_check_unsigned_eq (sent, sizeof (PacketHeader) + TEST_ZEROCOPY_SIZE, NULL);
+
+	// anything that could not be sent was copied to the send queue
+	size_t received = 0;
+	char *buffer = (char *) malloc (sizeof (PacketHeader) + TEST_ZEROCOPY_SIZE);
+	while (received < (sizeof (PacketHeader) + TEST_ZEROCOPY_SIZE)) {
+		ssize_t n = recv (
+			fds[1], buffer + received,
+			sizeof (PacketHeader) + TEST_ZEROCOPY_SIZE - received, MSG_DONTWAIT
+		);
+
+		if (n > 0) received += (size_t) n;
+		else test_check_unsigned_eq (connection_send_queue_flush (connection), 0, NULL);
+	}
+
+	test_check_unsigned_eq (((PacketHeader *) buffer)->packet_type, PACKET_TYPE_APP, NULL);
+	test_check_unsigned_eq (((PacketHeader *) buffer)->packet_size, sizeof (PacketHeader) + TEST_ZEROCOPY_SIZE, NULL);
+	for (size_t i = 0; i < TEST_ZEROCOPY_SIZE; i++)
+		test_check_int_eq (buffer[sizeof (PacketHeader) + i], (char) i, NULL);
+
+	if (connection->zerocopy->enabled) {
+		test_check (connection->stats->total_bytes_zerocopy > 0, NULL);
+
+		for (unsigned int i = 0; (i < 1000) && connection_zerocopy_get_pending (connection); i++) {
+			test_check_unsigned_eq (connection_zerocopy_handle_completions (connection), 0, NULL);
+			(void) usleep (1000);
+		}
+	}
+
+	test_check_unsigned_eq (connection_zerocopy_get_pending (connection), 0, NULL);
+	test_check (test_zerocopy_released, NULL);
+
+	// small payloads are copied & released right away
+	test_zerocopy_released = false;
+	data = (char *) malloc (64);
+	test_check_unsigned_eq (
+		packet_send_large (
+			PACKET_TYPE_APP, 0,
+			data, 64, test_zerocopy_data_delete,
+			&sent,
+			NULL, NULL, connection, NULL
+		), 0, NULL
+	);
+
+	test_check_unsigned_eq (sent, sizeof (PacketHeader) + 64, NULL);
+	test_check (test_zerocopy_released, NULL);
+	test_check_unsigned_eq (connection->stats->n_packets_sent, 2, NULL);
+
+	free (buffer);
+
+	(void) close (fds[1]);
+	(void) close (fds[0]);
+	(void) close (listen_fd);
+
+	connection_delete (connection);
+
+}
+
 int main (int argc, char **argv) {
 
 	(void) printf ("Testing CONNECTION...\n");
 
 	test_connection_base_configuration ();
 
+	test_connection_sock_receive ();
+
+	test_connection_send_queue ();
+
+	test_connection_send_queue_coalesce ();
+
+	test_connection_broadcast ();
+
+	test_connection_zerocopy ();
+
 	(void) printf ("\nDone with CONNECTION tests!\n\n");
 
 	return 0;
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include <cerver/threads/jobs.h>
+#include <cerver/threads/thpool.h>
 #include <cerver/threads/thread.h>
 
 #include "../test.h"
@@ -75,6 +77,107 @@ static void test_threads_cond (void) {
 
 }
 
+static void test_threads_jobs_ring (void) {
+
+	int values[8] = { 0 };
+
+	// capacity is rounded up to the next power of two
+	JobQueue *job_queue = job_queue_create_with_type (JOB_QUEUE_TYPE_RING, 6);
+	test_check_ptr (job_queue);
+	test_check_unsigned_eq (job_queue->mask, 7, NULL);
+
+	for (unsigned int i = 0; i < 8; i++) {
+		test_check_int_eq (job_queue_push (job_queue, job_create (NULL, &values[i])), 0, NULL);
+	}
+
+	test_check_unsigned_eq (job_queue_size (job_queue), 8, NULL);
+
+	// the queue is full
+	Job *job = job_create (NULL, NULL);
+	test_check_int_eq (job_queue_push (job_queue, job), 1, NULL);
+	job_delete (job);
+
+	for (unsigned int i = 0; i < 8; i++) {
+		job = job_queue_pull (job_queue);
+		test_check_ptr (job);
+		test_check_ptr_eq (job->args, &values[i]);
+		job_delete (job);
+	}
+
+	test_check_null_ptr (job_queue_pull (job_queue));
+	test_check_unsigned_eq (job_queue_size (job_queue), 0, NULL);
+
+	job_queue_delete (job_queue);
+
+}
+
+static void test_thpool_work (void *args) {
+
+	(void) __atomic_add_fetch ((unsigned int *) args, 1, __ATOMIC_RELAXED);
+
+}
+
+static void test_threads_thpool_ring (void) {
+
+	unsigned int count = 0;
+
+	Thpool *thpool = thpool_create (4);
+	test_check_ptr (thpool);
+	test_check_unsigned_eq (
+		thpool_set_job_queue_type (thpool, JOB_QUEUE_TYPE_RING, 1024), 0, NULL
+	);
+
+	test_check_unsigned_eq (thpool_init (thpool), 0, NULL);
+
+	for (unsigned int i = 0; i < 1000; i++) {
+		test_check_int_eq (thpool_add_work (thpool, test_thpool_work, &count), 0, NULL);
+	}
+
+	thpool_wait (thpool);
+	while (__atomic_load_n (&count, __ATOMIC_RELAXED) < 1000) {}
+
+	thpool_destroy (thpool);
+
+	test_check_unsigned_eq (count, 1000, NULL);
+
+}
+
+static Thpool *test_thpool = NULL;
+
+// adds a second job from inside the thpool
+static void test_thpool_work_nested (void *args) {
+
+	(void) __atomic_add_fetch ((unsigned int *) args, 1, __ATOMIC_RELAXED);
+	(void) thpool_add_work (test_thpool, test_thpool_work, args);
+
+}
+
+static void test_threads_thpool_work_stealing (void) {
+
+	unsigned int count = 0;
+
+	test_thpool = thpool_create (4);
+	test_check_ptr (test_thpool);
+
+	thpool_set_type (test_thpool, THPOOL_TYPE_WORK_STEALING);
+	test_check_unsigned_eq (thpool_init (test_thpool), 0, NULL);
+
+	// more jobs than the workers queues can hold
+	for (unsigned int i = 0; i < 5000; i++) {
+		test_check_int_eq (thpool_add_work (test_thpool, test_thpool_work_nested, &count), 0, NULL);
+	}
+
+	while (__atomic_load_n (&count, __ATOMIC_RELAXED) < 10000) {}
+	thpool_wait (test_thpool);
+
+	test_check_unsigned_eq (thpool_get_num_threads_working (test_thpool), 0, NULL);
+
+	thpool_destroy (test_thpool);
+
+	test_check_unsigned_eq (count, 10000, NULL);
+
+}
+
 static void threads_tests_main (void) {
 
 	(void) printf ("Testing THREADS main...\n");
@@ -82,6 +185,9 @@ static void threads_tests_main (void) {
 	test_threads_detachable ();
 	test_threads_mutex ();
 	test_threads_cond ();
+	test_threads_jobs_ring ();
+	test_threads_thpool_ring ();
+	test_threads_thpool_work_stealing ();
 
 	(void) printf ("Done!\n");
 
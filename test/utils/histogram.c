@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cerver/utils/histogram.h>
+
+#include "../test.h"
+
+static void utils_tests_histogram_percentiles (void) {
+
+	Histogram *histogram = histogram_new ();
+	test_check_ptr (histogram);
+
+	test_check_unsigned_eq (histogram_get_percentile (histogram, 50), 0, NULL);
+
+	for (u64 value = 1; value <= 1000; value++)
+		histogram_record (histogram, value);
+
+	test_check_unsigned_eq (histogram_get_count (histogram), 1000, NULL);
+	test_check_unsigned_eq (histogram_get_mean (histogram), 500, NULL);
+	test_check_unsigned_eq (histogram_get_max (histogram), 1000, NULL);
+
+	// values are off by at most 1 / 2^HISTOGRAM_SUB_BUCKETS_BITS
+	u64 p50 = histogram_get_percentile (histogram, 50);
+	test_check_true ((p50 >= 500));
+	test_check_true ((p50 <= (500 + (500 >> HISTOGRAM_SUB_BUCKETS_BITS))));
+
+	u64 p99 = histogram_get_percentile (histogram, 99);
+	test_check_true ((p99 >= 990));
+	test_check_true ((p99 <= 1000));
+
+	test_check_unsigned_eq (histogram_get_percentile (histogram, 100), 1000, NULL);
+
+	// small values are exact
+	histogram_reset (histogram);
+	for (u64 value = 0; value < HISTOGRAM_SUB_BUCKETS; value++)
+		histogram_record (histogram, value);
+
+	test_check_unsigned_eq (histogram_get_percentile (histogram, 50), (HISTOGRAM_SUB_BUCKETS / 2) - 1, NULL);
+
+	// values bigger than the last bucket are reported as the max
+	histogram_record_n (histogram, 1ULL << 40, 2 * HISTOGRAM_SUB_BUCKETS);
+	test_check_unsigned_eq (histogram_get_percentile (histogram, 99.9), 1ULL << 40, NULL);
+
+	histogram_delete (histogram);
+
+}
+
+static void utils_tests_histogram_accumulate (void) {
+
+	Histogram *first = histogram_new ();
+	Histogram *second = histogram_new ();
+	Histogram *total = histogram_new ();
+
+	for (u64 value = 0; value < 100; value++) {
+		histogram_record (first, 1000);
+		histogram_record (second, 100000);
+	}
+
+	histogram_accumulate (total, first);
+	histogram_accumulate (total, second);
+
+	test_check_unsigned_eq (histogram_get_count (total), 200, NULL);
+	test_check_unsigned_eq (histogram_get_max (total), 100000, NULL);
+	test_check_true ((histogram_get_percentile (total, 50) < 2000));
+	test_check_true ((histogram_get_percentile (total, 99) >= 100000));
+
+	histogram_delete (first);
+	histogram_delete (second);
+	histogram_delete (total);
+
+}
+
+void utils_tests_histogram (void) {
+
+	(void) printf ("Testing UTILS histogram...\n");
+
+	utils_tests_histogram_percentiles ();
+
+	utils_tests_histogram_accumulate ();
+
+	(void) printf ("Done!\n");
+
+}
@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cerver/utils/log.h>
+
+#include "../test.h"
+
+#define TEST_LOG_N_MESSAGES			256
+#define TEST_LOG_DROP_MESSAGES		2048
+#define TEST_LOG_DROP_SIZE			512
+
+static char test_log_dir[64] = { 0 };
+static char test_log_filename[512] = { 0 };
+
+// reads the whole log file
+static char *test_log_read (size_t *size) {
+
+	char *content = NULL;
+	*size = 0;
+
+	FILE *file = fopen (test_log_filename, "r");
+	if (file) {
+		(void) fseek (file, 0, SEEK_END);
+		long len = ftell (file);
+		(void) fseek (file, 0, SEEK_SET);
+
+		content = (char *) calloc ((size_t) len + 1, sizeof (char));
+		if (content) *size = fread (content, sizeof (char), (size_t) len, file);
+
+		(void) fclose (file);
+	}
+
+	return content;
+
+}
+
+// logs are written to a file in a new directory
+// using the smallest ring, so it wraps around many times
+static void test_log_start (void) {
+
+	(void) strcpy (test_log_dir, "/tmp/cerver-log-XXXXXX");
+	test_check_ptr (mkdtemp (test_log_dir));
+
+	test_check_unsigned_eq (cerver_log_set_path (test_log_dir), 0, NULL);
+	cerver_log_set_output_type (LOG_OUTPUT_TYPE_FILE);
+	cerver_log_set_async (true, LOG_ASYNC_MIN_RING_SIZE);
+
+	cerver_log_init ();
+
+	DIR *dir = opendir (test_log_dir);
+	test_check_ptr (dir);
+
+	struct dirent *entry = NULL;
+	while ((entry = readdir (dir))) {
+		if (entry->d_name[0] != '.') {
+			(void) snprintf (
+				test_log_filename, sizeof (test_log_filename),
+				"%s/%s", test_log_dir, entry->d_name
+			);
+		}
+	}
+
+	(void) closedir (dir);
+
+	test_check (test_log_filename[0] != '\0', "Failed to find log file!");
+
+}
+
+static void test_log_end (void) {
+
+	cerver_log_end ();
+
+	cerver_log_set_async (false, 0);
+	cerver_log_set_output_type (LOG_OUTPUT_TYPE_STD);
+
+	(void) unlink (test_log_filename);
+	(void) rmdir (test_log_dir);
+
+}
+
+static void test_log_flush (void) {
+
+	cerver_log_raw ("Hello async log!\n");
+	cerver_log_flush ();
+
+	size_t size = 0;
+	char *content = test_log_read (&size);
+	test_check_ptr (content);
+
+	test_check_str_eq (content, "Hello async log!\n", NULL);
+
+	free (content);
+
+}
+
+// messages with different sizes make the ring skip its end
+// so every one of them must be written complete & in order
+static void test_log_ring_wrap (void) {
+
+	size_t expected_size = 0;
+	char *expected = (char *) calloc (TEST_LOG_N_MESSAGES * LOG_MESSAGE_SIZE, sizeof (char));
+	test_check_ptr (expected);
+
+	char message[LOG_MESSAGE_SIZE] = { 0 };
+
+	const u64 dropped = cerver_log_get_dropped ();
+
+	size_t size = 0;
+	char *previous = test_log_read (&size);
+	test_check_ptr (previous);
+
+	for (unsigned int i = 0; i < TEST_LOG_N_MESSAGES; i++) {
+		size_t len = 100 + ((i * 997) % (LOG_MESSAGE_SIZE - 200));
+		(void) memset (message, 'a' + (i % 26), len);
+		message[len] = '\n';
+		message[len + 1] = '\0';
+
+		(void) memcpy (expected + expected_size, message, len + 1);
+		expected_size += len + 1;
+
+		// the ring never fills, so no message is dropped
+		cerver_log_raw ("%s", message);
+		cerver_log_flush ();
+	}
+
+	test_check_unsigned_eq (cerver_log_get_dropped (), dropped, NULL);
+
+	char *content = test_log_read (&size);
+	test_check_ptr (content);
+
+	const size_t previous_size = strlen (previous);
+	test_check_unsigned_eq (size, previous_size + expected_size, NULL);
+	test_check (!memcmp (content + previous_size, expected, expected_size), "Messages do not match!");
+
+	free (content);
+	free (previous);
+	free (expected);
+
+}
+
+// messages that don't fit in the ring are dropped & counted
+// every other one is written
+static void test_log_dropped (void) {
+
+	char message[TEST_LOG_DROP_SIZE] = { 0 };
+	(void) memset (message, 'x', TEST_LOG_DROP_SIZE - 2);
+	message[TEST_LOG_DROP_SIZE - 2] = '\n';
+
+	const u64 dropped = cerver_log_get_dropped ();
+
+	size_t previous_size = 0;
+	char *previous = test_log_read (&previous_size);
+	test_check_ptr (previous);
+
+	for (unsigned int i = 0; i < TEST_LOG_DROP_MESSAGES; i++)
+		cerver_log_raw ("%s", message);
+
+	cerver_log_flush ();
+
+	const u64 n_dropped = cerver_log_get_dropped () - dropped;
+	test_check_unsigned_gt (n_dropped, 0);
+
+	size_t size = 0;
+	char *content = test_log_read (&size);
+	test_check_ptr (content);
+
+	const size_t n_written = (size - previous_size) / (TEST_LOG_DROP_SIZE - 1);
+	test_check_unsigned_eq (n_written + n_dropped, TEST_LOG_DROP_MESSAGES, NULL);
+
+	free (content);
+	free (previous);
+
+}
+
+void utils_tests_log (void) {
+
+	(void) printf ("Testing UTILS log...\n");
+
+	test_log_start ();
+
+	test_log_flush ();
+	test_log_ring_wrap ();
+	test_log_dropped ();
+
+	test_log_end ();
+
+	(void) printf ("Done!\n");
+
+}
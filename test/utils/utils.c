@@ -9,10 +9,14 @@ int main (int argc, char **argv) {
 
 	utils_tests_base64 ();
 
+	utils_tests_histogram ();
+
 	utils_tests_c_strings ();
 
 	utils_tests_sha256 ();
 
+	utils_tests_log ();
+
 	(void) printf ("\nDone with UTILS tests!\n\n");
 
 	return 0;
@@ -5,6 +5,10 @@ extern void utils_tests_base64 (void);
 
 extern void utils_tests_c_strings (void);
 
+extern void utils_tests_histogram (void);
+
+extern void utils_tests_log (void);
+
 extern void utils_tests_sha256 (void);
 
 #endif
\ No newline at end of file